@@ -0,0 +1,161 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** Asynchronous memory copies between host and device for LMS.
+ */
+#ifndef __NBLA_CUDA_ARRAY_SWAP_ENGINE_HPP__
+#define __NBLA_CUDA_ARRAY_SWAP_ENGINE_HPP__
+
+#include <nbla/array.hpp>
+#include <nbla/cuda/defs.hpp>
+#include <nbla/singleton_manager.hpp>
+#include <nbla/synced_array.hpp>
+
+#include <cuda_runtime.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace nbla {
+
+/** Statistics of the copies issued by CudaSwapEngine.
+ */
+struct CudaSwapStatistics {
+  size_t bytes_htod = 0;          ///< Bytes copied from host to device
+  size_t bytes_dtoh = 0;          ///< Bytes copied from device to host
+  size_t copies_htod = 0;         ///< Number of copies from host to device
+  size_t copies_dtoh = 0;         ///< Number of copies from device to host
+  size_t pageable_copies = 0;     ///< Copies from or to non-pinned memory
+  size_t bytes_in_flight = 0;     ///< Bytes of copies not finished yet
+  size_t max_bytes_in_flight = 0; ///< Peak of bytes_in_flight
+  size_t throttles = 0;           ///< Times the host waited for a free slot
+  double throttle_ms = 0;         ///< Host time spent in those waits
+  /** Times the compute stream had to wait for an unfinished copy. Zero means
+      every swap-in was hidden behind computation.
+   */
+  size_t late_waits = 0;
+  /** Time the compute stream spent in those waits, measured by events around
+      each of them. Waits not finished yet are not included.
+   */
+  double stall_ms = 0;
+  size_t prefetches = 0; ///< Arrays given to CudaSwapEngine::prefetch()
+};
+
+/** Issues the asynchronous copies of LMS on two non-blocking streams.
+
+    Swap-ins (host to device) run on Cuda::stream_HtoD and swap-outs on
+    Cuda::stream_DtoH. The streams are created with the greatest and the least
+    priority respectively, so a swap-in needed by the next function overtakes
+    queued swap-outs.
+
+    Events are taken from a pool instead of being created for each copy, and
+    the null stream is ordered before a copy with a single reused event per
+    device.
+
+    At most NNABLA_CUDA_LMS_MAX_INFLIGHT copies (default 16, 0 for no limit)
+    are in flight. Issuing another one blocks the host until the oldest
+    finishes, which keeps the scheduler from running ahead of the copy
+    engines and holding the memory of too many pending arrays.
+
+    Host arrays should be CudaCachedHostArray, i.e. pinned memory from
+    Cuda::pinned_allocator(). Copies from or to pageable memory are not
+    asynchronous and are counted in CudaSwapStatistics::pageable_copies.
+ */
+class NBLA_CUDA_API CudaSwapEngine {
+public:
+  ~CudaSwapEngine();
+
+  /** Copies src to dst asynchronously and records the copy in dst.
+
+      @param kind cudaMemcpyHostToDevice or cudaMemcpyDeviceToHost.
+      @param device Device of the device-side array.
+      @param keep_src Keep src alive until the copy finishes.
+   */
+  void copy(Array *src, Array *dst, cudaMemcpyKind kind, int device,
+            bool keep_src);
+
+  /** Starts the swap-in of `array` to the device of `ctx` ahead of its use.
+
+      The copy is issued like an asynchronous swap-in of LMS, and the first
+      use of the array on the device waits for it. Nothing is copied if the
+      array is already on the device. The pages of a unified memory array are
+      also migrated to the device on the swap-in stream.
+   */
+  void prefetch(SyncedArrayPtr array, dtypes dtype, const Context &ctx);
+
+  /** Makes the null stream wait for the unfinished copy recorded in `event`
+      and measures the time of the wait. Called by CudaEvent.
+   */
+  void wait_late(cudaEvent_t event);
+
+  /** Greatest number of copies in flight. 0 means no limit. */
+  size_t get_max_in_flight();
+  void set_max_in_flight(size_t max_in_flight);
+
+  CudaSwapStatistics get_statistics();
+  void reset_statistics();
+
+  /** Waits for all copies and releases the pooled events. */
+  void clear();
+
+protected:
+  struct InFlight {
+    shared_ptr<cudaEvent_t> event;
+    size_t bytes;
+  };
+
+  /** Timing events recorded around a wait of the null stream. */
+  struct Stall {
+    int device;
+    cudaEvent_t begin;
+    cudaEvent_t end;
+  };
+
+  std::mutex mtx_;
+  size_t max_in_flight_;
+  std::deque<InFlight> in_flight_;
+  std::unordered_map<int, cudaEvent_t> order_events_;
+  std::deque<Stall> stalls_; ///< Waits not measured yet.
+  std::unordered_map<int, std::vector<Stall>> stall_events_;
+  /** Pooled events per device. Shared with the deleters of the events handed
+      out, which may outlive this object.
+   */
+  struct EventPool;
+  shared_ptr<EventPool> pool_;
+  CudaSwapStatistics stats_;
+
+  cudaStream_t stream(cudaMemcpyKind kind, int device);
+  shared_ptr<cudaEvent_t> get_event(int device);
+  void retire(bool wait_oldest);
+  void collect_stalls(bool wait);
+
+private:
+  friend SingletonManager;
+  CudaSwapEngine();
+  DISABLE_COPY_AND_ASSIGN(CudaSwapEngine);
+};
+
+/** Wrapper functions of CudaSwapEngine.
+ */
+NBLA_CUDA_API CudaSwapStatistics cuda_swap_get_statistics();
+NBLA_CUDA_API void cuda_swap_reset_statistics();
+NBLA_CUDA_API size_t cuda_swap_get_max_in_flight();
+NBLA_CUDA_API void cuda_swap_set_max_in_flight(size_t max_in_flight);
+NBLA_CUDA_API void cuda_swap_prefetch(SyncedArrayPtr array, dtypes dtype,
+                                      const Context &ctx);
+}
+#endif
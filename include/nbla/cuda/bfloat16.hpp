@@ -0,0 +1,277 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NBLA_CUDA_BFLOAT16_HPP_
+#define NBLA_CUDA_BFLOAT16_HPP_
+#include <nbla/cuda/half.hpp>
+
+#if CUDA_VERSION >= 11000
+#include <cuda_bf16.h>
+#define NBLA_CUDA_BFLOAT16 1
+#else
+#define NBLA_CUDA_BFLOAT16 0
+#endif
+
+#if NBLA_CUDA_BFLOAT16
+namespace nbla {
+
+/** Operator overloaded class for CUDA bfloat16 type.
+
+    bfloat16 keeps the exponent range of float, so networks can be trained in
+   it without loss scaling. Only the storage is 16-bit. All arithmetic runs in
+   float, and CudaTypeForceFloat maps the type to float for accumulation.
+ */
+struct NBLA_ALIGN(2) BFloat16Cuda {
+  __nv_bfloat16 h;
+  // ----------------------------------------------------------------------------
+  // Constructors
+  // ----------------------------------------------------------------------------
+  HALF_CUDA_HOSTDEVICE_PREFIX BFloat16Cuda() {}
+  HALF_CUDA_HOSTDEVICE_PREFIX BFloat16Cuda(const __nv_bfloat16 &rhs)
+      : h(rhs) {}
+  HALF_CUDA_HOSTDEVICE_PREFIX BFloat16Cuda(const BFloat16Cuda &rhs)
+      : h(rhs.h) {}
+  HALF_CUDA_HOSTDEVICE_PREFIX BFloat16Cuda(float f)
+      : h(__float2bfloat16(f)) {}
+  HALF_CUDA_HOSTDEVICE_PREFIX BFloat16Cuda &operator=(const BFloat16Cuda &rhs) {
+    h = rhs.h;
+    return *this;
+  }
+  HALF_CUDA_HOSTDEVICE_PREFIX unsigned short as_bits() const {
+    return ((__nv_bfloat16_raw)h).x;
+  }
+
+  // ----------------------------------------------------------------------------
+  // Cast
+  // ----------------------------------------------------------------------------
+  HALF_CUDA_HOSTDEVICE_PREFIX operator float() const {
+    return __bfloat162float(h);
+  }
+
+#if NBLA_CUDA_HALF
+  // ----------------------------------------------------------------------------
+  // Arithmetic operators
+  // ----------------------------------------------------------------------------
+  HALF_CUDA_PREFIX BFloat16Cuda operator+() const { return *this; }
+  HALF_CUDA_PREFIX BFloat16Cuda operator-() const {
+    return BFloat16Cuda{-(float)(*this)};
+  }
+#define AOP(OP)                                                                \
+  HALF_CUDA_PREFIX BFloat16Cuda operator OP(const BFloat16Cuda &rhs) const {   \
+    return BFloat16Cuda{(float)(*this) OP(float) rhs};                         \
+  }
+  AOP(+);
+  AOP(-);
+  AOP(*);
+  AOP(/);
+#undef AOP
+#define AOP(OP, TYPE)                                                          \
+  HALF_CUDA_PREFIX TYPE operator OP(const TYPE &rhs) const {                   \
+    return (float)(*this)OP rhs;                                               \
+  }
+#define AOPS(TYPE)                                                             \
+  AOP(+, TYPE);                                                                \
+  AOP(-, TYPE);                                                                \
+  AOP(*, TYPE);                                                                \
+  AOP(/, TYPE)
+  AOPS(float);
+  AOPS(double);
+#undef AOP
+#undef AOPS
+#define AOP(OP, TYPE)                                                          \
+  HALF_CUDA_PREFIX BFloat16Cuda operator OP(const TYPE &rhs) const {           \
+    return *this OP BFloat16Cuda((float)rhs);                                  \
+  }
+#define AOPS(TYPE)                                                             \
+  AOP(+, TYPE);                                                                \
+  AOP(-, TYPE);                                                                \
+  AOP(*, TYPE);                                                                \
+  AOP(/, TYPE)
+  AOPS(bool);
+  AOPS(unsigned char);
+  AOPS(char);
+  AOPS(unsigned short);
+  AOPS(short);
+  AOPS(unsigned int);
+  AOPS(int);
+  AOPS(unsigned long);
+  AOPS(long);
+  AOPS(unsigned long long);
+  AOPS(long long);
+#undef AOP
+#undef AOPS
+  // ----------------------------------------------------------------------------
+  // Inplace arithmetic operators
+  // ----------------------------------------------------------------------------
+#define IAOP(OP)                                                               \
+  template <typename RhsType>                                                  \
+  HALF_CUDA_PREFIX BFloat16Cuda &operator OP##=(const RhsType &rhs) {          \
+    *this = BFloat16Cuda{(float)(*this OP rhs)};                               \
+    return *this;                                                              \
+  }
+  IAOP(+);
+  IAOP(-);
+  IAOP(*);
+  IAOP(/);
+#undef IAOP
+#endif // NBLA_CUDA_HALF
+};
+
+#if NBLA_CUDA_HALF
+// ----------------------------------------------------------------------------
+// Scalar (left hand side) and relational operators
+// ----------------------------------------------------------------------------
+#define AOP(OP, TYPE)                                                          \
+  HALF_CUDA_PREFIX TYPE operator OP(const TYPE &lhs,                           \
+                                    const BFloat16Cuda &rhs) {                 \
+    return lhs OP(float) rhs;                                                  \
+  }
+#define AOPS(TYPE)                                                             \
+  AOP(+, TYPE);                                                                \
+  AOP(-, TYPE);                                                                \
+  AOP(*, TYPE);                                                                \
+  AOP(/, TYPE)
+AOPS(float);
+AOPS(double);
+#undef AOP
+#undef AOPS
+#define AOP(OP, TYPE)                                                          \
+  HALF_CUDA_PREFIX BFloat16Cuda operator OP(const TYPE &lhs,                   \
+                                            const BFloat16Cuda &rhs) {         \
+    return BFloat16Cuda((float)lhs) OP rhs;                                    \
+  }
+#define AOPS(TYPE)                                                             \
+  AOP(+, TYPE);                                                                \
+  AOP(-, TYPE);                                                                \
+  AOP(*, TYPE);                                                                \
+  AOP(/, TYPE)
+AOPS(bool);
+AOPS(unsigned char);
+AOPS(char);
+AOPS(unsigned short);
+AOPS(short);
+AOPS(unsigned int);
+AOPS(int);
+AOPS(unsigned long);
+AOPS(long);
+AOPS(unsigned long long);
+AOPS(long long);
+#undef AOP
+#undef AOPS
+#define ROP_TYPE(OP, LTYPE, RTYPE)                                             \
+  HALF_CUDA_PREFIX bool operator OP(const LTYPE &lhs, const RTYPE &rhs) {      \
+    return (float)lhs OP(float) rhs;                                           \
+  }
+#define ROPS(LTYPE, RTYPE)                                                     \
+  ROP_TYPE(<, LTYPE, RTYPE);                                                   \
+  ROP_TYPE(>, LTYPE, RTYPE);                                                   \
+  ROP_TYPE(<=, LTYPE, RTYPE);                                                  \
+  ROP_TYPE(>=, LTYPE, RTYPE);                                                  \
+  ROP_TYPE(==, LTYPE, RTYPE);                                                  \
+  ROP_TYPE(!=, LTYPE, RTYPE)
+#define ROP(TYPE)                                                              \
+  ROPS(BFloat16Cuda, TYPE);                                                    \
+  ROPS(TYPE, BFloat16Cuda)
+ROPS(BFloat16Cuda, BFloat16Cuda);
+ROP(int);
+ROP(float);
+ROP(double);
+#undef ROP_TYPE
+#undef ROPS
+#undef ROP
+#endif // NBLA_CUDA_HALF
+
+// ----------------------------------------------------------------------------
+// Type traits
+// ----------------------------------------------------------------------------
+template <> struct CudaTypeForceFloat<BFloat16Cuda> { typedef float type; };
+template <> struct CudaTypeForceFloat<__nv_bfloat16> { typedef float type; };
+template <> struct CudaNativeType<BFloat16Cuda> {
+  typedef __nv_bfloat16 type;
+};
+template <>
+inline typename CudaNativeType<BFloat16Cuda>::type
+get_native_arg<BFloat16Cuda>(const BFloat16Cuda &v) {
+  return v.h;
+}
+template <>
+inline typename CudaNativeType<BFloat16Cuda>::type
+get_cuda_native_scalar<BFloat16Cuda>(float val) {
+  return BFloat16Cuda(val).h;
+}
+} // End of nbla
+
+#if NBLA_CUDA_HALF
+// ----------------------------------------------------------------------------
+// cmath functions
+// ----------------------------------------------------------------------------
+#define MATHF_F(FUNC)                                                          \
+  HALF_CUDA_PREFIX nbla::BFloat16Cuda FUNC(const nbla::BFloat16Cuda &h) {      \
+    return nbla::BFloat16Cuda{FUNC((float)h)};                                 \
+  }
+namespace std {
+MATHF_F(abs);
+MATHF_F(fabs);
+MATHF_F(tanh);
+MATHF_F(exp);
+MATHF_F(log);
+MATHF_F(sqrt);
+MATHF_F(floor);
+MATHF_F(ceil);
+} // End of std
+MATHF_F(abs);
+MATHF_F(fabs);
+MATHF_F(sin);
+MATHF_F(cos);
+MATHF_F(tan);
+MATHF_F(sinh);
+MATHF_F(cosh);
+MATHF_F(tanh);
+MATHF_F(asin);
+MATHF_F(acos);
+MATHF_F(atan);
+MATHF_F(asinh);
+MATHF_F(acosh);
+MATHF_F(atanh);
+MATHF_F(round);
+MATHF_F(exp);
+MATHF_F(log);
+MATHF_F(sqrt);
+MATHF_F(rsqrt);
+MATHF_F(floor);
+MATHF_F(ceil);
+#undef MATHF_F
+HALF_CUDA_PREFIX nbla::BFloat16Cuda max(const nbla::BFloat16Cuda &a,
+                                        const nbla::BFloat16Cuda &b) {
+  return a > b ? a : b;
+}
+HALF_CUDA_PREFIX nbla::BFloat16Cuda min(const nbla::BFloat16Cuda &a,
+                                        const nbla::BFloat16Cuda &b) {
+  return a < b ? a : b;
+}
+HALF_CUDA_PREFIX nbla::BFloat16Cuda pow(const nbla::BFloat16Cuda &a,
+                                        const nbla::BFloat16Cuda &b) {
+  return pow((float)a, (float)b);
+}
+HALF_CUDA_PREFIX int isnan(const nbla::BFloat16Cuda &x) {
+  return (x.as_bits() & 0x7FFF) > 0x7F80;
+}
+HALF_CUDA_PREFIX int isinf(const nbla::BFloat16Cuda &x) {
+  return (x.as_bits() & 0x7FFF) == 0x7F80;
+}
+#endif // NBLA_CUDA_HALF
+#endif // NBLA_CUDA_BFLOAT16
+
+// ----------------------------------------------------------------------------
+#endif
@@ -28,10 +28,15 @@
 #include <nbla/common.hpp>
 #include <nbla/cuda/defs.hpp>
 #include <nbla/cuda/init.hpp>
+#include <nbla/cuda/launch.hpp>
+#include <nbla/cuda/profiler.hpp>
 #include <nbla/exception.hpp>
 
+#include <nbla/cuda/bfloat16.hpp>
 #include <nbla/cuda/half.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <map>
 
 namespace nbla {
@@ -155,6 +160,10 @@ CUDA_TYPE_T(Half, R_16F);
 CUDA_TYPE_T(HalfCuda, R_16F);
 CUDA_TYPE_T(uint8_t, R_8U);
 CUDA_TYPE_T(int8_t, R_8I);
+#if NBLA_CUDA_BFLOAT16
+CUDA_TYPE_T(__nv_bfloat16, R_16BF);
+CUDA_TYPE_T(BFloat16Cuda, R_16BF);
+#endif
 #undef CUDA_TYPE_T
 
 #else // CUDA_VERSION >= 8000
@@ -229,17 +238,20 @@ inline Size_t cuda_get_blocks_by_size_with_size_t(const Size_t size) {
 /** Launch simple kernel */
 #define NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, size, ...)                      \
   {                                                                            \
-    (kernel)<<<cuda_get_blocks_by_size(size), NBLA_CUDA_NUM_THREADS>>>(        \
-        (size), __VA_ARGS__);                                                  \
+    (kernel)<<<cuda_get_blocks_by_size(size), NBLA_CUDA_NUM_THREADS, 0,        \
+               cuda_get_current_stream()>>>((size), __VA_ARGS__);              \
     NBLA_CUDA_KERNEL_CHECK();                                                  \
+    cuda_profiler_count_launch();                                              \
   }
 
 /** Launch simple kernel */
 #define NBLA_CUDA_LAUNCH_KERNEL_SIMPLE_SIZE_T(kernel, size, ...)               \
   {                                                                            \
     (kernel)<<<cuda_get_blocks_by_size_with_size_t(size),                      \
-               NBLA_CUDA_NUM_THREADS>>>((size), __VA_ARGS__);                  \
+               NBLA_CUDA_NUM_THREADS, 0, cuda_get_current_stream()>>>(         \
+        (size), __VA_ARGS__);                                                  \
     NBLA_CUDA_KERNEL_CHECK();                                                  \
+    cuda_profiler_count_launch();                                              \
   }
 
 /** Launch simple kernel */
@@ -248,6 +260,29 @@ inline Size_t cuda_get_blocks_by_size_with_size_t(const Size_t size) {
     (kernel)<<<cuda_get_blocks_by_size(size), NBLA_CUDA_NUM_THREADS, 0,        \
                (stream)>>>((size), __VA_ARGS__);                               \
     NBLA_CUDA_KERNEL_CHECK();                                                  \
+    cuda_profiler_count_launch();                                              \
+  }
+
+/** Launch simple kernel with an occupancy-aware configuration.
+
+    Same arguments as NBLA_CUDA_LAUNCH_KERNEL_SIMPLE, except that `kernel`
+    must name a single function, e.g. with explicit template arguments.
+    The block size is taken from cudaOccupancyMaxPotentialBlockSize of the
+    kernel, or from the override table of CudaLaunchConfigCache, instead of
+    NBLA_CUDA_NUM_THREADS. The kernel must contain a grid-strided loop and
+    must not depend on the block size. Nothing is launched for size 0.
+ */
+#define NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY(kernel, size, ...)                   \
+  {                                                                            \
+    static thread_local CudaLaunchSite nbla_launch_site;                       \
+    const auto nbla_launch_dims =                                              \
+        nbla_launch_site.get_launch_dims(kernel, #kernel, size);               \
+    if (nbla_launch_dims.blocks > 0) {                                         \
+      (kernel)<<<nbla_launch_dims.blocks, nbla_launch_dims.threads, 0,         \
+                 cuda_get_current_stream()>>>((size), __VA_ARGS__);            \
+      NBLA_CUDA_KERNEL_CHECK();                                                \
+      cuda_profiler_count_launch();                                            \
+    }                                                                          \
   }
 
 /** Cuda grid-strided loop */
@@ -263,6 +298,58 @@ inline Size_t cuda_get_blocks_by_size_with_size_t(const Size_t size) {
        idx < (num); idx += static_cast<Size_t>(blockDim.x) *                   \
                            static_cast<Size_t>(gridDim.x))
 
+/** Cuda grid-strided loop with an index type of `index_t` */
+#define NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t)                         \
+  for (index_t idx = static_cast<index_t>(blockIdx.x) *                        \
+                         static_cast<index_t>(blockDim.x) +                    \
+                     static_cast<index_t>(threadIdx.x);                        \
+       idx < (num); idx += static_cast<index_t>(blockDim.x) *                  \
+                           static_cast<index_t>(gridDim.x))
+
+/** Max size iterated with int indices.
+
+    The margin keeps a grid-strided loop from overflowing int when it steps
+    past the end with up to NBLA_CUDA_MAX_BLOCKS blocks of 1024 threads.
+ */
+#define NBLA_CUDA_MAX_INT_INDEX_SIZE                                           \
+  (static_cast<Size_t>(std::numeric_limits<int>::max()) -                      \
+   static_cast<Size_t>(NBLA_CUDA_MAX_BLOCKS) * 1024)
+
+/** Whether `size` elements can be indexed by int in a kernel. */
+inline bool cuda_can_use_int_index(const Size_t size) {
+  return size <= NBLA_CUDA_MAX_INT_INDEX_SIZE;
+}
+
+/** Launch simple kernel templated on the index type.
+
+    `kernel` names the kernel with `index_t` as a template argument, e.g.
+    `(kernel_update<T, index_t>)`. `index_t` is int if `size` fits, which is
+    faster for the index arithmetic, and Size_t otherwise. The kernel takes
+    the size as `index_t` and iterates with NBLA_CUDA_KERNEL_LOOP_INDEX.
+ */
+#define NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(kernel, size, ...)              \
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(kernel, size, size,        \
+                                                    __VA_ARGS__)
+
+/** Same as NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX except that `index_t` is
+    chosen by `bound`, the number of elements of the largest array indexed in
+    the kernel, when it is larger than `size`.
+ */
+#define NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(kernel, bound, size, \
+                                                          ...)                 \
+  {                                                                            \
+    const Size_t nbla_launch_size = (size);                                    \
+    if (cuda_can_use_int_index(std::max<Size_t>(nbla_launch_size, (bound)))) { \
+      typedef int index_t;                                                     \
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(                                          \
+          kernel, static_cast<index_t>(nbla_launch_size), __VA_ARGS__);        \
+    } else {                                                                   \
+      typedef Size_t index_t;                                                  \
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE_SIZE_T(kernel, nbla_launch_size,          \
+                                            __VA_ARGS__);                      \
+    }                                                                          \
+  }
+
 /** Instantiate template CUDA functions */
 #define NBLA_INSTANTIATE_CUDA_FUNCS(type, classname)                           \
   template void classname<type>::forward_impl(const Variables &inputs,         \
@@ -289,5 +376,21 @@ NBLA_CUDA_API vector<size_t> cuda_mem_get_info();
 cudaDeviceProp cuda_get_current_device_properties();
 
 int cuda_get_current_device_attribute(cudaDeviceAttr attr);
+
+/** Get the stream which functions are issued to in the calling thread.
+
+    It is the null stream except while a CudaGraph is captured. Kernels
+    launched by NBLA_CUDA_LAUNCH_KERNEL_SIMPLE and the cuBLAS and cuDNN calls
+    follow it.
+ */
+NBLA_CUDA_API cudaStream_t cuda_get_current_stream();
+NBLA_CUDA_API void cuda_set_current_stream(cudaStream_t stream);
+
+/** Raise an error if the current stream is captured into a CUDA graph.
+
+    Called by functions which synchronize with the host and thus cannot be
+    replayed by a graph.
+ */
+NBLA_CUDA_API void cuda_check_not_capturing(const char *name);
 }
 #endif
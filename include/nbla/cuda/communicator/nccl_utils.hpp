@@ -18,6 +18,7 @@
 #define __NBLA_NCCL_NCCLUTILS_HPP__
 #include <nbla/array.hpp>
 #include <nbla/context.hpp>
+#include <nbla/cuda/bfloat16.hpp>
 #include <nbla/variable.hpp>
 
 #include <memory>
@@ -51,5 +52,10 @@ template <> inline ncclDataType_t get_nccl_dtype<Half>() { return ncclHalf; }
 template <> inline ncclDataType_t get_nccl_dtype<HalfCuda>() {
   return ncclHalf;
 }
+#if NBLA_CUDA_BFLOAT16 && NCCL_VERSION_CODE >= 21000
+template <> inline ncclDataType_t get_nccl_dtype<BFloat16Cuda>() {
+  return ncclBfloat16;
+}
+#endif
 }
 #endif
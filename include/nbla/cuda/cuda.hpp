@@ -119,6 +119,9 @@ public:
   cudaStream_t stream_DtoH = 0;
 
   /** Create non blockuing streams for data transfer
+
+      stream_HtoD has the greatest priority and stream_DtoH the least.
+      CudaSwapEngine creates them on the first asynchronous copy.
    */
   void create_lms_streams(int device = -1);
 
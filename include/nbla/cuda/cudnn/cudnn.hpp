@@ -27,6 +27,7 @@
 #include <nbla/cuda/defs.hpp>
 #include <nbla/singleton_manager.hpp>
 
+#include <nbla/cuda/bfloat16.hpp>
 #include <nbla/cuda/half.hpp>
 
 #include <algorithm>
@@ -67,6 +68,16 @@ template <> class cudnn_data_type<HalfCuda> {
 public:
   static cudnnDataType_t type() { return CUDNN_DATA_HALF; }
 };
+#if NBLA_CUDA_BFLOAT16 && CUDNN_VERSION >= 8100
+template <> class cudnn_data_type<__nv_bfloat16> {
+public:
+  static cudnnDataType_t type() { return CUDNN_DATA_BFLOAT16; }
+};
+template <> class cudnn_data_type<BFloat16Cuda> {
+public:
+  static cudnnDataType_t type() { return CUDNN_DATA_BFLOAT16; }
+};
+#endif
 
 /** Convert cuDNN enum dtype to NNabla enum dtype.
  */
@@ -85,6 +96,11 @@ inline dtypes get_dtype_by_cudnn_data_type(cudnnDataType_t dtype) {
     _T(INT32, INT);
 // TODO: INT8x4, UINT8x4
 #undef _T
+#if CUDNN_VERSION >= 8100
+  case CUDNN_DATA_BFLOAT16:
+    NBLA_ERROR(error_code::not_implemented,
+               "bfloat16 has no corresponding NNabla dtype.");
+#endif
   default:
     NBLA_ERROR(error_code::value, "Unknown value of cudnnDataType_t. INT8x4 "
                                   "and UINT8x4 are not supported yet.");
@@ -362,6 +378,73 @@ private:
   void find_best_algorithms();
 };
 
+#if CUDNN_VERSION >= 8000
+/** Key of a fused convolution plan: the convolution and whether the bias
+    addition is fused after it.
+ */
+struct NBLA_CUDA_API CudnnConvFusedDesc {
+  CudnnConvDesc conv; ///< Convolution.
+  bool bias;          ///< Bias addition fused.
+
+  /// Operator == compares all elements.
+  bool operator==(const CudnnConvFusedDesc &right) const;
+
+  /** Custom hash function for CudnnConvFusedDesc.
+   */
+  class Hash {
+  public:
+    std::size_t operator()(const CudnnConvFusedDesc &x) const {
+      size_t h = CudnnConvDesc::Hash{}(x.conv);
+      hash_combine(h, x.bias);
+      return h;
+    }
+  };
+};
+
+/** Execution plan of a fused convolution on the cuDNN v8 backend API.
+
+    The operation graph convolution -> bias addition is built once and
+    executed in a single call. Engine configs are taken from the cuDNN
+    heuristics and filtered by the workspace limit and the deterministic
+    option. With the heuristic option the first engine that can be
+    finalized is used, otherwise the candidates are timed and the fastest
+    is used.
+
+    supported() is false if no engine can run the graph (e.g. some fusions
+    are only available in NHWC half precision) or if the engine search
+    fails. Callers then fall back to the legacy API.
+ */
+class NBLA_CUDA_API CudnnConvFusedPlan {
+public:
+  CudnnConvFusedPlan(const CudnnConvFusedDesc &desc);
+  ~CudnnConvFusedPlan();
+
+  /** Whether an execution plan has been found.
+   */
+  bool supported() const { return plan_ != nullptr; }
+
+  /** Get workspace size.
+   */
+  size_t workspace_size() const { return workspace_size_; }
+
+  /** Execute y = conv(x, w) + b. b is ignored if the bias addition is not
+      fused.
+   */
+  void execute(cudnnHandle_t handle, const void *x, const void *w,
+               const void *b, void *y, void *workspace) const;
+
+private:
+  int device_;
+  bool bias_;
+  cudnnBackendDescriptor_t plan_{nullptr};
+  size_t workspace_size_{0};
+
+  void build(const CudnnConvFusedDesc &desc);
+
+  DISABLE_COPY_AND_ASSIGN(CudnnConvFusedPlan);
+};
+#endif
+
 /**
 Enum for Convolution operation type.
 */
@@ -389,6 +472,21 @@ public:
                 typename CudnnConvDesc::Hash>
       conv_resource;
 
+#if CUDNN_VERSION >= 8000
+  /** Hash map for CudnnConvFusedPlan. Unsupported graphs are cached too so
+      that the engine search runs only once per configuration.
+   */
+  unordered_map<CudnnConvFusedDesc, shared_ptr<CudnnConvFusedPlan>,
+                typename CudnnConvFusedDesc::Hash>
+      conv_fused_plan;
+
+  /** Get a fused convolution plan, creating it on the first call with the
+      configuration.
+   */
+  shared_ptr<CudnnConvFusedPlan>
+  get_conv_fused_plan(const CudnnConvFusedDesc &desc);
+#endif
+
   /** Get a workspace limit.
 
       The negative value means no limit of workspace size.
@@ -83,6 +83,11 @@ protected:
   int y_offset_;
 #endif
   shared_ptr<CudnnConvResource> rsc_;
+#if CUDNN_VERSION >= 8000
+  // Convolution and bias addition fused by the backend API. Null if there is
+  // no bias or no engine supports it.
+  shared_ptr<CudnnConvFusedPlan> fused_plan_;
+#endif
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
   virtual void backward_impl(const Variables &inputs, const Variables &outputs,
@@ -74,6 +74,7 @@ protected:
 
   vector<pair<int, int>> weight_offsets_;
   vector<pair<int, int>> bias_offsets_;
+  CudnnRNNPackedParams packed_params_;
   NdArray mem_reservespace_;
 
   virtual void copy_weight_bias_to_params(Tcu *params, const Tcu *w_init,
@@ -81,6 +81,46 @@ struct WCudnnRNNDesc {
   ~WCudnnRNNDesc() { NBLA_CUDNN_CHECK(cudnnDestroyRNNDescriptor(desc)); }
 };
 
+/** Flattened cuDNN RNN parameters kept across calls.
+
+    The weights and biases are packed into `params` only when one of the
+    parameter arrays has been replaced or modified since the last packing,
+    which is detected from the modification count of its SyncedArray.
+    `g_params` receives the weight gradients in the same layout.
+ */
+struct CudnnRNNPackedParams {
+  NdArray params;
+  NdArray g_params;
+
+  // Reallocate the buffers, which invalidates the packed parameters.
+  void reset(size_t size_in_bytes) {
+    params.reshape(Shape_t{static_cast<Size_t>(size_in_bytes)}, true);
+    g_params.reshape(Shape_t{static_cast<Size_t>(size_in_bytes)}, true);
+    params.zero(); // Parameters that are not packed remain 0.
+    arrays_.clear();
+  }
+
+  // Returns true if the parameter inputs starting at `first` must be packed,
+  // and remembers their current state.
+  bool modified(const Variables &inputs, int first) {
+    bool modified = arrays_.size() != inputs.size() - first;
+    arrays_.resize(inputs.size() - first);
+    for (size_t i = first; i < inputs.size(); i++) {
+      auto array = inputs[i]->data()->array();
+      auto &state = arrays_[i - first];
+      const size_t count = array->modification_count();
+      if (state.first.lock() != array || state.second != count) {
+        state = {array, count};
+        modified = true;
+      }
+    }
+    return modified;
+  }
+
+private:
+  vector<pair<std::weak_ptr<SyncedArray>, size_t>> arrays_;
+};
+
 template <typename T> class RNNCudaCudnn : public RNN<T> {
 public:
   typedef typename CudaType<T>::type Tcu;
@@ -132,6 +172,7 @@ protected:
 
   vector<pair<int, int>> weight_offsets_;
   vector<pair<int, int>> bias_offsets_;
+  CudnnRNNPackedParams packed_params_;
   NdArray mem_reservespace_;
 
   virtual void copy_weight_bias_to_params(Tcu *params, const Tcu *w_init,
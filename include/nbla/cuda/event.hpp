@@ -37,8 +37,9 @@ enum CudaEventFlag {
 };
 
 class CudaEvent : public Event {
-  cudaEvent_t raw_event_; // Event
-  ArrayPtr src_{nullptr}; // Source of memory copy
+  cudaEvent_t raw_event_;                // Event
+  ArrayPtr src_{nullptr};                // Source of memory copy
+  shared_ptr<cudaEvent_t> shared_event_; // Owner of a pooled event
 
 public:
   // disable copy & move
@@ -50,6 +51,10 @@ public:
   CudaEvent(CudaEventFlag flag);
   CudaEvent(cudaEvent_t event, ArrayPtr &src);
   CudaEvent(cudaEvent_t event, ArrayPtr &&src);
+  /** The event is released by the deleter of `event` instead of being
+      destroyed, which allows reusing it.
+   */
+  CudaEvent(shared_ptr<cudaEvent_t> event, ArrayPtr src);
   virtual ~CudaEvent();
   virtual cudaEvent_t raw_event();
 
@@ -34,6 +34,7 @@ protected:
   int blocks;
   // for transpose
   Variable v_axes_;
+  vector<int> trans_axes_;
   Variable v_in_strides_;
   Variable v_out_strides_;
   Variable v_out_shape_;
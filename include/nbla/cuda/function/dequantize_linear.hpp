@@ -34,7 +34,13 @@ public:
 
 protected:
   int device_;
+  // Per-channel layout of scale and zero_point (see setup_impl).
+  bool fused_;
+  Size_t channels_;
+  Size_t inner_size_;
+
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
+  virtual void forward_impl(const Variables &inputs, const Variables &outputs);
 };
 }
 #endif
@@ -55,6 +55,8 @@ public:
 
 protected:
   curandGenerator_t curand_generator_;
+  NdArray mask_bits_;  ///< Dropout mask, one bit per element
+  NdArray philox_key_; ///< Philox key of the mask of the last forward
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
   virtual void backward_impl(const Variables &inputs, const Variables &outputs,
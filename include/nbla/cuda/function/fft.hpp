@@ -30,12 +30,8 @@ public:
 
   explicit FFTCuda(const Context &ctx, int signal_ndim, bool normalized)
       : FFT<T>(ctx, signal_ndim, normalized), signal_size_(1),
-        device_(std::stoi(ctx.device_id)) {
-    cuda_set_device(this->device_);
-    NBLA_CUFFT_CHECK(cufftCreate(&plan_forward_));
-    NBLA_CUFFT_CHECK(cufftCreate(&plan_backward_));
-  }
-  virtual ~FFTCuda();
+        device_(std::stoi(ctx.device_id)) {}
+  virtual ~FFTCuda() {}
   virtual string name() { return "FFTCuda"; }
   virtual vector<string> allowed_array_classes() {
     return SingletonManager::get<Cuda>()->array_classes();
@@ -44,8 +40,6 @@ public:
 protected:
   Size_t signal_size_;
   int device_;
-  cufftHandle plan_forward_;
-  cufftHandle plan_backward_;
   vector<long long int> n_;
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
@@ -53,6 +53,9 @@ protected:
   Variable gamma_invstd_;
   Variable factor1_, factor2_;
 
+  // Channel-last kernels for [B, S, C]
+  bool channel_last_;
+
   // Adaptor for channel-last format
   bool need_adaptor_; // true: non channel-first (most case channel-last),
                       // false: already channel-first
@@ -61,13 +64,13 @@ protected:
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
-  void forward_channel_first(const Variables &inputs, const Variables &outputs);
+  void forward_normalization(const Variables &inputs, const Variables &outputs);
   virtual void backward_impl(const Variables &inputs, const Variables &outputs,
                              const vector<bool> &propagate_down,
                              const vector<bool> &accum);
-  void backward_channel_first(const Variables &inputs, const Variables &outputs,
-                              const vector<bool> &propagate_down,
-                              const vector<bool> &accum);
+  void backward_normalization(const Variables &inputs, const Variables &outputs,
+                               const vector<bool> &propagate_down,
+                               const vector<bool> &accum);
 };
 }
 #endif
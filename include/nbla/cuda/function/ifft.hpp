@@ -29,11 +29,8 @@ public:
 
   explicit IFFTCuda(const Context &ctx, int signal_ndim, bool normalized)
       : IFFT<T>(ctx, signal_ndim, normalized), signal_size_(1),
-        device_(std::stoi(ctx.device_id)) {
-    NBLA_CUFFT_CHECK(cufftCreate(&plan_forward_));
-    NBLA_CUFFT_CHECK(cufftCreate(&plan_backward_));
-  }
-  virtual ~IFFTCuda();
+        device_(std::stoi(ctx.device_id)) {}
+  virtual ~IFFTCuda() {}
   virtual string name() { return "IFFTCuda"; }
   virtual vector<string> allowed_array_classes() {
     return SingletonManager::get<Cuda>()->array_classes();
@@ -42,8 +39,6 @@ public:
 protected:
   Size_t signal_size_;
   int device_;
-  cufftHandle plan_forward_;
-  cufftHandle plan_backward_;
   vector<long long int> n_;
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
@@ -28,9 +28,6 @@ namespace nbla {
 template <typename T>
 class ImageAugmentationCuda : public ImageAugmentation<T> {
 
-protected:
-  Variable curand_state_;
-
 public:
   typedef typename CudaType<T>::type Tc;
   explicit ImageAugmentationCuda(const Context &ctx, const vector<int> &shape,
@@ -54,6 +51,7 @@ public:
 
 protected:
   int device_;
+  NdArray params_; ///< Per image and channel augmentation parameters
   bool save_output_data_ = false;
   NdArray output_data_for_recomp_;
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
@@ -41,12 +41,15 @@ protected:
   int device_;
   Variable mean_, var_;
   float inv_reduce_size_;
-  Size_t reduce_size_, outer_size_;
+  Size_t reduce_size_, outer_size_, channel_size_;
 
   // Internal buffers for backward
   Variable sum_dy_, sum_dyx_;
   Variable factor_a_, factor_b_;
 
+  // Channel-last kernels for [B, S, C]
+  bool channel_last_;
+
   // Adaptor for channel-last format
   bool need_adaptor_; // true: non channel-first (most case channel-last),
                       // false: already channel-first
@@ -55,13 +58,13 @@ protected:
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
-  void forward_channel_first(const Variables &inputs, const Variables &outputs);
+  void forward_normalization(const Variables &inputs, const Variables &outputs);
   virtual void backward_impl(const Variables &inputs, const Variables &outputs,
                              const vector<bool> &propagate_down,
                              const vector<bool> &accum);
-  void backward_channel_first(const Variables &inputs, const Variables &outputs,
-                              const vector<bool> &propagate_down,
-                              const vector<bool> &accum);
+  void backward_normalization(const Variables &inputs, const Variables &outputs,
+                               const vector<bool> &propagate_down,
+                               const vector<bool> &accum);
 };
 }
 #endif
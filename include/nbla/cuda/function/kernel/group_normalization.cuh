@@ -14,6 +14,7 @@
 
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/utils/block_reduce.cuh>
+#include <nbla/cuda/utils/pack.cuh>
 #include <nbla/cuda/utils/warp_reduce.cuh>
 
 namespace nbla {
@@ -72,6 +73,35 @@ group_norm_forward_normalization(const IndexT size, const IndexT spatial_size,
   }
 }
 
+/**
+ * Channel-last version of `group_norm_forward_normalization` for x of shape
+ * [B, S, C]. Each thread handles N consecutive channels with vector loads and
+ * stores, which requires C to be a multiple of N.
+ */
+template <typename T, typename IndexT, int N>
+__global__ void group_norm_forward_normalization_channel_last(
+    const IndexT size, const IndexT spatial_size, const IndexT channel_size,
+    const T *x, const T *a, const T *b, T *y) {
+  using PackT = Pack<T, N>;
+  const IndexT num_packs = size / N;
+
+  // Grid-stride loop
+  for (IndexT p = blockIdx.x * blockDim.x + threadIdx.x; p < num_packs;
+       p += gridDim.x * blockDim.x) {
+    const IndexT idx = p * N;
+    const IndexT c = idx % channel_size;
+    const IndexT ab_idx =
+        idx / (spatial_size * channel_size) * channel_size + c;
+    const PackT xp = reinterpret_cast<const PackT *>(x)[p];
+    PackT yp;
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      yp.v[i] = a[ab_idx + i] * xp.v[i] + b[ab_idx + i];
+    }
+    reinterpret_cast<PackT *>(y)[p] = yp;
+  }
+}
+
 template <typename T, typename IndexT, IndexT N_UNROLL>
 __global__ void group_norm_backward_gamma_invstd(
     const IndexT size, const IndexT channel_size, const int num_groups,
@@ -175,6 +205,44 @@ group_norm_backward_dx(const IndexT size, const IndexT channel_size,
   }
 }
 
+/**
+ * Channel-last version of `group_norm_backward_dx` for x of shape [B, S, C],
+ * vectorized over N consecutive channels as in
+ * `group_norm_forward_normalization_channel_last`.
+ */
+template <bool accum, typename T, typename IndexT, int N>
+__global__ void group_norm_backward_dx_channel_last(
+    const IndexT size, const IndexT channel_size, const IndexT spatial_size,
+    const int num_groups, const T *x, const T *dy, const T *gamma_invstd,
+    const T *factor1, const T *factor2, T *dx) {
+  using PackT = Pack<T, N>;
+  const IndexT num_packs = size / N;
+  const IndexT chunk_size = channel_size / num_groups;
+
+  // Grid-stride loop
+  for (IndexT p = blockIdx.x * blockDim.x + threadIdx.x; p < num_packs;
+       p += gridDim.x * blockDim.x) {
+    const IndexT idx = p * N;
+    const IndexT c = idx % channel_size;
+    const IndexT b = idx / (spatial_size * channel_size);
+    const IndexT param_idx = b * channel_size + c;
+    const PackT xp = reinterpret_cast<const PackT *>(x)[p];
+    const PackT dyp = reinterpret_cast<const PackT *>(dy)[p];
+    PackT dxp;
+    if (accum) {
+      dxp = reinterpret_cast<const PackT *>(dx)[p];
+    }
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      const IndexT factor_idx = b * num_groups + (c + i) / chunk_size;
+      dxp.v[i] = gamma_invstd[param_idx + i] * dyp.v[i] +
+                 factor1[factor_idx] * xp.v[i] + factor2[factor_idx] +
+                 (accum ? dxp.v[i] : (T)0.0f);
+    }
+    reinterpret_cast<PackT *>(dx)[p] = dxp;
+  }
+}
+
 template <bool beta_accum, bool gamma_accum, typename T, typename IndexT>
 __global__ void group_norm_backward_dbeta_dgamma(
     const IndexT batch_size, const IndexT channel_size, const int num_groups,
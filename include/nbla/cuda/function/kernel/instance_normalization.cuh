@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <nbla/cuda/common.hpp>
+#include <nbla/cuda/utils/pack.cuh>
 
 namespace nbla {
 
@@ -46,6 +47,40 @@ instance_norm_forward_normalization(const IndexT outer_size,
   }
 }
 
+/**
+ * Channel-last version of `instance_norm_forward_normalization` for x of
+ * shape [B, S, C] and statistics of shape [B, C]. Each thread handles N
+ * consecutive channels with vector loads and stores, which requires C to be a
+ * multiple of N.
+ */
+template <typename T, typename IndexT, int N>
+__global__ void instance_norm_forward_normalization_channel_last(
+    const IndexT size, const IndexT spatial_size, const IndexT channel_size,
+    const T *x, const T *mean, const T *var, const T *beta, const T *gamma,
+    T *y, const float eps) {
+  using PackT = Pack<T, N>;
+  const IndexT num_packs = size / N;
+
+  // Grid-stride loop
+  for (IndexT p = blockIdx.x * blockDim.x + threadIdx.x; p < num_packs;
+       p += gridDim.x * blockDim.x) {
+    const IndexT idx = p * N;
+    const IndexT c = idx % channel_size;
+    const IndexT stats_idx =
+        idx / (spatial_size * channel_size) * channel_size + c;
+    const PackT xp = reinterpret_cast<const PackT *>(x)[p];
+    PackT yp;
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      const T scale = gamma ? gamma[stats_idx + i] : (T)1.0f;
+      const T bias = beta ? beta[stats_idx + i] : (T)0.0f;
+      const T invstd = rsqrt(var[stats_idx + i] + eps);
+      yp.v[i] = scale * invstd * (xp.v[i] - mean[stats_idx + i]) + bias;
+    }
+    reinterpret_cast<PackT *>(y)[p] = yp;
+  }
+}
+
 template <typename T, typename IndexT>
 __global__ void instance_norm_backward_dx_factor(
     const IndexT outer_size, const float inv_reduce_size, const T *gamma,
@@ -94,6 +129,44 @@ instance_norm_backward_dx(const IndexT outer_size, const IndexT reduce_size,
   }
 }
 
+/**
+ * Channel-last version of `instance_norm_backward_dx`, vectorized over N
+ * consecutive channels as in
+ * `instance_norm_forward_normalization_channel_last`.
+ */
+template <bool accum, typename T, typename IndexT, int N>
+__global__ void instance_norm_backward_dx_channel_last(
+    const IndexT size, const IndexT spatial_size, const IndexT channel_size,
+    const T *x, const T *gamma, const T *dy, const T *var, const T *factor_a,
+    const T *factor_b, T *dx, const float eps) {
+  using PackT = Pack<T, N>;
+  const IndexT num_packs = size / N;
+
+  // Grid-stride loop
+  for (IndexT p = blockIdx.x * blockDim.x + threadIdx.x; p < num_packs;
+       p += gridDim.x * blockDim.x) {
+    const IndexT idx = p * N;
+    const IndexT c = idx % channel_size;
+    const IndexT stats_idx =
+        idx / (spatial_size * channel_size) * channel_size + c;
+    const PackT xp = reinterpret_cast<const PackT *>(x)[p];
+    const PackT dyp = reinterpret_cast<const PackT *>(dy)[p];
+    PackT dxp;
+    if (accum) {
+      dxp = reinterpret_cast<const PackT *>(dx)[p];
+    }
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      const IndexT j = stats_idx + i;
+      const T scale = gamma ? gamma[j] : (T)1.0f;
+      const T invstd = rsqrt(var[j] + eps);
+      dxp.v[i] = dyp.v[i] * invstd * scale + factor_a[j] * xp.v[i] +
+                 factor_b[j] + (accum ? dxp.v[i] : (T)0.0f);
+    }
+    reinterpret_cast<PackT *>(dx)[p] = dxp;
+  }
+}
+
 template <bool accum_beta, bool accum_gamma, typename T, typename IndexT>
 __global__ void instance_norm_backward_dbeta_dgamma(
     const IndexT outer_size, const IndexT reduce_size, const T *x,
@@ -19,6 +19,28 @@
 
 namespace nbla {
 
+/**
+ * True if the memory layout is [batch axes..., spatial axes..., C], which is
+ * normalized by channel-last kernels without transposing it to
+ * channel-first.
+ */
+inline bool is_channel_last_layout(const Shape_t &shape,
+                                   const vector<int> &batch_axis,
+                                   const int channel_axis) {
+  const int ndim = shape.size();
+  const int nbatch = batch_axis.size();
+  // Without spatial axes, the layout is channel-first as well.
+  if (channel_axis != ndim - 1 || ndim < nbatch + 2) {
+    return false;
+  }
+  for (int i = 0; i < nbatch; i++) {
+    if (batch_axis[i] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <typename Op, typename IndexT>
 __global__ void reduce_2d_x(Op op, IndexT outer_size, IndexT reduce_size) {
   const IndexT tidx = threadIdx.x;
@@ -63,4 +85,52 @@ __global__ void reduce_2d_x(Op op, IndexT outer_size, IndexT reduce_size) {
     }
   }
 }
+
+constexpr int NBLA_CUDA_REDUCE_3D_Y_ROWS = 16;
+
+/**
+ * Reduction over the middle axis of [outer_size, reduce_size, inner_size],
+ * e.g. the spatial axis of a channel-last [B, H * W, C] array.
+ *
+ * A block is [CUDA_WARP_SIZE, NBLA_CUDA_REDUCE_3D_Y_ROWS] threads. Adjacent
+ * threads read adjacent inner elements, so loads are coalesced even though
+ * the reduction axis is strided. The rows of a block are reduced in shared
+ * memory and the result is stored at `outer_idx * inner_size + inner_idx`.
+ *
+ * Launch with grid (ceil(inner_size / CUDA_WARP_SIZE), outer blocks).
+ */
+template <typename Op, typename IndexT>
+__global__ void reduce_3d_y(Op op, IndexT outer_size, IndexT reduce_size,
+                            IndexT inner_size) {
+  __shared__ typename Op::storage_type
+      buf[NBLA_CUDA_REDUCE_3D_Y_ROWS][CUDA_WARP_SIZE];
+  const IndexT tidx = threadIdx.x;
+  const IndexT tidy = threadIdx.y;
+  const IndexT inner_idx = blockIdx.x * CUDA_WARP_SIZE + tidx;
+
+  // Grid-stride loop
+  for (IndexT outer_idx = blockIdx.y; outer_idx < outer_size;
+       outer_idx += gridDim.y) {
+    typename Op::AccT val;
+    Op::init(val);
+    if (inner_idx < inner_size) {
+      for (IndexT i = tidy; i < reduce_size; i += NBLA_CUDA_REDUCE_3D_Y_ROWS) {
+        const IndexT global_idx =
+            (outer_idx * reduce_size + i) * inner_size + inner_idx;
+        op.reduce_one(val, op.load(global_idx, i));
+      }
+    }
+    buf[tidy][tidx] = val;
+    __syncthreads();
+
+    // Reduce the rows
+    if (tidy == 0 && inner_idx < inner_size) {
+      for (int j = 1; j < NBLA_CUDA_REDUCE_3D_Y_ROWS; j++) {
+        op.reduce(val, buf[j][tidx]);
+      }
+      op.store(outer_idx * inner_size + inner_idx, val);
+    }
+    __syncthreads();
+  }
+}
 }
@@ -0,0 +1,702 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_FUNCTION_KERNEL_SOFTMAX_CUH__
+#define __NBLA_CUDA_FUNCTION_KERNEL_SOFTMAX_CUH__
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/utils/warp_shuffle.cuh>
+#include <nbla/nd_array.hpp>
+
+#include <math_constants.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace nbla {
+
+/*
+  Softmax and log-softmax over the middle axis of an array viewed as
+  [size0, size1, size2], accumulated in float.
+
+  The element access is done through functors so that callers can fuse
+  element-wise operations (scaling, masking, dropout, ...) into the
+  softmax. `i` is the flat index into the [size0, size1, size2] array,
+  an int if the array has at most NBLA_CUDA_MAX_INT_INDEX_SIZE elements
+  and a Size_t otherwise. Functors load or store N consecutive elements
+  at once, where N is either 1 or the functor's PACK_SIZE. Vectorized
+  access is only used if `can_vectorize()` is true for all functors.
+
+  Forward functors:
+    load.load<N>(i, float *x)        reads x[i, ..., i + N - 1]
+    store.store<N>(i, const float *y) writes softmax (or log-softmax)
+
+  Backward functors:
+    load.load<N>(i, float *y, float *dy) reads output and its gradient
+    store.store<N>(i, const float *dx)   writes (or accumulates) dx
+*/
+
+template <typename T, int N> struct alignas(sizeof(T) * N) SoftmaxPack {
+  T v[N];
+};
+
+template <typename T> struct SoftmaxLoad {
+  enum { PACK_SIZE = 16 / sizeof(T) };
+  const T *x;
+
+  template <int N, typename index_t>
+  __device__ void load(const index_t i, float *v) const {
+    const auto p = *reinterpret_cast<const SoftmaxPack<T, N> *>(x + i);
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      v[j] = p.v[j];
+  }
+  bool can_vectorize() const {
+    return reinterpret_cast<uintptr_t>(x) % (sizeof(T) * PACK_SIZE) == 0;
+  }
+};
+
+template <typename T> struct SoftmaxStore {
+  enum { PACK_SIZE = 16 / sizeof(T) };
+  T *y;
+
+  template <int N, typename index_t>
+  __device__ void store(const index_t i, const float *v) const {
+    SoftmaxPack<T, N> p;
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      p.v[j] = v[j];
+    *reinterpret_cast<SoftmaxPack<T, N> *>(y + i) = p;
+  }
+  bool can_vectorize() const {
+    return reinterpret_cast<uintptr_t>(y) % (sizeof(T) * PACK_SIZE) == 0;
+  }
+};
+
+template <typename T> struct SoftmaxGradLoad {
+  enum { PACK_SIZE = 16 / sizeof(T) };
+  const T *y;
+  const T *dy;
+
+  template <int N, typename index_t>
+  __device__ void load(const index_t i, float *v, float *g) const {
+    const auto pv = *reinterpret_cast<const SoftmaxPack<T, N> *>(y + i);
+    const auto pg = *reinterpret_cast<const SoftmaxPack<T, N> *>(dy + i);
+#pragma unroll
+    for (int j = 0; j < N; j++) {
+      v[j] = pv.v[j];
+      g[j] = pg.v[j];
+    }
+  }
+  bool can_vectorize() const {
+    const auto bits =
+        reinterpret_cast<uintptr_t>(y) | reinterpret_cast<uintptr_t>(dy);
+    return bits % (sizeof(T) * PACK_SIZE) == 0;
+  }
+};
+
+template <typename T, bool accum> struct SoftmaxGradStore {
+  enum { PACK_SIZE = 16 / sizeof(T) };
+  T *dx;
+
+  template <int N, typename index_t>
+  __device__ void store(const index_t i, const float *v) const {
+    auto ptr = reinterpret_cast<SoftmaxPack<T, N> *>(dx + i);
+    SoftmaxPack<T, N> p;
+    if (accum)
+      p = *ptr;
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      p.v[j] = accum ? float(p.v[j]) + v[j] : v[j];
+    *ptr = p;
+  }
+  bool can_vectorize() const {
+    return reinterpret_cast<uintptr_t>(dx) % (sizeof(T) * PACK_SIZE) == 0;
+  }
+};
+
+namespace softmax_impl {
+
+enum {
+  WARP_ROWS = 4,            // rows per block of the warp kernels
+  WARP_MAX_SIZE = 1024,     // longest row handled by one warp
+  BLOCK_SIZE = 512,         // threads of the block and chunk kernels
+  CHUNK_SIZE = 8192,        // row chunk per block of the chunk kernels
+  CHUNK_MIN_SIZE = 32768,   // shortest row split into chunks
+  CHUNK_MAX_ROWS = 64,      // most rows for which rows are split
+};
+
+// Online update of the running maximum `m` and the sum `s` of
+// exp(x - m) with one element `x`.
+__device__ __forceinline__ void online_add(float &m, float &s,
+                                           const float x) {
+  if (x > m) {
+    s = s * expf(m - x) + 1.0f;
+    m = x;
+  } else if (m > -CUDART_INF_F) {
+    s += expf(x - m);
+  }
+}
+
+// Merge of two (maximum, sum of exponentials) pairs.
+__device__ __forceinline__ void online_merge(float &m, float &s,
+                                             const float m2, const float s2) {
+  if (m2 > m) {
+    s = s * expf(m - m2) + s2;
+    m = m2;
+  } else if (m2 > -CUDART_INF_F) {
+    s += s2 * expf(m2 - m);
+  }
+}
+
+__device__ __forceinline__ float warp_allreduce_max(float v) {
+#pragma unroll
+  for (int mask = CUDA_WARP_SIZE / 2; mask > 0; mask >>= 1)
+    v = max(v, warp::shuffle_xor(v, mask));
+  return v;
+}
+
+__device__ __forceinline__ float warp_allreduce_sum(float v) {
+#pragma unroll
+  for (int mask = CUDA_WARP_SIZE / 2; mask > 0; mask >>= 1)
+    v += warp::shuffle_xor(v, mask);
+  return v;
+}
+
+__device__ __forceinline__ void warp_allreduce_max_sum(float &m, float &s) {
+#pragma unroll
+  for (int mask = CUDA_WARP_SIZE / 2; mask > 0; mask >>= 1) {
+    const float m2 = warp::shuffle_xor(m, mask);
+    const float s2 = warp::shuffle_xor(s, mask);
+    online_merge(m, s, m2, s2);
+  }
+}
+
+// Block-wide (maximum, sum of exponentials), the result is returned to
+// all threads. Safe to call repeatedly in a loop.
+__device__ __forceinline__ void block_allreduce_max_sum(float &m, float &s) {
+  __shared__ float shared_m[CUDA_WARP_SIZE];
+  __shared__ float shared_s[CUDA_WARP_SIZE];
+  const int lane = threadIdx.x & CUDA_WARP_MASK;
+  const int warp = threadIdx.x >> CUDA_WARP_BITS;
+  warp_allreduce_max_sum(m, s);
+  __syncthreads();
+  if (lane == 0) {
+    shared_m[warp] = m;
+    shared_s[warp] = s;
+  }
+  __syncthreads();
+  const bool valid = lane < (blockDim.x >> CUDA_WARP_BITS);
+  m = valid ? shared_m[lane] : -CUDART_INF_F;
+  s = valid ? shared_s[lane] : 0.0f;
+  warp_allreduce_max_sum(m, s);
+}
+
+__device__ __forceinline__ float block_allreduce_sum(float v) {
+  __shared__ float shared[CUDA_WARP_SIZE];
+  const int lane = threadIdx.x & CUDA_WARP_MASK;
+  const int warp = threadIdx.x >> CUDA_WARP_BITS;
+  v = warp_allreduce_sum(v);
+  __syncthreads();
+  if (lane == 0)
+    shared[warp] = v;
+  __syncthreads();
+  v = lane < (blockDim.x >> CUDA_WARP_BITS) ? shared[lane] : 0.0f;
+  return warp_allreduce_sum(v);
+}
+
+template <bool LOG>
+__device__ __forceinline__ float softmax_output(const float x, const float m,
+                                                const float s,
+                                                const float log_s) {
+  return LOG ? x - m - log_s : expf(x - m) / s;
+}
+
+// Gradient wrt. the input given the output `y`, its gradient `dy` and
+// the row sum `r` of dy (log-softmax) or dy * y (softmax).
+template <bool LOG>
+__device__ __forceinline__ float softmax_grad(const float y, const float dy,
+                                              const float r) {
+  return LOG ? dy - expf(y) * r : y * (dy - r);
+}
+
+template <bool LOG>
+__device__ __forceinline__ float softmax_grad_term(const float y,
+                                                   const float dy) {
+  return LOG ? dy : dy * y;
+}
+
+/*
+  Strided rows (size2 > 1), one thread per row. Neighboring threads
+  read neighboring elements.
+*/
+template <bool LOG, typename index_t, typename Load, typename Store>
+__global__ void kernel_forward_strided(const index_t size0x2,
+                                       const index_t size1, const index_t size2,
+                                       Load load, Store store) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, size0x2, index_t) {
+    const index_t i0 = idx / size2;
+    const index_t i2 = idx - i0 * size2;
+    const index_t base = i0 * size1 * size2 + i2;
+    float m = -CUDART_INF_F, s = 0.0f;
+    for (index_t i1 = 0; i1 < size1; i1++) {
+      float x;
+      load.template load<1>(base + i1 * size2, &x);
+      online_add(m, s, x);
+    }
+    const float log_s = logf(s);
+    for (index_t i1 = 0; i1 < size1; i1++) {
+      float x;
+      load.template load<1>(base + i1 * size2, &x);
+      const float y = softmax_output<LOG>(x, m, s, log_s);
+      store.template store<1>(base + i1 * size2, &y);
+    }
+  }
+}
+
+template <bool LOG, typename index_t, typename Load, typename Store>
+__global__ void kernel_backward_strided(const index_t size0x2,
+                                        const index_t size1,
+                                        const index_t size2, Load load,
+                                        Store store) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, size0x2, index_t) {
+    const index_t i0 = idx / size2;
+    const index_t i2 = idx - i0 * size2;
+    const index_t base = i0 * size1 * size2 + i2;
+    float r = 0.0f;
+    for (index_t i1 = 0; i1 < size1; i1++) {
+      float y, dy;
+      load.template load<1>(base + i1 * size2, &y, &dy);
+      r += softmax_grad_term<LOG>(y, dy);
+    }
+    for (index_t i1 = 0; i1 < size1; i1++) {
+      float y, dy;
+      load.template load<1>(base + i1 * size2, &y, &dy);
+      const float dx = softmax_grad<LOG>(y, dy, r);
+      store.template store<1>(base + i1 * size2, &dx);
+    }
+  }
+}
+
+/*
+  Contiguous rows of up to 32 * ITEMS elements, one warp per row. The
+  row is kept in registers, so it is read once.
+*/
+template <bool LOG, int ITEMS, typename index_t, typename Load,
+          typename Store>
+__global__ void kernel_forward_warp(const index_t rows, const int cols,
+                                    Load load, Store store) {
+  const int lane = threadIdx.x;
+  for (index_t row = blockIdx.x * WARP_ROWS + threadIdx.y; row < rows;
+       row += gridDim.x * WARP_ROWS) {
+    const index_t base = row * cols;
+    float x[ITEMS];
+    float m = -CUDART_INF_F;
+#pragma unroll
+    for (int j = 0; j < ITEMS; j++) {
+      const int c = lane + j * CUDA_WARP_SIZE;
+      x[j] = -CUDART_INF_F;
+      if (c < cols)
+        load.template load<1>(base + c, &x[j]);
+      m = max(m, x[j]);
+    }
+    m = warp_allreduce_max(m);
+    float s = 0.0f;
+#pragma unroll
+    for (int j = 0; j < ITEMS; j++) {
+      if (lane + j * CUDA_WARP_SIZE < cols)
+        s += expf(x[j] - m);
+    }
+    s = warp_allreduce_sum(s);
+    const float log_s = logf(s);
+#pragma unroll
+    for (int j = 0; j < ITEMS; j++) {
+      const int c = lane + j * CUDA_WARP_SIZE;
+      if (c < cols) {
+        const float y = softmax_output<LOG>(x[j], m, s, log_s);
+        store.template store<1>(base + c, &y);
+      }
+    }
+  }
+}
+
+template <bool LOG, int ITEMS, typename index_t, typename Load,
+          typename Store>
+__global__ void kernel_backward_warp(const index_t rows, const int cols,
+                                     Load load, Store store) {
+  const int lane = threadIdx.x;
+  for (index_t row = blockIdx.x * WARP_ROWS + threadIdx.y; row < rows;
+       row += gridDim.x * WARP_ROWS) {
+    const index_t base = row * cols;
+    float y[ITEMS], dy[ITEMS];
+    float r = 0.0f;
+#pragma unroll
+    for (int j = 0; j < ITEMS; j++) {
+      const int c = lane + j * CUDA_WARP_SIZE;
+      if (c < cols) {
+        load.template load<1>(base + c, &y[j], &dy[j]);
+        r += softmax_grad_term<LOG>(y[j], dy[j]);
+      }
+    }
+    r = warp_allreduce_sum(r);
+#pragma unroll
+    for (int j = 0; j < ITEMS; j++) {
+      const int c = lane + j * CUDA_WARP_SIZE;
+      if (c < cols) {
+        const float dx = softmax_grad<LOG>(y[j], dy[j], r);
+        store.template store<1>(base + c, &dx);
+      }
+    }
+  }
+}
+
+/*
+  Contiguous rows, one block per row. The first pass computes the
+  maximum and the sum of exponentials online, the second pass writes
+  the output. N elements are accessed at once.
+*/
+template <bool LOG, int N, typename index_t, typename Load, typename Store>
+__global__ void kernel_forward_block(const index_t rows, const index_t cols,
+                                     Load load, Store store) {
+  for (index_t row = blockIdx.x; row < rows; row += gridDim.x) {
+    const index_t base = row * cols;
+    float m = -CUDART_INF_F, s = 0.0f;
+    for (index_t c = threadIdx.x * N; c < cols; c += blockDim.x * N) {
+      float x[N];
+      load.template load<N>(base + c, x);
+#pragma unroll
+      for (int j = 0; j < N; j++)
+        online_add(m, s, x[j]);
+    }
+    block_allreduce_max_sum(m, s);
+    const float log_s = logf(s);
+    for (index_t c = threadIdx.x * N; c < cols; c += blockDim.x * N) {
+      float x[N];
+      load.template load<N>(base + c, x);
+#pragma unroll
+      for (int j = 0; j < N; j++)
+        x[j] = softmax_output<LOG>(x[j], m, s, log_s);
+      store.template store<N>(base + c, x);
+    }
+  }
+}
+
+template <bool LOG, int N, typename index_t, typename Load, typename Store>
+__global__ void kernel_backward_block(const index_t rows, const index_t cols,
+                                      Load load, Store store) {
+  for (index_t row = blockIdx.x; row < rows; row += gridDim.x) {
+    const index_t base = row * cols;
+    float r = 0.0f;
+    for (index_t c = threadIdx.x * N; c < cols; c += blockDim.x * N) {
+      float y[N], dy[N];
+      load.template load<N>(base + c, y, dy);
+#pragma unroll
+      for (int j = 0; j < N; j++)
+        r += softmax_grad_term<LOG>(y[j], dy[j]);
+    }
+    r = block_allreduce_sum(r);
+    for (index_t c = threadIdx.x * N; c < cols; c += blockDim.x * N) {
+      float y[N], dy[N];
+      load.template load<N>(base + c, y, dy);
+#pragma unroll
+      for (int j = 0; j < N; j++)
+        y[j] = softmax_grad<LOG>(y[j], dy[j], r);
+      store.template store<N>(base + c, y);
+    }
+  }
+}
+
+/*
+  Few long contiguous rows, split into chunks of CHUNK_SIZE elements
+  with one block per chunk (grid x) and row (grid y). The first kernel
+  writes the partial reduction of every chunk, the second one combines
+  the partials of its row and writes the output of its chunk.
+*/
+template <int N, typename index_t, typename Load>
+__global__ void kernel_forward_chunk_reduce(const index_t cols, Load load,
+                                            float2 *partial) {
+  const index_t base = blockIdx.y * cols;
+  const index_t end =
+      min(cols, static_cast<index_t>(blockIdx.x + 1) * CHUNK_SIZE);
+  float m = -CUDART_INF_F, s = 0.0f;
+  for (index_t c = static_cast<index_t>(blockIdx.x) * CHUNK_SIZE +
+                   threadIdx.x * N;
+       c < end; c += blockDim.x * N) {
+    float x[N];
+    load.template load<N>(base + c, x);
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      online_add(m, s, x[j]);
+  }
+  block_allreduce_max_sum(m, s);
+  if (threadIdx.x == 0)
+    partial[blockIdx.y * gridDim.x + blockIdx.x] = make_float2(m, s);
+}
+
+template <bool LOG, int N, typename index_t, typename Load, typename Store>
+__global__ void kernel_forward_chunk_apply(const index_t cols,
+                                           const float2 *partial, Load load,
+                                           Store store) {
+  float m = -CUDART_INF_F, s = 0.0f;
+  for (int k = threadIdx.x; k < gridDim.x; k += blockDim.x) {
+    const float2 p = partial[blockIdx.y * gridDim.x + k];
+    online_merge(m, s, p.x, p.y);
+  }
+  block_allreduce_max_sum(m, s);
+  const float log_s = logf(s);
+  const index_t base = blockIdx.y * cols;
+  const index_t end =
+      min(cols, static_cast<index_t>(blockIdx.x + 1) * CHUNK_SIZE);
+  for (index_t c = static_cast<index_t>(blockIdx.x) * CHUNK_SIZE +
+                   threadIdx.x * N;
+       c < end; c += blockDim.x * N) {
+    float x[N];
+    load.template load<N>(base + c, x);
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      x[j] = softmax_output<LOG>(x[j], m, s, log_s);
+    store.template store<N>(base + c, x);
+  }
+}
+
+template <bool LOG, int N, typename index_t, typename Load>
+__global__ void kernel_backward_chunk_reduce(const index_t cols, Load load,
+                                             float *partial) {
+  const index_t base = blockIdx.y * cols;
+  const index_t end =
+      min(cols, static_cast<index_t>(blockIdx.x + 1) * CHUNK_SIZE);
+  float r = 0.0f;
+  for (index_t c = static_cast<index_t>(blockIdx.x) * CHUNK_SIZE +
+                   threadIdx.x * N;
+       c < end; c += blockDim.x * N) {
+    float y[N], dy[N];
+    load.template load<N>(base + c, y, dy);
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      r += softmax_grad_term<LOG>(y[j], dy[j]);
+  }
+  r = block_allreduce_sum(r);
+  if (threadIdx.x == 0)
+    partial[blockIdx.y * gridDim.x + blockIdx.x] = r;
+}
+
+template <bool LOG, int N, typename index_t, typename Load, typename Store>
+__global__ void kernel_backward_chunk_apply(const index_t cols,
+                                            const float *partial, Load load,
+                                            Store store) {
+  float r = 0.0f;
+  for (int k = threadIdx.x; k < gridDim.x; k += blockDim.x)
+    r += partial[blockIdx.y * gridDim.x + k];
+  r = block_allreduce_sum(r);
+  const index_t base = blockIdx.y * cols;
+  const index_t end =
+      min(cols, static_cast<index_t>(blockIdx.x + 1) * CHUNK_SIZE);
+  for (index_t c = static_cast<index_t>(blockIdx.x) * CHUNK_SIZE +
+                   threadIdx.x * N;
+       c < end; c += blockDim.x * N) {
+    float y[N], dy[N];
+    load.template load<N>(base + c, y, dy);
+#pragma unroll
+    for (int j = 0; j < N; j++)
+      y[j] = softmax_grad<LOG>(y[j], dy[j], r);
+    store.template store<N>(base + c, y);
+  }
+}
+
+template <bool LOG, int ITEMS, typename index_t, typename Load,
+          typename Store>
+void launch_forward_warp(const index_t rows, const int cols, Load load,
+                         Store store) {
+  const int blocks = static_cast<int>(std::min<index_t>(
+      (rows + WARP_ROWS - 1) / WARP_ROWS, NBLA_CUDA_MAX_BLOCKS));
+  kernel_forward_warp<LOG, ITEMS><<<blocks, dim3(CUDA_WARP_SIZE, WARP_ROWS), 0,
+                                    cuda_get_current_stream()>>>(
+      rows, cols, load, store);
+  NBLA_CUDA_KERNEL_CHECK();
+}
+
+template <bool LOG, int ITEMS, typename index_t, typename Load,
+          typename Store>
+void launch_backward_warp(const index_t rows, const int cols, Load load,
+                          Store store) {
+  const int blocks = static_cast<int>(std::min<index_t>(
+      (rows + WARP_ROWS - 1) / WARP_ROWS, NBLA_CUDA_MAX_BLOCKS));
+  kernel_backward_warp<LOG, ITEMS><<<blocks, dim3(CUDA_WARP_SIZE, WARP_ROWS), 0,
+                                     cuda_get_current_stream()>>>(
+      rows, cols, load, store);
+  NBLA_CUDA_KERNEL_CHECK();
+}
+
+template <bool LOG, int N, typename index_t, typename Load, typename Store>
+void launch_forward_rows(const Context &ctx, const index_t rows,
+                         const index_t cols, Load load, Store store) {
+  if (cols >= CHUNK_MIN_SIZE && rows <= CHUNK_MAX_ROWS) {
+    const dim3 grid(static_cast<int>((cols + CHUNK_SIZE - 1) / CHUNK_SIZE),
+                    static_cast<int>(rows));
+    NdArray arr(Shape_t{static_cast<Size_t>(grid.x * grid.y * 2)});
+    auto partial = reinterpret_cast<float2 *>(
+        arr.cast(get_dtype<float>(), ctx, true)->pointer<float>());
+    kernel_forward_chunk_reduce<N><<<grid, BLOCK_SIZE, 0,
+                                     cuda_get_current_stream()>>>(
+        cols, load, partial);
+    NBLA_CUDA_KERNEL_CHECK();
+    kernel_forward_chunk_apply<LOG, N><<<grid, BLOCK_SIZE, 0,
+                                         cuda_get_current_stream()>>>(
+        cols, partial, load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  } else {
+    const int blocks =
+        static_cast<int>(std::min<index_t>(rows, NBLA_CUDA_MAX_BLOCKS));
+    kernel_forward_block<LOG, N><<<blocks, BLOCK_SIZE, 0,
+                                   cuda_get_current_stream()>>>(rows, cols,
+                                                                load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  }
+}
+
+template <bool LOG, int N, typename index_t, typename Load, typename Store>
+void launch_backward_rows(const Context &ctx, const index_t rows,
+                          const index_t cols, Load load, Store store) {
+  if (cols >= CHUNK_MIN_SIZE && rows <= CHUNK_MAX_ROWS) {
+    const dim3 grid(static_cast<int>((cols + CHUNK_SIZE - 1) / CHUNK_SIZE),
+                    static_cast<int>(rows));
+    NdArray arr(Shape_t{static_cast<Size_t>(grid.x * grid.y)});
+    auto partial = arr.cast(get_dtype<float>(), ctx, true)->pointer<float>();
+    kernel_backward_chunk_reduce<LOG, N><<<grid, BLOCK_SIZE, 0,
+                                           cuda_get_current_stream()>>>(
+        cols, load, partial);
+    NBLA_CUDA_KERNEL_CHECK();
+    kernel_backward_chunk_apply<LOG, N><<<grid, BLOCK_SIZE, 0,
+                                          cuda_get_current_stream()>>>(
+        cols, partial, load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  } else {
+    const int blocks =
+        static_cast<int>(std::min<index_t>(rows, NBLA_CUDA_MAX_BLOCKS));
+    kernel_backward_block<LOG, N><<<blocks, BLOCK_SIZE, 0,
+                                    cuda_get_current_stream()>>>(rows, cols,
+                                                                 load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  }
+}
+
+// Contiguous rows (size2 == 1) of `cols` elements.
+template <bool LOG, typename index_t, typename Load, typename Store>
+void forward_rows(const Context &ctx, const index_t rows, const index_t cols,
+                  Load load, Store store) {
+  if (cols <= 32) {
+    launch_forward_warp<LOG, 1>(rows, cols, load, store);
+  } else if (cols <= 64) {
+    launch_forward_warp<LOG, 2>(rows, cols, load, store);
+  } else if (cols <= 128) {
+    launch_forward_warp<LOG, 4>(rows, cols, load, store);
+  } else if (cols <= 256) {
+    launch_forward_warp<LOG, 8>(rows, cols, load, store);
+  } else if (cols <= 512) {
+    launch_forward_warp<LOG, 16>(rows, cols, load, store);
+  } else if (cols <= WARP_MAX_SIZE) {
+    launch_forward_warp<LOG, 32>(rows, cols, load, store);
+  } else {
+    constexpr int N = Load::PACK_SIZE < Store::PACK_SIZE ? Load::PACK_SIZE
+                                                         : Store::PACK_SIZE;
+    if (N > 1 && cols % N == 0 && load.can_vectorize() &&
+        store.can_vectorize()) {
+      launch_forward_rows<LOG, N>(ctx, rows, cols, load, store);
+    } else {
+      launch_forward_rows<LOG, 1>(ctx, rows, cols, load, store);
+    }
+  }
+}
+
+template <bool LOG, typename index_t, typename Load, typename Store>
+void backward_rows(const Context &ctx, const index_t rows, const index_t cols,
+                   Load load, Store store) {
+  if (cols <= 32) {
+    launch_backward_warp<LOG, 1>(rows, cols, load, store);
+  } else if (cols <= 64) {
+    launch_backward_warp<LOG, 2>(rows, cols, load, store);
+  } else if (cols <= 128) {
+    launch_backward_warp<LOG, 4>(rows, cols, load, store);
+  } else if (cols <= 256) {
+    launch_backward_warp<LOG, 8>(rows, cols, load, store);
+  } else if (cols <= 512) {
+    launch_backward_warp<LOG, 16>(rows, cols, load, store);
+  } else if (cols <= WARP_MAX_SIZE) {
+    launch_backward_warp<LOG, 32>(rows, cols, load, store);
+  } else {
+    constexpr int N = Load::PACK_SIZE < Store::PACK_SIZE ? Load::PACK_SIZE
+                                                         : Store::PACK_SIZE;
+    if (N > 1 && cols % N == 0 && load.can_vectorize() &&
+        store.can_vectorize()) {
+      launch_backward_rows<LOG, N>(ctx, rows, cols, load, store);
+    } else {
+      launch_backward_rows<LOG, 1>(ctx, rows, cols, load, store);
+    }
+  }
+}
+} // namespace softmax_impl
+
+/*
+  Softmax (or log-softmax if LOG) forward over axis 1 of the array
+  viewed as [size0, size1, size2]. The kernel is chosen from the
+  shape: one thread per row for strided rows, one warp per row for
+  contiguous rows of up to 1024 elements, one block per row for
+  longer rows and several blocks per row for a few very long rows.
+  The kernels index with int if the array fits, and with Size_t
+  otherwise.
+*/
+template <bool LOG, typename Load, typename Store>
+void softmax_forward(const Context &ctx, const Size_t size0,
+                     const Size_t size1, const Size_t size2, Load load,
+                     Store store) {
+  using namespace softmax_impl;
+  const Size_t size = size0 * size1 * size2;
+  if (size == 0)
+    return;
+  if (size2 > 1) {
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+        (kernel_forward_strided<LOG, index_t, Load, Store>), size,
+        size0 * size2, size1, size2, load, store);
+  } else if (cuda_can_use_int_index(size)) {
+    forward_rows<LOG>(ctx, static_cast<int>(size0), static_cast<int>(size1),
+                      load, store);
+  } else {
+    forward_rows<LOG>(ctx, size0, size1, load, store);
+  }
+}
+
+/*
+  Softmax (or log-softmax if LOG) backward, see softmax_forward().
+*/
+template <bool LOG, typename Load, typename Store>
+void softmax_backward(const Context &ctx, const Size_t size0,
+                      const Size_t size1, const Size_t size2, Load load,
+                      Store store) {
+  using namespace softmax_impl;
+  const Size_t size = size0 * size1 * size2;
+  if (size == 0)
+    return;
+  if (size2 > 1) {
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+        (kernel_backward_strided<LOG, index_t, Load, Store>), size,
+        size0 * size2, size1, size2, load, store);
+  } else if (cuda_can_use_int_index(size)) {
+    backward_rows<LOG>(ctx, static_cast<int>(size0), static_cast<int>(size1),
+                       load, store);
+  } else {
+    backward_rows<LOG>(ctx, size0, size1, load, store);
+  }
+}
+}
+#endif
@@ -82,23 +82,28 @@ template <typename T> static __device__ __forceinline__ T warpSum(T val) {
   return val;
 }
 
-struct InvStd {
-  template <typename T>
-  __device__ __forceinline__ T operator()(T var, double epsilon) const {
-    T invstd = 0;
-    if (var != static_cast<T>(0) || epsilon != static_cast<T>(0)) {
-      invstd = static_cast<T>(1) / sqrt(var + epsilon);
-    }
-    return invstd;
-  }
-};
-
-struct Var {
-  template <typename T>
-  __device__ __forceinline__ T operator()(T var, double epsilon) const {
-    return var;
+// Writes the statistics of channel `c` of this worker, merged across workers
+// in two steps without the cancellation of E[x^2] - E[x]^2:
+//
+// 1. `sums` = [sum (C), count (1)] is all-reduced, which gives the global
+//    mean.
+// 2. Each worker adds its M2 and its count times the squared distance of its
+//    mean to the global mean (Chan et al.). The results are all-reduced into
+//    the global M2. See batch_norm_centered_moments_kernel.
+//
+// `local` = [mean (C), M2 (C), count (1)] keeps the inputs of the second step.
+template <typename T>
+__device__ __forceinline__ void
+store_local_moments(T *sums, T *local, const int c, const int size,
+                    const T avg, const T m2, const T count) {
+  sums[c] = avg * count;
+  local[c] = avg;
+  local[size + c] = m2;
+  if (c == 0) {
+    sums[size] = count;
+    local[2 * size] = count;
   }
-};
+}
 
 __host__ void flexible_launch_configs(const int reduction, const int stride,
                                       dim3 &block, dim3 &grid,
@@ -129,11 +134,10 @@ __host__ void flexible_launch_configs(const int reduction, const int stride,
   grid.z = 1;
 }
 
-template <typename VarTransform, typename input_scalar_t,
-          typename stat_accscalar_t, typename index_t>
+template <typename input_scalar_t, typename stat_accscalar_t, typename index_t>
 __global__ void batch_norm_collect_statistics_kernel(
-    const input_scalar_t *input, const stat_accscalar_t epsilon,
-    stat_accscalar_t *save_mean, stat_accscalar_t *save_transformed_var,
+    const input_scalar_t *input, stat_accscalar_t *save_sums,
+    stat_accscalar_t *save_local,
     const Size_t size0, const Size_t size1, const Size_t size2) {
 
   __shared__ int shared_n[2 * 2 * CUDA_WARP_SIZE + CUDA_WARP_SIZE];
@@ -248,14 +252,10 @@ __global__ void batch_norm_collect_statistics_kernel(
     n += o_n;
   }
 
-  // Save the mean, variance, and moving averages
+  // Save the local moments
   if (tid == 0) {
-    if (save_mean != NULL) {
-      save_mean[plane] = avg;
-    }
-    if (save_transformed_var != NULL) {
-      save_transformed_var[plane] = VarTransform{}(var_n / N, epsilon);
-    }
+    store_local_moments(save_sums, save_local, plane, size1, avg, var_n,
+                        static_cast<stat_accscalar_t>(N));
   }
 }
 
@@ -301,13 +301,12 @@ welford_merge_block_vertical(C &count, T &mean, T &m2n, C *shmem_count,
 // welford kernel for c last tensor calculating
 // mean/biased_variance/unbiased_variance
 // original apex name: welford_kernel_c_last
-template <typename VarTransform, typename scalar_t, typename accscalar_t,
-          typename index_t, int PARALLEL_LOADS>
+template <typename scalar_t, typename accscalar_t, typename index_t,
+          int PARALLEL_LOADS>
 __global__ void batch_norm_collect_statistics_channels_last_kernel(
-    const scalar_t *__restrict__ input, accscalar_t *__restrict__ out_mean,
-    accscalar_t *__restrict__ out_invstd, volatile accscalar_t *staging_data,
-    int *semaphores, const int reduction_size, const int stride,
-    accscalar_t epsilon) {
+    const scalar_t *__restrict__ input, accscalar_t *__restrict__ out_sums,
+    accscalar_t *__restrict__ out_local, volatile accscalar_t *staging_data,
+    int *semaphores, const int reduction_size, const int stride) {
   // hide latency with concurrency
   accscalar_t x_mean[PARALLEL_LOADS];
   accscalar_t m_2_n[PARALLEL_LOADS];
@@ -433,55 +432,56 @@ __global__ void batch_norm_collect_statistics_channels_last_kernel(
       welford_merge_block_vertical(count_th, mean_th, m2_th, shmem_count,
                                    shmem_mean, shmem_m2n);
       if (threadIdx.y == 0 && c_offset < stride) {
-        out_mean[c_offset] = static_cast<accscalar_t>(mean_th);
-        out_invstd[c_offset] = VarTransform{}(m2_th / count_th, epsilon);
+        store_local_moments(out_sums, out_local, c_offset, stride,
+                            static_cast<accscalar_t>(mean_th), m2_th,
+                            static_cast<accscalar_t>(count_th));
       }
     }
   } else {
     if (blockIdx.y == 0 && threadIdx.y == 0 && c_offset < stride) {
-      out_mean[c_offset] = static_cast<accscalar_t>(mean_th);
-      out_invstd[c_offset] = VarTransform{}(m2_th / count_th, epsilon);
+      store_local_moments(out_sums, out_local, c_offset, stride,
+                          static_cast<accscalar_t>(mean_th), m2_th,
+                          static_cast<accscalar_t>(count_th));
     }
   }
 }
 
-template <typename scalar_t, typename accscalar_t, typename index_t>
-__global__ void batch_norm_reduce_statistics_kernel(
-    const accscalar_t *vec_mean, const accscalar_t *vec_invstd,
-    accscalar_t *mean, accscalar_t *var, scalar_t *running_mean,
-    scalar_t *running_var, const accscalar_t epsilon,
-    const accscalar_t decay_rate, const scalar_t *counts,
-    const int feature_size, const int world_size) {
-
-  int bid = blockIdx.x;
-  int tid = threadIdx.x;
+// M2 of this worker around the global mean, i.e. the sum of the squared
+// distances of its samples to the global mean (see store_local_moments).
+template <typename accscalar_t>
+__global__ void batch_norm_centered_moments_kernel(const int feature_size,
+                                                   const accscalar_t *sums,
+                                                   const accscalar_t *local,
+                                                   accscalar_t *m2) {
+  const accscalar_t n = sums[feature_size];
+  const accscalar_t local_n = local[2 * feature_size];
+  NBLA_CUDA_KERNEL_LOOP(i, feature_size) {
+    const accscalar_t delta = local[i] - sums[i] / n;
+    m2[i] = local[feature_size + i] + local_n * delta * delta;
+  }
+}
 
-  // first the reductions each thread does separately
-  for (int i = bid * blockDim.x + tid; i < feature_size;
-       i += gridDim.x * blockDim.x) {
-    accscalar_t avg = 0;
-    accscalar_t var_n = 0;
-    index_t n = 0;
-    for (int j = 0; j < world_size; j++) {
-      scalar_t count = counts[j];
-      accscalar_t m = vec_mean[j * feature_size + i];
-      accscalar_t v = accscalar_t(1.0) / (vec_invstd[j * feature_size + i]);
-      v = (v * v - epsilon) * count;
-      accscalar_t factor = 1.0 / ((accscalar_t)n + count);
-      var_n += v + (avg - m) * (avg - m) * n * count * factor;
-      avg = n * factor * avg + count * factor * m;
-      n += (index_t)count;
-    }
+// Global mean and biased variance from the all-reduced sums and M2 (see
+// store_local_moments), followed by the update of the running statistics.
+template <typename scalar_t, typename accscalar_t>
+__global__ void batch_norm_finalize_statistics_kernel(
+    const int feature_size, const accscalar_t *sums, const accscalar_t *m2,
+    accscalar_t *mean, accscalar_t *var, scalar_t *running_mean,
+    scalar_t *running_var, const accscalar_t decay_rate) {
+  const accscalar_t n = sums[feature_size];
+  NBLA_CUDA_KERNEL_LOOP(i, feature_size) {
+    const accscalar_t avg = sums[i] / n;
+    const accscalar_t v = m2[i] / n;
     mean[i] = avg;
-    var[i] = var_n / n;
+    var[i] = v;
     if (running_mean != NULL) {
       running_mean[i] = static_cast<scalar_t>(decay_rate * running_mean[i] +
                                               (1.0 - decay_rate) * avg);
     }
-    accscalar_t unbiasedVar = var_n / (n - 1);
     if (running_var != NULL) {
+      const accscalar_t unbiased_var = v * n / (n - 1);
       running_var[i] = static_cast<scalar_t>(decay_rate * running_var[i] +
-                                             (1.0 - decay_rate) * unbiasedVar);
+                                             (1.0 - decay_rate) * unbiased_var);
     }
   }
 }
@@ -894,6 +894,32 @@ __global__ void batch_norm_backward_reduce_channels_last_kernel(
   }
 }
 
+// Gradients of beta and gamma from the all-reduced sums of dy and
+// dy * (x - mean).
+template <typename scalar_t, typename accscalar_t>
+__global__ void batch_norm_backward_param_kernel(
+    const int feature_size, const accscalar_t *sum_dy,
+    const accscalar_t *sum_dy_xmu, const accscalar_t *var,
+    const accscalar_t epsilon, scalar_t *grad_bias, scalar_t *grad_weight,
+    const bool accum_bias, const bool accum_weight) {
+  NBLA_CUDA_KERNEL_LOOP(i, feature_size) {
+    if (grad_bias != NULL) {
+      accscalar_t db = sum_dy[i];
+      if (accum_bias) {
+        db += static_cast<accscalar_t>(grad_bias[i]);
+      }
+      grad_bias[i] = static_cast<scalar_t>(db);
+    }
+    if (grad_weight != NULL) {
+      accscalar_t dw = sum_dy_xmu[i] / sqrt(var[i] + epsilon);
+      if (accum_weight) {
+        dw += static_cast<accscalar_t>(grad_weight[i]);
+      }
+      grad_weight[i] = static_cast<scalar_t>(dw);
+    }
+  }
+}
+
 template <bool accum, typename input_scalar_t, typename stat_scalar_t,
           typename stat_accscalar_t, typename index_t>
 __global__ void batch_norm_backward_elemt_kernel(
@@ -902,9 +928,8 @@ __global__ void batch_norm_backward_elemt_kernel(
     const stat_accscalar_t *dmean, const stat_accscalar_t *dvar,
     const stat_scalar_t *weight, const stat_accscalar_t *sum_dy,
     const stat_accscalar_t *sum_dy_xmu, input_scalar_t *grad_input,
-    const stat_accscalar_t epsilon, const int *__restrict__ numel,
-    const int world_size, const index_t size0, const index_t size1,
-    const index_t size2) {
+    const stat_accscalar_t epsilon, const stat_accscalar_t *__restrict__ count,
+    const index_t size0, const index_t size1, const index_t size2) {
   index_t plane = blockIdx.x;
 
   if (plane >= size1) {
@@ -912,12 +937,7 @@ __global__ void batch_norm_backward_elemt_kernel(
   }
 
   // Inverted total reduction size.
-  int64_t total_numel = 0;
-  for (int i = 0; i < world_size; i++) {
-    total_numel += numel[i];
-  }
-  const stat_accscalar_t norm_fct = static_cast<stat_accscalar_t>(1) /
-                                    static_cast<stat_accscalar_t>(total_numel);
+  const stat_accscalar_t norm_fct = static_cast<stat_accscalar_t>(1) / count[0];
 
   // weight, mean and invstd
   const stat_accscalar_t w_c = weight[plane];
@@ -969,8 +989,8 @@ __global__ void batch_norm_backward_elemt_channels_last_kernel(
     const accscalar_t *__restrict__ dvar,
     const layerscalar_t *__restrict__ weight,
     const accscalar_t *__restrict__ sum_dy,
-    const accscalar_t *__restrict__ sum_dy_xmu, const int *__restrict__ numel,
-    scalar_t *__restrict__ grad_input, const int world_size,
+    const accscalar_t *__restrict__ sum_dy_xmu,
+    const accscalar_t *__restrict__ count, scalar_t *__restrict__ grad_input,
     const index_t reduction_size, const index_t stride,
     const accscalar_t epsilon) {
   // tensor dimension (m,c)
@@ -986,12 +1006,7 @@ __global__ void batch_norm_backward_elemt_channels_last_kernel(
   }
 
   // Inverted total reduction size.
-  int64_t total_numel = 0;
-  for (int i = 0; i < world_size; i++) {
-    total_numel += numel[i];
-  }
-  auto norm_fct =
-      static_cast<accscalar_t>(1) / static_cast<accscalar_t>(total_numel);
+  auto norm_fct = static_cast<accscalar_t>(1) / count[0];
 
   // weight, mean and invstd
   const accscalar_t w_c = weight[c_offset];
@@ -37,6 +37,8 @@ public:
 
 protected:
   int device_;
+  int ndim_;       ///< Number of axes after merging unpadded axes
+  bool vectorize_; ///< Constant padding of packs of consecutive elements
   NdArray parameter_memory_;
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
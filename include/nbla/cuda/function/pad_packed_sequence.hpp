@@ -37,7 +37,6 @@ public:
 
 protected:
   int device_;
-  FunctionPtr f_transpose_ = nullptr;
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
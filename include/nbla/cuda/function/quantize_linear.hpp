@@ -27,7 +27,19 @@ public:
   explicit QuantizeLinearCuda(const Context &ctx, const string &round_mode,
                               bool narrow_range, int dtype)
       : QuantizeLinear<T>(ctx, round_mode, narrow_range, dtype),
-        device_(std::stoi(ctx.device_id)) {}
+        device_(std::stoi(ctx.device_id)),
+        half_to_even_(round_mode == "HALF_TO_EVEN") {
+    // Same ranges as QuantizeLinear::setup_impl.
+    if (dtype == static_cast<int>(dtypes::UBYTE)) {
+      storage_dtype_ = dtypes::UBYTE;
+      qmin_ = narrow_range ? 1 : 0;
+      qmax_ = 255;
+    } else {
+      storage_dtype_ = dtypes::BYTE;
+      qmin_ = narrow_range ? -127 : -128;
+      qmax_ = 127;
+    }
+  }
   virtual ~QuantizeLinearCuda() {}
   virtual string name() { return "QuantizeLinearCuda"; }
   virtual vector<string> allowed_array_classes() {
@@ -36,7 +48,17 @@ public:
 
 protected:
   int device_;
+  bool half_to_even_;
+  dtypes storage_dtype_;
+  int qmin_;
+  int qmax_;
+  // Per-channel layout of scale and zero_point (see setup_impl).
+  bool fused_;
+  Size_t channels_;
+  Size_t inner_size_;
+
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
+  virtual void forward_impl(const Variables &inputs, const Variables &outputs);
   NBLA_API virtual void round(Variable *inp, std::string round_mode);
   NBLA_API virtual void saturate(Variable *inp, int min_range, int max_range);
 };
@@ -16,6 +16,7 @@
 #define __NBLA_CUDA_FUNCTION_REDUCE_MEAN_HPP__
 
 #include <nbla/cuda/cuda.hpp>
+#include <nbla/cuda/utils/reduce.hpp>
 #include <nbla/function/reduce_mean.hpp>
 
 namespace nbla {
@@ -35,6 +36,8 @@ public:
   virtual string name() { return "ReduceMeanCuda"; }
 
 protected:
+  ReduceSetup reduce_setup_;
+  virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
   virtual void backward_impl(const Variables &inputs, const Variables &outputs,
                              const vector<bool> &propagate_down,
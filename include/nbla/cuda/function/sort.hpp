@@ -36,6 +36,11 @@ public:
 
 protected:
   int device_;
+  NdArray sort_keys_;  ///< Segment-major copy of the input keys
+  NdArray sort_perm_;  ///< Sorted linear index into `sort_keys_`
+  NdArray sort_segs_;  ///< Segment index of the sorted `sort_perm_`
+
+  virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
   virtual void backward_impl(const Variables &inputs, const Variables &outputs,
                              const vector<bool> &propagate_down,
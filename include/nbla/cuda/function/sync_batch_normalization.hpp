@@ -36,26 +36,17 @@ protected:
 
   BatchNormalizationCuda<T> batch_norm_;
 
-  // Temporally buffers and functions for forward
+  // Temporally buffers for forward
   Variable v_staging_data_for_forward_;
   Variable v_semaphores_for_forward_;
-  Variable v_local_mean_, v_local_invstd_, v_local_count_;
-  Variable v_all_mean_, v_all_invstd_, v_all_count_;
-  Variable v_all_gather_send_;
-  Variable v_all_gather_recv_;
+  Variable v_stats_;       ///< [sum (C), count (1)], all-reduced
+  Variable v_local_stats_; ///< [mean (C), M2 (C), count (1)] of this worker
+  Variable v_m2_;          ///< M2 around the global mean (C), all-reduced
 
-  FunctionPtr concatenate_;
-  FunctionPtr slice_mean_;
-  FunctionPtr slice_invstd_;
-  FunctionPtr slice_count_;
-
-  // Temporally buffers and functions for backward
+  // Temporally buffers for backward
   Variable v_staging_data_for_backward_;
   Variable v_semaphores_for_backward_;
-  Variable v_sum_dy_o_, v_sum_dy_xmu_o_;
-  Variable v_beta_grad_, v_gamma_grad_;
-
-  FunctionPtr add2_;
+  Variable v_grad_sums_; ///< [sum of dy (C), sum of dy * (x - mean) (C)]
 
 public:
   typedef typename CudaType<T>::type Tc;
@@ -37,7 +37,7 @@ public:
 
 protected:
   int device_;
-  std::shared_ptr<Variable> var_strides_;
+  vector<int> inv_axes_;
 
   virtual void setup_impl(const Variables &inputs, const Variables &outputs);
   virtual void forward_impl(const Variables &inputs, const Variables &outputs);
@@ -633,12 +633,13 @@ void forward_impl(const Context &ctx, BinaryOp op, const Variables &inputs,
           NBLA_CEIL_SIZE_T_DIV(x_size, blockDim.x),
           NBLA_CEIL_SIZE_T_DIV(y_size, blockDim.y),
           NBLA_CEIL_SIZE_T_DIV(z_size, blockDim.z));
-      kernel_forward_dim3<T, PRECISE_T, BinaryOp><<<gridDim, blockDim>>>(
-          op, x0, x1, y, params);
+      auto kernel = kernel_forward_dim3<T, PRECISE_T, BinaryOp>;
+      kernel<<<gridDim, blockDim, 0, cuda_get_current_stream()>>>(op, x0, x1, y,
+                                                                  params);
       NBLA_CUDA_KERNEL_CHECK();
     } else {
       // Not broadcast
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+      NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY(
           (kernel_forward_dim3_not_broadcasted_both_terms<T, PRECISE_T,
                                                           BinaryOp>),
           shape[2], op, x0, x1, y, params);
@@ -651,7 +652,7 @@ void forward_impl(const Context &ctx, BinaryOp op, const Variables &inputs,
     const auto *stride_x1 = v_strides_x1.get_data_pointer<Size_t>(ctx);
     const auto *stride_y = v_strides_y.get_data_pointer<Size_t>(ctx);
     const auto *shape_y = v_shape_y.get_data_pointer<Size_t>(ctx);
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+    NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY(
         (kernel_forward_ndim<T, PRECISE_T, BinaryOp>), size, op, x0, x1, y,
         ndim, stride_x0, stride_x1, stride_y, shape_y);
   }
@@ -677,13 +678,15 @@ void backward_impl_dim3_without_reduction(
         NBLA_CEIL_SIZE_T_DIV(y_size, blockDim.y),
         NBLA_CEIL_SIZE_T_DIV(z_size, blockDim.z));
 
-    kernel_backward_dim3_broadcasted_other_term<T, PRECISE_T, BinaryOp,
-                                                term><<<gridDim, blockDim>>>(
+    auto kernel =
+        kernel_backward_dim3_broadcasted_other_term<T, PRECISE_T, BinaryOp,
+                                                    term>;
+    kernel<<<gridDim, blockDim, 0, cuda_get_current_stream()>>>(
         op, dy, x0, x1, y, dx, inplace, params);
     NBLA_CUDA_KERNEL_CHECK();
   } else {
     // The other term is not broadcasted too. The computation becomes easier.
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+    NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY(
         (kernel_backward_dim3_not_broadcasted_both_terms<T, PRECISE_T, BinaryOp,
                                                          term>),
         shape[2], op, dy, x0, x1, y, dx, inplace, params);
@@ -708,15 +711,17 @@ void backward_impl_dim3_reduce_x(BinaryOp op, const T *dy, const T *x0,
   if (z_reduced_buff) {
     // z axis is reduced previously.
     dim3 gridDim = get_strided_grids_dim3<T, BinaryOp>(1, y_size, 1);
-    kernel_backward_dim3_reduce_x_after_z<
-        T, PRECISE_T, blockSize><<<gridDim, blockDim, smem_size>>>(
+    auto kernel =
+        kernel_backward_dim3_reduce_x_after_z<T, PRECISE_T, blockSize>;
+    kernel<<<gridDim, blockDim, smem_size, cuda_get_current_stream()>>>(
         z_reduced_buff, dx, x_size, y_size);
     NBLA_CUDA_KERNEL_CHECK();
   } else {
     // x axis is only reduced.
     dim3 gridDim = get_strided_grids_dim3<T, BinaryOp>(1, y_size, z_size);
-    kernel_backward_dim3_reduce_x<T, PRECISE_T, BinaryOp, term,
-                                  blockSize><<<gridDim, blockDim, smem_size>>>(
+    auto kernel =
+        kernel_backward_dim3_reduce_x<T, PRECISE_T, BinaryOp, term, blockSize>;
+    kernel<<<gridDim, blockDim, smem_size, cuda_get_current_stream()>>>(
         op, dy, x0, x1, y, dx, inplace, params, x_size, y_size, z_size);
     NBLA_CUDA_KERNEL_CHECK();
   }
@@ -738,9 +743,10 @@ void backward_impl_dim3_reduce_y(const Context &ctx, BinaryOp op, const T *dy,
       NBLA_CEIL_SIZE_T_DIV(z_size, blockDim.z));
 
   if (is_same<T, PRECISE_T>::value) {
-    kernel_backward_dim3_reduce_y<
-        T, T, BinaryOp, term,
-        TRANSFORM_BINARY_CUDA_GRID_DIV><<<gridDim, blockDim>>>(
+    auto kernel =
+        kernel_backward_dim3_reduce_y<T, T, BinaryOp, term,
+                                      TRANSFORM_BINARY_CUDA_GRID_DIV>;
+    kernel<<<gridDim, blockDim, 0, cuda_get_current_stream()>>>(
         op, dy, x0, x1, y, dx, inplace, params, x_size, y_size, z_size);
     NBLA_CUDA_KERNEL_CHECK();
   } else {
@@ -750,9 +756,10 @@ void backward_impl_dim3_reduce_y(const Context &ctx, BinaryOp op, const T *dy,
     tmp_arr.zero();
     auto tmp = tmp_arr.cast(get_dtype<PRECISE_T>(), ctx)->pointer<PRECISE_T>();
 
-    kernel_backward_dim3_reduce_y<
-        T, PRECISE_T, BinaryOp, term,
-        TRANSFORM_BINARY_CUDA_GRID_DIV><<<gridDim, blockDim>>>(
+    auto kernel =
+        kernel_backward_dim3_reduce_y<T, PRECISE_T, BinaryOp, term,
+                                      TRANSFORM_BINARY_CUDA_GRID_DIV>;
+    kernel<<<gridDim, blockDim, 0, cuda_get_current_stream()>>>(
         op, dy, x0, x1, y, tmp, inplace, params, x_size, y_size, z_size);
     NBLA_CUDA_KERNEL_CHECK();
 
@@ -775,9 +782,10 @@ PRECISE_T *backward_impl_dim3_reduce_z(
       NBLA_CEIL_SIZE_T_DIV(y_size, blockDim.y),
       NBLA_CEIL_SIZE_T_DIV(z_size, TRANSFORM_BINARY_CUDA_GRID_DIV));
   if (is_same<T, PRECISE_T>::value && !reduce_x) {
-    kernel_backward_dim3_reduce_z<
-        T, T, BinaryOp, term,
-        TRANSFORM_BINARY_CUDA_GRID_DIV><<<gridDim, blockDim>>>(
+    auto kernel =
+        kernel_backward_dim3_reduce_z<T, T, BinaryOp, term,
+                                      TRANSFORM_BINARY_CUDA_GRID_DIV>;
+    kernel<<<gridDim, blockDim, 0, cuda_get_current_stream()>>>(
         op, dy, x0, x1, y, dx, inplace, params, x_size, y_size, z_size);
     NBLA_CUDA_KERNEL_CHECK();
     return nullptr;
@@ -788,9 +796,10 @@ PRECISE_T *backward_impl_dim3_reduce_z(
     tmp_arr.zero();
     auto tmp = tmp_arr.cast(get_dtype<PRECISE_T>(), ctx)->pointer<PRECISE_T>();
 
-    kernel_backward_dim3_reduce_z<
-        T, PRECISE_T, BinaryOp, term,
-        TRANSFORM_BINARY_CUDA_GRID_DIV><<<gridDim, blockDim>>>(
+    auto kernel =
+        kernel_backward_dim3_reduce_z<T, PRECISE_T, BinaryOp, term,
+                                      TRANSFORM_BINARY_CUDA_GRID_DIV>;
+    kernel<<<gridDim, blockDim, 0, cuda_get_current_stream()>>>(
         op, dy, x0, x1, y, tmp, inplace, params, x_size, y_size, z_size);
     NBLA_CUDA_KERNEL_CHECK();
 
@@ -63,7 +63,8 @@ void forward_impl_transform_unary(const Variables &inputs,
   const T *x = inputs[0]->get_data_pointer<T>(ctx);
   T *y = outputs[0]->cast_data_and_get_pointer<T>(ctx, !inplace);
   int size = inputs[0]->size();
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_transform_unary, size, x, y, op);
+  NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY((kernel_transform_unary<T, UnaryOp>), size,
+                                    x, y, op);
 }
 
 template <class T, typename UnaryOp>
@@ -83,11 +84,11 @@ void backward_impl_transform_unary(const Variables &inputs,
   size_t size = inputs[0]->size();
   T *g = inputs[0]->cast_grad_and_get_pointer<T>(ctx, !accum[0]);
   if (accum[0]) {
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+    NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY(
         (kernel_transform_unary_grad<T, UnaryOp, true>), size, dy, x, y, g,
         inplace, op);
   } else {
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+    NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY(
         (kernel_transform_unary_grad<T, UnaryOp, false>), size, dy, x, y, g,
         inplace, op);
   }
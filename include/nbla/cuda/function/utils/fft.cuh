@@ -171,11 +171,14 @@ template <> inline cudaDataType_t get_cufft_dtype<float>(bool complex) {
 /*
  Execute cuFFT. This is the unscaled or unnormalized FFT.
  Note: the normalization is taken care by a user of this function.
+
+ The plan is taken from CufftPlanCache, so it is created only once per
+ configuration, and its work area is the shared one of the device.
  */
 template <typename Tcu>
 void exec_cufft(const Context ctx, const Tcu *input_ptr, Tcu *output_ptr,
-                Shape_t ishape, Shape_t oshape, cufftHandle &plan,
-                bool complex_input, bool complex_output, int direction,
+                Shape_t ishape, Shape_t oshape, bool complex_input,
+                bool complex_output, int direction,
                 std::vector<long long int> n, long long int signal_ndim) {
   // Check arguments
   NBLA_CHECK(complex_input || complex_output, error_code::value,
@@ -279,26 +282,31 @@ void exec_cufft(const Context ctx, const Tcu *input_ptr, Tcu *output_ptr,
   inembed[0] = batch; // just in case
   onembed[0] = batch; // just in case
 
-  // work size
-  size_t work_size = 0;
-
   // execution_type: execution type
   cudaDataType_t execution_type = get_cufft_dtype<Tcu>(true);
 
-  // Make plan
-  NBLA_CUFFT_CHECK(
-      cufftSetAutoAllocation(plan, false)); // use nnabla's memory allocation
-  NBLA_CUFFT_CHECK(
-      cufftXtMakePlanMany(plan, rank, n.data(), inembed.data(), istride, idist,
-                          input_type, onembed.data(), ostride, odist,
-                          output_type, batch, &work_size, execution_type));
-  NdArray arr_buff(Shape_t{static_cast<Size_t>(work_size)});
-  void *buff = arr_buff.cast(get_dtype<unsigned char>(), ctx, true)->pointer();
-  NBLA_CUFFT_CHECK(cufftSetWorkArea(plan, (void *)buff));
+  // Get plan
+  const CufftPlanKey key{std::stoi(ctx.device_id),
+                         n,
+                         inembed,
+                         istride,
+                         idist,
+                         onembed,
+                         ostride,
+                         odist,
+                         batch,
+                         input_type,
+                         output_type,
+                         execution_type};
+  auto cache = SingletonManager::get<CufftPlanCache>();
+  auto plan = cache->get_plan(key);
+  void *buff = cache->get_work_area(ctx, plan->work_size);
+  NBLA_CUFFT_CHECK(cufftSetWorkArea(plan->handle, buff));
+  NBLA_CUFFT_CHECK(cufftSetStream(plan->handle, cuda_get_current_stream()));
 
   // Execute FFT
-  NBLA_CUFFT_CHECK(
-      cufftXtExec(plan, (void *)input_ptr, (void *)output_ptr, direction));
+  NBLA_CUFFT_CHECK(cufftXtExec(plan->handle, (void *)input_ptr,
+                               (void *)output_ptr, direction));
 }
 }
 #endif
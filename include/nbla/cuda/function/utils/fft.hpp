@@ -14,9 +14,21 @@
 
 #ifndef NBLA_CUDA_FUNCTION_UTILS_FFT_HPP
 #define NBLA_CUDA_FUNCTION_UTILS_FFT_HPP
+#include <nbla/common.hpp>
+#include <nbla/context.hpp>
+#include <nbla/cuda/defs.hpp>
 #include <nbla/exception.hpp>
+#include <nbla/nd_array.hpp>
+#include <nbla/singleton_manager.hpp>
 
 #include <cufft.h>
+#include <library_types.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace nbla {
 
@@ -71,5 +83,131 @@ static const char *cufftGetErrorString(cufftResult error) {
                  cufftGetErrorString(ret));                                    \
     }                                                                          \
   } while (0)
+
+/** Configuration of a cuFFT plan, as passed to cufftXtMakePlanMany.
+
+The transform direction is not a part of it since C2C plans execute both
+directions and R2C/C2R plans differ by their input and output types.
+ */
+struct CufftPlanKey {
+  int device;
+  vector<long long int> n;
+  vector<long long int> inembed;
+  long long int istride;
+  long long int idist;
+  vector<long long int> onembed;
+  long long int ostride;
+  long long int odist;
+  long long int batch;
+  cudaDataType_t input_type;
+  cudaDataType_t output_type;
+  cudaDataType_t execution_type;
+
+  bool operator==(const CufftPlanKey &right) const {
+    return device == right.device && n == right.n &&
+           inembed == right.inembed && istride == right.istride &&
+           idist == right.idist && onembed == right.onembed &&
+           ostride == right.ostride && odist == right.odist &&
+           batch == right.batch && input_type == right.input_type &&
+           output_type == right.output_type &&
+           execution_type == right.execution_type;
+  }
+
+  class Hash {
+  public:
+    std::size_t operator()(const CufftPlanKey &x) const {
+      size_t h = std::hash<int>{}(x.device);
+      for (auto v : x.n)
+        hash_combine(h, v);
+      for (auto v : x.inembed)
+        hash_combine(h, v);
+      hash_combine(h, x.istride);
+      hash_combine(h, x.idist);
+      for (auto v : x.onembed)
+        hash_combine(h, v);
+      hash_combine(h, x.ostride);
+      hash_combine(h, x.odist);
+      hash_combine(h, x.batch);
+      hash_combine(h, static_cast<int>(x.input_type));
+      hash_combine(h, static_cast<int>(x.output_type));
+      hash_combine(h, static_cast<int>(x.execution_type));
+      return h;
+    }
+  };
+};
+
+/** cuFFT plan without an attached work area. The plan is destroyed with the
+last reference, so an evicted plan stays valid for a running execution.
+ */
+class NBLA_CUDA_API CufftPlan {
+public:
+  cufftHandle handle;
+  size_t work_size; ///< Size of the work area required by the plan.
+
+  CufftPlan(const CufftPlanKey &key);
+  ~CufftPlan();
+  DISABLE_COPY_AND_ASSIGN(CufftPlan);
+};
+
+/** LRU cache of cuFFT plans shared by the FFT functions, and a work area per
+device which all the plans use.
+
+The FFT functions execute on the current stream of the calling thread (see
+cuda_get_current_stream()) one after another, so a single work area per
+device is enough. While a CUDA graph is capturing, a work area is taken from
+the memory pool of the graph instead, since the graph keeps using it in every
+replay while the shared one may be reallocated.
+ */
+class NBLA_CUDA_API CufftPlanCache {
+public:
+  ~CufftPlanCache();
+
+  /** Get a plan for the configuration, creating it on a cache miss. The least
+      recently used plan is destroyed when the cache is full.
+   */
+  shared_ptr<CufftPlan> get_plan(const CufftPlanKey &key);
+
+  /** Get the work area of the device in the context, which has at least the
+      given size. It is only valid until the next call.
+   */
+  void *get_work_area(const Context &ctx, size_t bytes);
+
+  /** Get the maximum number of cached plans.
+
+      @note The default value is 128. The default value is overwritten if an
+            environment variable NNABLA_CUFFT_PLAN_CACHE_SIZE is specified.
+   */
+  size_t get_capacity();
+
+  /** Set the maximum number of cached plans. Plans beyond it are destroyed.
+   */
+  void set_capacity(size_t capacity);
+
+  /** Destroy all cached plans and release the work areas.
+   */
+  void clear();
+
+protected:
+  typedef std::list<std::pair<CufftPlanKey, shared_ptr<CufftPlan>>> lru_t;
+  std::mutex mtx_;
+  size_t capacity_;
+  lru_t lru_; ///< Most recently used first.
+  std::unordered_map<CufftPlanKey, lru_t::iterator, CufftPlanKey::Hash> plans_;
+  std::unordered_map<int, NdArrayPtr> work_areas_;
+  NdArrayPtr capture_work_area_;
+
+  void evict(size_t capacity);
+
+private:
+  friend SingletonManager;
+  CufftPlanCache();
+  DISABLE_COPY_AND_ASSIGN(CufftPlanCache);
+};
+
+/** Wrapper functions of CufftPlanCache.
+ */
+NBLA_CUDA_API size_t cufft_get_plan_cache_capacity();
+NBLA_CUDA_API void cufft_set_plan_cache_capacity(size_t capacity);
+NBLA_CUDA_API void cufft_clear_plan_cache();
 }
 #endif
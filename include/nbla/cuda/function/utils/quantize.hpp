@@ -0,0 +1,56 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** Utilities of QuantizeLinear and DequantizeLinear for CUDA.
+ */
+#ifndef __NBLA_CUDA_FUNCTION_UTILS_QUANTIZE_HPP__
+#define __NBLA_CUDA_FUNCTION_UTILS_QUANTIZE_HPP__
+
+#include <nbla/common.hpp>
+
+namespace nbla {
+
+/** Check that scale and zero_point are per-tensor or per-channel for x.
+
+    True if both have the same shape, broadcastable to x, with at most one axis
+    larger than 1. The element for x[i] is then
+    `(i / inner_size) % channels`.
+ */
+inline bool get_quantize_channel_layout(const Shape_t &x_shape,
+                                        const Shape_t &scale_shape,
+                                        const Shape_t &zero_point_shape,
+                                        Size_t &channels, Size_t &inner_size) {
+  channels = 1;
+  inner_size = 1;
+  const int ndim = x_shape.size();
+  const int offset = ndim - static_cast<int>(scale_shape.size());
+  if (offset < 0 || scale_shape != zero_point_shape)
+    return false;
+  int axis = -1;
+  for (int i = 0; i < static_cast<int>(scale_shape.size()); i++) {
+    if (scale_shape[i] == 1)
+      continue;
+    if (axis >= 0 || scale_shape[i] != x_shape[i + offset])
+      return false;
+    axis = i + offset;
+  }
+  if (axis >= 0) {
+    channels = x_shape[axis];
+    for (int i = axis + 1; i < ndim; i++)
+      inner_size *= x_shape[i];
+  }
+  return true;
+}
+}
+#endif
@@ -19,6 +19,7 @@
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/cuda.hpp>
 #include <nbla/cuda/utils/nd_index.cuh>
+#include <nbla/cuda/utils/scan.cuh>
 
 namespace nbla {
 namespace cuda {
@@ -26,148 +27,162 @@ namespace function {
 namespace utils {
 namespace rnn {
 
-template <typename U, bool accum = false>
-__global__ void kernel_sequential_add(int size, const U *x, U *y) {
-  NBLA_CUDA_KERNEL_LOOP(idx, size) {
-    y[idx] = accum ? y[idx] + x[idx] : x[idx];
+// Number of sequences longer than t. The lengths are sorted in
+// descending order.
+__device__ __forceinline__ int device_batch_size(const int *lengths, int B,
+                                                 int t) {
+  int lo = 0, hi = B;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (lengths[mid] > t)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Loads the batch size of time step t, computed from the lengths.
+struct LoadBatchSizeFromLengths {
+  const int *lengths;
+  int B;
+  __device__ int operator()(const int t) const {
+    return device_batch_size(lengths, B, t);
+  }
+};
+
+// Loads the batch size of time step t.
+struct LoadBatchSize {
+  const int *batch_sizes;
+  __device__ int operator()(const int t) const { return batch_sizes[t]; }
+};
+
+// Stores the offset of time step t in the packed sequence and, if given,
+// its batch size.
+struct StoreOffset {
+  const int *lengths;
+  int B;
+  int *batch_sizes;
+  int *offsets;
+  __device__ void operator()(const int t, const int offset) const {
+    offsets[t] = offset;
+    if (batch_sizes)
+      batch_sizes[t] = device_batch_size(lengths, B, t);
+  }
+};
+
+// The length of sequence b is the number of time steps with a batch size
+// greater than b. The batch sizes are sorted in descending order.
+__global__ void kernel_compute_lengths(int B, const int *batch_sizes, int T,
+                                       int *lengths) {
+  NBLA_CUDA_KERNEL_LOOP(b, B) {
+    int lo = 0, hi = T;
+    while (lo < hi) {
+      const int mid = (lo + hi) / 2;
+      if (batch_sizes[mid] > b)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    lengths[b] = lo;
   }
 }
 
-// Parallelize over the unpacked array.
-// Parallelizing over the packed array is slower since we have to iterate over
-// the time dimension
-// which is generally very long.
+// Parallelize over the padded array, each time step finds its rows in the
+// packed array by the precomputed offsets. The padded array is (TP, B, D)
+// or (B, TP, D) if batch_first, where TP >= T.
 template <typename U, bool accum = false>
-__global__ void kernel_pack_parallel_add0(int size, const U *padded_sequence,
-                                          const int *batch_sizes,
-                                          U *packed_sequence, int T, int B,
-                                          int D) {
-  auto stride0 = B * D;
-  auto stride1 = D;
+__global__ void kernel_pack(int size, const U *padded_sequence,
+                            const int *batch_sizes, const int *offsets,
+                            U *packed_sequence, int T, int TP, int B, int D,
+                            bool batch_first) {
+  const auto strides = batch_first ? make_int2(TP * D, D) : make_int2(B * D, D);
   NBLA_CUDA_KERNEL_LOOP(iidx, size) {
-    auto nd_iidx = device_flat_to_3d(iidx, make_int2(stride0, stride1));
-    auto t = nd_iidx.x;
-    auto b = nd_iidx.y;
+    auto nd_iidx = device_flat_to_3d(iidx, strides);
+    auto t = batch_first ? nd_iidx.y : nd_iidx.x;
+    auto b = batch_first ? nd_iidx.x : nd_iidx.y;
     auto d = nd_iidx.z;
-    auto batch_size = batch_sizes[t];
-    if (b < batch_size) {
-      int s = 0;
-      for (int i = 0; i < t; i++) {
-        s += batch_sizes[i];
-      }
-      auto packed_sequence_oidx = packed_sequence + (s + b) * D + d;
-      *packed_sequence_oidx =
-          accum ? *packed_sequence_oidx + padded_sequence[iidx]
-                : padded_sequence[iidx];
+    if (t < T && b < batch_sizes[t]) {
+      auto &y = packed_sequence[(offsets[t] + b) * D + d];
+      y = accum ? y + padded_sequence[iidx] : padded_sequence[iidx];
     }
   }
 }
 
 template <typename U, bool accum = false>
-__global__ void kernel_unpack_parallel_add0(int size, const U *packed_sequence,
-                                            const int *batch_sizes,
-                                            U *padded_sequence, int T, int B,
-                                            int D) {
-  auto stride0 = B * D;
-  auto stride1 = D;
+__global__ void kernel_unpack(int size, const U *packed_sequence,
+                              const int *batch_sizes, const int *offsets,
+                              U *padded_sequence, int T, int TP, int B, int D,
+                              bool batch_first, U padding_value) {
+  const auto strides = batch_first ? make_int2(TP * D, D) : make_int2(B * D, D);
   NBLA_CUDA_KERNEL_LOOP(iidx, size) {
-    auto nd_iidx = device_flat_to_3d(iidx, make_int2(stride0, stride1));
-    auto t = nd_iidx.x;
-    auto b = nd_iidx.y;
+    auto nd_iidx = device_flat_to_3d(iidx, strides);
+    auto t = batch_first ? nd_iidx.y : nd_iidx.x;
+    auto b = batch_first ? nd_iidx.x : nd_iidx.y;
     auto d = nd_iidx.z;
-    auto batch_size = batch_sizes[t];
-    if (b < batch_size) {
-      int s = 0;
-      for (int i = 0; i < t; i++) {
-        s += batch_sizes[i];
-      }
-      auto packed_sequence_oidx = packed_sequence + (s + b) * D + d;
-      padded_sequence[iidx] =
-          accum ? padded_sequence[iidx] + *packed_sequence_oidx
-                : *packed_sequence_oidx;
+    if (t < T && b < batch_sizes[t]) {
+      auto x = packed_sequence[(offsets[t] + b) * D + d];
+      padded_sequence[iidx] = accum ? padded_sequence[iidx] + x : x;
+    } else if (!accum) {
+      padded_sequence[iidx] = padding_value;
     }
   }
 }
 
-template <typename U, bool accum = false>
-__global__ void kernel_zeros(int size, U *padded_sequence) {
-  NBLA_CUDA_KERNEL_LOOP(idx, size) { padded_sequence[idx] = U(0); }
+/** Compute the batch sizes of T time steps from the B lengths sorted in
+    descending order, and the offsets of the time steps in the packed
+    sequence. Both are computed on device.
+ */
+inline void compute_batch_sizes(const Context &ctx, const int *lengths, int B,
+                                int T, int *batch_sizes, int *offsets) {
+  const ScanSetup setup{1, T, 1, true /* exclusive */, false /* reverse */};
+  device_scan<ScanOpSum<int>>(ctx, setup, LoadBatchSizeFromLengths{lengths, B},
+                              StoreOffset{lengths, B, batch_sizes, offsets});
+}
+
+/** Compute the offsets of T time steps in the packed sequence from their
+    batch sizes on device.
+ */
+inline void compute_offsets(const Context &ctx, const int *batch_sizes, int T,
+                            int *offsets) {
+  const ScanSetup setup{1, T, 1, true /* exclusive */, false /* reverse */};
+  device_scan<ScanOpSum<int>>(ctx, setup, LoadBatchSize{batch_sizes},
+                              StoreOffset{nullptr, 0, nullptr, offsets});
+}
+
+/** Compute the B lengths from the batch sizes of T time steps on device.
+ */
+inline void compute_lengths(const int *batch_sizes, int T, int B,
+                            int *lengths) {
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_compute_lengths, B, batch_sizes, T,
+                                 lengths);
 }
 
+/** Pack the padded sequence of TP >= T time steps into the packed sequence
+    in a single launch.
+ */
 template <typename U, bool accum = false>
-inline void pack(const Context &ctx, const U *padded_sequence,
-                 const int *batch_sizes, U *packed_sequence, int T, int B,
-                 int D, int N) {
-  // https://docs.nvidia.com/cuda/cuda-c-programming-guide/index.html#concurrent-execution-host-device
-  // > The following device operations are asynchronous with respect to the
-  // host:
-  // >   - Memory copies from host to device of a memory block of 64 KB or less;
-  if (N > (64 * 1024 / sizeof(int))) {
-    auto s = 0;
-    for (int t = 0; t < T; t++) {
-      auto batch_size = batch_sizes[t];
-      auto isize = s * D;
-      auto padded_sequence_t = padded_sequence + t * (B * D);
-      auto packed_sequence_t = packed_sequence + isize;
-      auto kernel = accum ? kernel_sequential_add<U, true>
-                          : kernel_sequential_add<U, false>;
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, batch_size * D, padded_sequence_t,
-                                     packed_sequence_t);
-      s += batch_size;
-    }
-  } else {
-    auto bytes = T * sizeof(int);
-    shared_ptr<CudaCachedArray> arr_buff =
-        make_shared<CudaCachedArray>(T, get_dtype<int>(), ctx);
-    int *buff = arr_buff->pointer<int>();
-    NBLA_CUDA_CHECK(
-        cudaMemcpy(buff, batch_sizes, bytes, cudaMemcpyHostToDevice));
-
-    auto kernel = accum ? kernel_pack_parallel_add0<U, true>
-                        : kernel_pack_parallel_add0<U, false>;
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, T * B * D, padded_sequence, buff,
-                                   packed_sequence, T, B, D);
-  }
+inline void pack(const U *padded_sequence, const int *batch_sizes,
+                 const int *offsets, U *packed_sequence, int T, int TP, int B,
+                 int D, bool batch_first) {
+  auto kernel = accum ? kernel_pack<U, true> : kernel_pack<U, false>;
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, TP * B * D, padded_sequence,
+                                 batch_sizes, offsets, packed_sequence, T, TP,
+                                 B, D, batch_first);
 }
 
+/** Unpack the packed sequence into the padded sequence of TP >= T time steps
+    in a single launch. The padding is filled with padding_value unless
+    accumulating.
+ */
 template <typename U, bool accum = false>
-inline void unpack(const Context &ctx, const U *packed_sequence,
-                   const int *batch_sizes, U *padded_sequence, int T, int B,
-                   int D, int N, int TL = -1) {
-  // Zeroing
-  auto size = (TL > T) ? (TL * B * D) : (T * B * D);
-  if (!accum)
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_zeros, size, padded_sequence);
-  // https://docs.nvidia.com/cuda/cuda-c-programming-guide/index.html#concurrent-execution-host-device
-  // > The following device operations are asynchronous with respect to the
-  // host:
-  // >   - Memory copies from host to device of a memory block of 64 KB or less;
-  // Unapck
-  if (N > (64 * 1024 / sizeof(int))) {
-    auto s = 0;
-    for (int t = 0; t < T; t++) {
-      auto batch_size = batch_sizes[t];
-      auto isize = s * D;
-      auto padded_sequence_t = padded_sequence + t * (B * D);
-      auto packed_sequence_t = packed_sequence + isize;
-      auto kernel = accum ? kernel_sequential_add<U, true>
-                          : kernel_sequential_add<U, false>;
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, batch_size * D, packed_sequence_t,
-                                     padded_sequence_t);
-      s += batch_size;
-    }
-  } else {
-    auto bytes = T * sizeof(int);
-    shared_ptr<CudaCachedArray> arr_buff =
-        make_shared<CudaCachedArray>(T, get_dtype<int>(), ctx);
-    auto buff = arr_buff->pointer<int>();
-    NBLA_CUDA_CHECK(
-        cudaMemcpy(buff, batch_sizes, bytes, cudaMemcpyHostToDevice));
-    auto kernel = accum ? kernel_unpack_parallel_add0<U, true>
-                        : kernel_unpack_parallel_add0<U, false>;
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, T * B * D, packed_sequence, buff,
-                                   padded_sequence, T, B, D);
-  }
+inline void unpack(const U *packed_sequence, const int *batch_sizes,
+                   const int *offsets, U *padded_sequence, int T, int TP,
+                   int B, int D, bool batch_first, U padding_value = U(0)) {
+  auto kernel = accum ? kernel_unpack<U, true> : kernel_unpack<U, false>;
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, TP * B * D, packed_sequence,
+                                 batch_sizes, offsets, padded_sequence, T, TP,
+                                 B, D, batch_first, padding_value);
 }
 
 } // rnn
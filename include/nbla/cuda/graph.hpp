@@ -0,0 +1,95 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_GRAPH_HPP__
+#define __NBLA_CUDA_GRAPH_HPP__
+
+#include <nbla/common.hpp>
+#include <nbla/cuda/defs.hpp>
+#include <nbla/memory/allocator.hpp>
+
+#include <cuda_runtime.h>
+
+#include <memory>
+
+namespace nbla {
+
+using std::shared_ptr;
+
+/** CUDA graph of a fixed sequence of function and solver calls.
+
+    The calls between begin_capture() and end_capture() are recorded into a
+    graph instead of being executed, and replay() runs them again with a
+    single launch.
+
+    While capturing, the calling thread issues to a capture stream (see
+    cuda_get_current_stream()). Kernels are launched to the current stream,
+    and the cuBLAS handle and the null-stream cuDNN handle of the thread are
+    switched to it at begin_capture() and back at end_capture(). Work issued
+    explicitly to the null stream, and host synchronization, invalidates the
+    capture and end_capture() raises an error. Functions known to synchronize
+    with the host raise an error at once (see cuda_check_not_capturing()).
+
+    Functions must be set up before the capture, in the thread capturing,
+    since the setup searches algorithms with synchronization and caches the
+    cuDNN handle of the thread. Scalars computed on the host, e.g. the step
+    count of a solver, are recorded as they are at the capture.
+
+    The arrays allocated by the caching allocator during the capture come from
+    a memory pool owned by the graph. Their memory is not used by others as
+    long as the graph is alive, even after the arrays are released, since the
+    graph keeps reading and writing it.
+
+    Replaying reads and writes the same memory as the capture. New inputs must
+    be written into the device arrays used in the capture, and random numbers
+    are the same in every replay.
+ */
+class NBLA_CUDA_API CudaGraph {
+public:
+  CudaGraph(int device = -1);
+  ~CudaGraph();
+
+  /** Start recording the calls in this thread. */
+  void begin_capture();
+
+  /** Stop recording and instantiate the graph. */
+  void end_capture();
+
+  /** Abandon the capture in progress in this thread, if any, without
+      raising an error.
+   */
+  void discard_capture();
+
+  /** Launch the captured graph to the null stream. */
+  void replay();
+
+  bool captured() const { return exec_ != nullptr; }
+
+  /** Graph being captured in the calling thread, or nullptr. */
+  static CudaGraph *capturing();
+
+  /** Memory pool of the buffers used by this graph. */
+  shared_ptr<Allocator> allocator() { return allocator_; }
+
+protected:
+  int device_;
+  cudaStream_t stream_;
+  cudaGraph_t graph_;
+  cudaGraphExec_t exec_;
+  shared_ptr<Allocator> allocator_;
+
+  DISABLE_COPY_AND_ASSIGN(CudaGraph);
+};
+}
+#endif
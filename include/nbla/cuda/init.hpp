@@ -121,5 +121,13 @@ NBLA_CUDA_API float cuda_event_elapsed_time(shared_ptr<void> event_s,
 
 /** Utils for Virtual memory allocator **/
 NBLA_CUDA_API void set_cuda_vma_chunk_size(size_t size);
+
+/** CudaGraph wrapper functions.
+*/
+NBLA_CUDA_API shared_ptr<void> cuda_create_graph(int device_id = -1);
+NBLA_CUDA_API void cuda_graph_begin_capture(shared_ptr<void> graph);
+NBLA_CUDA_API void cuda_graph_end_capture(shared_ptr<void> graph);
+NBLA_CUDA_API void cuda_graph_discard_capture(shared_ptr<void> graph);
+NBLA_CUDA_API void cuda_graph_replay(shared_ptr<void> graph);
 }
 #endif
@@ -0,0 +1,199 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** Occupancy-aware launch configuration of grid-strided kernels.
+ */
+#ifndef __NBLA_CUDA_LAUNCH_HPP__
+#define __NBLA_CUDA_LAUNCH_HPP__
+
+#include <nbla/common.hpp>
+#include <nbla/cuda/defs.hpp>
+#include <nbla/singleton_manager.hpp>
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nbla {
+
+using std::string;
+
+/** Launch configuration of a kernel on a device.
+ */
+struct CudaLaunchConfig {
+  int threads;         ///< Threads per block
+  int blocks_per_sm;   ///< Resident blocks per multiprocessor at `threads`
+  int multiprocessors; ///< Number of multiprocessors of the device
+};
+
+/** Grid and block sizes of a launch.
+ */
+struct CudaLaunchDims {
+  int blocks;
+  int threads;
+};
+
+/** Cache of the launch configurations by kernel symbol and device.
+
+    A configuration is computed once by cudaOccupancyMaxPotentialBlockSize,
+    which takes the registers and the static shared memory of the kernel
+    into account.
+
+    The computed values can be overridden per kernel name for tuning. The
+    name is the kernel expression given to the launch macro without the
+    enclosing parentheses, e.g. "kernel_transform_unary<T, UnaryOp>". The
+    overrides are also read from the environment variable
+    NNABLA_CUDA_LAUNCH_OVERRIDES as a comma separated list of
+    `name=threads` or `name=threads:blocks_per_sm`. Commas inside angle
+    brackets or parentheses belong to the name.
+
+    The generation is incremented whenever the computed configurations may
+    change, so that CudaLaunchSite knows when to look up again.
+ */
+class NBLA_CUDA_API CudaLaunchConfigCache {
+public:
+  ~CudaLaunchConfigCache();
+
+  /** Get the configuration of `kernel` on the current device.
+
+      `kernel` is a pointer to a __global__ function and `name` its name in
+      the override table.
+   */
+  CudaLaunchConfig get(const void *kernel, const char *name);
+
+  /** Override the threads per block and the resident blocks per
+      multiprocessor of the kernel named `name`.
+
+      `threads` must be a multiple of the warp size. A non-positive
+      `blocks_per_sm` takes the occupancy at `threads`.
+   */
+  void set_override(const string &name, int threads, int blocks_per_sm = 0);
+
+  /** Set the overrides in a list of the format of
+      NNABLA_CUDA_LAUNCH_OVERRIDES.
+   */
+  void set_overrides(const string &overrides);
+
+  /** Threads per block and resident blocks per multiprocessor overridden
+      for `name`, or zeros if not overridden.
+   */
+  std::pair<int, int> get_override(const string &name);
+
+  void clear_overrides();
+
+  /** Drop the computed configurations. */
+  void clear();
+
+  static uint64_t generation() {
+    return generation_.load(std::memory_order_acquire);
+  }
+
+protected:
+  struct KeyHash {
+    size_t operator()(const std::pair<const void *, int> &key) const {
+      return std::hash<const void *>()(key.first) ^
+             std::hash<int>()(key.second);
+    }
+  };
+
+  std::mutex mtx_;
+  std::unordered_map<std::pair<const void *, int>, CudaLaunchConfig, KeyHash>
+      configs_;
+  std::unordered_map<string, std::pair<int, int>> overrides_;
+  static std::atomic<uint64_t> generation_;
+
+  void read_overrides_from_env();
+
+private:
+  friend SingletonManager;
+  CudaLaunchConfigCache();
+  DISABLE_COPY_AND_ASSIGN(CudaLaunchConfigCache);
+};
+
+/** Grid and block sizes of a grid-strided kernel over `size` elements.
+
+    Blocks are capped at one full wave, i.e. the number of multiprocessors
+    times the resident blocks per multiprocessor, and the remaining elements
+    are covered by the grid-strided loop. Small sizes get smaller blocks so
+    that the work spreads over more multiprocessors.
+ */
+inline CudaLaunchDims cuda_get_launch_dims(const CudaLaunchConfig &config,
+                                           Size_t size) {
+  if (size <= 0) {
+    return CudaLaunchDims{0, 0};
+  }
+  const Size_t full_wave =
+      static_cast<Size_t>(config.multiprocessors) * config.blocks_per_sm;
+  int threads = config.threads;
+  // Halve blocks down to a warp while they do not fill a wave.
+  while (threads > 32 && (size + threads - 1) / threads < full_wave) {
+    threads = std::max(threads / 2 / 32 * 32, 32);
+  }
+  const Size_t blocks = (size + threads - 1) / threads;
+  return CudaLaunchDims{static_cast<int>(std::min(blocks, full_wave)),
+                        threads};
+}
+
+/** Occupancy-aware grid and block sizes of `kernel` over `size` elements.
+ */
+template <typename Kernel>
+CudaLaunchDims cuda_get_launch_dims(Kernel kernel, const char *name,
+                                    Size_t size) {
+  return cuda_get_launch_dims(
+      SingletonManager::get<CudaLaunchConfigCache>()->get(
+          reinterpret_cast<const void *>(kernel), name),
+      size);
+}
+
+/** Configurations of a single launch site by device.
+
+    NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY keeps one in a thread_local static, so
+    a launch takes neither the lock nor the map lookup of
+    CudaLaunchConfigCache. An entry is looked up again when the generation
+    of the cache has changed.
+ */
+class NBLA_CUDA_API CudaLaunchSite {
+public:
+  template <typename Kernel>
+  CudaLaunchDims get_launch_dims(Kernel kernel, const char *name,
+                                 Size_t size) {
+    return cuda_get_launch_dims(
+        get(reinterpret_cast<const void *>(kernel), name), size);
+  }
+
+  /** Get the configuration of `kernel` on the current device. */
+  const CudaLaunchConfig &get(const void *kernel, const char *name);
+
+private:
+  struct Entry {
+    uint64_t generation = 0; // 0 is never a generation of the cache.
+    CudaLaunchConfig config;
+  };
+  std::vector<Entry> entries_;
+};
+
+/** Wrapper functions of CudaLaunchConfigCache.
+ */
+NBLA_CUDA_API void cuda_set_launch_override(const string &name, int threads,
+                                            int blocks_per_sm = 0);
+NBLA_CUDA_API void cuda_clear_launch_overrides();
+}
+#endif
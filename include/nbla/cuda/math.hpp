@@ -77,6 +77,19 @@ inline void cuda_gemv<HalfCuda>(int device, HalfCuda *z, const HalfCuda *x,
                       1, false, alpha, beta);
 }
 
+#if NBLA_CUDA_BFLOAT16
+// cuBLAS has no bfloat16 gemv either. Use gemm as for half.
+template <>
+inline void
+cuda_gemv<BFloat16Cuda>(int device, BFloat16Cuda *z, const BFloat16Cuda *x,
+                        int row_x, int col_x, bool transpose_x,
+                        const BFloat16Cuda *y, int row_y, float alpha,
+                        float beta, int incy, int incz) {
+  cuda_gemm<BFloat16Cuda>(device, z, false, x, row_x, col_x, transpose_x, y,
+                          row_y, 1, false, alpha, beta);
+}
+#endif
+
 /**
  */
 template <typename T>
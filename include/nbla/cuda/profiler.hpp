@@ -0,0 +1,138 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_PROFILER_HPP__
+#define __NBLA_CUDA_PROFILER_HPP__
+
+#include <nbla/common.hpp>
+#include <nbla/cuda/defs.hpp>
+#include <nbla/singleton_manager.hpp>
+
+#include <cuda_runtime.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nbla {
+
+using std::string;
+using std::vector;
+
+/** Profile of a single call of a function.
+ */
+struct CudaProfileRecord {
+  string name;            ///< Name of the function
+  uint64_t key;           ///< Identifier of the function instance
+  int device;             ///< Device the call ran on
+  double start_ms;        ///< GPU start time since the profiler was enabled
+  float elapsed_ms;       ///< GPU time
+  size_t launches;        ///< Kernels launched by NBLA_CUDA_LAUNCH_KERNEL_*
+  size_t allocated_bytes; ///< Bytes of CudaCachedArray created
+  size_t workspace_bytes; ///< Part of allocated_bytes in BYTE arrays
+};
+
+/** Per-function GPU profiler.
+
+    begin() and end() are called around a function call, typically from the
+    function hooks of forward and backward. The GPU time is measured by events
+    recorded to the current stream. The events are pooled and read later
+    without synchronization. The number of kernel launches and the bytes of
+    device arrays created in between are counted in the calling thread.
+    Workspaces of the functions are BYTE arrays and are also reported
+    separately.
+
+    Only one call out of every `sampling_interval` calls of each function
+    instance is recorded, which keeps the overhead small enough for
+    production runs. Records are kept in a ring buffer of `capacity`
+    entries, dropping the oldest.
+ */
+class NBLA_CUDA_API CudaProfiler {
+public:
+  ~CudaProfiler();
+
+  void enable(bool enabled);
+  bool enabled();
+  void set_sampling_interval(int interval);
+  void set_capacity(size_t capacity);
+
+  /** Start profiling a call of function instance `key`. */
+  void begin(const string &name, uint64_t key);
+  /** Stop profiling the call started by begin() with the same key. */
+  void end(uint64_t key);
+
+  /** Finished records from the oldest. */
+  vector<CudaProfileRecord> records();
+  void clear();
+
+  /** Records as a JSON array of objects. */
+  string to_json();
+  /** Records in the Chrome trace event format, viewable in
+      chrome://tracing.
+   */
+  string to_chrome_trace();
+
+protected:
+  struct Pending {
+    CudaProfileRecord record;
+    cudaEvent_t start;
+    cudaEvent_t stop;
+    size_t launches;
+    size_t allocated_bytes;
+    size_t workspace_bytes;
+  };
+
+  std::mutex mtx_;
+  bool enabled_;
+  int sampling_interval_;
+  size_t capacity_;
+  std::unordered_map<int, cudaEvent_t> origins_;
+  std::unordered_map<uint64_t, size_t> calls_;
+  std::unordered_map<uint64_t, Pending> running_;
+  std::deque<Pending> pending_;
+  std::deque<CudaProfileRecord> records_;
+  std::unordered_map<int, vector<cudaEvent_t>> free_events_;
+
+  cudaEvent_t get_event(int device);
+  void release_event(int device, cudaEvent_t event);
+  void flush(bool wait);
+
+private:
+  friend SingletonManager;
+  CudaProfiler();
+  DISABLE_COPY_AND_ASSIGN(CudaProfiler);
+};
+
+/** Counters updated by CUDA launches and array allocations in the calling
+    thread, read by CudaProfiler.
+ */
+NBLA_CUDA_API void cuda_profiler_count_launch();
+NBLA_CUDA_API void cuda_profiler_count_allocation(size_t bytes,
+                                                  bool workspace);
+
+/** Wrapper functions of CudaProfiler.
+ */
+NBLA_CUDA_API void cuda_profiler_enable(bool enabled);
+NBLA_CUDA_API void cuda_profiler_set_sampling_interval(int interval);
+NBLA_CUDA_API void cuda_profiler_set_capacity(size_t capacity);
+NBLA_CUDA_API void cuda_profiler_begin(const string &name, uint64_t key);
+NBLA_CUDA_API void cuda_profiler_end(uint64_t key);
+NBLA_CUDA_API void cuda_profiler_clear();
+NBLA_CUDA_API string cuda_profiler_to_json();
+NBLA_CUDA_API string cuda_profiler_to_chrome_trace();
+}
+#endif
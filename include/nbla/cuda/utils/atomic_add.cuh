@@ -17,6 +17,7 @@
 
 #include <cuda.h>
 #include <cuda_fp16.h>
+#include <nbla/cuda/bfloat16.hpp>
 #include <nbla/cuda/half.hpp>
 
 namespace nbla {
@@ -63,5 +64,41 @@ __device__ __inline__ HalfCuda atomic_add(HalfCuda *dst_adr, HalfCuda add_val) {
 #endif
 }
 
+#if NBLA_CUDA_BFLOAT16
+/** bfloat16 atomic add by compare-and-swap on the aligned 32-bit word
+    containing the value. Used below sm_80, which has no native bfloat16
+    atomicAdd. Callable on any architecture so that it can be tested.
+ */
+__device__ __inline__ BFloat16Cuda atomic_add_cas(BFloat16Cuda *dst_adr,
+                                                  BFloat16Cuda add_val) {
+  const bool upper = (size_t(dst_adr) & 2) != 0;
+  unsigned int *address = (unsigned int *)(upper ? dst_adr - 1 : dst_adr);
+  const unsigned int shift = upper ? 16 : 0;
+  unsigned int old_int = *address;
+  unsigned int compare;
+  BFloat16Cuda old_val;
+  do {
+    old_val = __ushort_as_bfloat16((old_int >> shift) & 0xffff);
+    BFloat16Cuda new_val = old_val + add_val;
+    unsigned int new_bits = __bfloat16_as_ushort(new_val.h);
+    unsigned int new_int =
+        (old_int & ~(0xffffu << shift)) | (new_bits << shift);
+    compare = old_int;
+    old_int = atomicCAS(address, compare, new_int);
+  } while (old_int != compare);
+  return old_val;
+}
+
+template <>
+__device__ __inline__ BFloat16Cuda atomic_add(BFloat16Cuda *dst_adr,
+                                              BFloat16Cuda add_val) {
+#if __CUDA_ARCH__ >= 800
+  return atomicAdd(&(dst_adr->h), add_val.h);
+#else
+  return atomic_add_cas(dst_adr, add_val);
+#endif
+}
+#endif
+
 } // namespace nbla
 #endif
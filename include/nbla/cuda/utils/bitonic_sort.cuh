@@ -107,17 +107,21 @@ __device__ __forceinline__ void bitonic_merge(T *data, unsigned int tid,
 }
 } // namespace details
 
-template <typename T, unsigned N = 1024>
-__global__ void bitonic_sort(T *data, const int size) {
+/*
+  The bitonic_sort_block() device function sorts the N elements of
+  the `shared` memory array with N threads of a thread block. The
+  sort order is given by the T::compare() method. All threads of the
+  block must call this function after thread `tid` has stored its
+  element into `shared[tid]`.
+ */
+template <typename T, unsigned N>
+__device__ __forceinline__ void bitonic_sort_block(T *shared,
+                                                   const unsigned int tid) {
   using namespace bitonic_sort_details;
   static_assert(N == 32 || N == 64 || N == 128 || N == 256 || N == 512 ||
                     N == 1024,
                 "bitonic_sort supports only N=2^n with n=5..10");
 
-  static __shared__ T shared[1024];
-  const unsigned int tid = threadIdx.x;
-
-  shared[tid] = tid < size & 1023 ? data[tid] : T::extrema();
   warp_bitonic_sort<T>(shared, tid);
 
   if (N > 32) {
@@ -150,6 +154,15 @@ __global__ void bitonic_sort(T *data, const int size) {
     bitonic_merge<T, 1>(shared, tid, bfe(tid, 10));
     bitonic_merge<T>(shared, tid, bfe(tid, 10));
   }
+}
+
+template <typename T, unsigned N = 1024>
+__global__ void bitonic_sort(T *data, const int size) {
+  static __shared__ T shared[1024];
+  const unsigned int tid = threadIdx.x;
+
+  shared[tid] = tid < size & 1023 ? data[tid] : T::extrema();
+  bitonic_sort_block<T, N>(shared, tid);
   data[tid] = shared[tid];
 }
 }
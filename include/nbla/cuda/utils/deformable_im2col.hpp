@@ -401,9 +401,9 @@ void modulated_deformable_im2col_cuda(const T *data_im, const T *data_offset,
   const int w_o = (shape[1] + 2 * p[1] - (d[1] * (k[1] - 1) + 1)) / s[1] + 1;
   const int num_kernels = c_i * h_o * w_o;
 
-  modulated_deformable_im2col_gpu_kernel<
-      T,
-      MODULATED><<<NBLA_CUDA_GET_BLOCKS(num_kernels), NBLA_CUDA_NUM_THREADS>>>(
+  auto kernel = modulated_deformable_im2col_gpu_kernel<T, MODULATED>;
+  kernel<<<NBLA_CUDA_GET_BLOCKS(num_kernels), NBLA_CUDA_NUM_THREADS, 0,
+           cuda_get_current_stream()>>>(
       num_kernels, data_im, data_offset, data_mask, shape[0], shape[1], k[0],
       k[1], p[0], p[1], s[0], s[1], d[0], d[1], channel_per_deformable_group,
       c_i, deformable_group, h_o, w_o, data_col);
@@ -420,9 +420,9 @@ void modulated_deformable_col2im_cuda(const T *data_col, const T *data_offset,
   const int h_o = (shape[0] + 2 * p[0] - (d[0] * (k[0] - 1) + 1)) / s[0] + 1;
   const int w_o = (shape[1] + 2 * p[1] - (d[1] * (k[1] - 1) + 1)) / s[1] + 1;
   const int num_kernels = c_i * k[0] * k[1] * h_o * w_o;
-  modulated_deformable_col2im_gpu_kernel<
-      T,
-      MODULATED><<<NBLA_CUDA_GET_BLOCKS(num_kernels), NBLA_CUDA_NUM_THREADS>>>(
+  auto kernel = modulated_deformable_col2im_gpu_kernel<T, MODULATED>;
+  kernel<<<NBLA_CUDA_GET_BLOCKS(num_kernels), NBLA_CUDA_NUM_THREADS, 0,
+           cuda_get_current_stream()>>>(
       num_kernels, data_col, data_offset, data_mask, c_i, shape[0], shape[1],
       k[0], k[1], p[0], p[1], s[0], s[1], d[0], d[1],
       channel_per_deformable_group, deformable_group, h_o, w_o, grad_im);
@@ -441,9 +441,9 @@ void modulated_deformable_col2im_coord_cuda(
   const int num_kernels = h_o * w_o * 2 * k[0] * k[1] * deformable_group;
   const int channel_per_deformable_group = c_i * k[0] * k[1] / deformable_group;
 
-  modulated_deformable_col2im_coord_gpu_kernel<
-      T,
-      MODULATED><<<NBLA_CUDA_GET_BLOCKS(num_kernels), NBLA_CUDA_NUM_THREADS>>>(
+  auto kernel = modulated_deformable_col2im_coord_gpu_kernel<T, MODULATED>;
+  kernel<<<NBLA_CUDA_GET_BLOCKS(num_kernels), NBLA_CUDA_NUM_THREADS, 0,
+           cuda_get_current_stream()>>>(
       num_kernels, data_col, data_im, data_offset, data_mask, c_i, shape[0],
       shape[1], k[0], k[1], p[0], p[1], s[0], s[1], d[0], d[1],
       channel_per_deformable_group, deformable_group, h_o, w_o, grad_offset,
@@ -121,10 +121,12 @@ void reduce_2d_parallel_reduction(const int outer_size,
 
   // Per axis reduction
   for (int o = 0; o < outer_size; ++o) {
-    kernel_reduce_per_block<<<blocks, NBLA_CUDA_NUM_THREADS>>>(
+    kernel_reduce_per_block<<<blocks, NBLA_CUDA_NUM_THREADS, 0,
+                              cuda_get_current_stream()>>>(
         reduction_size, pre_op, o * reduction_size);
     NBLA_CUDA_KERNEL_CHECK();
-    kernel_reduce_per_block<<<1, 1024>>>(blocks, post_op, 0, o);
+    kernel_reduce_per_block<<<1, 1024, 0, cuda_get_current_stream()>>>(
+        blocks, post_op, 0, o);
     NBLA_CUDA_KERNEL_CHECK();
   }
 }
@@ -509,9 +509,9 @@ void fast_reduce_xy(const Context &ctx, Op &op, const ReduceSetup &setup) {
     }
   }
 
-  kernel<<<grid_dim, block_dim, smem_size>>>(op, block_counter, setup.size_x,
-                                             setup.size_y, inner_idx_conv,
-                                             outer_idx_conv);
+  kernel<<<grid_dim, block_dim, smem_size, cuda_get_current_stream()>>>(
+      op, block_counter, setup.size_x, setup.size_y, inner_idx_conv,
+      outer_idx_conv);
   NBLA_CUDA_KERNEL_CHECK();
 }
 
@@ -587,7 +587,8 @@ void fast_reduce_y(const Context &ctx, Op &op, const ReduceSetup &setup) {
                                               setup.strides_x_input);
 
   // Reduction kernel launch
-  kernel_reduce_y<<<grid_dim, block_dim, smem_size>>>(
+  kernel_reduce_y<<<grid_dim, block_dim, smem_size,
+                    cuda_get_current_stream()>>>(
       op, block_counter, setup.size_y, setup.size_x, inner_idx_conv,
       outer_idx_conv);
   NBLA_CUDA_KERNEL_CHECK();
@@ -30,7 +30,8 @@ void im2col_cuda(const T *img, const int c_i, const int *shape, const int *k,
   const int h_o = (shape[0] + 2 * p[0] - (d[0] * (k[0] - 1) + 1)) / s[0] + 1;
   const int w_o = (shape[1] + 2 * p[1] - (d[1] * (k[1] - 1) + 1)) / s[1] + 1;
   const int col_size = c_i * k[0] * k[1] * h_o * w_o;
-  im2col_kernel<T><<<NBLA_CUDA_GET_BLOCKS(col_size), NBLA_CUDA_NUM_THREADS>>>(
+  im2col_kernel<T><<<NBLA_CUDA_GET_BLOCKS(col_size), NBLA_CUDA_NUM_THREADS, 0,
+                     cuda_get_current_stream()>>>(
       col_size, img, shape[0], shape[1], k[0], k[1], p[0], p[1], s[0], s[1],
       d[0], d[1], h_o, w_o, col);
 }
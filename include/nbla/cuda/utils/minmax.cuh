@@ -150,11 +150,13 @@ __host__ void minmax(const T *data, const int size, MinMax<T> *minmax_data) {
   auto blocks = std::min(NBLA_CUDA_GET_BLOCKS(size), 1024);
 
   // Find min/max value per thread block, yields up to 1024 results.
-  reduce<T, UseAbsVal><<<blocks, threads>>>(data, size, minmax_data);
+  reduce<T, UseAbsVal><<<blocks, threads, 0, cuda_get_current_stream()>>>(
+      data, size, minmax_data);
   NBLA_CUDA_KERNEL_CHECK();
 
   // Find min/max value from the per-block results.
-  reduce<T, WipePartialResults><<<1, 1024>>>(minmax_data, blocks);
+  reduce<T, WipePartialResults><<<1, 1024, 0, cuda_get_current_stream()>>>(
+      minmax_data, blocks);
   NBLA_CUDA_KERNEL_CHECK();
 }
 
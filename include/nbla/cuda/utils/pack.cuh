@@ -0,0 +1,46 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_UTILS_PACK_CUH__
+#define __NBLA_CUDA_UTILS_PACK_CUH__
+
+#include <cstdint>
+
+namespace nbla {
+
+/** N consecutive elements read or written by a single vector instruction.
+
+Kernels working on the innermost (e.g. channel) axis of channel-last arrays
+cast their pointers to `Pack<T, N> *` when the axis size is a multiple of N
+and the pointers are aligned (see `pack_aligned`).
+ */
+template <typename T, int N> struct alignas(sizeof(T) * N) Pack {
+  T v[N];
+};
+
+/** Number of elements of T in a 16-byte vector access. */
+template <typename T> constexpr int max_pack_size() {
+  return sizeof(T) < 16 ? 16 / sizeof(T) : 1;
+}
+
+/** True if all pointers are aligned for `Pack<T, N>`. */
+template <typename T, int N> inline bool pack_aligned() { return true; }
+
+template <typename T, int N, typename P, typename... Ps>
+inline bool pack_aligned(const P *p, const Ps *... ps) {
+  return reinterpret_cast<uintptr_t>(p) % (sizeof(T) * N) == 0 &&
+         pack_aligned<T, N>(ps...);
+}
+}
+#endif
@@ -52,10 +52,12 @@ __host__ void sum_prod(const Context &ctx, const T *x, const T *y, T *sum_xy,
         make_shared<CudaCachedArray>(blocks, get_dtype<T>(), ctx);
     T *buff = arr_buff->pointer<T>();
     while (outer_size--) {
-      kernel_reduce_xy_per_block<<<blocks, threads>>>(reduction_size, x, y,
-                                                      buff);
+      kernel_reduce_xy_per_block<<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
+          reduction_size, x, y, buff);
       NBLA_CUDA_KERNEL_CHECK();
-      kernel_reduce_per_block<<<1, 1024>>>(blocks, buff, sum_xy);
+      kernel_reduce_per_block<<<1, 1024, 0, cuda_get_current_stream()>>>(
+          blocks, buff, sum_xy);
       NBLA_CUDA_KERNEL_CHECK();
       x += reduction_size;
       y += reduction_size;
@@ -63,7 +65,8 @@ __host__ void sum_prod(const Context &ctx, const T *x, const T *y, T *sum_xy,
     }
   } else {
     while (outer_size--) {
-      kernel_reduce_xy_per_block<<<1, 1024>>>(reduction_size, x, y, sum_xy);
+      kernel_reduce_xy_per_block<<<1, 1024, 0, cuda_get_current_stream()>>>(
+          reduction_size, x, y, sum_xy);
       NBLA_CUDA_KERNEL_CHECK();
       x += reduction_size;
       y += reduction_size;
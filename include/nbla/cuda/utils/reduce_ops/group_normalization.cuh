@@ -67,5 +67,30 @@ public:
     sum_dyx_[idx] = v.y;
   }
 };
+
+// Wraps a reduction operator to read a channel-last [B, S, C] array as
+// [B * G, S * C / G], i.e. one reduction row per group as for the
+// channel-first layout.
+template <typename Op, typename IndexT> class GNChannelLastOp : public Op {
+  IndexT spatial_size_, channel_size_, chunk_size_, num_groups_;
+
+public:
+  template <typename... Args>
+  GNChannelLastOp(const IndexT spatial_size, const IndexT channel_size,
+                  const int num_groups, Args... args)
+      : Op(args...), spatial_size_(spatial_size), channel_size_(channel_size),
+        chunk_size_(channel_size / num_groups), num_groups_(num_groups) {}
+
+  // Load
+  __forceinline__ __device__ typename Op::PreloadT load(const IndexT idx,
+                                                        const IndexT r_idx) {
+    const IndexT outer_idx = idx / (spatial_size_ * chunk_size_);
+    const IndexT b = outer_idx / num_groups_;
+    const IndexT g = outer_idx - b * num_groups_;
+    const IndexT s = r_idx / chunk_size_;
+    const IndexT c = g * chunk_size_ + (r_idx - s * chunk_size_);
+    return Op::load((b * spatial_size_ + s) * channel_size_ + c, r_idx);
+  }
+};
 }
 #endif
\ No newline at end of file
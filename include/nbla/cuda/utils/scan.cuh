@@ -0,0 +1,462 @@
+// Copyright 2021 Sony Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_UTILS_SCAN_CUH__
+#define __NBLA_CUDA_UTILS_SCAN_CUH__
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/utils/warp_shuffle.cuh>
+#include <nbla/nd_array.hpp>
+
+#include <algorithm>
+
+namespace nbla {
+
+/*
+  Scan operators. `Type` is the accumulation type, `identity()` the
+  neutral element and `op()` the associative and commutative
+  operation of the scan.
+*/
+template <typename T> struct ScanOpSum {
+  typedef T Type;
+  __device__ __forceinline__ static T identity() { return T(0); }
+  __device__ __forceinline__ static T op(const T a, const T b) {
+    return a + b;
+  }
+};
+
+template <typename T> struct ScanOpProd {
+  typedef T Type;
+  __device__ __forceinline__ static T identity() { return T(1); }
+  __device__ __forceinline__ static T op(const T a, const T b) {
+    return a * b;
+  }
+};
+
+/*
+  Shape of a scan. The input is viewed as [size_outer, size_scan,
+  size_inner] and scanned along the middle axis, each (outer, inner)
+  pair being an independent row. The element values are read with
+  `load(i)` and the scan results written with `store(i, value)` where
+  `i` is the flat index into the [size_outer, size_scan, size_inner]
+  array. This allows callers to fuse element-wise operations into the
+  scan. `i` is an int if the array has at most
+  NBLA_CUDA_MAX_INT_INDEX_SIZE elements, and a Size_t otherwise.
+*/
+struct ScanSetup {
+  Size_t size_outer;
+  Size_t size_scan;
+  Size_t size_inner;
+  bool exclusive;
+  bool reverse;
+};
+
+namespace scan_impl {
+
+// ScanSetup on the device with the index type chosen by device_scan().
+template <typename index_t> struct ScanShape {
+  index_t size_outer;
+  index_t size_scan;
+  index_t size_inner;
+  bool exclusive;
+  bool reverse;
+
+  __host__ __device__ index_t rows() const { return size_outer * size_inner; }
+
+  // Flat index of the k-th element (in scan order) of row `row`.
+  __device__ __forceinline__ index_t index(const index_t row,
+                                           const index_t k) const {
+    const index_t outer = row / size_inner;
+    const index_t inner = row - outer * size_inner;
+    const index_t kk = reverse ? size_scan - 1 - k : k;
+    return (outer * size_scan + kk) * size_inner + inner;
+  }
+};
+
+enum {
+  BLOCK_SIZE = 256,
+  ITEMS_PER_THREAD = 4,
+  TILE_SIZE = BLOCK_SIZE * ITEMS_PER_THREAD,
+  STRIDED_BLOCK_X = 32,
+  STRIDED_BLOCK_Y = 16,
+};
+
+template <typename Op>
+__device__ __forceinline__ typename Op::Type
+warp_inclusive_scan(typename Op::Type v) {
+  const int lane = threadIdx.x & CUDA_WARP_MASK;
+  for (int offset = 1; offset < CUDA_WARP_SIZE; offset <<= 1) {
+    const auto n = warp::shuffle_up(v, offset);
+    if (lane >= offset)
+      v = Op::op(n, v);
+  }
+  return v;
+}
+
+// Block-wide exclusive scan of `v` with `BLOCK` threads. The block
+// aggregate is returned in `total`. The `shared` array must hold one
+// element per warp.
+template <typename Op, int BLOCK>
+__device__ __forceinline__ typename Op::Type
+block_exclusive_scan(typename Op::Type v, typename Op::Type *shared,
+                     typename Op::Type &total) {
+  typedef typename Op::Type Type;
+  const int lane = threadIdx.x & CUDA_WARP_MASK;
+  const int warp = threadIdx.x >> CUDA_WARP_BITS;
+  const int warps = BLOCK / CUDA_WARP_SIZE;
+
+  const Type inclusive = warp_inclusive_scan<Op>(v);
+  Type exclusive = warp::shuffle_up(inclusive, 1);
+  if (lane == 0)
+    exclusive = Op::identity();
+  if (warps == 1) {
+    total = warp::shuffle(inclusive, CUDA_WARP_SIZE - 1);
+    return exclusive;
+  }
+
+  if (lane == CUDA_WARP_SIZE - 1)
+    shared[warp] = inclusive;
+  __syncthreads();
+  if (warp == 0) {
+    Type w = lane < warps ? shared[lane] : Op::identity();
+    w = warp_inclusive_scan<Op>(w);
+    if (lane < warps)
+      shared[lane] = w;
+  }
+  __syncthreads();
+  if (warp > 0)
+    exclusive = Op::op(shared[warp - 1], exclusive);
+  total = shared[warps - 1];
+  __syncthreads(); // allow reuse of `shared`
+  return exclusive;
+}
+
+// Load ITEMS consecutive elements of a tile starting at `base` and
+// return their reduction.
+template <typename Op, int ITEMS, typename index_t, typename Load>
+__device__ __forceinline__ typename Op::Type
+load_items(const ScanShape<index_t> &setup, const index_t row,
+           const index_t base, Load &load, typename Op::Type *items) {
+  auto sum = Op::identity();
+  const index_t first = base + threadIdx.x * ITEMS;
+#pragma unroll
+  for (int j = 0; j < ITEMS; j++) {
+    const index_t k = first + j;
+    items[j] =
+        k < setup.size_scan ? load(setup.index(row, k)) : Op::identity();
+    sum = Op::op(sum, items[j]);
+  }
+  return sum;
+}
+
+// Store the scan of ITEMS consecutive elements starting with the
+// running value `run` (the exclusive prefix of the first element).
+template <typename Op, int ITEMS, typename index_t, typename Store>
+__device__ __forceinline__ void
+store_items(const ScanShape<index_t> &setup, const index_t row,
+            const index_t base, Store &store, typename Op::Type run,
+            const typename Op::Type *items) {
+  const index_t first = base + threadIdx.x * ITEMS;
+#pragma unroll
+  for (int j = 0; j < ITEMS; j++) {
+    const index_t k = first + j;
+    if (k < setup.size_scan) {
+      const index_t i = setup.index(row, k);
+      if (setup.exclusive)
+        store(i, run);
+      run = Op::op(run, items[j]);
+      if (!setup.exclusive)
+        store(i, run);
+    }
+  }
+}
+
+/*
+  Scan of contiguous rows (size_inner == 1) with one thread block per
+  row (grid strided). The row is processed in tiles of BLOCK * ITEMS
+  elements, carrying the prefix from tile to tile.
+*/
+template <typename Op, int BLOCK, int ITEMS, typename index_t, typename Load,
+          typename Store>
+__global__ void kernel_scan_rows(const ScanShape<index_t> setup, Load load,
+                                 Store store) {
+  typedef typename Op::Type Type;
+  __shared__ Type shared[BLOCK / CUDA_WARP_SIZE];
+  Type items[ITEMS];
+
+  for (index_t row = blockIdx.x; row < setup.rows(); row += gridDim.x) {
+    Type carry = Op::identity();
+    for (index_t base = 0; base < setup.size_scan; base += BLOCK * ITEMS) {
+      Type total;
+      const auto sum = load_items<Op, ITEMS>(setup, row, base, load, items);
+      const auto prefix = block_exclusive_scan<Op, BLOCK>(sum, shared, total);
+      store_items<Op, ITEMS>(setup, row, base, store, Op::op(carry, prefix),
+                             items);
+      carry = Op::op(carry, total);
+    }
+  }
+}
+
+// Tile status of the decoupled look-back, packed as (flag << 32 | value)
+// so that flag and value are published with one 64 bit store.
+enum { STATUS_INVALID = 0, STATUS_AGGREGATE = 1, STATUS_INCLUSIVE = 2 };
+
+template <typename T>
+__device__ __forceinline__ unsigned long long
+pack_status(const unsigned int flag, const T value) {
+  static_assert(sizeof(T) == sizeof(unsigned int),
+                "decoupled look-back requires a 32 bit scan type");
+  union {
+    T value;
+    unsigned int bits;
+  } u;
+  u.value = value;
+  return (static_cast<unsigned long long>(flag) << 32) | u.bits;
+}
+
+template <typename T>
+__device__ __forceinline__ T unpack_status(const unsigned long long status) {
+  union {
+    T value;
+    unsigned int bits;
+  } u;
+  u.bits = static_cast<unsigned int>(status & 0xffffffff);
+  return u.value;
+}
+
+__device__ __forceinline__ void
+publish_status(unsigned long long *status, const unsigned long long value) {
+  __threadfence();
+  atomicExch(status, value);
+}
+
+/*
+  Single pass scan of long contiguous rows with decoupled look-back.
+  Tiles are assigned in launch order through the atomic `counter` so
+  that every tile only waits for tiles that are already running. Each
+  tile publishes its aggregate, then accumulates the aggregates of its
+  predecessors in the same row until it finds an inclusive prefix,
+  and publishes its own inclusive prefix.
+*/
+template <typename Op, int BLOCK, int ITEMS, typename index_t, typename Load,
+          typename Store>
+__global__ void kernel_scan_lookback(const ScanShape<index_t> setup,
+                                     const int tiles_per_row,
+                                     unsigned long long *status,
+                                     unsigned int *counter, Load load,
+                                     Store store) {
+  typedef typename Op::Type Type;
+  __shared__ Type shared[BLOCK / CUDA_WARP_SIZE];
+  __shared__ int tile_shared;
+  __shared__ Type prefix_shared;
+  Type items[ITEMS];
+
+  if (threadIdx.x == 0)
+    tile_shared = atomicAdd(counter, 1);
+  __syncthreads();
+  const int tile = tile_shared;
+  const index_t row = tile / tiles_per_row;
+  const index_t base = (tile - row * tiles_per_row) * BLOCK * ITEMS;
+
+  Type total;
+  const auto sum = load_items<Op, ITEMS>(setup, row, base, load, items);
+  const auto prefix = block_exclusive_scan<Op, BLOCK>(sum, shared, total);
+
+  if (threadIdx.x == 0) {
+    Type tile_prefix = Op::identity();
+    if (base == 0) {
+      publish_status(&status[tile], pack_status(STATUS_INCLUSIVE, total));
+    } else {
+      publish_status(&status[tile], pack_status(STATUS_AGGREGATE, total));
+      volatile unsigned long long *vstatus = status;
+      for (int j = tile - 1;; j--) {
+        unsigned long long s;
+        do {
+          s = vstatus[j];
+        } while ((s >> 32) == STATUS_INVALID);
+        tile_prefix = Op::op(unpack_status<Type>(s), tile_prefix);
+        if ((s >> 32) == STATUS_INCLUSIVE)
+          break;
+      }
+      publish_status(&status[tile],
+                     pack_status(STATUS_INCLUSIVE, Op::op(tile_prefix, total)));
+    }
+    prefix_shared = tile_prefix;
+  }
+  __syncthreads();
+  store_items<Op, ITEMS>(setup, row, base, store,
+                         Op::op(prefix_shared, prefix), items);
+}
+
+/*
+  Scan of strided rows (size_inner > 1). A block of 32 x 16 threads
+  scans 32 adjacent rows, reading coalesced along the inner axis. The
+  scan axis is split into 16 segments: each thread first reduces its
+  segment, the segment totals are scanned in shared memory, and each
+  thread then rescans its segment starting from the segment prefix.
+*/
+template <typename Op, typename index_t, typename Load, typename Store>
+__global__ void kernel_scan_strided(const ScanShape<index_t> setup, Load load,
+                                    Store store) {
+  typedef typename Op::Type Type;
+  __shared__ Type shared[STRIDED_BLOCK_Y][STRIDED_BLOCK_X];
+
+  const index_t tiles_inner =
+      (setup.size_inner + STRIDED_BLOCK_X - 1) / STRIDED_BLOCK_X;
+  const index_t seg = (setup.size_scan + STRIDED_BLOCK_Y - 1) / STRIDED_BLOCK_Y;
+  const index_t k0 = threadIdx.y * seg;
+  const index_t k1 = min(k0 + seg, setup.size_scan);
+
+  for (index_t t = blockIdx.x; t < setup.size_outer * tiles_inner;
+       t += gridDim.x) {
+    const index_t outer = t / tiles_inner;
+    const index_t inner =
+        (t - outer * tiles_inner) * STRIDED_BLOCK_X + threadIdx.x;
+    const bool active = inner < setup.size_inner;
+    const index_t row = outer * setup.size_inner + inner;
+
+    Type sum = Op::identity();
+    if (active) {
+      for (index_t k = k0; k < k1; k++)
+        sum = Op::op(sum, load(setup.index(row, k)));
+    }
+    shared[threadIdx.y][threadIdx.x] = sum;
+    __syncthreads();
+
+    Type run = Op::identity();
+    for (int y = 0; y < threadIdx.y; y++)
+      run = Op::op(run, shared[y][threadIdx.x]);
+    if (active) {
+      for (index_t k = k0; k < k1; k++) {
+        const index_t i = setup.index(row, k);
+        const Type v = load(i);
+        if (setup.exclusive)
+          store(i, run);
+        run = Op::op(run, v);
+        if (!setup.exclusive)
+          store(i, run);
+      }
+    }
+    __syncthreads();
+  }
+}
+
+/*
+  Scan with one thread per row. Used for strided rows when there are
+  enough rows to fill the device, reads are coalesced along the inner
+  axis.
+*/
+template <typename Op, typename index_t, typename Load, typename Store>
+__global__ void kernel_scan_sequential(const index_t rows,
+                                       const ScanShape<index_t> setup,
+                                       Load load, Store store) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(row, rows, index_t) {
+    auto run = Op::identity();
+    for (index_t k = 0; k < setup.size_scan; k++) {
+      const index_t i = setup.index(row, k);
+      const auto v = load(i);
+      if (setup.exclusive)
+        store(i, run);
+      run = Op::op(run, v);
+      if (!setup.exclusive)
+        store(i, run);
+    }
+  }
+}
+template <typename Op, typename index_t, typename Load, typename Store>
+void scan(const Context &ctx, const ScanShape<index_t> &setup, Load load,
+          Store store) {
+  const index_t rows = setup.rows();
+  const int row_blocks =
+      static_cast<int>(std::min<index_t>(rows, NBLA_CUDA_MAX_BLOCKS));
+
+  if (setup.size_inner > 1) {
+    if (rows >= 64 * 1024 || setup.size_scan <= STRIDED_BLOCK_Y) {
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE_SIZE_T(
+          (kernel_scan_sequential<Op, index_t, Load, Store>), rows, setup,
+          load, store);
+    } else {
+      const index_t tiles =
+          setup.size_outer *
+          ((setup.size_inner + STRIDED_BLOCK_X - 1) / STRIDED_BLOCK_X);
+      const dim3 threads(STRIDED_BLOCK_X, STRIDED_BLOCK_Y);
+      kernel_scan_strided<Op><<<
+          static_cast<int>(std::min<index_t>(tiles, NBLA_CUDA_MAX_BLOCKS)),
+          threads, 0, cuda_get_current_stream()>>>(setup, load, store);
+      NBLA_CUDA_KERNEL_CHECK();
+    }
+  } else if (setup.size_scan <= ITEMS_PER_THREAD * CUDA_WARP_SIZE) {
+    auto kernel = kernel_scan_rows<Op, CUDA_WARP_SIZE, ITEMS_PER_THREAD>;
+    kernel<<<row_blocks, CUDA_WARP_SIZE, 0, cuda_get_current_stream()>>>(
+        setup, load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  } else if (rows >= 128 || setup.size_scan <= 4 * TILE_SIZE) {
+    auto kernel = kernel_scan_rows<Op, BLOCK_SIZE, ITEMS_PER_THREAD>;
+    kernel<<<row_blocks, BLOCK_SIZE, 0, cuda_get_current_stream()>>>(
+        setup, load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  } else {
+    // Fewer than 128 rows of more than 4 tiles, the tile count fits an
+    // int up to 2^41 elements.
+    const int tiles_per_row =
+        static_cast<int>((setup.size_scan + TILE_SIZE - 1) / TILE_SIZE);
+    const int tiles = static_cast<int>(rows) * tiles_per_row;
+    NdArray workspace(Shape_t{
+        static_cast<Size_t>(tiles * sizeof(unsigned long long) + 8)});
+    workspace.zero();
+    auto status = workspace.cast(get_dtype<char>(), ctx, false)
+                      ->template pointer<unsigned long long>();
+    auto counter = reinterpret_cast<unsigned int *>(status + tiles);
+    auto kernel = kernel_scan_lookback<Op, BLOCK_SIZE, ITEMS_PER_THREAD>;
+    kernel<<<tiles, BLOCK_SIZE, 0, cuda_get_current_stream()>>>(
+        setup, tiles_per_row, status, counter, load, store);
+    NBLA_CUDA_KERNEL_CHECK();
+  }
+}
+} // namespace scan_impl
+
+/*
+  The device_scan() function computes the inclusive or exclusive scan
+  described by `setup` with operator `Op`, reading elements with
+  `load` and writing results with `store` (see ScanSetup). The kernels
+  index with int if the array fits, and with Size_t otherwise. The
+  implementation is chosen by shape:
+
+  - strided rows: one thread per row if there are many rows, else a
+    tiled kernel that splits the scan axis among 16 threads per row,
+  - contiguous rows: a block scan per row if there are many or short
+    rows, else a single pass decoupled look-back scan over tiles of
+    all rows, which needs a workspace allocated in context `ctx`.
+*/
+template <typename Op, typename Load, typename Store>
+void device_scan(const Context &ctx, const ScanSetup &setup, Load load,
+                 Store store) {
+  using namespace scan_impl;
+  const Size_t size = setup.size_outer * setup.size_scan * setup.size_inner;
+  if (size == 0)
+    return;
+  if (cuda_can_use_int_index(size)) {
+    const ScanShape<int> shape{
+        static_cast<int>(setup.size_outer), static_cast<int>(setup.size_scan),
+        static_cast<int>(setup.size_inner), setup.exclusive, setup.reverse};
+    scan<Op>(ctx, shape, load, store);
+  } else {
+    const ScanShape<Size_t> shape{setup.size_outer, setup.size_scan,
+                                  setup.size_inner, setup.exclusive,
+                                  setup.reverse};
+    scan<Op>(ctx, shape, load, store);
+  }
+}
+}
+#endif
@@ -0,0 +1,160 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_UTILS_SCATTER_ADD_CUH__
+#define __NBLA_CUDA_UTILS_SCATTER_ADD_CUH__
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/cudnn/cudnn.hpp>
+#include <nbla/cuda/half.hpp>
+#include <nbla/cuda/utils/atomic_add.cuh>
+#include <nbla/cuda/utils/thrust_allocator.cuh>
+#include <nbla/nd_array.hpp>
+
+#include <thrust/device_ptr.h>
+#include <thrust/execution_policy.h>
+#include <thrust/scan.h>
+#include <thrust/sort.h>
+
+namespace nbla {
+
+/** True if the kernels adding to arbitrary locations must produce
+    reproducible results.
+
+    It follows the deterministic option of CudnnHandleManager, which is also
+    set by the environment variable NNABLA_CUDNN_DETERMINISTIC.
+ */
+inline bool scatter_add_deterministic() {
+  return SingletonManager::get<CudnnHandleManager>()
+      ->get_deterministic_option();
+}
+
+/** Device side of ScatterAdder.
+
+    A kernel calls `scatter(slot, idx, value)` for each value to be added to
+    `dst[idx]`. Every call must use its own slot in [0, slots), which fixes the
+    order of the additions in the deterministic mode. Slots are Size_t since
+    there are often several per element, e.g. 8 for trilinear interpolation.
+ */
+template <typename T> struct ScatterAddView {
+  typedef typename CudaTypeForceFloat<T>::type Tacc;
+
+  T *dst;
+  int *keys;
+  Tacc *values;
+
+  __device__ __forceinline__ void operator()(const Size_t slot, const int idx,
+                                             const T value) const {
+    if (keys) {
+      keys[slot] = idx;
+      values[slot] = value;
+    } else {
+      atomic_add(dst + idx, value);
+    }
+  }
+};
+
+// Adds the last partial sum of each run of equal sorted keys.
+template <typename T, typename Tacc, typename index_t>
+__global__ void kernel_scatter_add_sums(const index_t size, const int *keys,
+                                        const Tacc *sums, T *dst) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, size, index_t) {
+    const int idx = keys[i];
+    if (idx >= 0 && (i + 1 == size || keys[i + 1] != idx)) {
+      dst[idx] = static_cast<T>(static_cast<Tacc>(dst[idx]) + sums[i]);
+    }
+  }
+}
+
+/** Adds values to arbitrary locations of an array.
+
+    Without the deterministic mode the values are added by atomic_add, whose
+    order varies from run to run.
+
+    In the deterministic mode the values are recorded with their destination
+    in their slots. finish() sorts them by destination with a stable sort,
+    which keeps the slot order among values for the same destination, sums
+    them by a scan by key and adds the last partial sum of each destination
+    without atomics. The results are reproducible and, for half, accumulated
+    in float. Slots without a value are skipped. Nothing is read back to the
+    host, so the additions can be captured into a CUDA graph.
+
+    Usage:
+    @code
+    ScatterAdder<Tcu> adder(ctx, dst, slots);
+    kernel<<<...>>>(..., adder.view());
+    adder.finish();
+    @endcode
+ */
+template <typename T> class ScatterAdder {
+public:
+  typedef typename ScatterAddView<T>::Tacc Tacc;
+
+  ScatterAdder(const Context &ctx, T *dst, const Size_t slots,
+               const bool deterministic = scatter_add_deterministic())
+      : ctx_(ctx), slots_(slots) {
+    view_.dst = dst;
+    view_.keys = nullptr;
+    view_.values = nullptr;
+    if (deterministic && slots > 0) {
+      keys_ = std::make_shared<NdArray>(Shape_t{slots});
+      values_ = std::make_shared<NdArray>(Shape_t{slots});
+      view_.keys =
+          keys_->cast(get_dtype<int>(), ctx, true)->template pointer<int>();
+      view_.values = values_->cast(get_dtype<Tacc>(), ctx, true)
+                         ->template pointer<Tacc>();
+      // All bits set makes every key -1, i.e. an empty slot.
+      NBLA_CUDA_CHECK(cudaMemsetAsync(view_.keys, 0xff, sizeof(int) * slots,
+                                      cuda_get_current_stream()));
+    }
+  }
+
+  const ScatterAddView<T> &view() const { return view_; }
+
+  /** Adds the recorded values in the deterministic mode. */
+  void finish() {
+    if (!view_.keys) {
+      return;
+    }
+    NdArray sums(Shape_t{slots_});
+    Tacc *sums_ptr =
+        sums.cast(get_dtype<Tacc>(), ctx_, true)->template pointer<Tacc>();
+
+    auto keys = thrust::device_pointer_cast(view_.keys);
+    auto values = thrust::device_pointer_cast(view_.values);
+    ThrustCachingAllocator alloc(ctx_.device_id);
+    auto policy = NBLA_THRUST_PAR(alloc).on(cuda_get_current_stream());
+    thrust::stable_sort_by_key(policy, keys, keys + slots_, values);
+    // Unlike reduce_by_key, the scan does not read the number of
+    // destinations back to the host.
+    thrust::inclusive_scan_by_key(policy, keys, keys + slots_, values,
+                                  thrust::device_pointer_cast(sums_ptr));
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_scatter_add_sums<T, Tacc, index_t>), slots_, view_.keys,
+        sums_ptr, view_.dst);
+    view_.keys = nullptr;
+    keys_ = nullptr;
+    values_ = nullptr;
+  }
+
+private:
+  const Context ctx_;
+  const Size_t slots_;
+  ScatterAddView<T> view_;
+  NdArrayPtr keys_;
+  NdArrayPtr values_;
+  DISABLE_COPY_AND_ASSIGN(ScatterAdder);
+};
+}
+#endif
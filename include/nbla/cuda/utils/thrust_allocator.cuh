@@ -0,0 +1,75 @@
+// Copyright 2021 Sony Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_UTILS_THRUST_ALLOCATOR_CUH__
+#define __NBLA_CUDA_UTILS_THRUST_ALLOCATOR_CUH__
+
+#include <nbla/cuda/cuda.hpp>
+#include <nbla/memory/allocator.hpp>
+#include <nbla/singleton_manager.hpp>
+
+#include <thrust/execution_policy.h>
+#include <thrust/version.h>
+
+#include <cstddef>
+#include <unordered_map>
+
+/** Thrust execution policy of the extension.
+
+    Used as `NBLA_THRUST_PAR(alloc).on(cuda_get_current_stream())`. Thrust
+    1.16 and later leave out the stream synchronization at the end of an
+    algorithm with par_nosync, which cannot be captured into a CUDA graph.
+ */
+#if THRUST_VERSION >= 101600
+#define NBLA_THRUST_PAR thrust::cuda::par_nosync
+#else
+#define NBLA_THRUST_PAR thrust::cuda::par
+#endif
+
+namespace nbla {
+
+/** Temporary storage allocator for thrust algorithms.
+
+    Thrust algorithms (sort, scan, ...) allocate their temporary
+    storage with cudaMalloc/cudaFree on every call. Passing this
+    allocator as `NBLA_THRUST_PAR(alloc)` takes the temporary
+    storage from Cuda::caching_allocator() instead, so repeated calls
+    reuse cached device memory.
+
+    An instance must outlive the thrust call it is passed to.
+ */
+class ThrustCachingAllocator {
+public:
+  typedef char value_type;
+
+  explicit ThrustCachingAllocator(const string &device_id)
+      : device_id_(device_id) {}
+
+  char *allocate(std::ptrdiff_t num_bytes) {
+    auto mem = SingletonManager::get<Cuda>()->caching_allocator()->alloc(
+        static_cast<size_t>(num_bytes), device_id_);
+    char *ptr = static_cast<char *>(mem.pointer());
+    memory_.emplace(ptr, std::move(mem));
+    return ptr;
+  }
+
+  void deallocate(char *ptr, size_t) { memory_.erase(ptr); }
+
+private:
+  string device_id_;
+  std::unordered_map<char *, AllocatorMemory> memory_;
+  DISABLE_COPY_AND_ASSIGN(ThrustCachingAllocator);
+};
+}
+#endif
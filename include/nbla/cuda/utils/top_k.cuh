@@ -17,8 +17,13 @@
 
 #include <nbla/cuda/utils/bitonic_sort.cuh>
 #include <nbla/cuda/utils/minmax.cuh>
+#include <nbla/cuda/utils/thrust_allocator.cuh>
 #include <nbla/cuda/utils/warp_shuffle.cuh>
 
+#include <thrust/device_ptr.h>
+#include <thrust/execution_policy.h>
+#include <thrust/sort.h>
+
 namespace nbla {
 
 template <typename T> struct Bucket {
@@ -126,12 +131,13 @@ __host__ void find_top_k_value(const T *data, const int size, MinMax<T> *minmax,
 
   for (int i = 0; i < CUDA_WARP_SIZE; i++) {
     // count values > min + 0.5 * (max - min)
-    bucket_count<UseAbsVal><<<blocks, threads>>>(data, size, K, i, minmax,
-                                                 bucket_data);
+    bucket_count<UseAbsVal><<<blocks, threads, 0, cuda_get_current_stream()>>>(
+        data, size, K, i, minmax, bucket_data);
     NBLA_CUDA_KERNEL_CHECK();
   }
 
-  bucket_reduce<<<1, CUDA_WARP_SIZE>>>(K, bucket_data);
+  bucket_reduce<<<1, CUDA_WARP_SIZE, 0, cuda_get_current_stream()>>>(
+      K, bucket_data);
   NBLA_CUDA_KERNEL_CHECK();
 }
 
@@ -190,11 +196,12 @@ __host__ void find_top_k_index(const T *data, const int size, Bucket<T> *bucket,
   auto threads = NBLA_CUDA_NUM_THREADS;
   auto blocks = NBLA_CUDA_GET_BLOCKS(size);
 
-  init_val_idx_list<T, UseAbsVal><<<blocks, threads>>>(data, size, bucket,
-                                                       sort_data, 1024);
+  init_val_idx_list<T, UseAbsVal><<<blocks, threads, 0,
+                                    cuda_get_current_stream()>>>(
+      data, size, bucket, sort_data, 1024);
   NBLA_CUDA_KERNEL_CHECK();
 
-  bitonic_sort<<<1, 1024>>>(sort_data, K);
+  bitonic_sort<<<1, 1024, 0, cuda_get_current_stream()>>>(sort_data, K);
   NBLA_CUDA_KERNEL_CHECK();
 }
 
@@ -213,6 +220,235 @@ __host__ void top_k(const T *data, const unsigned int size,
   find_top_k_index<T, UseAbsVal>(data, size, &buffer->bucket[0],
                                  &buffer->sorted[0], K);
 }
+/*
+  Batched top-k for K > 1024.
+
+  The K-th largest value of every sample is found by a most
+  significant digit radix select over an order preserving 32 bit key
+  of the sample values. Each of the four 8 bit digit passes builds a
+  256 bin histogram of the keys that match the digits selected so far
+  (all samples in one launch) and then picks the bin that contains the
+  K-th largest key for each sample. After the last pass the exact K-th
+  key is known. If more values than needed share the K-th key, four
+  more passes over the index digits of those values select the
+  smallest indices, so that ties are broken by index and not by the
+  order of atomic operations. The K survivors of every sample are then
+  gathered into a candidate list of K elements per sample. Only the
+  candidates are sorted, by value (descending) and index (ascending),
+  with two stable radix sorts over all samples.
+ */
+struct RadixSelect {
+  unsigned int prefix;    // digits of the K-th key selected so far
+  unsigned int mask;      // bits of `prefix` that are valid
+  unsigned int remaining; // number of values still needed from the bin
+  unsigned int last;      // digits of the largest index taken for ties
+  unsigned int last_mask; // bits of `last` that are valid
+  unsigned int count;     // atomic counter for the gathered values
+};
+
+namespace top_k_batched_impl {
+
+// Order preserving unsigned integer key, larger values give larger keys.
+template <typename T, bool UseAbsVal>
+__device__ __forceinline__ unsigned int radix_key(const T value) {
+  const float v = UseAbsVal ? abs(static_cast<float>(value))
+                            : static_cast<float>(value);
+  const unsigned int u = __float_as_uint(v);
+  return (u & 0x80000000) ? ~u : (u | 0x80000000);
+}
+
+__global__ void radix_select_init(const int batch, const unsigned int K,
+                                  unsigned int *hist, RadixSelect *state) {
+  NBLA_CUDA_KERNEL_LOOP(i, batch * 256) {
+    hist[i] = 0;
+    if (i < batch)
+      state[i] = {0, 0, K, 0, 0, 0};
+  }
+}
+
+// Histogram of the key digits, or with `ByIndex` of the index digits
+// of the values that have the K-th key.
+template <typename T, bool UseAbsVal, bool ByIndex>
+__global__ void radix_select_histogram(const T *data, const int batch,
+                                       const int size, const int shift,
+                                       const RadixSelect *state,
+                                       unsigned int *hist) {
+  __shared__ unsigned int shared[256];
+
+  for (int s = blockIdx.y; s < batch; s += gridDim.y) {
+    const auto st = state[s];
+    if (ByIndex && st.last_mask == 0xffffffff)
+      continue; // no ties to break
+    for (int b = threadIdx.x; b < 256; b += blockDim.x)
+      shared[b] = 0;
+    __syncthreads();
+
+    const T *x = data + static_cast<size_t>(s) * size;
+
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += blockDim.x * gridDim.x) {
+      const auto key = radix_key<T, UseAbsVal>(x[i]);
+      if ((key & st.mask) != st.prefix)
+        continue;
+      if (!ByIndex)
+        atomicAdd(&shared[(key >> shift) & 0xff], 1);
+      else if ((static_cast<unsigned int>(i) & st.last_mask) == st.last)
+        atomicAdd(&shared[(i >> shift) & 0xff], 1);
+    }
+    __syncthreads();
+
+    for (int b = threadIdx.x; b < 256; b += blockDim.x) {
+      if (shared[b] > 0)
+        atomicAdd(&hist[s * 256 + b], shared[b]);
+    }
+    __syncthreads();
+  }
+}
+
+// Select the bin with the K-th largest key, or with `ByIndex` the bin
+// with the K-th smallest index among the ties, and clear the histogram
+// for the next pass.
+template <bool ByIndex>
+__global__ void radix_select_bin(const int batch, const int shift,
+                                 unsigned int *hist, RadixSelect *state) {
+  NBLA_CUDA_KERNEL_LOOP(s, batch) {
+    auto h = hist + s * 256;
+    auto st = state[s];
+    if (ByIndex && st.last_mask == 0xffffffff)
+      continue; // no ties to break
+    unsigned int digit = 0, tied = 0;
+    bool found = false;
+
+    for (int n = 0; n < 256; n++) {
+      const int b = ByIndex ? n : 255 - n;
+      const auto count = h[b];
+      h[b] = 0;
+      if (!found) {
+        if (count >= st.remaining) {
+          digit = b;
+          tied = count;
+          found = true;
+        } else {
+          st.remaining -= count;
+        }
+      }
+    }
+    if (ByIndex) {
+      st.last |= digit << shift;
+      st.last_mask |= 0xffu << shift;
+    } else {
+      st.prefix |= digit << shift;
+      st.mask |= 0xffu << shift;
+      // All values with the K-th key are taken, any index will do.
+      if (shift == 0 && tied == st.remaining)
+        st.last = st.last_mask = 0xffffffff;
+    }
+    state[s] = st;
+  }
+}
+
+template <typename T, bool UseAbsVal>
+__global__ void radix_select_gather(const T *data, const int batch,
+                                    const int size, const unsigned int K,
+                                    RadixSelect *state,
+                                    unsigned long long *keys,
+                                    unsigned int *segs) {
+  for (int s = blockIdx.y; s < batch; s += gridDim.y) {
+    const auto kth = state[s].prefix;
+    const auto last = state[s].last;
+    const T *x = data + static_cast<size_t>(s) * size;
+
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += blockDim.x * gridDim.x) {
+      const auto key = radix_key<T, UseAbsVal>(x[i]);
+      if (key < kth || (key == kth && static_cast<unsigned int>(i) > last))
+        continue;
+      // The candidate set is exact, its order is fixed by the sort.
+      const auto pos = atomicAdd(&state[s].count, 1);
+      // ascending sort of the inverted key yields descending values
+      // and ascending index for equal values
+      const auto offset = static_cast<size_t>(s) * K + pos;
+      keys[offset] = (static_cast<unsigned long long>(~key) << 32) | i;
+      segs[offset] = s;
+    }
+  }
+}
+
+__global__ void radix_select_index(const int size,
+                                   const unsigned long long *keys,
+                                   unsigned int *sorted_idx) {
+  NBLA_CUDA_KERNEL_LOOP(i, size) {
+    sorted_idx[i] = static_cast<unsigned int>(keys[i] & 0xffffffff);
+  }
+}
+} // namespace top_k_batched_impl
+
+/*
+  Size in bytes of the `buffer` required by top_k_batched().
+ */
+inline size_t top_k_batched_buffer_size(const int batch, const int K) {
+  return static_cast<size_t>(batch) * K *
+             (sizeof(unsigned long long) + sizeof(unsigned int)) +
+         static_cast<size_t>(batch) * (256 * sizeof(unsigned int) +
+                                       sizeof(RadixSelect));
+}
+
+/*
+  The top_k_batched() function writes the indices of the `K` largest
+  values of each of the `batch` samples of `size` elements in `data`
+  to `sorted_idx` (`batch` x `K` elements, largest value first). The
+  `buffer` must provide top_k_batched_buffer_size(batch, K) bytes of
+  device memory.
+ */
+template <typename T, bool UseAbsVal = false>
+__host__ void top_k_batched(const T *data, const int batch, const int size,
+                            const unsigned int K, char *buffer,
+                            unsigned int *sorted_idx) {
+  using namespace top_k_batched_impl;
+  const int total = batch * K;
+
+  auto keys = reinterpret_cast<unsigned long long *>(buffer);
+  auto segs = reinterpret_cast<unsigned int *>(keys + total);
+  auto hist = segs + total;
+  auto state = reinterpret_cast<RadixSelect *>(hist + batch * 256);
+
+  const dim3 threads(NBLA_CUDA_NUM_THREADS);
+  const dim3 blocks(std::max(1, std::min(NBLA_CEIL_INT_DIV(size, 8 * 1024),
+                                         CUDA_WARP_SIZE)),
+                    std::min(batch, 65535));
+
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(radix_select_init, batch * 256, K, hist,
+                                 state);
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    radix_select_histogram<T, UseAbsVal, false><<<blocks, threads, 0,
+                                                  cuda_get_current_stream()>>>(
+        data, batch, size, shift, state, hist);
+    NBLA_CUDA_KERNEL_CHECK();
+    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((radix_select_bin<false>), batch, shift,
+                                   hist, state);
+  }
+  // Take the values with the K-th key in index order.
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    radix_select_histogram<T, UseAbsVal, true><<<blocks, threads, 0,
+                                                 cuda_get_current_stream()>>>(
+        data, batch, size, shift, state, hist);
+    NBLA_CUDA_KERNEL_CHECK();
+    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((radix_select_bin<true>), batch, shift,
+                                   hist, state);
+  }
+  radix_select_gather<T, UseAbsVal><<<blocks, threads, 0,
+                                      cuda_get_current_stream()>>>(
+      data, batch, size, K, state, keys, segs);
+  NBLA_CUDA_KERNEL_CHECK();
+
+  ThrustCachingAllocator alloc(std::to_string(cuda_get_device()));
+  auto keys_ptr = thrust::device_pointer_cast(keys);
+  auto segs_ptr = thrust::device_pointer_cast(segs);
+  auto policy = NBLA_THRUST_PAR(alloc).on(cuda_get_current_stream());
+  thrust::stable_sort_by_key(policy, keys_ptr, keys_ptr + total, segs_ptr);
+  thrust::stable_sort_by_key(policy, segs_ptr, segs_ptr + total, keys_ptr);
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(radix_select_index, total, keys, sorted_idx);
+}
 } // namespace nbla
 
 #endif
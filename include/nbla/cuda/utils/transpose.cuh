@@ -0,0 +1,344 @@
+// Copyright 2021 Sony Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NBLA_CUDA_UTILS_TRANSPOSE_CUH__
+#define __NBLA_CUDA_UTILS_TRANSPOSE_CUH__
+
+#include <nbla/cuda/common.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace nbla {
+
+namespace transpose_impl {
+
+enum {
+  MAX_DIM = 16,
+  TILE = CUDA_WARP_SIZE,
+  TILE_ROWS = 8,
+};
+
+/*
+  Permutation with size one axes removed and axes that stay adjacent
+  in the output merged. `shape` is the (merged) input shape and output
+  axis `i` is input axis `axes[i]`.
+*/
+struct TransposeSetup {
+  int ndim;
+  int64_t size;
+  int shape[MAX_DIM];
+  int axes[MAX_DIM];
+
+  TransposeSetup(const Shape_t &in_shape, const vector<int> &in_axes) {
+    const int in_ndim = in_shape.size();
+    size = 1;
+    for (auto s : in_shape)
+      size *= s;
+
+    // Drop size one axes and renumber the remaining ones.
+    vector<int> index(in_ndim, -1);
+    vector<int64_t> kept_shape;
+    for (int d = 0; d < in_ndim; d++) {
+      if (in_shape[d] != 1) {
+        index[d] = kept_shape.size();
+        kept_shape.push_back(in_shape[d]);
+      }
+    }
+    vector<int> kept_axes;
+    for (auto a : in_axes) {
+      if (index[a] >= 0)
+        kept_axes.push_back(index[a]);
+    }
+
+    // Group output axes that are consecutive input axes.
+    vector<int> group_first, group_last;
+    for (size_t i = 0; i < kept_axes.size(); i++) {
+      if (i > 0 && kept_axes[i] == group_last.back() + 1) {
+        group_last.back() = kept_axes[i];
+      } else {
+        group_first.push_back(kept_axes[i]);
+        group_last.push_back(kept_axes[i]);
+      }
+    }
+    ndim = group_first.size();
+    NBLA_CHECK(ndim <= MAX_DIM, error_code::value,
+               "Transpose supports at most %d non-mergeable axes, got %d.",
+               MAX_DIM, ndim);
+
+    // The merged input axes in input order, and the output order of them.
+    vector<int> order(ndim);
+    for (int g = 0; g < ndim; g++)
+      order[g] = g;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      return group_first[a] < group_first[b];
+    });
+    for (int d = 0; d < ndim; d++) {
+      const int g = order[d];
+      int64_t s = 1;
+      for (int a = group_first[g]; a <= group_last[g]; a++)
+        s *= kept_shape[a];
+      shape[d] = s;
+      axes[g] = d;
+    }
+  }
+};
+
+// Writes or accumulates a value into the destination.
+template <bool accum> struct TransposeStore {
+  template <typename T>
+  __device__ __forceinline__ static void store(T *dst, const int i,
+                                               const T &v) {
+    dst[i] = v;
+  }
+};
+
+template <> struct TransposeStore<true> {
+  template <typename T>
+  __device__ __forceinline__ static void store(T *dst, const int i,
+                                               const T &v) {
+    dst[i] = dst[i] + v;
+  }
+};
+
+template <typename T, bool accum>
+__global__ void kernel_transpose_copy(const int size, const T *src, T *dst) {
+  NBLA_CUDA_KERNEL_LOOP(idx, size) {
+    TransposeStore<accum>::store(dst, idx, src[idx]);
+  }
+}
+
+/*
+  Parameters of a permutation that keeps the innermost axis. The rows
+  along the innermost axis are contiguous in both source and
+  destination, so they are copied in units of a vector type V. Row
+  strides are given in units of rows.
+*/
+struct TransposeRowsParams {
+  int ndim;
+  int row_size;
+  int dst_row_strides[MAX_DIM];
+  int src_row_strides[MAX_DIM];
+};
+
+template <typename V, bool accum>
+__global__ void kernel_transpose_rows(const int size,
+                                      const TransposeRowsParams p,
+                                      const V *src, V *dst) {
+  NBLA_CUDA_KERNEL_LOOP(idx, size) {
+    int row = idx / p.row_size;
+    const int col = idx - row * p.row_size;
+    int src_row = 0;
+    for (int d = 0; d < p.ndim; d++) {
+      const int k = row / p.dst_row_strides[d];
+      row -= k * p.dst_row_strides[d];
+      src_row += k * p.src_row_strides[d];
+    }
+    TransposeStore<accum>::store(dst, idx, src[src_row * p.row_size + col]);
+  }
+}
+
+/*
+  Parameters of a permutation that moves the innermost axis. The
+  source innermost axis (x) and the source axis that becomes the
+  destination innermost axis (y) span the 2-D tiles, all other axes
+  are batch axes.
+*/
+struct TransposeTiledParams {
+  int size_x;
+  int size_y;
+  int src_stride_y;
+  int dst_stride_x;
+  int batch_size;
+  int batch_ndim;
+  int batch_shape[MAX_DIM];
+  int batch_src_strides[MAX_DIM];
+  int batch_dst_strides[MAX_DIM];
+};
+
+/*
+  Tiled transpose through shared memory, reads are coalesced along x
+  and writes along y. Tiles along y and batches are grid strided.
+*/
+template <typename T, bool accum>
+__global__ void kernel_transpose_tiled(const TransposeTiledParams p,
+                                       const T *src, T *dst) {
+  // One extra column to avoid memory bank conflicts.
+  __shared__ T tile[TILE][TILE + 1];
+  const int x0 = blockIdx.x * TILE;
+
+  for (int batch = blockIdx.z; batch < p.batch_size; batch += gridDim.z) {
+    int src_offset = 0, dst_offset = 0, rest = batch;
+    for (int d = p.batch_ndim - 1; d >= 0; d--) {
+      const int k = rest % p.batch_shape[d];
+      rest /= p.batch_shape[d];
+      src_offset += k * p.batch_src_strides[d];
+      dst_offset += k * p.batch_dst_strides[d];
+    }
+    for (int y0 = blockIdx.y * TILE; y0 < p.size_y; y0 += gridDim.y * TILE) {
+      const int x = x0 + threadIdx.x;
+#pragma unroll
+      for (int j = 0; j < TILE; j += TILE_ROWS) {
+        const int y = y0 + threadIdx.y + j;
+        if (x < p.size_x && y < p.size_y)
+          tile[threadIdx.y + j][threadIdx.x] =
+              src[src_offset + y * p.src_stride_y + x];
+      }
+      __syncthreads();
+
+      const int y = y0 + threadIdx.x;
+#pragma unroll
+      for (int j = 0; j < TILE; j += TILE_ROWS) {
+        const int x = x0 + threadIdx.y + j;
+        if (x < p.size_x && y < p.size_y)
+          TransposeStore<accum>::store(dst, dst_offset + x * p.dst_stride_x + y,
+                                       tile[threadIdx.x][threadIdx.y + j]);
+      }
+      __syncthreads();
+    }
+  }
+}
+
+template <typename V, bool accum>
+void launch_transpose_rows(const int size, const TransposeRowsParams &p,
+                           const void *src, void *dst) {
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_transpose_rows<V, accum>), size, p,
+                                 static_cast<const V *>(src),
+                                 static_cast<V *>(dst));
+}
+
+// Largest vector width in bytes (up to 16) dividing the row size in
+// bytes and the alignment of both pointers.
+inline int transpose_vector_width(const size_t row_bytes, const void *src,
+                                  const void *dst) {
+  const auto bits = row_bytes | reinterpret_cast<uintptr_t>(src) |
+                    reinterpret_cast<uintptr_t>(dst);
+  int width = 16;
+  while (width > 1 && (bits & (width - 1)))
+    width >>= 1;
+  return width;
+}
+} // namespace transpose_impl
+
+/*
+  The device_transpose() function writes (or accumulates, if `accum`)
+  the permutation `axes` of the array `src` with `shape` into `dst`,
+  i.e. `dst` has the shape `shape[axes[0]], shape[axes[1]], ...`.
+
+  Size one axes are dropped and axes that remain adjacent in the
+  output are merged before choosing a kernel:
+
+  - identity: a device to device copy,
+  - innermost axis kept: a copy of contiguous rows with vector loads
+    and stores of up to 16 bytes,
+  - innermost axis moved: a shared memory tiled transpose, batched
+    over all remaining axes in a single launch.
+
+  The array size must fit into an int.
+*/
+template <typename T, bool accum = false>
+void device_transpose(const Shape_t &shape, const vector<int> &axes,
+                      const T *src, T *dst) {
+  using namespace transpose_impl;
+  const TransposeSetup setup(shape, axes);
+  if (setup.size == 0)
+    return;
+  NBLA_CHECK(setup.size <= std::numeric_limits<int>::max(), error_code::value,
+             "Maximum supported array size is %d elements",
+             std::numeric_limits<int>::max());
+  const int size = setup.size;
+  const int ndim = setup.ndim;
+
+  bool identity = true;
+  for (int d = 0; d < ndim; d++)
+    identity &= (setup.axes[d] == d);
+  if (identity) {
+    if (accum) {
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_transpose_copy<T, accum>), size,
+                                     src, dst);
+    } else {
+      NBLA_CUDA_CHECK(cudaMemcpyAsync(dst, src, sizeof(T) * size,
+                                      cudaMemcpyDeviceToDevice,
+                                      cuda_get_current_stream()));
+    }
+    return;
+  }
+
+  int src_strides[MAX_DIM], dst_strides[MAX_DIM], inv_axes[MAX_DIM];
+  for (int d = ndim - 1, s = 1; d >= 0; d--) {
+    src_strides[d] = s;
+    s *= setup.shape[d];
+  }
+  for (int d = ndim - 1, s = 1; d >= 0; d--) {
+    dst_strides[d] = s;
+    s *= setup.shape[setup.axes[d]];
+    inv_axes[setup.axes[d]] = d;
+  }
+
+  if (setup.axes[ndim - 1] == ndim - 1) {
+    const int row = setup.shape[ndim - 1];
+    TransposeRowsParams p;
+    p.ndim = ndim - 1;
+    for (int d = 0; d < ndim - 1; d++) {
+      p.dst_row_strides[d] = dst_strides[d] / row;
+      p.src_row_strides[d] = src_strides[setup.axes[d]] / row;
+    }
+    const int width =
+        accum ? sizeof(T) : transpose_vector_width(sizeof(T) * row, src, dst);
+    p.row_size = sizeof(T) * row / width;
+    const int n = sizeof(T) * size / width;
+    if (accum) {
+      launch_transpose_rows<T, accum>(n, p, src, dst);
+    } else if (width == 16) {
+      launch_transpose_rows<uint4, false>(n, p, src, dst);
+    } else if (width == 8) {
+      launch_transpose_rows<uint2, false>(n, p, src, dst);
+    } else if (width == 4) {
+      launch_transpose_rows<unsigned int, false>(n, p, src, dst);
+    } else if (width == 2) {
+      launch_transpose_rows<unsigned short, false>(n, p, src, dst);
+    } else {
+      launch_transpose_rows<unsigned char, false>(n, p, src, dst);
+    }
+    return;
+  }
+
+  const int ax = ndim - 1;
+  const int ay = setup.axes[ndim - 1];
+  TransposeTiledParams p;
+  p.size_x = setup.shape[ax];
+  p.size_y = setup.shape[ay];
+  p.src_stride_y = src_strides[ay];
+  p.dst_stride_x = dst_strides[inv_axes[ax]];
+  p.batch_size = size / (p.size_x * p.size_y);
+  p.batch_ndim = 0;
+  for (int d = 0; d < ndim; d++) {
+    if (d != ax && d != ay) {
+      p.batch_shape[p.batch_ndim] = setup.shape[d];
+      p.batch_src_strides[p.batch_ndim] = src_strides[d];
+      p.batch_dst_strides[p.batch_ndim] = dst_strides[inv_axes[d]];
+      p.batch_ndim++;
+    }
+  }
+  const dim3 grid(NBLA_CEIL_INT_DIV(p.size_x, TILE),
+                  std::min(NBLA_CEIL_INT_DIV(p.size_y, TILE), 65535),
+                  std::min(p.batch_size, 65535));
+  const dim3 block(TILE, TILE_ROWS);
+  kernel_transpose_tiled<T, accum><<<grid, block, 0,
+                                     cuda_get_current_stream()>>>(p, src, dst);
+  NBLA_CUDA_KERNEL_CHECK();
+}
+}
+#endif
@@ -20,7 +20,7 @@ namespace warp {
 
 __forceinline__ __device__ int all(int predicate) {
 #if CUDA_VERSION >= 9000
-  return __all_sync(0xfffffff, predicate);
+  return __all_sync(0xffffffff, predicate);
 #else  // !(CUDA_VERSION >= 9000)
   return __all(predicate);
 #endif // CUDA_VERSION >= 9000
@@ -28,7 +28,7 @@ __forceinline__ __device__ int all(int predicate) {
 
 __forceinline__ __device__ int any(int predicate) {
 #if CUDA_VERSION >= 9000
-  return __any_sync(0xfffffff, predicate);
+  return __any_sync(0xffffffff, predicate);
 #else  // !(CUDA_VERSION >= 9000)
   return __any(predicate);
 #endif // CUDA_VERSION >= 9000
@@ -36,7 +36,7 @@ __forceinline__ __device__ int any(int predicate) {
 
 __forceinline__ __device__ unsigned int ballot(int predicate) {
 #if CUDA_VERSION >= 9000
-  return __ballot_sync(0xfffffff, predicate);
+  return __ballot_sync(0xffffffff, predicate);
 #else  // !(CUDA_VERSION >= 9000)
   return __ballot(predicate);
 #endif // CUDA_VERSION >= 9000
@@ -281,6 +281,9 @@ def cuda_config(root_dir, cuda_lib, ext_opts, lib_dirs):
         Extension(cuda_pkg + '.nvtx',
                   [join(path_cuda_pkg, 'nvtx.pyx')],
                   **cuda_ext_opts),
+        Extension(cuda_pkg + '.profiler',
+                  [join(path_cuda_pkg, 'profiler.pyx')],
+                  **cuda_ext_opts),
     ]
 
     return ExtConfig(package_dir, packages, package_data,
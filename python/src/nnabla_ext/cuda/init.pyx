@@ -13,6 +13,8 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import contextlib
+
 from nnabla.logger import logger
 from nnabla import add_available_context
 
@@ -58,10 +60,43 @@ cdef extern from "nbla/cuda/init.hpp" namespace "nbla":
     float cuda_event_elapsed_time(shared_ptr[void], shared_ptr[void]) except +
     void cuda_event_record(shared_ptr[void]) except +
     void set_cuda_vma_chunk_size(size_t size) except +
+    shared_ptr[void] cuda_create_graph(int device_id) except +
+    void cuda_graph_begin_capture(shared_ptr[void]) except +
+    void cuda_graph_end_capture(shared_ptr[void]) except +
+    void cuda_graph_discard_capture(shared_ptr[void]) except +
+    void cuda_graph_replay(shared_ptr[void]) except +
 
 cdef extern from "nbla/cuda/common.hpp" namespace "nbla":
     vector[size_t] cuda_mem_get_info() except +
 
+cdef extern from "nbla/cuda/launch.hpp" namespace "nbla":
+    void cuda_set_launch_override(const string & name, int threads, int blocks_per_sm) except +
+    void cuda_clear_launch_overrides() except +
+
+cdef extern from "nbla/cuda/array/swap_engine.hpp" namespace "nbla":
+    cdef struct CudaSwapStatistics:
+        size_t bytes_htod
+        size_t bytes_dtoh
+        size_t copies_htod
+        size_t copies_dtoh
+        size_t pageable_copies
+        size_t bytes_in_flight
+        size_t max_bytes_in_flight
+        size_t throttles
+        double throttle_ms
+        size_t late_waits
+        double stall_ms
+        size_t prefetches
+    CudaSwapStatistics cuda_swap_get_statistics() except +
+    void cuda_swap_reset_statistics() except +
+    size_t cuda_swap_get_max_in_flight() except +
+    void cuda_swap_set_max_in_flight(size_t max_in_flight) except +
+
+cdef extern from "nbla/cuda/function/utils/fft.hpp" namespace "nbla":
+    size_t cufft_get_plan_cache_capacity() except +
+    void cufft_set_plan_cache_capacity(size_t capacity) except +
+    void cufft_clear_plan_cache() except +
+
 logger.info('Initializing CUDA extension...')
 try:
     init_cuda()
@@ -296,6 +331,171 @@ cdef class StreamEventHandler:
         with nogil:
             cuda_nullstream_synchronize()
 
+###############################################################################
+# Wrapper class for CudaGraph.
+###############################################################################
+
+cdef class Graph:
+    """CUDA graph of a fixed sequence of forward, backward and update calls.
+
+    The calls in the ``capture()`` block are recorded instead of executed,
+    and ``replay()`` runs them again with a single launch. Inputs must be
+    updated in the device arrays used in the capture, and random numbers
+    are the same in every replay.
+
+    Functions are set up and search their algorithms when first called,
+    which synchronizes with the host, so the network must be run once
+    before the capture in the same thread.
+
+    Host-side values given to the kernels are recorded as they are at the
+    capture. Solver updates depending on the step count, like the bias
+    correction of Adam, or on a changing learning rate must therefore be
+    called outside of the graph.
+
+    Example:
+
+    .. code-block:: python
+
+        loss.forward(clear_no_need_grad=True)
+        solver.zero_grad()
+        loss.backward(clear_buffer=True)
+        graph = Graph(device_id)
+        with graph.capture():
+            loss.forward(clear_no_need_grad=True)
+            solver.zero_grad()
+            loss.backward(clear_buffer=True)
+        for i in range(max_iter):
+            x.d = next_batch()
+            graph.replay()
+            solver.update()
+
+    """
+    cdef shared_ptr[void] graph
+
+    def __init__(self, int device_id=-1):
+        self.graph = cuda_create_graph(device_id)
+
+    def begin_capture(self):
+        cuda_graph_begin_capture(self.graph)
+
+    def end_capture(self):
+        cuda_graph_end_capture(self.graph)
+
+    def discard_capture(self):
+        cuda_graph_discard_capture(self.graph)
+
+    @contextlib.contextmanager
+    def capture(self):
+        self.begin_capture()
+        try:
+            yield self
+        except BaseException:
+            # The error of the body is raised, not the one of end_capture.
+            self.discard_capture()
+            raise
+        self.end_capture()
+
+    def replay(self):
+        cuda_graph_replay(self.graph)
+
+###############################################################################
+# Launch configuration
+###############################################################################
+
+def set_launch_override(str name, int threads, int blocks_per_sm=0):
+    """Override the launch configuration of a kernel.
+
+    Applies to kernels launched by ``NBLA_CUDA_LAUNCH_KERNEL_OCCUPANCY``,
+    which otherwise take the block size maximizing the occupancy.
+
+    Args:
+        name (str): Kernel expression given to the launch macro, e.g.
+            ``"kernel_transform_unary<T, UnaryOp>"``.
+        threads (int): Threads per block. A multiple of 32.
+        blocks_per_sm (int): Resident blocks per multiprocessor, which
+            bounds the grid size. Taken from the occupancy if not positive.
+    """
+    cuda_set_launch_override(name, threads, blocks_per_sm)
+
+
+def clear_launch_overrides():
+    """Clear the overrides set by :func:`set_launch_override`.
+    """
+    cuda_clear_launch_overrides()
+
+###############################################################################
+# LMS swap engine
+###############################################################################
+
+def get_swap_statistics():
+    """Get the statistics of the asynchronous copies of LMS.
+
+    Returns:
+        dict: ``bytes_htod``, ``bytes_dtoh``, ``copies_htod`` and
+        ``copies_dtoh`` count the copies issued so far. ``pageable_copies``
+        counts those from or to non-pinned host memory, ``throttles`` and
+        ``throttle_ms`` the host waits for a free slot, and ``late_waits``
+        the waits of the compute stream for an unfinished copy.
+        ``stall_ms`` is the time the compute stream spent in those waits,
+        measured on the device for the waits finished so far.
+        ``bytes_in_flight`` and ``max_bytes_in_flight`` are the current and
+        the peak bytes of unfinished copies. ``prefetches`` counts the arrays
+        prefetched by ``CudaSwapEngine::prefetch()``.
+    """
+    return cuda_swap_get_statistics()
+
+
+def reset_swap_statistics():
+    """Reset the statistics returned by :func:`get_swap_statistics`.
+    """
+    cuda_swap_reset_statistics()
+
+
+def get_lms_max_in_flight():
+    """Get the greatest number of LMS copies in flight. 0 means no limit.
+    """
+    return cuda_swap_get_max_in_flight()
+
+
+def set_lms_max_in_flight(size_t max_in_flight):
+    """Set the greatest number of LMS copies in flight.
+
+    Overrides the environment variable ``NNABLA_CUDA_LMS_MAX_INFLIGHT``.
+
+    Args:
+        max_in_flight (int): Number of copies. 0 means no limit.
+    """
+    cuda_swap_set_max_in_flight(max_in_flight)
+
+###############################################################################
+# cuFFT plan cache
+###############################################################################
+
+def get_fft_plan_cache_capacity():
+    """Get the maximum number of cuFFT plans cached for FFT and IFFT.
+    """
+    return cufft_get_plan_cache_capacity()
+
+
+def set_fft_plan_cache_capacity(size_t capacity):
+    """Set the maximum number of cuFFT plans cached for FFT and IFFT.
+
+    Overrides the environment variable ``NNABLA_CUFFT_PLAN_CACHE_SIZE``.
+    The least recently used plans beyond the capacity are destroyed.
+
+    Args:
+        capacity (int): Number of plans. 0 disables the cache.
+    """
+    cufft_set_plan_cache_capacity(capacity)
+
+
+def clear_fft_plan_cache():
+    """Destroy the cached cuFFT plans and release their work areas.
+
+    Also done by :func:`clear_memory_cache`.
+    """
+    cufft_clear_plan_cache()
+
 ###############################################################################
 # CudaVirtualMemoryAllocator
 ###############################################################################
@@ -0,0 +1,54 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from libcpp cimport bool
+from libcpp.string cimport string
+from libc.stdint cimport uint64_t
+
+cdef extern from "nbla/cuda/profiler.hpp" namespace "nbla":
+    void cuda_profiler_enable(bool) except +
+    void cuda_profiler_set_sampling_interval(int) except +
+    void cuda_profiler_set_capacity(size_t) except +
+    void cuda_profiler_begin(const string &, uint64_t) except +
+    void cuda_profiler_end(uint64_t) except +
+    void cuda_profiler_clear() except +
+    string cuda_profiler_to_json() except +
+    string cuda_profiler_to_chrome_trace() except +
+
+
+def enable(bool enabled=True):
+    cuda_profiler_enable(enabled)
+
+def set_sampling_interval(int interval):
+    """Record one out of every `interval` calls of each function."""
+    cuda_profiler_set_sampling_interval(interval)
+
+def set_capacity(size_t capacity):
+    """Set the number of records kept in the ring buffer."""
+    cuda_profiler_set_capacity(capacity)
+
+def begin(str name, uint64_t key):
+    cuda_profiler_begin(name, key)
+
+def end(uint64_t key):
+    cuda_profiler_end(key)
+
+def clear():
+    cuda_profiler_clear()
+
+def to_json():
+    return cuda_profiler_to_json()
+
+def to_chrome_trace():
+    return cuda_profiler_to_chrome_trace()
@@ -14,4 +14,4 @@
 
 from __future__ import absolute_import
 
-from .profile import CudaEventTimerCallback
+from .profile import CudaEventTimerCallback, CudaProfilerCallback
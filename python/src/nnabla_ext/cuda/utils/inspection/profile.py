@@ -13,6 +13,7 @@
 # limitations under the License.
 
 from nnabla_ext.cuda.init import Event
+from nnabla_ext.cuda import profiler
 
 from collections import OrderedDict
 import numpy as np
@@ -71,3 +72,45 @@ class CudaEventTimerCallback(FunctionHookCallbackBase):
             }
 
         return ret
+
+
+class CudaProfilerCallback(FunctionHookCallbackBase):
+    """Records functions with the C++ profiler of the CUDA backend.
+
+    Unlike CudaEventTimerCallback, events are pooled and read without
+    synchronization, and kernel launches and allocated bytes are recorded
+    as well. With `sampling_interval` > 1, only one out of that many calls
+    of each function is recorded.
+    """
+
+    def __init__(self, ext_name, device_id, sampling_interval=1,
+                 capacity=65536):
+        super(CudaProfilerCallback, self).__init__()
+
+        profiler.set_sampling_interval(sampling_interval)
+        profiler.set_capacity(capacity)
+        profiler.enable(True)
+
+    @property
+    def pre_hook(self):
+        def callback(key):
+            profiler.begin(getattr(key, "name", str(key)),
+                           hash(key) & 0xFFFFFFFFFFFFFFFF)
+
+        return callback
+
+    @property
+    def post_hook(self):
+        def callback(key):
+            profiler.end(hash(key) & 0xFFFFFFFFFFFFFFFF)
+
+        return callback
+
+    def to_json(self):
+        return profiler.to_json()
+
+    def to_chrome_trace(self):
+        return profiler.to_chrome_trace()
+
+    def close(self):
+        profiler.enable(False)
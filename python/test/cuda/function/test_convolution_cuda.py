@@ -0,0 +1,64 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+# With a bias, the cuDNN convolution runs the convolution and the bias
+# addition as one fused plan if an engine supports it. The result must match
+# the convolution without bias followed by a separate addition.
+
+
+@pytest.mark.parametrize("type_config, rtol, atol", [('float', 1e-5, 1e-5),
+                                                     ('half', 1e-2, 5e-2)])
+@pytest.mark.parametrize("channel_last", [False, True])
+@pytest.mark.parametrize("inshape, kernel, pad, stride, dilation, group", [
+    ((2, 4, 10), (3,), (1,), (1,), (1,), 1),
+    ((2, 4, 10, 12), (3, 3), (1, 1), (1, 2), (1, 1), 1),
+    ((2, 4, 9, 9), (3, 3), (0, 0), (1, 1), (2, 2), 2),
+    ((1, 4, 6, 6, 6), (3, 3, 3), (1, 1, 1), (1, 1, 1), (1, 1, 1), 1),
+])
+def test_convolution_fused_bias_matches_unfused(type_config, rtol, atol,
+                                                channel_last, inshape,
+                                                kernel, pad, stride,
+                                                dilation, group):
+    rng = np.random.RandomState(313)
+    outmaps = 8
+    base_axis = 1
+    if channel_last:
+        inshape = inshape[:1] + inshape[2:] + inshape[1:2]
+    cin = inshape[-1] if channel_last else inshape[1]
+    wshape = (outmaps, cin // group) + kernel
+    if channel_last:
+        wshape = wshape[:1] + wshape[2:] + wshape[1:2]
+    x_data = rng.randn(*inshape).astype(np.float32)
+    w_data = rng.randn(*wshape).astype(np.float32)
+    b_data = rng.randn(outmaps).astype(np.float32)
+    ctx = get_extension_context('cudnn', type_config=type_config)
+    with nn.context_scope(ctx), nn.auto_forward():
+        x = nn.Variable.from_numpy_array(x_data)
+        w = nn.Variable.from_numpy_array(w_data)
+        b = nn.Variable.from_numpy_array(b_data)
+        y = F.convolution(x, w, b, base_axis, pad, stride, dilation, group,
+                          channel_last)
+        z = F.convolution(x, w, None, base_axis, pad, stride, dilation,
+                          group, channel_last)
+    bshape = [1] * z.ndim
+    bshape[-1 if channel_last else 1] = outmaps
+    ref = z.d + b_data.reshape(bshape)
+    assert_allclose(y.d, ref, rtol=rtol, atol=atol)
@@ -0,0 +1,46 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+# The mask is stored as one bit per element, packed by warps of 32 lanes.
+# Sizes which are not multiples of 32 leave a partial warp at the end.
+
+
+@pytest.mark.parametrize("shape", [(1,), (31,), (33,), (3, 5, 7), (1000,),
+                                   (4, 1025)])
+@pytest.mark.parametrize("p", [0.3, 0.5])
+@pytest.mark.parametrize("seed", [-1, 313])
+def test_dropout_mask_forward_backward(shape, p, seed):
+    rng = np.random.RandomState(0)
+    x_data = rng.rand(*shape).astype(np.float32) + 1
+    dy_data = rng.rand(*shape).astype(np.float32) + 1
+    scale = 1. / (1. - p)
+    with nn.context_scope(get_extension_context('cudnn')):
+        x = nn.Variable.from_numpy_array(x_data, need_grad=True)
+        y, mask = F.dropout(x, p=p, seed=seed, output_mask=True)
+        y.forward()
+        x.grad.zero()
+        y.backward(dy_data)
+    m = mask.d.copy()
+    assert set(np.unique(m)) <= {0., 1.}
+    assert_allclose(y.d, x_data * m * scale, rtol=1e-6)
+    # Backward reads the bit mask, which must agree with forward's mask in
+    # every lane including those of the last partial warp.
+    assert_allclose(x.g, dy_data * m * scale, rtol=1e-6)
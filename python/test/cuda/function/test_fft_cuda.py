@@ -0,0 +1,52 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+import nnabla_ext.cuda.init as cuda_init
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+
+def ref_fft(x):
+    c = np.fft.fft(x[..., 0] + 1j * x[..., 1])
+    return np.stack([c.real, c.imag], axis=-1)
+
+
+@pytest.fixture
+def plan_cache():
+    capacity = cuda_init.get_fft_plan_cache_capacity()
+    yield
+    cuda_init.set_fft_plan_cache_capacity(capacity)
+    cuda_init.clear_fft_plan_cache()
+
+
+# Plans are looked up by shape. The work area shared by the plans grows with
+# the largest one, and both are released by clear_memory_cache().
+@pytest.mark.parametrize("capacity", [0, 1, 128])
+def test_fft_plan_cache(plan_cache, capacity):
+    cuda_init.set_fft_plan_cache_capacity(capacity)
+    assert cuda_init.get_fft_plan_cache_capacity() == capacity
+    rng = np.random.RandomState(313)
+    with nn.context_scope(get_extension_context('cudnn')):
+        for n in [8, 64, 8, 1024, 64]:
+            x_data = rng.randn(3, n, 2).astype(np.float32)
+            x = nn.Variable.from_numpy_array(x_data)
+            y = F.fft(x, signal_ndim=1)
+            y.forward()
+            assert_allclose(y.d, ref_fft(x_data), rtol=1e-4, atol=1e-3)
+            if n == 1024:
+                cuda_init.clear_memory_cache()
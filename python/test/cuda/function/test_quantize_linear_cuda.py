@@ -0,0 +1,73 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+# QuantizeLinear with per-tensor or per-channel scale and zero_point runs one
+# kernel and stores its output as int8 or uint8. DequantizeLinear reads that
+# storage directly.
+
+
+def ref_quantize_linear(x, scale, zero_point, round_mode, qmin, qmax):
+    # Rounded in float64 so that adding 0.5 does not round up.
+    v = (x / scale).astype(np.float64)
+    if round_mode == "HALF_TO_EVEN":
+        v = np.round(v)
+    else:
+        v = np.sign(v) * np.floor(np.abs(v) + 0.5)
+    return np.clip(v + zero_point, qmin, qmax)
+
+
+def ref_dequantize_linear(x, scale, zero_point):
+    return (x - zero_point) * scale
+
+
+@pytest.mark.parametrize("dtype, qmin, qmax", [(np.int8, -128, 127),
+                                               (np.uint8, 0, 255)])
+@pytest.mark.parametrize("round_mode", ["HALF_AWAY_FROM_ZERO",
+                                        "HALF_TO_EVEN"])
+@pytest.mark.parametrize("sshape", [(1, 1, 1, 1), (1, 3, 1, 1), (1, 1, 1, 5)])
+def test_quantize_dequantize_linear_storage(dtype, qmin, qmax, round_mode,
+                                            sshape):
+    rng = np.random.RandomState(313)
+    xshape = (2, 3, 4, 5)
+    x_data = rng.randn(*xshape).astype(np.float32) * 50
+    # Exact halves check the rounding mode.
+    x_data.flat[:4] = [0.5, 1.5, -0.5, -2.5]
+    scale_data = rng.rand(*sshape).astype(np.float32) + 0.5
+    scale_data.flat[0] = 1.0
+    zero_point_data = rng.randint(
+        qmin // 2, qmax // 2 + 1, size=sshape).astype(np.float32)
+    zero_point_data.flat[0] = 0
+    with nn.context_scope(get_extension_context('cudnn')):
+        x = nn.Variable.from_numpy_array(x_data)
+        scale = nn.Variable.from_numpy_array(scale_data)
+        zero_point = nn.Variable.from_numpy_array(zero_point_data)
+        q = F.quantize_linear(x, scale, zero_point, round_mode=round_mode,
+                              dtype=np.dtype(dtype).num)
+        y = F.dequantize_linear(q, scale, zero_point)
+        y.forward()
+
+    # The quantized values are kept in 8-bit storage on the device.
+    assert q.data.dtype == dtype
+    q_ref = ref_quantize_linear(x_data, scale_data, zero_point_data,
+                                round_mode, qmin, qmax)
+    assert_allclose(q.d, q_ref)
+    assert_allclose(y.d, ref_dequantize_linear(q_ref, scale_data,
+                                               zero_point_data), rtol=1e-6)
@@ -0,0 +1,64 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+
+@pytest.fixture(scope='module')
+def comm():
+    ctx = get_extension_context('cudnn')
+    try:
+        import nnabla.communicators as C
+        comm = C.MultiProcessDataParallelCommunicator(ctx)
+        comm.init()
+    except Exception:
+        pytest.skip('MultiProcessDataParallelCommunicator is not available.')
+    return comm
+
+
+# E[x^2] - E[x]^2 in float loses the variance entirely at a mean of 1e4,
+# since x^2 ~ 1e8 has an ulp of 8.
+@pytest.mark.parametrize("shape, axis", [((8, 3, 16, 16), 1),
+                                         ((8, 16, 16, 3), 3)])
+@pytest.mark.parametrize("offset", [0., 1e4])
+def test_sync_batch_normalization_large_mean(comm, shape, axis, offset):
+    rng = np.random.RandomState(313)
+    x_data = (rng.randn(*shape) + offset).astype(np.float32)
+    stat_shape = [1] * len(shape)
+    stat_shape[axis] = shape[axis]
+    with nn.context_scope(get_extension_context('cudnn')):
+        x = nn.Variable.from_numpy_array(x_data)
+        beta = nn.Variable.from_numpy_array(np.zeros(stat_shape, np.float32))
+        gamma = nn.Variable.from_numpy_array(np.ones(stat_shape, np.float32))
+        rmean = nn.Variable.from_numpy_array(np.zeros(stat_shape, np.float32))
+        rvar = nn.Variable.from_numpy_array(np.ones(stat_shape, np.float32))
+        y, mean, var = F.sync_batch_normalization(
+            x, beta, gamma, rmean, rvar, comm, axes=[axis], batch_stat=True,
+            output_stat=True)
+        y.forward()
+
+    # Reference in double precision.
+    x64 = x_data.astype(np.float64)
+    axes = tuple(i for i in range(len(shape)) if i != axis)
+    ref_mean = x64.mean(axis=axes, keepdims=True)
+    ref_var = x64.var(axis=axes, keepdims=True)
+    assert_allclose(mean.d, ref_mean, rtol=1e-6, atol=1e-6)
+    assert_allclose(var.d, ref_var, rtol=1e-3)
+    assert_allclose(y.d, (x64 - ref_mean) / np.sqrt(ref_var + 1e-5),
+                    atol=2e-3)
@@ -0,0 +1,51 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+# For k > 1024 TopKData selects the k largest values of all samples with a
+# batched radix select. Values equal to the k-th largest value must be taken
+# in index order, so that the unreduced output does not depend on the order
+# of atomic operations.
+
+
+def ref_top_k_data(x, k, abs):
+    v = np.abs(x) if abs else x
+    idx = np.argsort(-v, axis=1, kind='stable')[:, :k]
+    y = np.zeros_like(x)
+    np.put_along_axis(y, idx, np.take_along_axis(x, idx, axis=1), axis=1)
+    return np.take_along_axis(x, idx, axis=1), y
+
+
+@pytest.mark.parametrize("abs", [False, True])
+@pytest.mark.parametrize("k", [1025, 2000, 4095])
+def test_top_k_data_large_k_breaks_ties_by_index(abs, k):
+    rng = np.random.RandomState(313)
+    # Few distinct non-zero values give many ties at the k-th value.
+    x_data = rng.choice([-3, -2, -1, 1, 2, 3], size=(3, 4096))
+    x_data = x_data.astype(np.float32)
+    ref_reduced, ref_full = ref_top_k_data(x_data, k, abs)
+    with nn.context_scope(get_extension_context('cudnn')):
+        x = nn.Variable.from_numpy_array(x_data)
+        y_reduced = F.top_k_data(x, k, abs=abs, reduce=True)
+        y_full = F.top_k_data(x, k, abs=abs, reduce=False)
+        for _ in range(3):
+            F.sink(y_reduced, y_full).forward()
+            assert_allclose(y_reduced.d, ref_reduced)
+            assert_allclose(y_full.d, ref_full)
@@ -0,0 +1,85 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+
+import nnabla as nn
+import nnabla.functions as F
+import nnabla.lms as lms
+import nnabla_ext.cuda.init as cuda_init
+from nnabla.ext_utils import get_extension_context
+
+
+def teardown_function(function):
+    from nnabla import prefer_cached_array
+    prefer_cached_array(True)
+    cuda_init.clear_memory_cache()
+
+
+def test_lms_max_in_flight():
+    default = cuda_init.get_lms_max_in_flight()
+    try:
+        cuda_init.set_lms_max_in_flight(3)
+        assert cuda_init.get_lms_max_in_flight() == 3
+        cuda_init.set_lms_max_in_flight(0)
+        assert cuda_init.get_lms_max_in_flight() == 0
+    finally:
+        cuda_init.set_lms_max_in_flight(default)
+
+
+@pytest.mark.parametrize("max_in_flight", [0, 1])
+def test_swap_statistics(max_in_flight):
+    cuda_init.prefer_cpu_pinned_array()
+    cpu_ctx = get_extension_context('cpu', device_id='')
+    gpu_ctx = get_extension_context('cudnn', device_id='0')
+    nn.set_default_context(gpu_ctx)
+
+    x = nn.Variable((16, 1024))
+    h = x
+    for i in range(4):
+        h = F.tanh(h)
+    y = F.sum(h)
+
+    # A budget below the size of the graph forces swap-outs.
+    scheduler = lms.SwapInOutScheduler(cpu_ctx, gpu_ctx, 3 * x.size * 4,
+                                       6 * x.size * 4, True)
+    default = cuda_init.get_lms_max_in_flight()
+    cuda_init.set_lms_max_in_flight(max_in_flight)
+    cuda_init.reset_swap_statistics()
+    try:
+        for i in range(2):
+            with scheduler:
+                x.d = np.random.randn(*x.shape)
+                y.forward(clear_no_need_grad=True)
+        cuda_init.device_synchronize('0')
+    finally:
+        cuda_init.set_lms_max_in_flight(default)
+
+    stats = cuda_init.get_swap_statistics()
+    assert stats['copies_htod'] + stats['copies_dtoh'] > 0
+    assert (stats['copies_htod'] > 0) == (stats['bytes_htod'] > 0)
+    assert (stats['copies_dtoh'] > 0) == (stats['bytes_dtoh'] > 0)
+    assert stats['pageable_copies'] == 0
+    assert stats['bytes_in_flight'] == 0
+    assert stats['max_bytes_in_flight'] > 0
+    if max_in_flight == 0:
+        assert stats['throttles'] == 0
+    assert stats['stall_ms'] >= 0
+    if stats['late_waits'] == 0:
+        assert stats['stall_ms'] == 0
+
+    cuda_init.reset_swap_statistics()
+    stats = cuda_init.get_swap_statistics()
+    assert all(v == 0 for v in stats.values())
@@ -0,0 +1,95 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+import nnabla.parametric_functions as PF
+import nnabla_ext.cuda.init as cuda_init
+from nnabla.ext_utils import get_extension_context
+from nnabla.testing import assert_allclose
+
+
+@pytest.fixture
+def ctx():
+    ctx = get_extension_context('cudnn')
+    nn.clear_parameters()
+    yield ctx
+    nn.clear_parameters()
+
+
+def write(v, data):
+    # Written on the device, into the array read by the graph.
+    v.data.copy_from(nn.NdArray.from_numpy_array(data))
+
+
+def read(a):
+    # The replay updates the device array behind the synced array, so it is
+    # copied on the device instead of reading the host array synced before.
+    return F.identity(a).data.copy()
+
+
+def test_cuda_graph_replay_matches_eager(ctx):
+    rng = np.random.RandomState(313)
+    inputs = [rng.randn(2, 3, 8, 8).astype(np.float32) for _ in range(3)]
+    with nn.context_scope(ctx):
+        x = nn.Variable.from_numpy_array(inputs[0])
+        # Convolution with bias takes the fused cuDNN plan if available.
+        h = F.relu(PF.convolution(x, 4, (3, 3), pad=(1, 1), name='conv'))
+        h = F.tanh(PF.affine(h, 5, name='fc'))
+        y = F.sum(h ** 2)
+    params = list(nn.get_parameters().values())
+
+    def run():
+        for p in params:
+            p.grad.zero()
+        y.forward()
+        y.backward()
+
+    # Eager references, which also set up the functions before the capture.
+    expected = []
+    with nn.context_scope(ctx):
+        for data in inputs:
+            write(x, data)
+            run()
+            expected.append((y.d.copy(), [p.g.copy() for p in params]))
+
+    graph = cuda_init.Graph()
+    with nn.context_scope(ctx):
+        write(x, inputs[0])
+        with graph.capture():
+            run()
+        for data, (y_ref, g_ref) in zip(inputs, expected):
+            write(x, data)
+            graph.replay()
+            assert_allclose(read(y.data), y_ref, rtol=1e-5)
+            for p, g in zip(params, g_ref):
+                assert_allclose(read(p.grad), g, rtol=1e-5, atol=1e-6)
+
+
+def test_cuda_graph_capture_raises_error_of_body(ctx):
+    graph = cuda_init.Graph()
+    with pytest.raises(ValueError):
+        with graph.capture():
+            raise ValueError('body')
+    # The capture was discarded, so another one can begin in this thread.
+    with nn.context_scope(ctx):
+        x = nn.Variable.from_numpy_array(np.ones((4, 4), np.float32))
+        y = F.add_scalar(x, 1.0)
+        y.forward()
+        with graph.capture():
+            y.forward()
+        graph.replay()
+        assert_allclose(read(y.data), np.full((4, 4), 2.0))
@@ -0,0 +1,37 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+import os
+import subprocess
+import sys
+
+
+'''
+This test verifies that the functions adding to arbitrary locations through
+ScatterAdder give bitwise identical results from run to run when
+NNABLA_CUDNN_DETERMINISTIC is set. The option is read only once per process,
+so the check runs in test_deterministic_scatter_add_main.py.
+'''
+
+
+@pytest.mark.parametrize("context", ['cuda', 'cudnn'])
+def test_deterministic_scatter_add(context):
+    env = dict(os.environ)
+    env["NNABLA_CUDNN_DETERMINISTIC"] = "1"
+    d = os.path.dirname(os.path.abspath(__file__))
+    test_main_path = d + "/test_deterministic_scatter_add_main.py"
+    result = subprocess.run(
+        [sys.executable, test_main_path, "--context", context], env=env)
+    assert result.returncode == 0
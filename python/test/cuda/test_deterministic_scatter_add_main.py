@@ -0,0 +1,93 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+import argparse
+
+'''
+This test is called by test_deterministic_scatter_add.py with
+NNABLA_CUDNN_DETERMINISTIC=1. Each case runs twice on the same inputs, and
+the results must be bitwise identical. The inputs make many values collide
+on few destinations, where the order of atomic additions would show.
+'''
+
+
+def run_scatter_add(rng):
+    x0 = rng.randn(4).astype(np.float32)
+    indices = rng.randint(0, 4, size=(100000,))
+    x1 = rng.randn(100000).astype(np.float32)
+
+    def run():
+        y = F.scatter_add(nn.Variable.from_numpy_array(x0),
+                          nn.Variable.from_numpy_array(indices),
+                          nn.Variable.from_numpy_array(x1), axis=0)
+        y.forward()
+        return y.d.copy()
+    return run
+
+
+def run_interpolate_backward(rng):
+    x_data = rng.randn(2, 3, 4, 4).astype(np.float32)
+    dy = rng.randn(2, 3, 256, 256).astype(np.float32)
+
+    def run():
+        x = nn.Variable.from_numpy_array(x_data, need_grad=True)
+        y = F.interpolate(x, output_size=(256, 256), mode='linear')
+        y.forward()
+        x.grad.zero()
+        y.backward(dy)
+        return x.g.copy()
+    return run
+
+
+def run_warp_by_grid_backward(rng):
+    x_data = rng.randn(2, 3, 8, 8).astype(np.float32)
+    # Every sampling point falls near the center of the input.
+    grid_data = rng.uniform(-0.1, 0.1, size=(2, 64, 64, 2)).astype(np.float32)
+    dy = rng.randn(2, 3, 64, 64).astype(np.float32)
+
+    def run():
+        x = nn.Variable.from_numpy_array(x_data, need_grad=True)
+        grid = nn.Variable.from_numpy_array(grid_data, need_grad=True)
+        y = F.warp_by_grid(x, grid)
+        y.forward()
+        x.grad.zero()
+        grid.grad.zero()
+        y.backward(dy)
+        return np.concatenate([x.g.ravel(), grid.g.ravel()])
+    return run
+
+
+def main(args):
+    from nnabla.ext_utils import get_extension_context
+    rng = np.random.RandomState(313)
+    with nn.context_scope(get_extension_context(args.context)):
+        for case in [run_scatter_add, run_interpolate_backward,
+                     run_warp_by_grid_backward]:
+            run = case(rng)
+            first = run()
+            for _ in range(3):
+                assert run().tobytes() == first.tobytes(), case.__name__
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--context", type=str,
+                        default="cuda", choices=["cudnn", "cuda"])
+    args = parser.parse_args()
+    main(args)
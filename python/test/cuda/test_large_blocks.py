@@ -35,3 +35,75 @@ def test_cuda_large_blocks(cuda_test_opts, m):
     with nn.context_scope(get_extension_context('cuda')):
         y = F.relu(v)
         y.forward()
+
+
+def _skip_unless_large_memory(cuda_test_opts, nbytes):
+    if cuda_test_opts.disable_test_large_blocks:
+        pytest.skip('`--disable-test-large-blocks` is passed')
+    import nnabla_ext.cuda
+    free, _ = nnabla_ext.cuda.get_device_memory_size()
+    if free < nbytes:
+        pytest.skip('{} bytes of device memory required'.format(nbytes))
+
+
+# More elements than int can index.
+LARGE_SIZE = 2 ** 31 + 3
+
+
+def test_cuda_large_index_concatenate(cuda_test_opts):
+    _skip_unless_large_memory(cuda_test_opts, LARGE_SIZE * 2 * 4 + 2 ** 30)
+    from nnabla.ext_utils import get_extension_context
+    with nn.context_scope(get_extension_context('cuda')):
+        a = nn.Variable((LARGE_SIZE // 2,))
+        b = nn.Variable((LARGE_SIZE - LARGE_SIZE // 2,))
+        a.data.zero()
+        b.data.fill(1)
+        y = F.concatenate(a, b, axis=0)
+        y.forward(clear_buffer=True)
+    d = y.d
+    assert d[LARGE_SIZE // 2 - 1] == 0
+    assert d[-1] == 1
+
+
+def test_cuda_large_index_sgd(cuda_test_opts):
+    _skip_unless_large_memory(cuda_test_opts, LARGE_SIZE * 2 * 4 + 2 ** 30)
+    import nnabla.solvers as S
+    from nnabla.ext_utils import get_extension_context
+    with nn.context_scope(get_extension_context('cuda')):
+        p = nn.Variable((LARGE_SIZE,), need_grad=True)
+        p.data.zero()
+        p.grad.fill(1)
+        solver = S.Sgd(lr=0.5)
+        solver.set_parameters({'p': p})
+        solver.update()
+    d = p.d
+    assert d[0] == -0.5
+    assert d[-1] == -0.5
+
+
+def test_cuda_large_index_cumsum(cuda_test_opts):
+    _skip_unless_large_memory(cuda_test_opts, LARGE_SIZE * 2 * 4 + 2 ** 30)
+    from nnabla.ext_utils import get_extension_context
+    n = LARGE_SIZE // 2 + 1
+    with nn.context_scope(get_extension_context('cuda')):
+        x = nn.Variable((2, n))
+        x.data.fill(1)
+        y = F.cumsum(x, axis=0)
+        y.forward(clear_buffer=True)
+    d = y.d
+    assert d[0, -1] == 1
+    assert d[1, -1] == 2
+
+
+def test_cuda_large_index_softmax(cuda_test_opts):
+    _skip_unless_large_memory(cuda_test_opts, LARGE_SIZE * 2 * 4 + 2 ** 30)
+    from nnabla.ext_utils import get_extension_context
+    n = LARGE_SIZE // 2 + 1
+    with nn.context_scope(get_extension_context('cuda')):
+        x = nn.Variable((n, 2))
+        x.data.zero()
+        y = F.softmax(x, axis=1)
+        y.forward(clear_buffer=True)
+    d = y.d
+    assert d[0, 0] == 0.5
+    assert d[-1, -1] == 0.5
@@ -0,0 +1,65 @@
+# Copyright 2021 Sony Group Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import json
+
+import pytest
+import numpy as np
+import nnabla as nn
+import nnabla.functions as F
+from nnabla.ext_utils import get_extension_context
+from nnabla_ext.cuda import profiler
+from nnabla_ext.cuda.utils.inspection import CudaProfilerCallback
+
+
+@pytest.fixture
+def callback():
+    profiler.clear()
+    cb = CudaProfilerCallback('cuda', '0')
+    yield cb
+    cb.close()
+    profiler.clear()
+
+
+@pytest.mark.parametrize("sampling_interval", [1, 2])
+def test_cuda_profiler_callback(callback, sampling_interval):
+    profiler.set_sampling_interval(sampling_interval)
+    n_iter = 4
+    with nn.context_scope(get_extension_context('cuda')):
+        x = nn.Variable.from_numpy_array(
+            np.random.randn(8, 1024).astype(np.float32))
+        # Both are transform_unary kernels launched through the counted
+        # launch macros.
+        y = F.mul_scalar(F.add_scalar(x, 1.0), 2.0)
+        for i in range(n_iter):
+            y.forward(function_pre_hook=callback.pre_hook,
+                      function_post_hook=callback.post_hook)
+
+    records = json.loads(callback.to_json())
+    names = [r['name'] for r in records]
+    assert sorted(set(names)) == ['AddScalar', 'MulScalar']
+    for name in ('AddScalar', 'MulScalar'):
+        assert names.count(name) == n_iter // sampling_interval
+    for r in records:
+        assert r['launches'] > 0
+        assert r['elapsed_ms'] >= 0
+        assert r['device'] == 0
+
+    trace = json.loads(callback.to_chrome_trace())
+    events = trace['traceEvents']
+    assert len(events) == len(records)
+    for e, r in zip(events, records):
+        assert e['ph'] == 'X'
+        assert e['name'] == r['name']
+        assert e['args']['launches'] == r['launches']
@@ -16,8 +16,9 @@
 #include <nbla/array_registry.hpp>
 #include <nbla/cpu.hpp>
 #include <nbla/cuda/array/cuda_array.hpp>
+#include <nbla/cuda/array/swap_engine.hpp>
 #include <nbla/cuda/cuda.hpp>
-#include <nbla/cuda/event.hpp>
+#include <nbla/cuda/profiler.hpp>
 #include <nbla/cuda/function/my_cuda_memset.hpp>
 #include <nbla/nd_array.hpp>
 #include <nbla/singleton_manager.hpp>
@@ -75,53 +76,9 @@ Context CudaArray::filter_context(const Context &ctx) {
   return Context({}, "CudaArray", ctx.device_id);
 }
 
-void CUDART_CB delete_callback(cudaStream_t stream, cudaError_t status,
-                               void *userData) {
-  delete reinterpret_cast<shared_ptr<Array> *>(userData);
-}
-
-// Main process of asynchronous synchronizer
-void synchronize_async_cuda_array_cpu_array(Array *src, Array *dst,
-                                            cudaMemcpyKind kind,
-                                            const cudaStream_t stream,
-                                            const int async_flags) {
-  // Wait an previous asynchronous memcpy
-  src->wait_event(dst->context(), async_flags);
-
-  if (dst->have_event()) {
-    NBLA_ERROR(error_code::target_specific_async,
-               "Duplicated asynchronous memcpy to the same destination array");
-  }
-
-  cudaEvent_t null_event;
-  NBLA_CUDA_CHECK(cudaEventCreate(&null_event));
-  NBLA_CUDA_CHECK(cudaEventRecord(null_event, 0));
-  NBLA_CUDA_CHECK(cudaStreamWaitEvent(stream, null_event, 0));
-  NBLA_CUDA_CHECK(cudaEventDestroy(null_event));
-
-  // Prepare an event
-  cudaEvent_t event;
-  NBLA_CUDA_CHECK(cudaEventCreate(&event));
-
-  // Memory copy
-  size_t size = src->size() * sizeof_dtype(dst->dtype());
-  NBLA_CUDA_CHECK(cudaMemcpyAsync(
-      dst->pointer<void>(), src->const_pointer<void>(), size, kind, stream));
-
-  // No cudaStreamCallback becasuse cudaStreamSycnhronize(0) in
-  // CudaEvent::wait_event
-  // has the same effect.
-
-  // Record the memory copy as an event into the destination array
-  NBLA_CUDA_CHECK(cudaEventRecord(event, stream));
-  dst->set_event(shared_ptr<Event>(new CudaEvent(event, src->getptr())));
-}
-
 // Main process of asynchronous synchronizer
-void synchronize_async_cpu_array_cuda_array(Array *src, Array *dst,
-                                            cudaMemcpyKind kind,
-                                            const cudaStream_t stream,
-                                            const int async_flags) {
+void synchronize_async(Array *src, Array *dst, cudaMemcpyKind kind, int device,
+                       const int async_flags) {
   // Wait an previous asynchronous memcpy
   src->wait_event(dst->context(), async_flags);
 
@@ -130,32 +87,13 @@ void synchronize_async_cpu_array_cuda_array(Array *src, Array *dst,
                "Duplicated asynchronous memcpy to the same destination array");
   }
 
-  // Synchronize to null stream which managed the GPU memory usage of the array
-  // dst
-  cudaEvent_t null_event;
-  NBLA_CUDA_CHECK(cudaEventCreate(&null_event));
-  NBLA_CUDA_CHECK(cudaEventRecord(null_event, 0));
-  NBLA_CUDA_CHECK(cudaStreamWaitEvent(stream, null_event, 0));
-  NBLA_CUDA_CHECK(cudaEventDestroy(null_event));
-
-  // Prepare an event
-  cudaEvent_t event;
-  NBLA_CUDA_CHECK(cudaEventCreate(&event));
-
-  // Memory copy
-  size_t size = src->size() * sizeof_dtype(dst->dtype());
-  NBLA_CUDA_CHECK(cudaMemcpyAsync(
-      dst->pointer<void>(), src->const_pointer<void>(), size, kind, stream));
-
-  if (!(async_flags & AsyncFlag::UNSAFE)) { // Keep safe CPU memory of src
-    auto delete_guard = new shared_ptr<Array>(src->getptr());
-    NBLA_CUDA_CHECK(
-        cudaStreamAddCallback(stream, delete_callback, delete_guard, 0));
-  }
-
-  // Record the memory copy as an event into the destination array
-  NBLA_CUDA_CHECK(cudaEventRecord(event, stream));
-  dst->set_event(shared_ptr<Event>(new CudaEvent(event, src->getptr())));
+  // No cudaStreamCallback for a copy to host because
+  // cudaStreamSynchronize(0) in CudaEvent::wait_event has the same effect.
+  // A copy to device keeps safe CPU memory of src unless UNSAFE.
+  const bool keep_src = kind == cudaMemcpyHostToDevice &&
+                        !(async_flags & AsyncFlag::UNSAFE);
+  SingletonManager::get<CudaSwapEngine>()->copy(src, dst, kind, device,
+                                                keep_src);
 }
 
 // Main process of synchronous synchronizer
@@ -198,9 +136,8 @@ void synchronizer_cuda_array_cpu_array(Array *src, Array *dst,
   }
 
   if (async_flags & AsyncFlag::ASYNC) { // cudaMemcpyAsync
-    synchronize_async_cuda_array_cpu_array(
-        src, dst, cudaMemcpyDeviceToHost,
-        SingletonManager::get<Cuda>()->stream_DtoH, async_flags);
+    synchronize_async(src, dst, cudaMemcpyDeviceToHost,
+                      std::stoi(src->context().device_id), async_flags);
   } else { // cudaMemcpy
     synchronize_sync(src, dst, cudaMemcpyDeviceToHost, async_flags);
   }
@@ -227,9 +164,8 @@ void synchronizer_cpu_array_cuda_array(Array *src, Array *dst,
   }
 
   if (async_flags & AsyncFlag::ASYNC) { // cudaMemcpyAsync
-    synchronize_async_cpu_array_cuda_array(
-        src, dst, cudaMemcpyHostToDevice,
-        SingletonManager::get<Cuda>()->stream_HtoD, async_flags);
+    synchronize_async(src, dst, cudaMemcpyHostToDevice,
+                      std::stoi(dst->context().device_id), async_flags);
   } else { // cudaMemcpy
     synchronize_sync(src, dst, cudaMemcpyHostToDevice, async_flags);
   }
@@ -242,7 +178,11 @@ CudaCachedArray::CudaCachedArray(const Size_t size, dtypes dtype,
                                  const Context &ctx)
     : CudaArray(size, dtype, ctx,
                 SingletonManager::get<Cuda>()->caching_allocator()->alloc(
-                    Array::size_as_bytes(size, dtype), ctx.device_id)) {}
+                    Array::size_as_bytes(size, dtype), ctx.device_id)) {
+  // Functions allocate their workspaces as BYTE arrays.
+  cuda_profiler_count_allocation(Array::size_as_bytes(size, dtype),
+                                 dtype == dtypes::BYTE);
+}
 
 CudaCachedArray::~CudaCachedArray() {}
 
@@ -0,0 +1,320 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <nbla/cuda/array/cuda_array.hpp>
+#include <nbla/cuda/array/swap_engine.hpp>
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/cuda.hpp>
+#include <nbla/cuda/event.hpp>
+#include <nbla/singleton_manager-internal.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace nbla {
+
+struct CudaSwapEngine::EventPool {
+  std::mutex mtx;
+  std::unordered_map<int, std::vector<cudaEvent_t>> events;
+
+  ~EventPool() {
+    // Not checked since it may run at exit after the device is released.
+    for (auto &device_events : events) {
+      for (auto event : device_events.second) {
+        cudaEventDestroy(event);
+      }
+    }
+  }
+};
+
+static void CUDART_CB delete_callback(cudaStream_t stream, cudaError_t status,
+                                      void *userData) {
+  delete reinterpret_cast<shared_ptr<Array> *>(userData);
+}
+
+CudaSwapEngine::CudaSwapEngine()
+    : max_in_flight_(16), pool_(std::make_shared<EventPool>()) {
+  const char *e = std::getenv("NNABLA_CUDA_LMS_MAX_INFLIGHT");
+  if (e) {
+    std::stringstream sstream(e);
+    long long int max_in_flight;
+    NBLA_CHECK(sstream >> max_in_flight && max_in_flight >= 0,
+               error_code::value,
+               "Invalid value: NNABLA_CUDA_LMS_MAX_INFLIGHT=%s. Non-negative "
+               "integer required.",
+               e);
+    max_in_flight_ = max_in_flight;
+  }
+}
+
+CudaSwapEngine::~CudaSwapEngine() {
+  // Not checked since it may run at exit after the device is released.
+  for (auto &order_event : order_events_) {
+    cudaEventDestroy(order_event.second);
+  }
+  for (auto &stall : stalls_) {
+    cudaEventDestroy(stall.begin);
+    cudaEventDestroy(stall.end);
+  }
+  for (auto &device_stalls : stall_events_) {
+    for (auto &stall : device_stalls.second) {
+      cudaEventDestroy(stall.begin);
+      cudaEventDestroy(stall.end);
+    }
+  }
+}
+
+cudaStream_t CudaSwapEngine::stream(cudaMemcpyKind kind, int device) {
+  auto cuda = SingletonManager::get<Cuda>();
+  if (!cuda->stream_HtoD || !cuda->stream_DtoH) {
+    cuda->create_lms_streams(device);
+  }
+  return kind == cudaMemcpyHostToDevice ? cuda->stream_HtoD
+                                        : cuda->stream_DtoH;
+}
+
+shared_ptr<cudaEvent_t> CudaSwapEngine::get_event(int device) {
+  cudaEvent_t event = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(pool_->mtx);
+    auto &events = pool_->events[device];
+    if (!events.empty()) {
+      event = events.back();
+      events.pop_back();
+    }
+  }
+  if (!event) {
+    NBLA_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  }
+  // Recording a pooled event again is safe even if it has not completed yet,
+  // since waits already issued keep the state at their call.
+  auto pool = pool_;
+  return shared_ptr<cudaEvent_t>(new cudaEvent_t(event),
+                                 [pool, device](cudaEvent_t *event) {
+                                   std::lock_guard<std::mutex> lock(pool->mtx);
+                                   pool->events[device].push_back(*event);
+                                   delete event;
+                                 });
+}
+
+void CudaSwapEngine::retire(bool wait_oldest) {
+  if (wait_oldest && !in_flight_.empty()) {
+    NBLA_CUDA_CHECK(cudaEventSynchronize(*in_flight_.front().event));
+  }
+  while (!in_flight_.empty()) {
+    const cudaError_t status = cudaEventQuery(*in_flight_.front().event);
+    if (status == cudaErrorNotReady) {
+      break;
+    }
+    NBLA_CUDA_CHECK(status);
+    stats_.bytes_in_flight -= in_flight_.front().bytes;
+    in_flight_.pop_front();
+  }
+}
+
+void CudaSwapEngine::copy(Array *src, Array *dst, cudaMemcpyKind kind,
+                          int device, bool keep_src) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  retire(false);
+  if (max_in_flight_ > 0 && in_flight_.size() >= max_in_flight_) {
+    auto start = std::chrono::steady_clock::now();
+    while (in_flight_.size() >= max_in_flight_) {
+      retire(true);
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    stats_.throttles++;
+    stats_.throttle_ms += elapsed.count();
+  }
+
+  // The copy must start after the functions issued so far to the null stream,
+  // which manages the memory of both arrays.
+  const cudaStream_t s = stream(kind, device);
+  cudaEvent_t &order_event = order_events_[device];
+  if (!order_event) {
+    NBLA_CUDA_CHECK(
+        cudaEventCreateWithFlags(&order_event, cudaEventDisableTiming));
+  }
+  NBLA_CUDA_CHECK(cudaEventRecord(order_event, 0));
+  NBLA_CUDA_CHECK(cudaStreamWaitEvent(s, order_event, 0));
+
+  const size_t bytes = src->size() * sizeof_dtype(dst->dtype());
+  NBLA_CUDA_CHECK(cudaMemcpyAsync(dst->pointer<void>(),
+                                  src->const_pointer<void>(), bytes, kind, s));
+
+  if (keep_src) {
+    auto delete_guard = new shared_ptr<Array>(src->getptr());
+    NBLA_CUDA_CHECK(cudaStreamAddCallback(s, delete_callback, delete_guard, 0));
+  }
+
+  // Record the memory copy as an event into the destination array
+  auto event = get_event(device);
+  NBLA_CUDA_CHECK(cudaEventRecord(*event, s));
+  dst->set_event(std::make_shared<CudaEvent>(event, src->getptr()));
+
+  in_flight_.push_back({event, bytes});
+  stats_.bytes_in_flight += bytes;
+  stats_.max_bytes_in_flight =
+      std::max(stats_.max_bytes_in_flight, stats_.bytes_in_flight);
+  const Array *host = kind == cudaMemcpyHostToDevice ? src : dst;
+  if (!dynamic_cast<const CudaCachedHostArray *>(host)) {
+    stats_.pageable_copies++;
+  }
+  if (kind == cudaMemcpyHostToDevice) {
+    stats_.bytes_htod += bytes;
+    stats_.copies_htod++;
+  } else {
+    stats_.bytes_dtoh += bytes;
+    stats_.copies_dtoh++;
+  }
+}
+
+void CudaSwapEngine::collect_stalls(bool wait) {
+  while (!stalls_.empty()) {
+    Stall stall = stalls_.front();
+    if (wait) {
+      NBLA_CUDA_CHECK(cudaEventSynchronize(stall.end));
+    } else {
+      const cudaError_t status = cudaEventQuery(stall.end);
+      if (status == cudaErrorNotReady) {
+        break;
+      }
+      NBLA_CUDA_CHECK(status);
+    }
+    float ms = 0;
+    NBLA_CUDA_CHECK(cudaEventElapsedTime(&ms, stall.begin, stall.end));
+    stats_.stall_ms += ms;
+    stall_events_[stall.device].push_back(stall);
+    stalls_.pop_front();
+  }
+}
+
+void CudaSwapEngine::prefetch(SyncedArrayPtr array, dtypes dtype,
+                              const Context &ctx) {
+  // A host-resident array is copied by copy() through the synchronizer.
+  auto arr = array->get(dtype, ctx, AsyncFlag::ASYNC);
+  std::lock_guard<std::mutex> lock(mtx_);
+  stats_.prefetches++;
+  if (!dynamic_cast<const CudaCachedUnifiedArray *>(arr)) {
+    return;
+  }
+  const int device = std::stoi(ctx.device_id);
+  int concurrent = 0;
+  NBLA_CUDA_CHECK(cudaDeviceGetAttribute(
+      &concurrent, cudaDevAttrConcurrentManagedAccess, device));
+  if (!concurrent) {
+    // Pages migrate on the first access on this device.
+    return;
+  }
+  const size_t bytes = arr->size() * sizeof_dtype(arr->dtype());
+  NBLA_CUDA_CHECK(cudaMemPrefetchAsync(arr->const_pointer<void>(), bytes,
+                                       device,
+                                       stream(cudaMemcpyHostToDevice, device)));
+}
+
+void CudaSwapEngine::wait_late(cudaEvent_t event) {
+  const int device = cuda_get_device();
+  std::lock_guard<std::mutex> lock(mtx_);
+  stats_.late_waits++;
+  collect_stalls(false);
+  auto &free_stalls = stall_events_[device];
+  Stall stall{device, nullptr, nullptr};
+  if (!free_stalls.empty()) {
+    stall = free_stalls.back();
+    free_stalls.pop_back();
+  } else {
+    NBLA_CUDA_CHECK(cudaEventCreate(&stall.begin));
+    NBLA_CUDA_CHECK(cudaEventCreate(&stall.end));
+  }
+  NBLA_CUDA_CHECK(cudaEventRecord(stall.begin, 0));
+  NBLA_CUDA_CHECK(cudaStreamWaitEvent(0, event, 0));
+  NBLA_CUDA_CHECK(cudaEventRecord(stall.end, 0));
+  stalls_.push_back(stall);
+}
+
+size_t CudaSwapEngine::get_max_in_flight() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return max_in_flight_;
+}
+
+void CudaSwapEngine::set_max_in_flight(size_t max_in_flight) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  max_in_flight_ = max_in_flight;
+}
+
+CudaSwapStatistics CudaSwapEngine::get_statistics() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  retire(false);
+  collect_stalls(false);
+  return stats_;
+}
+
+void CudaSwapEngine::reset_statistics() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  // Finished waits are not carried over into the next statistics.
+  collect_stalls(false);
+  const size_t bytes_in_flight = stats_.bytes_in_flight;
+  stats_ = CudaSwapStatistics();
+  stats_.bytes_in_flight = bytes_in_flight;
+  stats_.max_bytes_in_flight = bytes_in_flight;
+}
+
+void CudaSwapEngine::clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  while (!in_flight_.empty()) {
+    retire(true);
+  }
+  collect_stalls(true);
+  for (auto &device_stalls : stall_events_) {
+    for (auto &stall : device_stalls.second) {
+      NBLA_CUDA_CHECK(cudaEventDestroy(stall.begin));
+      NBLA_CUDA_CHECK(cudaEventDestroy(stall.end));
+    }
+  }
+  stall_events_.clear();
+  std::lock_guard<std::mutex> pool_lock(pool_->mtx);
+  for (auto &device_events : pool_->events) {
+    for (auto event : device_events.second) {
+      NBLA_CUDA_CHECK(cudaEventDestroy(event));
+    }
+  }
+  pool_->events.clear();
+}
+
+NBLA_INSTANTIATE_SINGLETON(NBLA_CUDA_API, CudaSwapEngine);
+
+CudaSwapStatistics cuda_swap_get_statistics() {
+  return SingletonManager::get<CudaSwapEngine>()->get_statistics();
+}
+
+void cuda_swap_reset_statistics() {
+  SingletonManager::get<CudaSwapEngine>()->reset_statistics();
+}
+
+size_t cuda_swap_get_max_in_flight() {
+  return SingletonManager::get<CudaSwapEngine>()->get_max_in_flight();
+}
+
+void cuda_swap_set_max_in_flight(size_t max_in_flight) {
+  SingletonManager::get<CudaSwapEngine>()->set_max_in_flight(max_in_flight);
+}
+
+void cuda_swap_prefetch(SyncedArrayPtr array, dtypes dtype,
+                        const Context &ctx) {
+  SingletonManager::get<CudaSwapEngine>()->prefetch(array, dtype, ctx);
+}
+}
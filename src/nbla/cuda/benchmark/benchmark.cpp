@@ -0,0 +1,352 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// benchmark.cpp
+//
+// Times forward and backward of CUDA functions, and update of solvers, over
+// a grid of shapes, dtypes and layouts. See parse_options() for the options.
+
+#include "benchmark_utils.hpp"
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/cudnn/init.hpp>
+#include <nbla/function/add2.hpp>
+#include <nbla/function/affine.hpp>
+#include <nbla/function/batch_normalization.hpp>
+#include <nbla/function/convolution.hpp>
+#include <nbla/function/mul2.hpp>
+#include <nbla/function/relu.hpp>
+#include <nbla/function/sigmoid.hpp>
+#include <nbla/function/softmax.hpp>
+#include <nbla/function/sum.hpp>
+#include <nbla/solver/adam.hpp>
+#include <nbla/solver/momentum.hpp>
+#include <nbla/solver/sgd.hpp>
+#include <nbla/variable.hpp>
+
+#include <cuda_runtime.h>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace nbla {
+namespace benchmark {
+
+namespace {
+
+Size_t size_of(const Shape_t &shape) {
+  Size_t size = 1;
+  for (auto s : shape) {
+    size *= s;
+  }
+  return size;
+}
+
+/** A function with its inputs for a case. */
+struct FunctionSetup {
+  FunctionPtr function;
+  vector<Shape_t> inputs;
+  /** Operations of forward. Backward is taken as twice of it. */
+  double flops;
+};
+
+typedef std::function<FunctionSetup(const Context &, const BenchmarkCase &)>
+    FunctionFactory;
+
+/** Shape in the layout of the case, and the channel axis. */
+Shape_t layout_shape(const BenchmarkCase &c, int &channel_axis) {
+  Shape_t shape = c.shape;
+  channel_axis = shape.size() > 1 ? 1 : 0;
+  if (c.layout == "nhwc" && shape.size() > 2) {
+    shape.erase(shape.begin() + 1);
+    shape.push_back(c.shape[1]);
+    channel_axis = shape.size() - 1;
+  }
+  return shape;
+}
+
+/** Functions by name. Each gives the arguments which fit any shape. */
+const std::map<string, FunctionFactory> &function_factories() {
+  static const std::map<string, FunctionFactory> factories{
+      {"ReLU",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         return FunctionSetup{create_ReLU(ctx, false), {c.shape},
+                              double(size_of(c.shape))};
+       }},
+      {"Sigmoid",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         return FunctionSetup{create_Sigmoid(ctx), {c.shape},
+                              4.0 * size_of(c.shape)};
+       }},
+      {"Add2",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         return FunctionSetup{create_Add2(ctx, false), {c.shape, c.shape},
+                              double(size_of(c.shape))};
+       }},
+      {"Mul2",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         return FunctionSetup{create_Mul2(ctx, false), {c.shape, c.shape},
+                              double(size_of(c.shape))};
+       }},
+      {"Affine",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         // As many output units as the last axis.
+         const Size_t n = c.shape[0];
+         const Size_t k = size_of(c.shape) / n;
+         const Size_t units = c.shape.back();
+         return FunctionSetup{create_Affine(ctx, 1),
+                              {c.shape, Shape_t{k, units}, Shape_t{units}},
+                              2.0 * n * k * units};
+       }},
+      {"Convolution",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         // 3x3 with the same number of output channels and spatial size.
+         int channel_axis;
+         const Shape_t x = layout_shape(c, channel_axis);
+         NBLA_CHECK(x.size() == 4, error_code::value,
+                    "Convolution requires a 4-d shape.");
+         const Size_t channels = x[channel_axis];
+         const bool channel_last = channel_axis == 3;
+         const Shape_t w = channel_last ? Shape_t{channels, 3, 3, channels}
+                                        : Shape_t{channels, channels, 3, 3};
+         return FunctionSetup{
+             create_Convolution(ctx, 1, {1, 1}, {1, 1}, {1, 1}, 1,
+                                channel_last),
+             {x, w, Shape_t{channels}}, 2.0 * size_of(x) * channels * 9};
+       }},
+      {"BatchNormalization",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         int channel_axis;
+         const Shape_t x = layout_shape(c, channel_axis);
+         Shape_t param(x.size(), 1);
+         param[channel_axis] = x[channel_axis];
+         return FunctionSetup{create_BatchNormalization(ctx, {channel_axis},
+                                                        0.9, 1e-5, true,
+                                                        false, false),
+                              {x, param, param, param, param},
+                              8.0 * size_of(x)};
+       }},
+      {"Softmax",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         int channel_axis;
+         const Shape_t x = layout_shape(c, channel_axis);
+         return FunctionSetup{create_Softmax(ctx, channel_axis), {x},
+                              5.0 * size_of(x)};
+       }},
+      {"Sum",
+       [](const Context &ctx, const BenchmarkCase &c) {
+         // Sum over all axes but the first.
+         vector<int> axes;
+         for (int i = 1; i < static_cast<int>(c.shape.size()); i++) {
+           axes.push_back(i);
+         }
+         return FunctionSetup{create_Sum(ctx, axes, false), {c.shape},
+                              double(size_of(c.shape))};
+       }},
+  };
+  return factories;
+}
+
+/** A solver with its bytes and operations per parameter element. */
+struct SolverSetup {
+  SolverPtr solver;
+  int accesses;
+  int flops;
+};
+
+typedef std::function<SolverSetup(const Context &)> SolverFactory;
+
+const std::map<string, SolverFactory> &solver_factories() {
+  static const std::map<string, SolverFactory> factories{
+      {"Sgd",
+       [](const Context &ctx) {
+         return SolverSetup{create_SgdSolver(ctx, 0.01), 3, 2};
+       }},
+      {"Momentum",
+       [](const Context &ctx) {
+         return SolverSetup{create_MomentumSolver(ctx, 0.01, 0.9), 5, 4};
+       }},
+      {"Adam",
+       [](const Context &ctx) {
+         return SolverSetup{create_AdamSolver(ctx, 0.001, 0.9, 0.999, 1e-8),
+                            7, 12};
+       }},
+  };
+  return factories;
+}
+
+/** Average time of `iterations` calls after `warmup` calls, in ms. */
+double time_ms(const std::function<void()> &call, int warmup,
+               int iterations) {
+  for (int i = 0; i < warmup; i++) {
+    call();
+  }
+  cudaEvent_t start, stop;
+  NBLA_CUDA_CHECK(cudaEventCreate(&start));
+  NBLA_CUDA_CHECK(cudaEventCreate(&stop));
+  NBLA_CUDA_CHECK(cudaEventRecord(start, 0));
+  for (int i = 0; i < iterations; i++) {
+    call();
+  }
+  NBLA_CUDA_CHECK(cudaEventRecord(stop, 0));
+  NBLA_CUDA_CHECK(cudaEventSynchronize(stop));
+  float ms;
+  NBLA_CUDA_CHECK(cudaEventElapsedTime(&ms, start, stop));
+  NBLA_CUDA_CHECK(cudaEventDestroy(start));
+  NBLA_CUDA_CHECK(cudaEventDestroy(stop));
+  return ms / iterations;
+}
+
+void fill_random(VariablePtr v, const Context &cpu_ctx,
+                 std::mt19937 &engine) {
+  std::uniform_real_distribution<float> dist(0.1f, 1.0f);
+  float *data = v->cast_data_and_get_pointer<float>(cpu_ctx, true);
+  for (Size_t i = 0; i < v->size(); i++) {
+    data[i] = dist(engine);
+  }
+}
+
+bool run_case(const BenchmarkCase &c, const BenchmarkOptions &options,
+              BenchmarkResult &result) {
+  const string device = std::to_string(options.device);
+  const Context ctx{
+      {"cudnn:" + c.dtype, "cuda:" + c.dtype, "cpu:float"},
+      "CudaCachedArray",
+      device};
+  const Context cpu_ctx{{"cpu:float"}, "CpuCachedArray", "0"};
+  const double elem_size = c.dtype == "half" ? 2 : 4;
+  std::mt19937 engine(313);
+  result.bench_case = c;
+
+  auto fit = function_factories().find(c.name);
+  if (fit != function_factories().end()) {
+    FunctionSetup setup = fit->second(ctx, c);
+    vector<VariablePtr> inputs, outputs{std::make_shared<Variable>()};
+    Variables in, out{outputs[0].get()};
+    for (const auto &shape : setup.inputs) {
+      inputs.push_back(std::make_shared<Variable>(shape));
+      in.push_back(inputs.back().get());
+      fill_random(inputs.back(), cpu_ctx, engine);
+    }
+    setup.function->setup(in, out);
+    outputs[0]->grad()->fill(1);
+    double in_bytes = 0;
+    for (auto v : in) {
+      in_bytes += v->size() * elem_size;
+    }
+    const double out_bytes = outputs[0]->size() * elem_size;
+    const vector<bool> propagate_down(in.size(), true);
+    const vector<bool> accum(in.size(), false);
+    result.implementation = setup.function->name();
+    result.forward_ms = time_ms([&]() { setup.function->forward(in, out); },
+                                options.warmup, options.iterations);
+    result.backward_ms = time_ms(
+        [&]() {
+          setup.function->backward(in, out, propagate_down, accum);
+        },
+        options.warmup, options.iterations);
+    // Reads of the inputs and writes of the outputs at least.
+    result.forward_bytes = in_bytes + out_bytes;
+    result.backward_bytes = 2 * in_bytes + out_bytes;
+    result.forward_flops = setup.flops;
+    result.backward_flops = 2 * setup.flops;
+    return true;
+  }
+
+  auto sit = solver_factories().find(c.name);
+  if (sit != solver_factories().end()) {
+    SolverSetup setup = sit->second(ctx);
+    auto param = std::make_shared<Variable>(c.shape);
+    fill_random(param, cpu_ctx, engine);
+    param->grad()->fill(0.01);
+    setup.solver->set_parameters({{"param", param}});
+    result.implementation = setup.solver->name();
+    result.forward_ms = time_ms([&]() { setup.solver->update(); },
+                                options.warmup, options.iterations);
+    result.forward_bytes = setup.accesses * param->size() * elem_size;
+    result.forward_flops = double(setup.flops) * param->size();
+    return true;
+  }
+  return false;
+}
+
+bool layout_sensitive(const string &name) {
+  return name == "Convolution" || name == "BatchNormalization" ||
+         name == "Softmax";
+}
+
+int run(const vector<string> &args) {
+  const BenchmarkOptions options = parse_options(args);
+  init_cudnn();
+  cuda_set_device(options.device);
+  const cudaDeviceProp prop = cuda_get_current_device_properties();
+  const Roofline roofline = compute_roofline(
+      prop.memoryClockRate, prop.memoryBusWidth, prop.multiProcessorCount,
+      prop.clockRate, prop.major, prop.minor);
+
+  vector<BenchmarkResult> results;
+  for (const auto &c : expand_grid(options)) {
+    // The layout does not matter to the others.
+    if (!layout_sensitive(c.name) && c.layout != options.layouts[0]) {
+      continue;
+    }
+    BenchmarkResult result;
+    if (!run_case(c, options, result)) {
+      std::cerr << "Unknown function or solver: " << c.name << std::endl;
+      return 1;
+    }
+    results.push_back(result);
+  }
+
+  std::cout << prop.name << std::endl;
+  std::cout << format_report(results, roofline);
+
+  if (!options.baseline_out.empty()) {
+    std::ofstream ofs(options.baseline_out);
+    ofs << to_baseline(results);
+  }
+  if (!options.baseline_in.empty()) {
+    std::ifstream ifs(options.baseline_in);
+    NBLA_CHECK(ifs, error_code::value, "Cannot open %s.",
+               options.baseline_in.c_str());
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    const auto regressions = find_regressions(
+        results, parse_baseline(ss.str()), options.tolerance);
+    for (const auto &r : regressions) {
+      std::cout << "Regression: " << r << std::endl;
+    }
+    if (!regressions.empty()) {
+      return 2;
+    }
+  }
+  return 0;
+}
+}
+}
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    return nbla::benchmark::run(
+        std::vector<std::string>(argv + 1, argv + argc));
+  } catch (std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
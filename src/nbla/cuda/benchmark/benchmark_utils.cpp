@@ -0,0 +1,304 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark_utils.hpp"
+
+#include <nbla/exception.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace nbla {
+namespace benchmark {
+
+vector<string> split(const string &s, char delimiter) {
+  vector<string> tokens;
+  std::stringstream ss(s);
+  string token;
+  while (std::getline(ss, token, delimiter)) {
+    if (!token.empty()) {
+      tokens.push_back(token);
+    }
+  }
+  return tokens;
+}
+
+Shape_t parse_shape(const string &s) {
+  Shape_t shape;
+  for (const auto &dim : split(s, 'x')) {
+    size_t pos = 0;
+    long long value = -1;
+    try {
+      value = std::stoll(dim, &pos);
+    } catch (std::exception &) {
+    }
+    NBLA_CHECK(pos == dim.size() && value > 0, error_code::value,
+               "Invalid shape: %s. Positive sizes joined by 'x' required.",
+               s.c_str());
+    shape.push_back(value);
+  }
+  NBLA_CHECK(!shape.empty(), error_code::value, "Empty shape.");
+  return shape;
+}
+
+string shape_to_string(const Shape_t &shape) {
+  std::stringstream ss;
+  for (size_t i = 0; i < shape.size(); i++) {
+    ss << (i ? "x" : "") << shape[i];
+  }
+  return ss.str();
+}
+
+static int parse_int(const string &name, const string &value) {
+  size_t pos = 0;
+  int ret = 0;
+  try {
+    ret = std::stoi(value, &pos);
+  } catch (std::exception &) {
+  }
+  NBLA_CHECK(pos == value.size() && ret >= 0, error_code::value,
+             "Invalid value: %s %s. Non-negative integer required.",
+             name.c_str(), value.c_str());
+  return ret;
+}
+
+BenchmarkOptions parse_options(const vector<string> &args) {
+  BenchmarkOptions options;
+  for (size_t i = 0; i < args.size(); i += 2) {
+    const string &name = args[i];
+    NBLA_CHECK(i + 1 < args.size(), error_code::value,
+               "Missing value of %s.", name.c_str());
+    const string &value = args[i + 1];
+    if (name == "--names") {
+      options.names = split(value, ',');
+    } else if (name == "--shapes") {
+      options.shapes.clear();
+      for (const auto &shape : split(value, ',')) {
+        options.shapes.push_back(parse_shape(shape));
+      }
+    } else if (name == "--dtypes") {
+      options.dtypes = split(value, ',');
+      for (const auto &dtype : options.dtypes) {
+        NBLA_CHECK(dtype == "float" || dtype == "half", error_code::value,
+                   "Unsupported dtype: %s.", dtype.c_str());
+      }
+    } else if (name == "--layouts") {
+      options.layouts = split(value, ',');
+      for (const auto &layout : options.layouts) {
+        NBLA_CHECK(layout == "nchw" || layout == "nhwc", error_code::value,
+                   "Unsupported layout: %s.", layout.c_str());
+      }
+    } else if (name == "--device") {
+      options.device = parse_int(name, value);
+    } else if (name == "--warmup") {
+      options.warmup = parse_int(name, value);
+    } else if (name == "--iterations") {
+      options.iterations = parse_int(name, value);
+    } else if (name == "--baseline-out") {
+      options.baseline_out = value;
+    } else if (name == "--baseline-in") {
+      options.baseline_in = value;
+    } else if (name == "--tolerance") {
+      options.tolerance = std::stod(value);
+    } else {
+      NBLA_ERROR(error_code::value, "Unknown option: %s.", name.c_str());
+    }
+  }
+  NBLA_CHECK(!options.names.empty(), error_code::value,
+             "No function given by --names.");
+  NBLA_CHECK(!options.shapes.empty(), error_code::value,
+             "No shape given by --shapes.");
+  NBLA_CHECK(options.iterations > 0, error_code::value,
+             "--iterations must be positive.");
+  return options;
+}
+
+vector<BenchmarkCase> expand_grid(const BenchmarkOptions &options) {
+  vector<BenchmarkCase> cases;
+  for (const auto &name : options.names) {
+    for (const auto &shape : options.shapes) {
+      for (const auto &dtype : options.dtypes) {
+        for (const auto &layout : options.layouts) {
+          cases.push_back(BenchmarkCase{name, shape, dtype, layout});
+        }
+      }
+    }
+  }
+  return cases;
+}
+
+string case_key(const BenchmarkCase &c) {
+  return c.name + "," + shape_to_string(c.shape) + "," + c.dtype + "," +
+         c.layout;
+}
+
+Roofline compute_roofline(int memory_clock_rate_khz, int memory_bus_width,
+                          int multiprocessor_count, int clock_rate_khz,
+                          int major, int minor) {
+  // FP32 cores per multiprocessor.
+  int cores = 64;
+  if (major == 2) {
+    cores = minor == 1 ? 48 : 32;
+  } else if (major == 3) {
+    cores = 192;
+  } else if (major == 5) {
+    cores = 128;
+  } else if (major == 6 || major == 8) {
+    cores = minor == 0 ? 64 : 128;
+  } else if (major >= 9) {
+    cores = 128;
+  }
+  Roofline roofline;
+  // Double data rate.
+  roofline.bandwidth_gbps =
+      2.0 * memory_clock_rate_khz * 1e3 * (memory_bus_width / 8) / 1e9;
+  roofline.tflops =
+      2.0 * cores * multiprocessor_count * clock_rate_khz * 1e3 / 1e12;
+  return roofline;
+}
+
+double to_gbps(double bytes, double ms) {
+  return ms > 0 ? bytes / (ms * 1e-3) / 1e9 : 0;
+}
+
+double to_tflops(double flops, double ms) {
+  return ms > 0 ? flops / (ms * 1e-3) / 1e12 : 0;
+}
+
+string format_report(const vector<BenchmarkResult> &results,
+                     const Roofline &roofline) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(3);
+  ss << "Peak: " << roofline.bandwidth_gbps << " GB/s, " << roofline.tflops
+     << " TFLOP/s (FP32)\n";
+  ss << std::left << std::setw(44) << "case" << std::setw(28)
+     << "implementation" << std::right << std::setw(10) << "fwd ms"
+     << std::setw(10) << "GB/s" << std::setw(10) << "TFLOP/s" << std::setw(8)
+     << "%peak" << std::setw(10) << "bwd ms" << std::setw(10) << "GB/s"
+     << std::setw(10) << "TFLOP/s" << std::setw(8) << "%peak"
+     << "\n";
+  auto write = [&](double ms, double bytes, double flops) {
+    const double gbps = to_gbps(bytes, ms);
+    const double tflops = to_tflops(flops, ms);
+    // The achieved fraction of the roofline bound of the call.
+    const double bound_ms =
+        std::max(roofline.bandwidth_gbps > 0
+                     ? bytes / (roofline.bandwidth_gbps * 1e9) * 1e3
+                     : 0,
+                 roofline.tflops > 0 ? flops / (roofline.tflops * 1e12) * 1e3
+                                     : 0);
+    const double peak = ms > 0 ? bound_ms / ms * 100 : 0;
+    ss << std::setw(10) << ms << std::setw(10) << gbps << std::setw(10)
+       << tflops << std::setw(8) << std::setprecision(1) << peak
+       << std::setprecision(3);
+  };
+  for (const auto &r : results) {
+    ss << std::left << std::setw(44) << case_key(r.bench_case)
+       << std::setw(28) << r.implementation << std::right;
+    write(r.forward_ms, r.forward_bytes, r.forward_flops);
+    write(r.backward_ms, r.backward_bytes, r.backward_flops);
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+static const char *baseline_header =
+    "name,shape,dtype,layout,implementation,forward_ms,backward_ms,"
+    "forward_bytes,backward_bytes,forward_flops,backward_flops";
+
+string to_baseline(const vector<BenchmarkResult> &results) {
+  std::stringstream ss;
+  ss << std::setprecision(9);
+  ss << baseline_header << "\n";
+  for (const auto &r : results) {
+    ss << case_key(r.bench_case) << "," << r.implementation << ","
+       << r.forward_ms << "," << r.backward_ms << "," << r.forward_bytes
+       << "," << r.backward_bytes << "," << r.forward_flops << ","
+       << r.backward_flops << "\n";
+  }
+  return ss.str();
+}
+
+vector<BenchmarkResult> parse_baseline(const string &text) {
+  vector<BenchmarkResult> results;
+  std::stringstream ss(text);
+  string line;
+  bool header = true;
+  while (std::getline(ss, line)) {
+    if (header) {
+      NBLA_CHECK(line == baseline_header, error_code::value,
+                 "Unknown baseline header: %s.", line.c_str());
+      header = false;
+      continue;
+    }
+    if (line.empty()) {
+      continue;
+    }
+    // Empty fields are kept, e.g. an empty implementation.
+    vector<string> fields;
+    std::stringstream ls(line);
+    string field;
+    while (std::getline(ls, field, ',')) {
+      fields.push_back(field);
+    }
+    NBLA_CHECK(fields.size() == 11, error_code::value,
+               "Invalid baseline line: %s.", line.c_str());
+    BenchmarkResult r;
+    r.bench_case = BenchmarkCase{fields[0], parse_shape(fields[1]), fields[2],
+                                 fields[3]};
+    r.implementation = fields[4];
+    r.forward_ms = std::stod(fields[5]);
+    r.backward_ms = std::stod(fields[6]);
+    r.forward_bytes = std::stod(fields[7]);
+    r.backward_bytes = std::stod(fields[8]);
+    r.forward_flops = std::stod(fields[9]);
+    r.backward_flops = std::stod(fields[10]);
+    results.push_back(r);
+  }
+  return results;
+}
+
+vector<string> find_regressions(const vector<BenchmarkResult> &results,
+                                const vector<BenchmarkResult> &baseline,
+                                double tolerance) {
+  std::map<string, const BenchmarkResult *> base;
+  for (const auto &b : baseline) {
+    base[case_key(b.bench_case)] = &b;
+  }
+  vector<string> regressions;
+  for (const auto &r : results) {
+    const string key = case_key(r.bench_case);
+    auto it = base.find(key);
+    if (it == base.end()) {
+      continue;
+    }
+    const BenchmarkResult &b = *it->second;
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    if (r.forward_ms > b.forward_ms * (1 + tolerance)) {
+      ss << " forward " << b.forward_ms << " -> " << r.forward_ms << " ms";
+    }
+    if (r.backward_ms > b.backward_ms * (1 + tolerance)) {
+      ss << " backward " << b.backward_ms << " -> " << r.backward_ms << " ms";
+    }
+    if (!ss.str().empty()) {
+      regressions.push_back(key + ":" + ss.str());
+    }
+  }
+  return regressions;
+}
+}
+}
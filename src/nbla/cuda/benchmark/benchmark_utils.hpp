@@ -0,0 +1,124 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** Grid setup and reporting of cudabench.
+
+    Nothing here uses the GPU, so it is tested in clibtest without one.
+ */
+#ifndef __NBLA_CUDA_BENCHMARK_BENCHMARK_UTILS_HPP__
+#define __NBLA_CUDA_BENCHMARK_BENCHMARK_UTILS_HPP__
+
+#include <nbla/common.hpp>
+
+#include <string>
+#include <vector>
+
+namespace nbla {
+namespace benchmark {
+
+using std::string;
+using std::vector;
+
+/** A function or solver with an input shape, a dtype and a layout.
+
+    `shape` is given in NCHW. With the "nhwc" layout, functions which have a
+    channel-last variant run on the permuted shape.
+ */
+struct BenchmarkCase {
+  string name;
+  Shape_t shape;
+  string dtype;
+  string layout;
+};
+
+struct BenchmarkOptions {
+  vector<string> names;
+  vector<Shape_t> shapes;
+  vector<string> dtypes{"float"};
+  vector<string> layouts{"nchw"};
+  int device = 0;
+  int warmup = 10;
+  int iterations = 100;
+  string baseline_out;    ///< Baseline file written after the run
+  string baseline_in;     ///< Baseline file compared with
+  double tolerance = 0.1; ///< Relative slowdown reported as a regression
+};
+
+/** Peak numbers of a device. */
+struct Roofline {
+  double bandwidth_gbps;
+  double tflops;
+};
+
+/** Times of a case with the bytes and operations of a single call. */
+struct BenchmarkResult {
+  BenchmarkCase bench_case;
+  string implementation;
+  double forward_ms = 0;
+  double backward_ms = 0;
+  double forward_bytes = 0;
+  double backward_bytes = 0;
+  double forward_flops = 0;
+  double backward_flops = 0;
+};
+
+vector<string> split(const string &s, char delimiter);
+
+/** Parse a shape such as "8x64x56x56". */
+Shape_t parse_shape(const string &s);
+string shape_to_string(const Shape_t &shape);
+
+/** Parse the command line. Lists are comma separated.
+
+    --names ReLU,Convolution --shapes 8x64x56x56,32x256x14x14
+    --dtypes float,half --layouts nchw,nhwc --device 0 --warmup 10
+    --iterations 100 --baseline-out new.csv --baseline-in old.csv
+    --tolerance 0.1
+ */
+BenchmarkOptions parse_options(const vector<string> &args);
+
+/** All the combinations of the grid. */
+vector<BenchmarkCase> expand_grid(const BenchmarkOptions &options);
+
+/** Unique key of a case in baseline files. */
+string case_key(const BenchmarkCase &c);
+
+/** Roofline from cudaDeviceProp fields.
+
+    The FP32 peak assumes one FMA per CUDA core per clock.
+ */
+Roofline compute_roofline(int memory_clock_rate_khz, int memory_bus_width,
+                          int multiprocessor_count, int clock_rate_khz,
+                          int major, int minor);
+
+double to_gbps(double bytes, double ms);
+double to_tflops(double flops, double ms);
+
+/** Human readable table with the fraction of the roofline achieved. */
+string format_report(const vector<BenchmarkResult> &results,
+                     const Roofline &roofline);
+
+/** CSV with a header line, one result per line. */
+string to_baseline(const vector<BenchmarkResult> &results);
+vector<BenchmarkResult> parse_baseline(const string &text);
+
+/** Cases slower than the baseline by more than `tolerance` in forward or
+    backward time, one description per case.
+ */
+vector<string> find_regressions(const vector<BenchmarkResult> &results,
+                                const vector<BenchmarkResult> &baseline,
+                                double tolerance);
+}
+}
+#endif
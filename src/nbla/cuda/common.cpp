@@ -50,4 +50,22 @@ int cuda_get_current_device_attribute(cudaDeviceAttr attr) {
 
   return value;
 }
+
+static thread_local cudaStream_t current_stream = 0;
+
+cudaStream_t cuda_get_current_stream() { return current_stream; }
+
+void cuda_set_current_stream(cudaStream_t stream) { current_stream = stream; }
+
+void cuda_check_not_capturing(const char *name) {
+  if (!current_stream) {
+    return;
+  }
+  cudaStreamCaptureStatus status;
+  NBLA_CUDA_CHECK(cudaStreamIsCapturing(current_stream, &status));
+  NBLA_CHECK(status == cudaStreamCaptureStatusNone, error_code::target_specific,
+             "%s synchronizes with the host and cannot be captured into a "
+             "CUDA graph.",
+             name);
+}
 }
@@ -25,6 +25,10 @@ namespace nbla {
 // Get preferred cuBLAS GEMM algorithm. Only if data type is half, the use of
 // Tensor Core is allowed.
 inline cublasGemmAlgo_t infer_gemm_algo_by_type(cudaDataType_t dt) {
+#if CUDA_VERSION >= 11000
+  if (dt == CUDA_R_16BF)
+    return CUBLAS_GEMM_DEFAULT_TENSOR_OP;
+#endif
   return dt == CUDA_R_16F ? CUBLAS_GEMM_DEFAULT_TENSOR_OP : CUBLAS_GEMM_DEFAULT;
 }
 #endif
@@ -90,6 +94,24 @@ void cublas_gemm<half>(cublasHandle_t handle, cublasOperation_t op_x,
 #endif
 }
 
+#if NBLA_CUDA_BFLOAT16
+// bfloat16 storage with float computation. Only available on CUDA 11 or
+// later, where cublasGemmEx supports CUDA_R_16BF.
+template <>
+void cublas_gemm<__nv_bfloat16>(cublasHandle_t handle, cublasOperation_t op_x,
+                                cublasOperation_t op_y, int m, int n, int k,
+                                float alpha, const __nv_bfloat16 *x, int lda,
+                                const __nv_bfloat16 *y, int ldb, float beta,
+                                __nv_bfloat16 *z, int ldc) {
+  float a = alpha;
+  float b = beta;
+  auto dt = cuda_data_type<__nv_bfloat16>::type();
+  NBLA_CUBLAS_CHECK(cublasGemmEx(handle, op_x, op_y, m, n, k, &a, x, dt, lda,
+                                 y, dt, ldb, &b, z, dt, ldc, CUBLAS_COMPUTE_32F,
+                                 infer_gemm_algo_by_type(dt)));
+}
+#endif
+
 // ----------------------------------------------------------------------
 // Gemv
 // ----------------------------------------------------------------------
@@ -129,6 +151,9 @@ void cublas_dot(cublasHandle_t handle, int n, const T *x, int incx, const T *y,
 DEF_CUBLAS_DOT(half);
 DEF_CUBLAS_DOT(float);
 DEF_CUBLAS_DOT(double);
+#if NBLA_CUDA_BFLOAT16
+DEF_CUBLAS_DOT(__nv_bfloat16);
+#endif
 #else // CUDA_VERSION < 8000
 template <>
 void cublas_dot<double>(cublasHandle_t handle, int n, const double *x, int incx,
@@ -180,6 +205,9 @@ void cublas_gemm_batched(cublasHandle_t handle, cublasOperation_t op_x,
 DEF_CUBLAS_GEMM_BATCHED(half);
 DEF_CUBLAS_GEMM_BATCHED(float);
 DEF_CUBLAS_GEMM_BATCHED(double);
+#if NBLA_CUDA_BFLOAT16
+DEF_CUBLAS_GEMM_BATCHED(__nv_bfloat16);
+#endif
 #else  // CUDA_VERSION < 9010
 template <>
 void cublas_gemm_batched<double>(cublasHandle_t handle, cublasOperation_t op_x,
@@ -332,6 +360,20 @@ void cublas_gemm_strided_batched<half>(
                       beta, z_, ldc);
   }
 }
+
+#if NBLA_CUDA_BFLOAT16
+template <>
+void cublas_gemm_strided_batched<__nv_bfloat16>(
+    cublasHandle_t handle, cublasOperation_t op_x, cublasOperation_t op_y,
+    int m, int n, int k, float alpha, const __nv_bfloat16 *x, int lda,
+    int stride_a, const __nv_bfloat16 *y, int ldb, int stride_b, float beta,
+    __nv_bfloat16 *z, int ldc, int stride_c, int batch_count) {
+  // Same batch count limitation as half.
+  cublas_gemm_strided_batched_chunk<__nv_bfloat16, 1 << 15>(
+      handle, op_x, op_y, m, n, k, alpha, x, lda, stride_a, y, ldb, stride_b,
+      beta, z, ldc, stride_c, batch_count);
+}
+#endif
 #endif // CUDA_VERSION >= 8000
 
 // ----------------------------------------------------------------------
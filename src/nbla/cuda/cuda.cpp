@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <nbla/cuda/cuda.hpp>
+#include <nbla/cuda/graph.hpp>
 #include <nbla/cuda/utils/random.hpp>
 #include <nbla/singleton_manager-internal.hpp>
 
@@ -85,8 +86,13 @@ cublasHandle_t Cuda::cublas_handle(int device) {
   if (it == this->cublas_handles_.end()) {
     cublasHandle_t handle;
     NBLA_CUBLAS_CHECK(cublasCreate(&handle));
-    this->cublas_handles_.insert({device, handle});
-    return handle;
+    it = this->cublas_handles_.insert({device, handle}).first;
+  }
+  // Follow the stream of a CUDA graph being captured.
+  cudaStream_t stream;
+  NBLA_CUBLAS_CHECK(cublasGetStream(it->second, &stream));
+  if (stream != cuda_get_current_stream()) {
+    NBLA_CUBLAS_CHECK(cublasSetStream(it->second, cuda_get_current_stream()));
   }
   return it->second;
 }
@@ -123,10 +129,15 @@ void Cuda::create_lms_streams(int device) {
 
   cuda_set_device(device);
 
+  // Swap-in is given the greatest priority since the next function waits for
+  // it, while swap-out only frees memory.
+  int least_priority, greatest_priority;
   NBLA_CUDA_CHECK(
-      cudaStreamCreateWithFlags(&stream_HtoD, cudaStreamNonBlocking));
-  NBLA_CUDA_CHECK(
-      cudaStreamCreateWithFlags(&stream_DtoH, cudaStreamNonBlocking));
+      cudaDeviceGetStreamPriorityRange(&least_priority, &greatest_priority));
+  NBLA_CUDA_CHECK(cudaStreamCreateWithPriority(
+      &stream_HtoD, cudaStreamNonBlocking, greatest_priority));
+  NBLA_CUDA_CHECK(cudaStreamCreateWithPriority(
+      &stream_DtoH, cudaStreamNonBlocking, least_priority));
 }
 
 #if CUDA_VERSION >= 10020 && CUDNN_VERSION >= 8000
@@ -226,7 +237,14 @@ void Cuda::register_array_class(const string &name) {
   array_classes_.push_back(name);
 }
 
-shared_ptr<Allocator> Cuda::caching_allocator() { return caching_allocator_; }
+shared_ptr<Allocator> Cuda::caching_allocator() {
+  // Buffers used by a CUDA graph come from its own pool.
+  auto graph = CudaGraph::capturing();
+  if (graph) {
+    return graph->allocator();
+  }
+  return caching_allocator_;
+}
 shared_ptr<Allocator> Cuda::naive_allocator() { return naive_allocator_; }
 shared_ptr<Allocator> Cuda::unified_allocator() { return unified_allocator_; }
 shared_ptr<Allocator> Cuda::pinned_allocator() { return pinned_allocator_; }
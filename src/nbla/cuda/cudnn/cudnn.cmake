@@ -13,5 +13,6 @@
 # limitations under the License.
 list(APPEND NBLA_CUDNN_CPP_SRCS
   cudnn/cudnn.cpp
+  cudnn/cudnn_backend.cpp
   cudnn/init.cpp
   )
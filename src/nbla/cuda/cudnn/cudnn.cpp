@@ -515,6 +515,10 @@ void CudnnConvResource::find_best_algorithms() {
   auto workspace_limit = cudnn_handle_manager->get_workspace_limit_in_bytes();
   bool deterministic = cudnn_handle_manager->get_deterministic_option();
   bool heuristic = cudnn_handle_manager->get_heuristic_option();
+  if (!heuristic) {
+    // The algorithms are timed with synchronization.
+    cuda_check_not_capturing("Search of convolution algorithms");
+  }
 
 #if CUDNN_VERSION >= 3000
   this->find_forward_algorithm(workspace_limit, deterministic, heuristic);
@@ -734,14 +738,21 @@ cudnnHandle_t CudnnHandleManager::handle(int device, cudaStream_t stream) {
   auto &tid_handles = this->handles_[device];
   auto &dev_handles = tid_handles[tid];
   auto handle = dev_handles[stream];
-  if (handle) {
-    return *handle;
+  if (!handle) {
+    handle = make_shared<cudnnHandle_t>();
+    NBLA_CUDNN_CHECK(cudnnCreate(handle.get()));
+    NBLA_CUDNN_CHECK(cudnnSetStream(*handle, stream));
+    tid_handles[tid][stream] = handle;
+  }
+  if (!stream) {
+    // The handle of the null stream follows the stream of a CUDA graph being
+    // captured in this thread.
+    cudaStream_t current;
+    NBLA_CUDNN_CHECK(cudnnGetStream(*handle, &current));
+    if (current != cuda_get_current_stream()) {
+      NBLA_CUDNN_CHECK(cudnnSetStream(*handle, cuda_get_current_stream()));
+    }
   }
-
-  handle = make_shared<cudnnHandle_t>();
-  NBLA_CUDNN_CHECK(cudnnCreate(handle.get()));
-  NBLA_CUDNN_CHECK(cudnnSetStream(*handle, stream));
-  tid_handles[tid][stream] = handle;
   return *handle;
 }
 
@@ -0,0 +1,416 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Fused convolution on the cuDNN v8 backend (graph) API.
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/cudnn/cudnn.hpp>
+#include <nbla/nd_array.hpp>
+
+#if CUDNN_VERSION >= 8000
+
+#include <limits>
+
+namespace nbla {
+
+namespace {
+
+// Unique ids of the tensors of the operation graph.
+enum {
+  UID_X = 1,
+  UID_W,
+  UID_B,
+  UID_Y,
+  UID_CONV,
+};
+
+/* RAII wrapper of a cuDNN backend descriptor.
+ */
+struct BackendDescriptor {
+  cudnnBackendDescriptor_t desc{nullptr};
+
+  explicit BackendDescriptor(cudnnBackendDescriptorType_t type) {
+    NBLA_CUDNN_CHECK(cudnnBackendCreateDescriptor(type, &desc));
+  }
+  ~BackendDescriptor() {
+    if (desc)
+      cudnnBackendDestroyDescriptor(desc);
+  }
+  template <typename V>
+  void set(cudnnBackendAttributeName_t name, cudnnBackendAttributeType_t type,
+           int64_t count, const V *values) {
+    NBLA_CUDNN_CHECK(
+        cudnnBackendSetAttribute(desc, name, type, count, values));
+  }
+  void set(cudnnBackendAttributeName_t name,
+           const cudnnBackendDescriptor_t &value) {
+    set(name, CUDNN_TYPE_BACKEND_DESCRIPTOR, 1, &value);
+  }
+  void finalize() { NBLA_CUDNN_CHECK(cudnnBackendFinalize(desc)); }
+  cudnnBackendDescriptor_t release() {
+    auto d = desc;
+    desc = nullptr;
+    return d;
+  }
+  DISABLE_COPY_AND_ASSIGN(BackendDescriptor);
+};
+
+typedef std::unique_ptr<BackendDescriptor> BackendDescriptorPtr;
+
+/* Tensor descriptor of NC(D)HW dims. The strides follow the memory layout,
+   i.e. channels are the innermost axis if channel_last.
+ */
+BackendDescriptorPtr create_tensor(int64_t uid, cudnnDataType_t dtype,
+                                   const vector<int64_t> &dims,
+                                   bool channel_last, bool is_virtual) {
+  vector<int64_t> strides(dims.size());
+  if (channel_last) {
+    // Memory order: N, spatial..., C
+    int64_t s = 1;
+    strides[1] = s;
+    s *= dims[1];
+    for (int i = dims.size() - 1; i >= 2; i--) {
+      strides[i] = s;
+      s *= dims[i];
+    }
+    strides[0] = s;
+  } else {
+    int64_t s = 1;
+    for (int i = dims.size() - 1; i >= 0; i--) {
+      strides[i] = s;
+      s *= dims[i];
+    }
+  }
+  const int64_t alignment = 16;
+  BackendDescriptorPtr t(
+      new BackendDescriptor(CUDNN_BACKEND_TENSOR_DESCRIPTOR));
+  t->set(CUDNN_ATTR_TENSOR_DATA_TYPE, CUDNN_TYPE_DATA_TYPE, 1, &dtype);
+  t->set(CUDNN_ATTR_TENSOR_DIMENSIONS, CUDNN_TYPE_INT64, dims.size(),
+         dims.data());
+  t->set(CUDNN_ATTR_TENSOR_STRIDES, CUDNN_TYPE_INT64, strides.size(),
+         strides.data());
+  t->set(CUDNN_ATTR_TENSOR_UNIQUE_ID, CUDNN_TYPE_INT64, 1, &uid);
+  t->set(CUDNN_ATTR_TENSOR_BYTE_ALIGNMENT, CUDNN_TYPE_INT64, 1, &alignment);
+  t->set(CUDNN_ATTR_TENSOR_IS_VIRTUAL, CUDNN_TYPE_BOOLEAN, 1, &is_virtual);
+  t->finalize();
+  return t;
+}
+
+/* Pointwise operation y = mode(x, b).
+ */
+BackendDescriptorPtr create_pointwise(cudnnPointwiseMode_t mode,
+                                      cudnnBackendDescriptor_t x,
+                                      cudnnBackendDescriptor_t b,
+                                      cudnnBackendDescriptor_t y) {
+  const cudnnDataType_t prec = CUDNN_DATA_FLOAT;
+  BackendDescriptor pw(CUDNN_BACKEND_POINTWISE_DESCRIPTOR);
+  pw.set(CUDNN_ATTR_POINTWISE_MODE, CUDNN_TYPE_POINTWISE_MODE, 1, &mode);
+  pw.set(CUDNN_ATTR_POINTWISE_MATH_PREC, CUDNN_TYPE_DATA_TYPE, 1, &prec);
+  pw.finalize();
+  BackendDescriptorPtr op(
+      new BackendDescriptor(CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR));
+  op->set(CUDNN_ATTR_OPERATION_POINTWISE_PW_DESCRIPTOR, pw.desc);
+  op->set(CUDNN_ATTR_OPERATION_POINTWISE_XDESC, x);
+  op->set(CUDNN_ATTR_OPERATION_POINTWISE_BDESC, b);
+  op->set(CUDNN_ATTR_OPERATION_POINTWISE_YDESC, y);
+  op->finalize();
+  return op;
+}
+
+inline int64_t get_conv_outsize(int w, int k, int p, int s, int d) {
+  const int dk = d * (k - 1) + 1;
+  return (w + 2 * p - dk) / s + 1;
+}
+
+bool is_deterministic(cudnnBackendDescriptor_t cfg) {
+  BackendDescriptor engine(CUDNN_BACKEND_ENGINE_DESCRIPTOR);
+  int64_t count = 0;
+  NBLA_CUDNN_CHECK(cudnnBackendGetAttribute(cfg, CUDNN_ATTR_ENGINECFG_ENGINE,
+                                            CUDNN_TYPE_BACKEND_DESCRIPTOR, 1,
+                                            &count, &engine.desc));
+  vector<cudnnBackendNumericalNote_t> notes(CUDNN_NUMERICAL_NOTE_TYPE_COUNT);
+  NBLA_CUDNN_CHECK(cudnnBackendGetAttribute(
+      engine.desc, CUDNN_ATTR_ENGINE_NUMERICAL_NOTE, CUDNN_TYPE_NUMERICAL_NOTE,
+      notes.size(), &count, notes.data()));
+  for (int64_t i = 0; i < count; i++) {
+    if (notes[i] == CUDNN_NUMERICAL_NOTE_NONDETERMINISTIC)
+      return false;
+  }
+  return true;
+}
+
+void execute_plan(cudnnHandle_t handle, cudnnBackendDescriptor_t plan,
+                  bool bias, const void *x, const void *w, const void *b,
+                  void *y, void *workspace) {
+  vector<int64_t> uids{UID_X, UID_W, UID_Y};
+  vector<void *> ptrs{const_cast<void *>(x), const_cast<void *>(w), y};
+  if (bias) {
+    uids.push_back(UID_B);
+    ptrs.push_back(const_cast<void *>(b));
+  }
+  BackendDescriptor pack(CUDNN_BACKEND_VARIANT_PACK_DESCRIPTOR);
+  pack.set(CUDNN_ATTR_VARIANT_PACK_UNIQUE_IDS, CUDNN_TYPE_INT64, uids.size(),
+           uids.data());
+  pack.set(CUDNN_ATTR_VARIANT_PACK_DATA_POINTERS, CUDNN_TYPE_VOID_PTR,
+           ptrs.size(), ptrs.data());
+  pack.set(CUDNN_ATTR_VARIANT_PACK_WORKSPACE, CUDNN_TYPE_VOID_PTR, 1,
+           &workspace);
+  pack.finalize();
+  NBLA_CUDNN_CHECK(cudnnBackendExecute(handle, plan, pack.desc));
+}
+}
+
+bool CudnnConvFusedDesc::operator==(const CudnnConvFusedDesc &x) const {
+  return conv == x.conv && bias == x.bias;
+}
+
+CudnnConvFusedPlan::CudnnConvFusedPlan(const CudnnConvFusedDesc &desc)
+    : device_(desc.conv.device), bias_(desc.bias) {
+  // A failure anywhere in the engine search leaves the plan unsupported, so
+  // that the callers fall back to the legacy API.
+  try {
+    build(desc);
+  } catch (std::exception &exc) {
+    plan_ = nullptr;
+    workspace_size_ = 0;
+  }
+}
+
+void CudnnConvFusedPlan::build(const CudnnConvFusedDesc &desc) {
+  const auto &conv = desc.conv;
+  // The backend API supports 2D and 3D convolutions with float or half
+  // storage. 1D convolutions are run as 2D like the legacy path.
+  if (conv.ndim < 1 || conv.ndim > 3 ||
+      !(conv.dtype == CUDNN_DATA_FLOAT || conv.dtype == CUDNN_DATA_HALF)) {
+    return;
+  }
+  cuda_set_device(device_);
+  auto manager = SingletonManager::get<CudnnHandleManager>();
+  auto handle = manager->handle(device_);
+  const Size_t workspace_limit = manager->get_workspace_limit_in_bytes();
+  const bool deterministic = manager->get_deterministic_option();
+  const bool heuristic = manager->get_heuristic_option();
+
+  // Dimensions in N, C, spatial order.
+  const int nspatial = std::max(conv.ndim, 2);
+  vector<int64_t> xdims{conv.n, conv.c}, wdims{conv.o, conv.c / conv.group},
+      ydims{conv.n, conv.o}, bdims{1, conv.o};
+  vector<int64_t> pad, stride, dilation;
+  for (int d = 0; d < nspatial; d++) {
+    const bool dummy = d >= conv.ndim;
+    const int s = dummy ? 1 : conv.sample[d];
+    const int k = dummy ? 1 : conv.kernel[d];
+    const int p = dummy ? 0 : conv.pad[d];
+    const int st = dummy ? 1 : conv.stride[d];
+    const int dl = dummy ? 1 : conv.dilation[d];
+    xdims.push_back(s);
+    wdims.push_back(k);
+    ydims.push_back(get_conv_outsize(s, k, p, st, dl));
+    bdims.push_back(1);
+    pad.push_back(p);
+    stride.push_back(st);
+    dilation.push_back(dl);
+  }
+  const bool cl = conv.channel_last;
+  auto x = create_tensor(UID_X, conv.dtype, xdims, cl, false);
+  auto w = create_tensor(UID_W, conv.dtype, wdims, cl, false);
+  auto y = create_tensor(UID_Y, conv.dtype, ydims, cl, false);
+  // The convolution result is virtual and kept in float.
+  auto conv_out =
+      bias_ ? create_tensor(UID_CONV, CUDNN_DATA_FLOAT, ydims, cl, true)
+            : nullptr;
+  auto b = bias_ ? create_tensor(UID_B, conv.dtype, bdims, cl, false) : nullptr;
+
+  // Convolution
+  const cudnnDataType_t compute_type = CUDNN_DATA_FLOAT;
+  const int64_t spatial_dims = nspatial;
+  BackendDescriptor conv_desc(CUDNN_BACKEND_CONVOLUTION_DESCRIPTOR);
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_COMP_TYPE, CUDNN_TYPE_DATA_TYPE, 1,
+                &compute_type);
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_CONV_MODE, CUDNN_TYPE_CONVOLUTION_MODE,
+                1, &conv.mode);
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_SPATIAL_DIMS, CUDNN_TYPE_INT64, 1,
+                &spatial_dims);
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_PRE_PADDINGS, CUDNN_TYPE_INT64,
+                pad.size(), pad.data());
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_POST_PADDINGS, CUDNN_TYPE_INT64,
+                pad.size(), pad.data());
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_DILATIONS, CUDNN_TYPE_INT64,
+                dilation.size(), dilation.data());
+  conv_desc.set(CUDNN_ATTR_CONVOLUTION_FILTER_STRIDES, CUDNN_TYPE_INT64,
+                stride.size(), stride.data());
+  conv_desc.finalize();
+
+  const float alpha = 1, beta = 0;
+  BackendDescriptor conv_op(
+      CUDNN_BACKEND_OPERATION_CONVOLUTION_FORWARD_DESCRIPTOR);
+  conv_op.set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_X, x->desc);
+  conv_op.set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_W, w->desc);
+  conv_op.set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_Y,
+              conv_out ? conv_out->desc : y->desc);
+  conv_op.set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_CONV_DESC,
+              conv_desc.desc);
+  conv_op.set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_ALPHA, CUDNN_TYPE_FLOAT,
+              1, &alpha);
+  conv_op.set(CUDNN_ATTR_OPERATION_CONVOLUTION_FORWARD_BETA, CUDNN_TYPE_FLOAT,
+              1, &beta);
+  conv_op.finalize();
+
+  vector<cudnnBackendDescriptor_t> ops{conv_op.desc};
+  BackendDescriptorPtr bias_op;
+  if (bias_) {
+    bias_op = create_pointwise(CUDNN_POINTWISE_ADD, conv_out->desc, b->desc,
+                               y->desc);
+    ops.push_back(bias_op->desc);
+  }
+
+  BackendDescriptor graph(CUDNN_BACKEND_OPERATIONGRAPH_DESCRIPTOR);
+  graph.set(CUDNN_ATTR_OPERATIONGRAPH_OPS, CUDNN_TYPE_BACKEND_DESCRIPTOR,
+            ops.size(), ops.data());
+  graph.set(CUDNN_ATTR_OPERATIONGRAPH_HANDLE, CUDNN_TYPE_HANDLE, 1, &handle);
+  if (cudnnBackendFinalize(graph.desc) != CUDNN_STATUS_SUCCESS)
+    return; // The graph is not supported by this cuDNN.
+
+  // Engine configs ordered by the heuristics.
+  const cudnnBackendHeurMode_t heur_mode = CUDNN_HEUR_MODE_INSTANT;
+  BackendDescriptor heur(CUDNN_BACKEND_ENGINEHEUR_DESCRIPTOR);
+  heur.set(CUDNN_ATTR_ENGINEHEUR_OPERATION_GRAPH, graph.desc);
+  heur.set(CUDNN_ATTR_ENGINEHEUR_MODE, CUDNN_TYPE_HEUR_MODE, 1, &heur_mode);
+  heur.finalize();
+  int64_t num_cfgs = 0;
+  NBLA_CUDNN_CHECK(cudnnBackendGetAttribute(heur.desc,
+                                            CUDNN_ATTR_ENGINEHEUR_RESULTS,
+                                            CUDNN_TYPE_BACKEND_DESCRIPTOR, 0,
+                                            &num_cfgs, nullptr));
+  vector<BackendDescriptorPtr> cfgs;
+  vector<cudnnBackendDescriptor_t> cfg_descs;
+  for (int64_t i = 0; i < num_cfgs; i++) {
+    cfgs.emplace_back(
+        new BackendDescriptor(CUDNN_BACKEND_ENGINECFG_DESCRIPTOR));
+    cfg_descs.push_back(cfgs.back()->desc);
+  }
+  if (num_cfgs > 0) {
+    NBLA_CUDNN_CHECK(cudnnBackendGetAttribute(
+        heur.desc, CUDNN_ATTR_ENGINEHEUR_RESULTS, CUDNN_TYPE_BACKEND_DESCRIPTOR,
+        num_cfgs, &num_cfgs, cfg_descs.data()));
+  }
+
+  // Candidate plans that satisfy the options.
+  const int max_candidates = heuristic ? 1 : 8;
+  vector<BackendDescriptorPtr> plans;
+  vector<size_t> workspace_sizes;
+  for (int64_t i = 0; i < num_cfgs && (int)plans.size() < max_candidates;
+       i++) {
+    if (deterministic && !is_deterministic(cfg_descs[i]))
+      continue;
+    BackendDescriptorPtr plan(
+        new BackendDescriptor(CUDNN_BACKEND_EXECUTION_PLAN_DESCRIPTOR));
+    plan->set(CUDNN_ATTR_EXECUTION_PLAN_HANDLE, CUDNN_TYPE_HANDLE, 1, &handle);
+    plan->set(CUDNN_ATTR_EXECUTION_PLAN_ENGINE_CONFIG, cfg_descs[i]);
+    if (cudnnBackendFinalize(plan->desc) != CUDNN_STATUS_SUCCESS)
+      continue;
+    int64_t workspace_size = 0, count = 0;
+    NBLA_CUDNN_CHECK(cudnnBackendGetAttribute(
+        plan->desc, CUDNN_ATTR_EXECUTION_PLAN_WORKSPACE_SIZE, CUDNN_TYPE_INT64,
+        1, &count, &workspace_size));
+    if (workspace_limit >= 0 && workspace_size > workspace_limit)
+      continue;
+    plans.push_back(std::move(plan));
+    workspace_sizes.push_back(workspace_size);
+  }
+  if (plans.empty())
+    return;
+
+  int best = plans.size() > 1 ? -1 : 0;
+  if (plans.size() > 1) {
+    // Time the candidates on scratch buffers.
+    Context ctx({"cudnn:float"}, "CudaCachedArray", std::to_string(device_));
+    auto scratch = [](const vector<int64_t> &dims, cudnnDataType_t dtype) {
+      Size_t size = sizeof_dtype(get_dtype_by_cudnn_data_type(dtype));
+      for (auto d : dims)
+        size *= d;
+      auto arr = std::make_shared<NdArray>(Shape_t{size});
+      arr->zero();
+      return arr;
+    };
+    auto x_arr = scratch(xdims, conv.dtype);
+    auto w_arr = scratch(wdims, conv.dtype);
+    auto b_arr = scratch(bdims, conv.dtype);
+    auto y_arr = scratch(ydims, conv.dtype);
+    auto ws_arr = std::make_shared<NdArray>(Shape_t{static_cast<Size_t>(
+        *std::max_element(workspace_sizes.begin(), workspace_sizes.end()) +
+        1)});
+    auto ptr = [&ctx](std::shared_ptr<NdArray> &a) {
+      return a->cast(dtypes::BYTE, ctx)->pointer<void>();
+    };
+    void *xp = ptr(x_arr), *wp = ptr(w_arr), *bp = ptr(b_arr), *yp = ptr(y_arr);
+    void *wsp = ptr(ws_arr);
+    cudaEvent_t start, stop;
+    NBLA_CUDA_CHECK(cudaEventCreate(&start));
+    NBLA_CUDA_CHECK(cudaEventCreate(&stop));
+    float best_time = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < plans.size(); i++) {
+      const int repeat = 3;
+      float time;
+      try {
+        execute_plan(handle, plans[i]->desc, bias_, xp, wp, bp, yp, wsp);
+        NBLA_CUDA_CHECK(cudaEventRecord(start, 0));
+        for (int r = 0; r < repeat; r++)
+          execute_plan(handle, plans[i]->desc, bias_, xp, wp, bp, yp, wsp);
+        NBLA_CUDA_CHECK(cudaEventRecord(stop, 0));
+        NBLA_CUDA_CHECK(cudaEventSynchronize(stop));
+        NBLA_CUDA_CHECK(cudaEventElapsedTime(&time, start, stop));
+      } catch (std::exception &exc) {
+        continue; // A plan that fails to run is not a candidate.
+      }
+      if (time < best_time) {
+        best_time = time;
+        best = i;
+      }
+    }
+    NBLA_CUDA_CHECK(cudaEventDestroy(start));
+    NBLA_CUDA_CHECK(cudaEventDestroy(stop));
+  }
+  if (best < 0)
+    return;
+  plan_ = plans[best]->release();
+  workspace_size_ = workspace_sizes[best];
+}
+
+CudnnConvFusedPlan::~CudnnConvFusedPlan() {
+  if (plan_)
+    cudnnBackendDestroyDescriptor(plan_);
+}
+
+void CudnnConvFusedPlan::execute(cudnnHandle_t handle, const void *x,
+                                 const void *w, const void *b, void *y,
+                                 void *workspace) const {
+  NBLA_CHECK(plan_, error_code::target_specific,
+             "No cuDNN execution plan for the fused convolution.");
+  execute_plan(handle, plan_, bias_, x, w, b, y, workspace);
+}
+
+shared_ptr<CudnnConvFusedPlan>
+CudnnHandleManager::get_conv_fused_plan(const CudnnConvFusedDesc &desc) {
+  auto it = conv_fused_plan.find(desc);
+  if (it != conv_fused_plan.end())
+    return it->second;
+  // The engines are timed with synchronization.
+  cuda_check_not_capturing("Search of fused convolution engines");
+  auto plan = make_shared<CudnnConvFusedPlan>(desc);
+  conv_fused_plan.insert({desc, plan});
+  return plan;
+}
+}
+#endif
@@ -83,6 +83,18 @@ void ConvolutionCudaCudnn<T>::setup_impl(const Variables &inputs,
                      this->stride_,
                      this->dilation_};
 
+#if CUDNN_VERSION >= 8000
+  // Fuse the bias addition into the convolution if an engine supports it,
+  // otherwise fall back to cudnnConvolutionForward and cudnnAddTensor.
+  fused_plan_ = nullptr;
+  if (inputs.size() == 3) {
+    auto manager = SingletonManager::get<CudnnHandleManager>();
+    auto plan = manager->get_conv_fused_plan({desc, true});
+    if (plan->supported())
+      fused_plan_ = plan;
+  }
+#endif
+
   auto &rsc = SingletonManager::get<CudnnHandleManager>()->conv_resource;
   auto it = rsc.find(desc);
   if (it != rsc.end()) {
@@ -110,6 +122,20 @@ void ConvolutionCudaCudnn<T>::forward_impl(const Variables &inputs,
   if (inputs.size() == 3) {
     b = inputs[2]->get_data_pointer<Tw>(this->ctx_);
   }
+#if CUDNN_VERSION >= 8000
+  if (fused_plan_) {
+    NdArray workspace_arr;
+    void *workspace{nullptr};
+    if (fused_plan_->workspace_size()) {
+      workspace_arr.reshape(
+          {static_cast<Size_t>(fused_plan_->workspace_size())}, true);
+      workspace =
+          workspace_arr.cast(dtypes::BYTE, this->ctx_, true)->pointer<void>();
+    }
+    fused_plan_->execute(cudnn_handle_, x, w, b, y, workspace);
+    return;
+  }
+#endif
   const auto workspace_size = rsc_->fwd_workspace_size();
   NdArray workspace_arr;
 
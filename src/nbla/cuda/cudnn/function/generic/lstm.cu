@@ -461,11 +461,11 @@ void LSTMCudaCudnn<T>::setup_impl(const Variables &inputs,
   // weight : [H, I+H]
   // bias : [H]
 
-  // Temporary buffer. This is used only for getting address offsets of matrix
-  // and biases from the head of the params pointer.
-  NdArray params_array(Shape_t{static_cast<Size_t>(params_size_in_bytes_)});
+  // Flattened parameter buffer kept across calls. Address offsets of matrix
+  // and biases are taken from the head of the params pointer.
+  packed_params_.reset(params_size_in_bytes_);
   Tcu *params =
-      params_array.cast(dtypes::BYTE, this->ctx_, true)->pointer<Tcu>();
+      packed_params_.params.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
 
   weight_offsets_.clear();
   bias_offsets_.clear();
@@ -559,13 +559,13 @@ void LSTMCudaCudnn<T>::forward_impl_training(const Variables &inputs,
     bias = inputs[5]->get_data_pointer<Tcu>(this->ctx_);
   }
 
-  // Create flattened weight buffer.
-  NdArray params_array(Shape_t{static_cast<Size_t>(params_size_in_bytes_)});
-  params_array.zero(); // Initialize params with 0
-  Tcu *params = params_array.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
-
-  this->copy_weight_bias_to_params(params, w_init, weight, bias, weight_exists_,
-                                   bias_exists_);
+  // Flattened weight buffer, re-packed only if the weights were modified.
+  Tcu *params =
+      packed_params_.params.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
+  if (packed_params_.modified(inputs, 3)) {
+    this->copy_weight_bias_to_params(params, w_init, weight, bias,
+                                     weight_exists_, bias_exists_);
+  }
 
   void *mem_buff = nullptr;
   NdArray mem_workspace;
@@ -621,13 +621,13 @@ void LSTMCudaCudnn<T>::forward_impl_inference(const Variables &inputs,
     bias = inputs[5]->get_data_pointer<Tcu>(this->ctx_);
   }
 
-  // Create flattened weight buffer.
-  NdArray params_array(Shape_t{static_cast<Size_t>(params_size_in_bytes_)});
-  params_array.zero(); // Initialize params with 0
-  Tcu *params = params_array.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
-
-  this->copy_weight_bias_to_params(params, w_init, weight, bias, weight_exists_,
-                                   bias_exists_);
+  // Flattened weight buffer, re-packed only if the weights were modified.
+  Tcu *params =
+      packed_params_.params.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
+  if (packed_params_.modified(inputs, 3)) {
+    this->copy_weight_bias_to_params(params, w_init, weight, bias,
+                                     weight_exists_, bias_exists_);
+  }
 
   void *mem_buff = nullptr;
   NdArray mem_workspace;
@@ -702,15 +702,16 @@ void LSTMCudaCudnn<T>::backward_impl(const Variables &inputs,
   Tcu *g_weight{nullptr};
   Tcu *g_bias{nullptr};
 
-  NdArray params_array(Shape_t{static_cast<Size_t>(params_size_in_bytes_)});
-  NdArray g_params_array(Shape_t{static_cast<Size_t>(params_size_in_bytes_)});
-  params_array.zero(); // Initialize params with 0
-  g_params_array.zero();
-  Tcu *params = params_array.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
-  Tcu *g_params = g_params_array.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
-
-  this->copy_weight_bias_to_params(params, w_init, weight, bias, weight_exists_,
-                                   bias_exists_);
+  Tcu *params =
+      packed_params_.params.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
+  if (packed_params_.modified(inputs, 3)) {
+    this->copy_weight_bias_to_params(params, w_init, weight, bias,
+                                     weight_exists_, bias_exists_);
+  }
+  // cudnnRNNBackwardWeights accumulates into the gradient buffer.
+  packed_params_.g_params.zero();
+  Tcu *g_params =
+      packed_params_.g_params.cast(dtypes::BYTE, this->ctx_)->pointer<Tcu>();
 
   if (propagate_down[0]) {
     g_x = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
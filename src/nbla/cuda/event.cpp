@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <nbla/cuda/array/swap_engine.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/event.hpp>
 
@@ -27,13 +28,26 @@ CudaEvent::CudaEvent(cudaEvent_t event, ArrayPtr &src)
 CudaEvent::CudaEvent(cudaEvent_t event, ArrayPtr &&src)
     : raw_event_(event), src_(src) {}
 
-CudaEvent::~CudaEvent() { cudaEventDestroy(raw_event_); }
+CudaEvent::CudaEvent(shared_ptr<cudaEvent_t> event, ArrayPtr src)
+    : raw_event_(*event), src_(src), shared_event_(event) {}
+
+CudaEvent::~CudaEvent() {
+  if (!shared_event_) {
+    cudaEventDestroy(raw_event_);
+  }
+}
 
 cudaEvent_t CudaEvent::raw_event() { return raw_event_; }
 
 void CudaEvent::wait_event(const Context ctx, const int async_flags) {
-  // Null stream (function stream) waits for an event
-  NBLA_CUDA_CHECK(cudaStreamWaitEvent(0, raw_event_, 0));
+  // The compute stream stalls if the copy has not finished yet. Only the
+  // pooled events of CudaSwapEngine are copies of LMS.
+  if (shared_event_ && cudaEventQuery(raw_event_) == cudaErrorNotReady) {
+    SingletonManager::get<CudaSwapEngine>()->wait_late(raw_event_);
+  } else {
+    // Null stream (function stream) waits for an event
+    NBLA_CUDA_CHECK(cudaStreamWaitEvent(0, raw_event_, 0));
+  }
 
   // If this event is waited for on CPU, in addition to null stream,
   // the host also wait for this event.
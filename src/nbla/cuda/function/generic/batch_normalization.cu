@@ -18,6 +18,7 @@
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/batch_normalization.hpp>
 #include <nbla/cuda/limits.hpp>
+#include <nbla/cuda/utils/transpose.cuh>
 
 //#include <nbla/cuda/function/kernel/batch_normalization.cuh>
 #include "kernel/batch_normalization.cu"
@@ -70,6 +71,7 @@ void BatchNormalizationCuda<T>::setup_impl(const Variables &inputs,
     p_axes[this->axes_[0]] = 0;
   }
   Shape_t shape(ndim);
+  trans_axes_.assign(p_axes, p_axes + ndim);
   for (int i = 0; i < ndim; ++i)
     shape[i] = inputs[0]->shape()[p_axes[i]];
   v_in_trans_.reshape(shape, true);
@@ -159,10 +161,11 @@ void BatchNormalizationCuda<T>::forward_impl_batch(const Variables &inputs,
   Tc *variance_reduction_space =
       get_data_ptr_(this->v_variance_reduction_space_);
   Tc *inv_sqrt_variance = get_data_ptr_(this->v_inv_sqrt_variance_);
+  device_transpose<Tc>(inputs[0]->shape(), this->trans_axes_, x, in_trans);
   forward_batch_parallel_reduction(
       this->size0_, this->size1_, this->size2_, ndim, axes, in_strides,
-      in_shape, out_strides, out_shape, this->decay_rate_, this->eps_, x, gamma,
-      beta, in_trans, m, v, rm, rv, y, mean_reduction_space,
+      in_shape, out_strides, out_shape, this->decay_rate_, this->eps_,
+      in_trans, gamma, beta, m, v, rm, rv, y, mean_reduction_space,
       variance_reduction_space, inv_sqrt_variance);
 #else
   forward_batch(this->size0_, this->size1_, this->size2_, this->decay_rate_,
@@ -255,9 +258,8 @@ void BatchNormalizationCuda<T>::backward_impl_batch(
   Tc *variance_reduction_space =
       get_data_ptr_(this->v_variance_reduction_space_);
   Tc *inv_sqrt_variance = get_data_ptr_(this->v_inv_sqrt_variance_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-      transpose_2value_kernel, this->size1_ * this->size02_, ndim, axes,
-      in_strides, out_strides, out_shape, x, dy, d_x_trans, d_dy_trans);
+  device_transpose<Tc>(inputs[0]->shape(), this->trans_axes_, x, d_x_trans);
+  device_transpose<Tc>(inputs[0]->shape(), this->trans_axes_, dy, d_dy_trans);
 #endif
   if (propagate_down[0]) {
     if (!accum[0])
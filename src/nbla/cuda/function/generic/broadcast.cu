@@ -105,7 +105,8 @@ template <int ND, typename T> struct switch_broadcast_cuda {
       const int blocks = NBLA_CUDA_GET_BLOCKS(size);
       const int inkernel_loop = NBLA_CEIL_INT_DIV(blocks, NBLA_CUDA_MAX_BLOCKS);
       const int total_blocks = NBLA_CEIL_INT_DIV(blocks, inkernel_loop);
-      kernel_broadcast<ND, T><<<total_blocks, NBLA_CUDA_NUM_THREADS>>>(
+      kernel_broadcast<ND, T><<<total_blocks, NBLA_CUDA_NUM_THREADS, 0,
+                                cuda_get_current_stream()>>>(
           size, x, stride_x, shape_y, y);
       NBLA_CUDA_KERNEL_CHECK();
       return;
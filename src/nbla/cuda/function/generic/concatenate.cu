@@ -23,26 +23,27 @@
 namespace nbla {
 
 // size: inner size x outer size
-template <typename T>
+// The indices of y run up to its size, which bounds the index type.
+template <typename T, typename index_t>
 __global__ void
-kernel_concatenate_forward(const int size, const int inner_total_size,
-                           const int inner_size, const int inner_offset,
+kernel_concatenate_forward(const index_t size, const index_t inner_total_size,
+                           const index_t inner_size, const index_t inner_offset,
                            const T *x, T *y) {
-  NBLA_CUDA_KERNEL_LOOP(index, size) {
-    const int o = index / inner_size;
-    const int c = index % inner_size;
+  NBLA_CUDA_KERNEL_LOOP_INDEX(index, size, index_t) {
+    const index_t o = index / inner_size;
+    const index_t c = index % inner_size;
     y[o * inner_total_size + inner_offset + c] = x[index];
   }
 }
 
-template <typename T, bool accum>
+template <typename T, bool accum, typename index_t>
 __global__ void
-kernel_concatenate_backward(const int size, const int inner_total_size,
-                            const int inner_size, const int inner_offset,
-                            const T *dy, T *dx) {
-  NBLA_CUDA_KERNEL_LOOP(index, size) {
-    const int o = index / inner_size;
-    const int c = index % inner_size;
+kernel_concatenate_backward(const index_t size, const index_t inner_total_size,
+                            const index_t inner_size,
+                            const index_t inner_offset, const T *dy, T *dx) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(index, size, index_t) {
+    const index_t o = index / inner_size;
+    const index_t c = index % inner_size;
     dx[index] = (accum ? dx[index] : (T)0) +
                 dy[o * inner_total_size + inner_offset + c];
   }
@@ -59,12 +60,13 @@ void ConcatenateCuda<T>::forward_impl(const Variables &inputs,
                                       const Variables &outputs) {
   cuda_set_device(std::stoi(this->ctx_.device_id));
   Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
-  int inner_offset = 0;
+  Size_t inner_offset = 0;
   for (int c = 0; c < inputs.size(); ++c) {
     const Tc *x = inputs[c]->get_data_pointer<Tc>(this->ctx_);
-    const int inner_size = inputs[c]->size(this->axis_);
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-        kernel_concatenate_forward, this->outer_size_ * inner_size,
+    const Size_t inner_size = inputs[c]->size(this->axis_);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+        (kernel_concatenate_forward<Tc, index_t>), outputs[0]->size(),
+        static_cast<Size_t>(this->outer_size_) * inner_size,
         this->inner_total_size_, inner_size, inner_offset, x, y);
     inner_offset += inner_size;
   }
@@ -80,21 +82,22 @@ void ConcatenateCuda<T>::backward_impl(const Variables &inputs,
   }
   cuda_set_device(std::stoi(this->ctx_.device_id));
   const Tc *dy = outputs[0]->get_grad_pointer<Tc>(this->ctx_);
-  int inner_offset = 0;
+  Size_t inner_offset = 0;
   for (int c = 0; c < inputs.size(); ++c) {
-    const int inner_size = inputs[c]->size(this->axis_);
+    const Size_t inner_size = inputs[c]->size(this->axis_);
+    const Size_t size = static_cast<Size_t>(this->outer_size_) * inner_size;
     if (propagate_down[c]) {
       Tc *dx = inputs[c]->cast_grad_and_get_pointer<Tc>(this->ctx_, !accum[c]);
       if (accum[c]) {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_concatenate_backward<Tc, true>),
-                                       this->outer_size_ * inner_size,
-                                       this->inner_total_size_, inner_size,
-                                       inner_offset, dy, dx);
+        NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+            (kernel_concatenate_backward<Tc, true, index_t>),
+            outputs[0]->size(), size, this->inner_total_size_, inner_size,
+            inner_offset, dy, dx);
       } else {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_concatenate_backward<Tc, false>),
-                                       this->outer_size_ * inner_size,
-                                       this->inner_total_size_, inner_size,
-                                       inner_offset, dy, dx);
+        NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+            (kernel_concatenate_backward<Tc, false, index_t>),
+            outputs[0]->size(), size, this->inner_total_size_, inner_size,
+            inner_offset, dy, dx);
       }
     }
     inner_offset += inner_size;
@@ -15,6 +15,7 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/cumprod.hpp>
+#include <nbla/cuda/utils/scan.cuh>
 #include <nbla/variable.hpp>
 
 #include <memory>
@@ -28,90 +29,82 @@ void CumProdCuda<T>::setup_impl(const Variables &inputs,
   cuda_set_device(this->device_);
 }
 
-template <typename T, typename AccumType>
-__global__ void kernel_cumprod_forward(const int size0x2_, const int size1_,
-                                       const int size2_, const T *x,
-                                       AccumType *y, bool exclusive_,
-                                       bool reverse_) {
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
-    const int i0 = idx / size2_;
-    const int i2 = idx % size2_;
-
-    int j = i0 * size1_ * size2_ + i2;
-    for (int index = 0; index < size1_; ++index) {
-      const int i1 = reverse_ ? size1_ - index - 1 : index;
-
-      const int d = reverse_ ? -1 : 1;
-      const int x_k = exclusive_ ? (i1 - d) * size2_ + j : i1 * size2_ + j;
-      const int y_k = i1 * size2_ + j;
-      const int y_k_prev = y_k - d * size2_;
-
-      y[y_k] = index != 0 ? y[y_k_prev] * x[x_k] : exclusive_ ? 1 : x[x_k];
-    }
+namespace cumprod_cuda {
+
+template <typename T, typename AccumType> struct Load {
+  const T *x;
+  template <typename index_t>
+  __device__ AccumType operator()(const index_t i) const { return x[i]; }
+};
+
+template <typename T, typename AccumType> struct Store {
+  T *y;
+  template <typename index_t>
+  __device__ void operator()(const index_t i, const AccumType v) const {
+    y[i] = v;
   }
-}
+};
+
+// Loads y * g_y for the backward scan.
+template <typename T, typename AccumType> struct LoadYGradY {
+  const T *y;
+  const T *g_y;
+  template <typename index_t>
+  __device__ AccumType operator()(const index_t i) const {
+    return AccumType(y[i]) * AccumType(g_y[i]);
+  }
+};
+
+// Stores the scan of y * g_y divided by x. Skipped when the input has
+// zeros, in which case kernel_cumprod_backward_zero_input writes g_x.
+template <typename T, typename AccumType, bool accum> struct StoreGrad {
+  const T *x;
+  T *g_x;
+  const int *zero_input_present;
+  template <typename index_t>
+  __device__ void operator()(const index_t i, const AccumType v) const {
+    if (*zero_input_present)
+      return;
+    const AccumType g = v / AccumType(x[i]);
+    g_x[i] = accum ? AccumType(g_x[i]) + g : g;
+  }
+};
+} // namespace cumprod_cuda
 
 template <typename T>
 void CumProdCuda<T>::forward_impl(const Variables &inputs,
                                   const Variables &outputs) {
+  using namespace cumprod_cuda;
   cuda_set_device(this->device_);
 
   const Tcu *x = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
-  AccumType *y = outputs[0]->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
+  Tcu *y = outputs[0]->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
 
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-      kernel_cumprod_forward, this->size0_ * this->size2_, this->size1_,
-      this->size2_, x, y, this->exclusive_, this->reverse_);
+  const ScanSetup setup{this->size0_, this->size1_, this->size2_,
+                        this->exclusive_, this->reverse_};
+  device_scan<ScanOpProd<AccumType>>(this->ctx_, setup,
+                                     Load<Tcu, AccumType>{x},
+                                     Store<Tcu, AccumType>{y});
 }
 
-template <typename T>
-__global__ void
-kernel_cumprod_backward(const int size0x2_, const int size1_, const int size2_,
-                        const T *x, const T *y, const T *g_y, T *g_x,
-                        bool exclusive_, bool reverse_, bool accum) {
+template <typename T, typename index_t>
+__global__ void kernel_cumprod_backward_zero_input(
+    const index_t size0x2_, const index_t size1_, const index_t size2_,
+    const T *x, const T *y, const T *g_y, T *g_x, bool exclusive_,
+    bool reverse_, bool accum, const int *zero_input_present) {
   typedef typename CudaTypeForceFloat<T>::type AccumType;
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
-    const int i0 = idx / size2_;
-    const int i2 = idx % size2_;
-    const int j = i0 * size1_ * size2_ + i2;
-
-    AccumType cum_sum_ydy = T(0);
-    for (int index = 0; index < size1_; ++index) {
-
-      const int i1 = reverse_ ? index : size1_ - index - 1;
-      const int x_k = i1 * size2_ + j;
-
-      cum_sum_ydy += y[x_k] * g_y[x_k];
-      if (accum) {
-        g_x[x_k] +=
-            (exclusive_ ? cum_sum_ydy - y[x_k] * g_y[x_k] : cum_sum_ydy) /
-            x[x_k];
-      } else {
-        g_x[x_k] =
-            (exclusive_ ? cum_sum_ydy - y[x_k] * g_y[x_k] : cum_sum_ydy) /
-            x[x_k];
-      }
-    }
-  }
-}
-
-template <typename T>
-__global__ void
-kernel_cumprod_backward_zero_input(const int size0x2_, const int size1_,
-                                   const int size2_, const T *x, const T *y,
-                                   const T *g_y, T *g_x, bool exclusive_,
-                                   bool reverse_, bool accum) {
-  typedef typename CudaTypeForceFloat<T>::type AccumType;
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
-    const int i0 = idx / size2_;
-    const int i2 = idx % size2_;
-    const int j = i0 * size1_ * size2_ + i2;
+  if (!*zero_input_present)
+    return;
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, size0x2_, index_t) {
+    const index_t i0 = idx / size2_;
+    const index_t i2 = idx % size2_;
+    const index_t j = i0 * size1_ * size2_ + i2;
 
     AccumType cur = T(0);
-    for (int index = 0; index < size1_; ++index) {
+    for (index_t index = 0; index < size1_; ++index) {
 
-      const int i1 = reverse_ ? index : size1_ - index - 1;
-      const int x_k = i1 * size2_ + j;
+      const index_t i1 = reverse_ ? index : size1_ - index - 1;
+      const index_t x_k = i1 * size2_ + j;
 
       T coeff =
           (i1 == 0) ? (T)1 : exclusive_ ? y[x_k] : y[(i1 - 1) * size2_ + j];
@@ -123,14 +116,14 @@ kernel_cumprod_backward_zero_input(const int size0x2_, const int size1_,
       cur = exclusive_ ? (T)0 : coeff * g_y[x_k];
 
       if (reverse_) {
-        for (int i4 = i1 - 1; i4 >= 0; --i4) {
+        for (index_t i4 = i1 - 1; i4 >= 0; --i4) {
           if (!exclusive_ || i4 != i1 - 1)
             coeff *=
                 (exclusive_ ? x[(i4 + 1) * size2_ + j] : x[i4 * size2_ + j]);
           cur += coeff * g_y[i4 * size2_ + j];
         }
       } else {
-        for (int i4 = i1 + 1; i4 < size1_; ++i4) {
+        for (index_t i4 = i1 + 1; i4 < size1_; ++i4) {
           if (!exclusive_ || i4 != i1 + 1) {
             coeff *=
                 (exclusive_ ? x[(i4 - 1) * size2_ + j] : x[i4 * size2_ + j]);
@@ -147,12 +140,12 @@ kernel_cumprod_backward_zero_input(const int size0x2_, const int size1_,
   }
 }
 
-template <typename T>
-__global__ void kernel_zero_input_check(const int size0x2_, const T *x,
-                                        bool *zero_input_present) {
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
+template <typename T, typename index_t>
+__global__ void kernel_zero_input_check(const index_t size, const T *x,
+                                        int *zero_input_present) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, size, index_t) {
     if (x[idx] == (T)0) {
-      *zero_input_present = true;
+      *zero_input_present = 1;
       break;
     }
   }
@@ -170,34 +163,41 @@ void CumProdCuda<T>::backward_impl(const Variables &inputs,
   cuda_set_device(this->device_);
 
   const Tcu *g_y = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
-  const T *y = outputs[0]->get_data_pointer<T>(this->ctx_);
-  const T *x = inputs[0]->get_data_pointer<T>(this->ctx_);
-
-  bool *d_zero_input_present, h_zero_input_present = false;
-  NBLA_CUDA_CHECK(cudaMalloc(&d_zero_input_present, sizeof(bool)));
-  NBLA_CUDA_CHECK(cudaMemcpy(d_zero_input_present, &h_zero_input_present,
-                             sizeof(bool), cudaMemcpyHostToDevice));
-
-  size_t size = inputs[0]->size();
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_zero_input_check<Tcu>), size, x,
-                                 d_zero_input_present);
-  NBLA_CUDA_CHECK(cudaMemcpy(&h_zero_input_present, d_zero_input_present,
-                             sizeof(bool), cudaMemcpyDeviceToHost));
-
-  if (propagate_down[0]) {
-    Tcu *g_x = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
-
-    if (h_zero_input_present == 1) {
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          (kernel_cumprod_backward_zero_input<Tcu>),
-          this->size0_ * this->size2_, this->size1_, this->size2_, x, y, g_y,
-          g_x, this->exclusive_, this->reverse_, accum[0]);
-    } else {
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          (kernel_cumprod_backward<Tcu>), this->size0_ * this->size2_,
-          this->size1_, this->size2_, x, y, g_y, g_x, this->exclusive_,
-          this->reverse_, accum[0]);
-    }
+  const Tcu *y = outputs[0]->get_data_pointer<Tcu>(this->ctx_);
+  const Tcu *x = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
+  Tcu *g_x = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
+
+  // The zero input flag stays on the device. Both the division based
+  // scan and the zero input kernel are launched and each of them exits
+  // early depending on the flag, which avoids a host synchronization.
+  NdArray flag(Shape_t{1});
+  flag.zero();
+  int *zero_input_present =
+      flag.cast(get_dtype<int>(), this->ctx_, false)->pointer<int>();
+  const Size_t size = inputs[0]->size();
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_zero_input_check<Tcu, index_t>), size, x, zero_input_present);
+
+  // Without zeros, g_x[i] = sum_{j >= i} y[j] * g_y[j] / x[i] where j runs
+  // in scan direction, i.e. a scan of y * g_y in the opposite direction.
+  using namespace cumprod_cuda;
+  const ScanSetup setup{this->size0_, this->size1_, this->size2_,
+                        this->exclusive_, !this->reverse_};
+  const LoadYGradY<Tcu, AccumType> load{y, g_y};
+  if (accum[0]) {
+    device_scan<ScanOpSum<AccumType>>(
+        this->ctx_, setup, load,
+        StoreGrad<Tcu, AccumType, true>{x, g_x, zero_input_present});
+  } else {
+    device_scan<ScanOpSum<AccumType>>(
+        this->ctx_, setup, load,
+        StoreGrad<Tcu, AccumType, false>{x, g_x, zero_input_present});
   }
+
+  // Bounded by the input size, which the kernel indexes.
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+      (kernel_cumprod_backward_zero_input<Tcu, index_t>), size,
+      this->size0_ * this->size2_, this->size1_, this->size2_, x, y, g_y, g_x,
+      this->exclusive_, this->reverse_, accum[0], zero_input_present);
+}
 }
-}
\ No newline at end of file
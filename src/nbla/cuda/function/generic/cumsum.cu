@@ -15,6 +15,7 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/cumsum.hpp>
+#include <nbla/cuda/utils/scan.cuh>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -26,65 +27,44 @@ void CumSumCuda<T>::setup_impl(const Variables &inputs,
   cuda_set_device(this->device_);
 }
 
-template <typename T, typename AccumType>
-__global__ void kernel_cumsum_forward(const int size0x2_, const int size1_,
-                                      const int size2_, const T *x,
-                                      AccumType *y, bool exclusive_,
-                                      bool reverse_) {
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
-    const int i0 = idx / size2_;
-    const int i2 = idx % size2_;
+namespace cumsum_cuda {
 
-    int j = i0 * size1_ * size2_ + i2;
-    for (int index = 0; index < size1_; ++index) {
-      const int i1 = reverse_ ? size1_ - index - 1 : index;
+template <typename T, typename AccumType> struct Load {
+  const T *x;
+  template <typename index_t>
+  __device__ AccumType operator()(const index_t i) const { return x[i]; }
+};
 
-      const int d = reverse_ ? -1 : 1;
-      const int x_k = exclusive_ ? (i1 - d) * size2_ + j : i1 * size2_ + j;
-      const int y_k = i1 * size2_ + j;
-      const int y_k_prev = y_k - d * size2_;
+template <typename T, typename AccumType> struct Store {
+  T *y;
+  template <typename index_t>
+  __device__ void operator()(const index_t i, const AccumType v) const {
+    y[i] = v;
+  }
+};
 
-      y[y_k] = index != 0 ? y[y_k_prev] + x[x_k] : exclusive_ ? 0 : x[x_k];
-    }
+template <typename T, typename AccumType, bool accum> struct StoreGrad {
+  T *g_x;
+  template <typename index_t>
+  __device__ void operator()(const index_t i, const AccumType v) const {
+    g_x[i] = accum ? AccumType(g_x[i]) + v : v;
   }
-}
+};
+} // namespace cumsum_cuda
 
 template <typename T>
 void CumSumCuda<T>::forward_impl(const Variables &inputs,
                                  const Variables &outputs) {
+  using namespace cumsum_cuda;
   cuda_set_device(this->device_);
   const Tcu *x = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
-  AccumType *y = outputs[0]->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
-
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-      kernel_cumsum_forward, this->size0_ * this->size2_, this->size1_,
-      this->size2_, x, y, this->exclusive_, this->reverse_);
-}
-
-template <typename T>
-__global__ void kernel_cumsum_backward(const int size0x2_, const int size1_,
-                                       const int size2_, const T *g_y, T *g_x,
-                                       bool exclusive_, bool reverse_,
-                                       bool accum) {
-  typedef typename CudaTypeForceFloat<T>::type AccumType;
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
-    const int i0 = idx / size2_;
-    const int i2 = idx % size2_;
-    const int j = i0 * size1_ * size2_ + i2;
-
-    AccumType cum_sum = T(0);
-    for (int index = 0; index < size1_; ++index) {
-
-      const int i1 = reverse_ ? index : size1_ - index - 1;
-      const int x_k = i1 * size2_ + j;
+  Tcu *y = outputs[0]->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
 
-      cum_sum += g_y[x_k];
-      if (accum)
-        g_x[x_k] += (exclusive_ ? cum_sum - g_y[x_k] : cum_sum);
-      else
-        g_x[x_k] = (exclusive_ ? cum_sum - g_y[x_k] : cum_sum);
-    }
-  }
+  const ScanSetup setup{this->size0_, this->size1_, this->size2_,
+                        this->exclusive_, this->reverse_};
+  device_scan<ScanOpSum<AccumType>>(this->ctx_, setup,
+                                    Load<Tcu, AccumType>{x},
+                                    Store<Tcu, AccumType>{y});
 }
 
 template <typename T>
@@ -95,15 +75,23 @@ void CumSumCuda<T>::backward_impl(const Variables &inputs,
   if (!(propagate_down[0])) {
     return;
   }
+  using namespace cumsum_cuda;
   cuda_set_device(this->device_);
 
+  // The gradient is the cumulative sum of the output gradient in the
+  // opposite direction.
   const Tcu *g_y = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
-  if (propagate_down[0]) {
-    Tcu *g_x = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_cumsum_backward<Tcu>),
-                                   this->size0_ * this->size2_, this->size1_,
-                                   this->size2_, g_y, g_x, this->exclusive_,
-                                   this->reverse_, accum[0]);
+  Tcu *g_x = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
+  const ScanSetup setup{this->size0_, this->size1_, this->size2_,
+                        this->exclusive_, !this->reverse_};
+  if (accum[0]) {
+    device_scan<ScanOpSum<AccumType>>(this->ctx_, setup,
+                                      Load<Tcu, AccumType>{g_y},
+                                      StoreGrad<Tcu, AccumType, true>{g_x});
+  } else {
+    device_scan<ScanOpSum<AccumType>>(this->ctx_, setup,
+                                      Load<Tcu, AccumType>{g_y},
+                                      StoreGrad<Tcu, AccumType, false>{g_x});
   }
 }
-}
\ No newline at end of file
+}
@@ -454,34 +454,40 @@ void DepthwiseConvolutionCuda<T>::forward_impl(const Variables &inputs,
 
   if (this->kernel_shape_.size() == 1) {
     if (kernel_1d_ == 3) {
-      forward_kernel_1d<Tc, 3><<<blocks, threads>>>(
+      forward_kernel_1d<Tc, 3><<<blocks, threads, 0,
+                                 cuda_get_current_stream()>>>(
           input_data, output_data, weight_data, bias_data, output_data_size_,
           sample_1d_, outmap_1d_, kernel_1d_, stride_1d_, padding_1d_,
           dilation_1d_, this->multiplier_);
     } else if (kernel_1d_ == 5) {
-      forward_kernel_1d<Tc, 5><<<blocks, threads>>>(
+      forward_kernel_1d<Tc, 5><<<blocks, threads, 0,
+                                 cuda_get_current_stream()>>>(
           input_data, output_data, weight_data, bias_data, output_data_size_,
           sample_1d_, outmap_1d_, kernel_1d_, stride_1d_, padding_1d_,
           dilation_1d_, this->multiplier_);
     } else {
-      forward_kernel_1d<Tc, 0><<<blocks, threads>>>(
+      forward_kernel_1d<Tc, 0><<<blocks, threads, 0,
+                                 cuda_get_current_stream()>>>(
           input_data, output_data, weight_data, bias_data, output_data_size_,
           sample_1d_, outmap_1d_, kernel_1d_, stride_1d_, padding_1d_,
           dilation_1d_, this->multiplier_);
     }
   } else {
     if ((kernel_2d_.x == 3) && (kernel_2d_.y == 3)) {
-      forward_kernel_2d<Tc, 3><<<blocks, threads>>>(
+      forward_kernel_2d<Tc, 3><<<blocks, threads, 0,
+                                 cuda_get_current_stream()>>>(
           input_data, output_data, weight_data, bias_data, output_data_size_,
           sample_2d_, outmap_2d_, kernel_2d_, stride_2d_, padding_2d_,
           dilation_2d_, this->multiplier_);
     } else if ((kernel_2d_.x == 5) && (kernel_2d_.y == 5)) {
-      forward_kernel_2d<Tc, 5><<<blocks, threads>>>(
+      forward_kernel_2d<Tc, 5><<<blocks, threads, 0,
+                                 cuda_get_current_stream()>>>(
           input_data, output_data, weight_data, bias_data, output_data_size_,
           sample_2d_, outmap_2d_, kernel_2d_, stride_2d_, padding_2d_,
           dilation_2d_, this->multiplier_);
     } else {
-      forward_kernel_2d<Tc, 0><<<blocks, threads>>>(
+      forward_kernel_2d<Tc, 0><<<blocks, threads, 0,
+                                 cuda_get_current_stream()>>>(
           input_data, output_data, weight_data, bias_data, output_data_size_,
           sample_2d_, outmap_2d_, kernel_2d_, stride_2d_, padding_2d_,
           dilation_2d_, this->multiplier_);
@@ -537,34 +543,40 @@ void DepthwiseConvolutionCuda<T>::backward_impl(
     const int blocks = (input_data_size_ + threads - 1) / threads;
     if (this->kernel_shape_.size() == 1) {
       if (kernel_1d_ == 3) {
-        backprop_input_1d<Tc, 3><<<blocks, threads>>>(
+        backprop_input_1d<Tc, 3><<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
             input_grad, output_grad, weight_data, input_data_size_, sample_1d_,
             outmap_1d_, kernel_1d_, stride_1d_, padding_1d_, dilation_1d_,
             this->multiplier_);
       } else if (kernel_1d_ == 5) {
-        backprop_input_1d<Tc, 5><<<blocks, threads>>>(
+        backprop_input_1d<Tc, 5><<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
             input_grad, output_grad, weight_data, input_data_size_, sample_1d_,
             outmap_1d_, kernel_1d_, stride_1d_, padding_1d_, dilation_1d_,
             this->multiplier_);
       } else {
-        backprop_input_1d<Tc, 0><<<blocks, threads>>>(
+        backprop_input_1d<Tc, 0><<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
             input_grad, output_grad, weight_data, input_data_size_, sample_1d_,
             outmap_1d_, kernel_1d_, stride_1d_, padding_1d_, dilation_1d_,
             this->multiplier_);
       }
     } else {
       if ((kernel_2d_.x == 3) && (kernel_2d_.y == 3)) {
-        backprop_input_2d<Tc, 3><<<blocks, threads>>>(
+        backprop_input_2d<Tc, 3><<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
             input_grad, output_grad, weight_data, input_data_size_, sample_2d_,
             outmap_2d_, kernel_2d_, stride_2d_, padding_2d_, dilation_2d_,
             this->multiplier_);
       } else if ((kernel_2d_.x == 5) && (kernel_2d_.y == 5)) {
-        backprop_input_2d<Tc, 5><<<blocks, threads>>>(
+        backprop_input_2d<Tc, 5><<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
             input_grad, output_grad, weight_data, input_data_size_, sample_2d_,
             outmap_2d_, kernel_2d_, stride_2d_, padding_2d_, dilation_2d_,
             this->multiplier_);
       } else {
-        backprop_input_2d<Tc, 0><<<blocks, threads>>>(
+        backprop_input_2d<Tc, 0><<<blocks, threads, 0,
+                                   cuda_get_current_stream()>>>(
             input_grad, output_grad, weight_data, input_data_size_, sample_2d_,
             outmap_2d_, kernel_2d_, stride_2d_, padding_2d_, dilation_2d_,
             this->multiplier_);
@@ -598,7 +610,8 @@ void DepthwiseConvolutionCuda<T>::backward_impl(
       const int kernel_size = kernel_1d_;
       const int output_channels = outmap_1d_.y;
       const int blocks = output_channels * kernel_size;
-      backprop_weights_1d<Tc><<<blocks, threads>>>(
+      backprop_weights_1d<Tc><<<blocks, threads, 0,
+                                cuda_get_current_stream()>>>(
           output_grad, input_data, weight_grad, bias_grad, batch_size,
           sample_1d_, outmap_1d_, kernel_1d_, stride_1d_, padding_1d_,
           dilation_1d_, this->multiplier_);
@@ -606,7 +619,8 @@ void DepthwiseConvolutionCuda<T>::backward_impl(
       const int kernel_size = kernel_2d_.x * kernel_2d_.y;
       const int output_channels = outmap_2d_.z;
       const int blocks = output_channels * kernel_size;
-      backprop_weights_2d<Tc><<<blocks, threads>>>(
+      backprop_weights_2d<Tc><<<blocks, threads, 0,
+                                cuda_get_current_stream()>>>(
           output_grad, input_data, weight_grad, bias_grad, batch_size,
           sample_2d_, outmap_2d_, kernel_2d_, stride_2d_, padding_2d_,
           dilation_2d_, this->multiplier_);
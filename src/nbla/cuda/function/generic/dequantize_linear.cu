@@ -15,14 +15,70 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/dequantize_linear.hpp>
+#include <nbla/cuda/function/utils/quantize.hpp>
 #include <nbla/variable.hpp>
 
 namespace nbla {
 
+// y = (x - zero_point) * scale in a single pass, with scale and zero_point
+// indexed per channel.
+template <typename Tx, typename T, typename index_t>
+__global__ void kernel_dequantize_linear(const index_t size, const Tx *x,
+                                         const T *scale, const T *zero_point,
+                                         const index_t channels,
+                                         const index_t inner_size, T *y) {
+  typedef typename CudaTypeForceFloat<T>::type Tf;
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, size, index_t) {
+    const index_t c = (i / inner_size) % channels;
+    y[i] = (Tf(x[i]) - Tf(zero_point[c])) * Tf(scale[c]);
+  }
+}
+
 template <typename T>
 void DequantizeLinearCuda<T>::setup_impl(const Variables &inputs,
                                          const Variables &outputs) {
   DequantizeLinear<T>::setup_impl(inputs, outputs);
   cuda_set_device(this->device_);
+
+  // The fused kernel needs per-tensor or per-channel scale and zero_point.
+  // Other broadcasts go through DequantizeLinear::forward_impl.
+  fused_ = get_quantize_channel_layout(inputs[0]->shape(), inputs[1]->shape(),
+                                       inputs[2]->shape(), channels_,
+                                       inner_size_);
+}
+
+template <typename T>
+void DequantizeLinearCuda<T>::forward_impl(const Variables &inputs,
+                                           const Variables &outputs) {
+  if (!fused_) {
+    DequantizeLinear<T>::forward_impl(inputs, outputs);
+    return;
+  }
+  cuda_set_device(this->device_);
+  const Tcu *scale = inputs[1]->get_data_pointer<Tcu>(this->ctx_);
+  const Tcu *zero_point = inputs[2]->get_data_pointer<Tcu>(this->ctx_);
+  Tcu *y = outputs[0]->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
+  const Size_t size = inputs[0]->size();
+
+  // Read the 8-bit integers written by QuantizeLinearCuda as they are,
+  // without casting them to T first.
+  const dtypes x_dtype = inputs[0]->data()->dtype();
+  if (x_dtype == dtypes::BYTE) {
+    const char *x = inputs[0]->get_data_pointer<char>(this->ctx_);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_dequantize_linear<char, Tcu, index_t>), size, x, scale,
+        zero_point, channels_, inner_size_, y);
+  } else if (x_dtype == dtypes::UBYTE) {
+    const unsigned char *x =
+        inputs[0]->get_data_pointer<unsigned char>(this->ctx_);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_dequantize_linear<unsigned char, Tcu, index_t>), size, x,
+        scale, zero_point, channels_, inner_size_, y);
+  } else {
+    const Tcu *x = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_dequantize_linear<Tcu, Tcu, index_t>), size, x, scale,
+        zero_point, channels_, inner_size_, y);
+  }
 }
 }
@@ -17,25 +17,50 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/dropout.hpp>
+#include <nbla/cuda/utils/warp_vote.cuh>
 #include <nbla/variable.hpp>
 
+#include <curand_kernel.h>
+
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_dropout_forward(const int size, const float scale,
-                                       const float p, const T *x, T *y,
+// Each element draws its uniform random value from a Philox generator keyed
+// by `key` with the element index as subsequence, so the mask can be
+// regenerated from the key alone. The keep decisions of a warp are packed
+// into one 32 bit word of `bits`. If `m` is not null, the mask is also
+// written as float. The loop runs over whole warps so that every lane takes
+// part in the ballot.
+template <typename T, typename index_t>
+__global__ void kernel_dropout_forward(const index_t size, const float scale,
+                                       const float p,
+                                       const unsigned long long *key,
+                                       const T *x, T *y, unsigned int *bits,
                                        float *m) {
-  NBLA_CUDA_KERNEL_LOOP(s, size) {
-    m[s] = (m[s] > p) ? 1 : 0;
-    y[s] = x[s] * m[s] * scale;
+  const index_t words = (size + CUDA_WARP_SIZE - 1) / CUDA_WARP_SIZE;
+  const unsigned long long seed = *key;
+  NBLA_CUDA_KERNEL_LOOP_INDEX(s, words * CUDA_WARP_SIZE, index_t) {
+    bool keep = false;
+    if (s < size) {
+      curandStatePhilox4_32_10_t state;
+      curand_init(seed, s, 0, &state);
+      keep = curand_uniform(&state) > p;
+      y[s] = keep ? x[s] * scale : (T)0;
+      if (m)
+        m[s] = keep ? 1 : 0;
+    }
+    const unsigned int word = warp::ballot(keep);
+    if ((threadIdx.x & CUDA_WARP_MASK) == 0)
+      bits[s >> CUDA_WARP_BITS] = word;
   }
 }
 
-template <typename T, bool accum>
-__global__ void kernel_dropout_backward(const int size, const float scale,
-                                        const T *dy, const float *m, T *dx) {
-  NBLA_CUDA_KERNEL_LOOP(s, size) {
-    dx[s] = (accum ? dx[s] : (T)0) + dy[s] * m[s] * scale;
+template <typename T, bool accum, typename index_t>
+__global__ void kernel_dropout_backward(const index_t size, const float scale,
+                                        const T *dy, const unsigned int *bits,
+                                        T *dx) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(s, size, index_t) {
+    const bool keep = (bits[s >> CUDA_WARP_BITS] >> (s & CUDA_WARP_MASK)) & 1;
+    dx[s] = (accum ? dx[s] : (T)0) + (keep ? dy[s] * scale : (T)0);
   }
 }
 
@@ -45,37 +70,53 @@ void DropoutCuda<T>::setup_impl(const Variables &inputs,
   outputs[0]->reshape(inputs[0]->shape(), true);
   if (this->output_mask_) {
     outputs[1]->reshape(inputs[0]->shape(), true);
-  } else {
-    this->mask_.reshape(inputs[0]->shape(), true);
   }
+  // The mask is kept as one bit per element. The Philox key of the last
+  // forward is kept so that recomputation reproduces the same mask.
+  const auto words = NBLA_CEIL_SIZE_T_DIV(inputs[0]->size(), CUDA_WARP_SIZE);
+  this->mask_bits_.reshape(Shape_t{words}, true);
+  this->philox_key_.reshape(Shape_t{2}, true);
+}
+
+template <class T>
+void DropoutCuda<T>::dropout(const Variables &inputs,
+                             const Variables &outputs) {
+  const Tc *x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
+  Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
+  float *m = this->output_mask_
+                 ? outputs[1]->cast_data_and_get_pointer<float>(this->ctx_,
+                                                                true)
+                 : nullptr;
+  auto bits = this->mask_bits_.cast(get_dtype<unsigned int>(), this->ctx_, true)
+                  ->template pointer<unsigned int>();
+  auto key = this->philox_key_.get(get_dtype<unsigned int>(), this->ctx_)
+                 ->template const_pointer<unsigned long long>();
+  // The kernel itself runs over whole warps past the size.
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_dropout_forward<Tc, index_t>),
+                                         inputs[0]->size(), this->scale_,
+                                         this->p_, key, x, y, bits, m);
 }
 
 template <class T>
 void DropoutCuda<T>::forward_impl(const Variables &inputs,
                                   const Variables &outputs) {
   cuda_set_device(std::stoi(this->ctx_.device_id));
-  const Tc *x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
-  Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
-  Variable &mask = this->output_mask_ ? *outputs[1] : this->mask_;
-  float *m = mask.cast_data_and_get_pointer<float>(this->ctx_, true);
+  // Draw a new 64 bit Philox key on the device. No other random numbers are
+  // generated outside the dropout kernel.
   curandGenerator_t &gen =
       this->seed_ == -1 ? SingletonManager::get<Cuda>()->curand_generator()
                         : curand_generator_;
-  curand_generate_rand<float>(gen, 0.0f, 1.0f, m, inputs[0]->size());
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_dropout_forward, inputs[0]->size(),
-                                 this->scale_, this->p_, x, y, m);
+  auto key = this->philox_key_.cast(get_dtype<unsigned int>(), this->ctx_, true)
+                 ->template pointer<unsigned int>();
+  NBLA_CURAND_CHECK(curandGenerate(gen, key, 2));
+  this->dropout(inputs, outputs);
 }
 
 template <class T>
 void DropoutCuda<T>::recompute_impl(const Variables &inputs,
                                     const Variables &outputs) {
   cuda_set_device(std::stoi(this->ctx_.device_id));
-  const Tc *x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
-  Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
-  Variable &mask = this->output_mask_ ? *outputs[1] : this->mask_;
-  float *m = mask.cast_data_and_get_pointer<float>(this->ctx_, true);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_dropout_forward, inputs[0]->size(),
-                                 this->scale_, this->p_, x, y, m);
+  this->dropout(inputs, outputs);
 }
 
 template <class T>
@@ -89,14 +130,16 @@ void DropoutCuda<T>::backward_impl(const Variables &inputs,
   cuda_set_device(std::stoi(this->ctx_.device_id));
   Tc *dx = inputs[0]->cast_grad_and_get_pointer<Tc>(this->ctx_, !accum[0]);
   const Tc *dy = outputs[0]->get_grad_pointer<Tc>(this->ctx_);
-  Variable &mask = this->output_mask_ ? *outputs[1] : this->mask_;
-  const float *m = mask.get_data_pointer<float>(this->ctx_);
+  auto bits = this->mask_bits_.get(get_dtype<unsigned int>(), this->ctx_)
+                  ->template const_pointer<unsigned int>();
   if (accum[0]) {
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_dropout_backward<Tc, true>),
-                                   inputs[0]->size(), this->scale_, dy, m, dx);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_dropout_backward<Tc, true, index_t>), inputs[0]->size(),
+        this->scale_, dy, bits, dx);
   } else {
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_dropout_backward<Tc, false>),
-                                   inputs[0]->size(), this->scale_, dy, m, dx);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_dropout_backward<Tc, false, index_t>), inputs[0]->size(),
+        this->scale_, dy, bits, dx);
   }
 }
 }
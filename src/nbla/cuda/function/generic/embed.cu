@@ -19,23 +19,24 @@
 
 namespace nbla {
 
-template <typename T, typename T1>
-__global__ void kernel_embed_forward(const int num, T1 *y, const T *x,
-                                     const T1 *w, int stride0) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
-    const int i = idx / stride0;
-    const int j = idx % stride0;
+template <typename T, typename T1, typename index_t>
+__global__ void kernel_embed_forward(const index_t num, T1 *y, const T *x,
+                                     const T1 *w, index_t stride0) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
+    const index_t i = idx / stride0;
+    const index_t j = idx % stride0;
     y[idx] = w[x[i] * stride0 + j];
   }
 }
 
-template <typename T, typename T1, typename Tw>
-__global__ void kernel_embed_backward_weight(const int num, Tw *dw, const T *x,
-                                             const T1 *dy, int stride0) {
+template <typename T, typename T1, typename Tw, typename index_t>
+__global__ void kernel_embed_backward_weight(const index_t num, Tw *dw,
+                                             const T *x, const T1 *dy,
+                                             index_t stride0) {
   // TODO: optimize
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
-    const int i = idx / stride0;
-    const int j = idx % stride0;
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
+    const index_t i = idx / stride0;
+    const index_t j = idx % stride0;
     atomicAdd(dw + x[i] * stride0 + j,
               (typename CudaTypeForceFloat<T1>::type)dy[i * stride0 + j]);
   }
@@ -57,8 +58,9 @@ void EmbedCuda<T, T1>::forward_impl(const Variables &inputs,
   Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
 
   Size_t stride0 = inputs[1]->size(1);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_embed_forward,
-                                 inputs[0]->size() * stride0, y, x, w, stride0);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+      (kernel_embed_forward<T, Tc, index_t>), inputs[1]->size(),
+      outputs[0]->size(), y, x, w, stride0);
 }
 
 template <typename T, typename T1>
@@ -84,8 +86,8 @@ void EmbedCuda<T, T1>::backward_impl(const Variables &inputs,
   const Tc *dy = outputs[0]->get_grad_pointer<Tc>(this->ctx_);
 
   Size_t stride0 = inputs[1]->size(1);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_embed_backward_weight,
-                                 inputs[0]->size() * stride0, dw, x, dy,
-                                 stride0);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX_WITH_BOUND(
+      (kernel_embed_backward_weight<T, Tc, Tw, index_t>), inputs[1]->size(),
+      outputs[0]->size(), dw, x, dy, stride0);
 }
 }
@@ -21,11 +21,6 @@
 
 namespace nbla {
 
-template <typename T> FFTCuda<T>::~FFTCuda() {
-  NBLA_CUFFT_CHECK(cufftDestroy(plan_forward_));
-  NBLA_CUFFT_CHECK(cufftDestroy(plan_backward_));
-}
-
 template <typename T>
 void FFTCuda<T>::setup_impl(const Variables &inputs, const Variables &outputs) {
   cuda_set_device(this->device_);
@@ -50,8 +45,7 @@ void FFTCuda<T>::forward_impl(const Variables &inputs,
   const Tcu *x = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
   Tcu *y = outputs[0]->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
   exec_cufft<Tcu>(this->ctx_, x, y, inputs[0]->shape(), outputs[0]->shape(),
-                  plan_forward_, true, true, CUFFT_FORWARD, this->n_,
-                  this->signal_ndim_);
+                  true, true, CUFFT_FORWARD, this->n_, this->signal_ndim_);
   // Normalize
   if (this->normalized_) {
     const Size_t size = inputs[0]->size();
@@ -79,8 +73,8 @@ void FFTCuda<T>::backward_impl(const Variables &inputs,
     const Tcu *dy = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
     Tcu *tmp_buff = ndarray->cast(get_dtype<Tcu>(), this->ctx_)->pointer<Tcu>();
     exec_cufft<Tcu>(this->ctx_, dy, tmp_buff, outputs[0]->shape(),
-                    inputs[0]->shape(), plan_backward_, true, true,
-                    CUFFT_INVERSE, this->n_, this->signal_ndim_);
+                    inputs[0]->shape(), true, true, CUFFT_INVERSE, this->n_,
+                    this->signal_ndim_);
 
     // Normalize
     const Size_t size = inputs[0]->size();
@@ -99,8 +93,7 @@ void FFTCuda<T>::backward_impl(const Variables &inputs,
     const Tcu *dy = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
     Tcu *dx = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
     exec_cufft<Tcu>(this->ctx_, dy, dx, outputs[0]->shape(), inputs[0]->shape(),
-                    plan_backward_, true, true, CUFFT_INVERSE, this->n_,
-                    this->signal_ndim_);
+                    true, true, CUFFT_INVERSE, this->n_, this->signal_ndim_);
     // Normalize
     const Size_t size = inputs[0]->size();
     if (this->normalized_) {
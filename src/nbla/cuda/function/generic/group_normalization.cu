@@ -35,11 +35,23 @@ void GroupNormalizationCuda<T>::setup_impl(const Variables &inputs,
   const auto x_shape = x->shape();
   const auto ndim = x->ndim();
 
-  // Setup input and output adaptor for channel-last memory format
-  need_adaptor_ = ChannelFirstAdaptor::need_adaptor(
-      inputs[0]->shape(), this->batch_axis_, this->channel_axis_);
-
-  if (need_adaptor_) {
+  // [B, S, C] is normalized directly by the channel-last kernels. The other
+  // non channel-first layouts are transposed by an adaptor.
+  channel_last_ = is_channel_last_layout(x_shape, this->batch_axis_,
+                                         this->channel_axis_);
+  need_adaptor_ =
+      !channel_last_ &&
+      ChannelFirstAdaptor::need_adaptor(inputs[0]->shape(), this->batch_axis_,
+                                        this->channel_axis_);
+
+  if (channel_last_) {
+    const auto c = this->channel_axis_;
+    channel_size_ = x_shape[c];
+    batch_size_ = x->size() / x->size(this->batch_axis_.size());
+    reduce_size_ = x->size() / (batch_size_ * this->num_groups_);
+    inv_reduce_size_ = 1.0f / reduce_size_;
+    outer_size_ = x->size() / reduce_size_;
+  } else if (need_adaptor_) {
     adaptor_ = std::make_shared<ChannelFirstAdaptor>();
     adaptor_->setup(inputs[0], &pre_adaptor_, &post_adaptor_, outputs[0],
                     inputs[0]->shape(), this->batch_axis_, this->channel_axis_,
@@ -85,10 +97,8 @@ template <typename T>
 void GroupNormalizationCuda<T>::forward_impl(const Variables &inputs,
                                              const Variables &outputs) {
   cuda_set_device(this->device_);
-  // Currently, only channel-fist kernels are provided. Channel-last execution
-  // is performed by transforming input and output memory format to
-  // channel-first and using channel-first implementation. The transformation is
-  // performed by ChannelFirstAdaptor.
+  // Channel-first and [B, S, C] inputs are normalized directly. Other layouts
+  // are transformed to channel-first by ChannelFirstAdaptor.
   if (need_adaptor_) {
     // Transpose input to [B, C, H, W] memory format.
     adaptor_->convert_to_channel_first(inputs[0], &pre_adaptor_);
@@ -99,17 +109,17 @@ void GroupNormalizationCuda<T>::forward_impl(const Variables &inputs,
     channel_first_outputs[0] = &post_adaptor_;
 
     // Group normalization
-    forward_channel_first(channel_first_inputs, channel_first_outputs);
+    forward_normalization(channel_first_inputs, channel_first_outputs);
 
     // Transpose output to original memory format.
     adaptor_->convert_from_channel_first(&post_adaptor_, outputs[0]);
   } else {
-    forward_channel_first(inputs, outputs);
+    forward_normalization(inputs, outputs);
   }
 }
 
 template <typename T>
-void GroupNormalizationCuda<T>::forward_channel_first(
+void GroupNormalizationCuda<T>::forward_normalization(
     const Variables &inputs, const Variables &outputs) {
   Variable *v_mean = &mean_;
   Variable *v_var = &var_;
@@ -132,8 +142,19 @@ void GroupNormalizationCuda<T>::forward_channel_first(
         std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
     const auto block = num_threads;
 
-    WelfordOp<Tc, Size_t> op(x, mean, var, reduce_size_);
-    reduce_2d_x<<<grid, block>>>(op, outer_size_, reduce_size_);
+    if (channel_last_) {
+      const Size_t spatial_size =
+          inputs[0]->size() / (batch_size_ * channel_size_);
+      GNChannelLastOp<WelfordOp<Tc, Size_t>, Size_t> op(
+          spatial_size, channel_size_, this->num_groups_, x, mean, var,
+          reduce_size_);
+      reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, outer_size_, reduce_size_);
+    } else {
+      WelfordOp<Tc, Size_t> op(x, mean, var, reduce_size_);
+      reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, outer_size_, reduce_size_);
+    }
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -157,7 +178,8 @@ void GroupNormalizationCuda<T>::forward_channel_first(
     const auto grid = std::min(NBLA_CEIL_SIZE_T_DIV(batch_size_ * channel_size_,
                                                     NBLA_CUDA_GN_NUM_THREADS),
                                static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
-    group_norm_forward_normalization_factor<<<grid, block>>>(
+    group_norm_forward_normalization_factor<<<grid, block, 0,
+                                              cuda_get_current_stream()>>>(
         batch_size_, channel_size_, this->num_groups_, mean, var, beta, gamma,
         a, b, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
@@ -172,16 +194,33 @@ void GroupNormalizationCuda<T>::forward_channel_first(
 
     const Size_t size = inputs[0]->size();
     const Size_t spatial_size = size / (batch_size_ * channel_size_);
-    const Size_t num_threads = CUDA_WARP_SIZE * 2;
 
-    const auto block = num_threads;
-    const auto grid = std::min(
-        NBLA_CEIL_SIZE_T_DIV(size, num_threads * NBLA_CUDA_GN_N_UNROLL),
-        static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
-
-    group_norm_forward_normalization<Tc, Size_t,
-                                     NBLA_CUDA_GN_N_UNROLL><<<grid, block>>>(
-        size, spatial_size, x, a, b, y);
+    if (channel_last_) {
+      constexpr int N = max_pack_size<Tc>();
+      const bool vectorize =
+          channel_size_ % N == 0 && pack_aligned<Tc, N>(x, y);
+      const auto block = NBLA_CUDA_GN_NUM_THREADS;
+      const auto grid = std::min(
+          NBLA_CEIL_SIZE_T_DIV(size / (vectorize ? N : 1), block),
+          static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
+      auto kernel =
+          vectorize
+              ? group_norm_forward_normalization_channel_last<Tc, Size_t, N>
+              : group_norm_forward_normalization_channel_last<Tc, Size_t, 1>;
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          size, spatial_size, channel_size_, x, a, b, y);
+    } else {
+      const Size_t num_threads = CUDA_WARP_SIZE * 2;
+      const auto block = num_threads;
+      const auto grid = std::min(
+          NBLA_CEIL_SIZE_T_DIV(size, num_threads * NBLA_CUDA_GN_N_UNROLL),
+          static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
+
+      auto kernel =
+          group_norm_forward_normalization<Tc, Size_t, NBLA_CUDA_GN_N_UNROLL>;
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          size, spatial_size, x, a, b, y);
+    }
     NBLA_CUDA_KERNEL_CHECK();
 
     // Clear internal buffers
@@ -211,7 +250,7 @@ void GroupNormalizationCuda<T>::backward_impl(
 
     auto channel_first_accum = accum;
     channel_first_accum[0] = false;
-    backward_channel_first(channel_first_inputs, channel_first_outputs,
+    backward_normalization(channel_first_inputs, channel_first_outputs,
                            propagate_down, channel_first_accum);
 
     post_adaptor_.data()->array()->clear();
@@ -223,12 +262,12 @@ void GroupNormalizationCuda<T>::backward_impl(
     pre_adaptor_.data()->array()->clear();
     pre_adaptor_.grad()->array()->clear();
   } else {
-    backward_channel_first(inputs, outputs, propagate_down, accum);
+    backward_normalization(inputs, outputs, propagate_down, accum);
   }
 }
 
 template <typename T>
-void GroupNormalizationCuda<T>::backward_channel_first(
+void GroupNormalizationCuda<T>::backward_normalization(
     const Variables &inputs, const Variables &outputs,
     const vector<bool> &propagate_down, const vector<bool> &accum) {
   Variable *v_mean = &mean_;
@@ -249,16 +288,27 @@ void GroupNormalizationCuda<T>::backward_channel_first(
     const Size_t size = inputs[0]->size();
     const Size_t bc_size = batch_size_ * channel_size_;
     const Size_t spatial_size = size / bc_size;
-    const auto num_threads = spatial_size < NBLA_CUDA_GN_NUM_THREADS
-                                 ? CUDA_WARP_SIZE
-                                 : NBLA_CUDA_GN_NUM_THREADS;
-
-    const auto grid =
-        std::min(bc_size, static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
-    const auto block = num_threads;
 
     GNGradOp<Tc, Size_t> op(x, dy, sum_dy, sum_dyx);
-    reduce_2d_x<<<grid, block>>>(op, bc_size, spatial_size);
+    if (channel_last_) {
+      const dim3 block(CUDA_WARP_SIZE, NBLA_CUDA_REDUCE_3D_Y_ROWS);
+      const dim3 grid(
+          NBLA_CEIL_SIZE_T_DIV(channel_size_, CUDA_WARP_SIZE),
+          std::min(batch_size_, static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS)));
+      reduce_3d_y<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, batch_size_, spatial_size, channel_size_);
+    } else {
+      const auto num_threads = spatial_size < NBLA_CUDA_GN_NUM_THREADS
+                                   ? CUDA_WARP_SIZE
+                                   : NBLA_CUDA_GN_NUM_THREADS;
+
+      const auto grid =
+          std::min(bc_size, static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
+      const auto block = num_threads;
+
+      reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(op, bc_size,
+                                                                 spatial_size);
+    }
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -280,8 +330,9 @@ void GroupNormalizationCuda<T>::backward_channel_first(
         static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
     const auto block = num_threads;
 
-    group_norm_backward_gamma_invstd<Tc, Size_t,
-                                     NBLA_CUDA_GN_N_UNROLL><<<grid, block>>>(
+    auto kernel =
+        group_norm_backward_gamma_invstd<Tc, Size_t, NBLA_CUDA_GN_N_UNROLL>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         size, channel_size_, this->num_groups_, gamma, var, gamma_invstd,
         this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
@@ -316,7 +367,8 @@ void GroupNormalizationCuda<T>::backward_channel_first(
                       static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
     dim3 block(num_threads);
 
-    group_norm_backward_dx_factor<<<grid, block>>>(
+    group_norm_backward_dx_factor<<<grid, block, 0,
+                                    cuda_get_current_stream()>>>(
         batch_size_, channel_size_, spatial_size, inv_reduce_size_,
         this->num_groups_, mean, var, dmean, dvar, gamma, sum_dy, sum_dyx,
         factor1, factor2, this->eps_);
@@ -334,20 +386,44 @@ void GroupNormalizationCuda<T>::backward_channel_first(
 
     const Size_t size = inputs[0]->size();
     const Size_t spatial_size = size / (batch_size_ * channel_size_);
-    const Size_t num_threads = CUDA_WARP_SIZE * 2;
 
-    const auto block = num_threads;
-    const auto grid = std::min(
-        NBLA_CEIL_SIZE_T_DIV(size, num_threads * NBLA_CUDA_GN_N_UNROLL),
-        static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
-
-    auto kernel =
-        accum[0]
-            ? group_norm_backward_dx<true, Tc, Size_t, NBLA_CUDA_GN_N_UNROLL>
-            : group_norm_backward_dx<false, Tc, Size_t, NBLA_CUDA_GN_N_UNROLL>;
-    kernel<<<grid, block>>>(size, channel_size_, spatial_size,
-                            this->num_groups_, x, dy, gamma_invstd, factor1,
-                            factor2, dx);
+    if (channel_last_) {
+      constexpr int N = max_pack_size<Tc>();
+      const bool vectorize =
+          channel_size_ % N == 0 && pack_aligned<Tc, N>(x, dy, dx);
+      const auto block = NBLA_CUDA_GN_NUM_THREADS;
+      const auto grid = std::min(
+          NBLA_CEIL_SIZE_T_DIV(size / (vectorize ? N : 1), block),
+          static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
+      auto kernel = group_norm_backward_dx_channel_last<false, Tc, Size_t, 1>;
+      if (vectorize) {
+        kernel =
+            accum[0]
+                ? group_norm_backward_dx_channel_last<true, Tc, Size_t, N>
+                : group_norm_backward_dx_channel_last<false, Tc, Size_t, N>;
+      } else if (accum[0]) {
+        kernel = group_norm_backward_dx_channel_last<true, Tc, Size_t, 1>;
+      }
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          size, channel_size_, spatial_size, this->num_groups_, x, dy,
+          gamma_invstd, factor1, factor2, dx);
+    } else {
+      const Size_t num_threads = CUDA_WARP_SIZE * 2;
+
+      const auto block = num_threads;
+      const auto grid = std::min(
+          NBLA_CEIL_SIZE_T_DIV(size, num_threads * NBLA_CUDA_GN_N_UNROLL),
+          static_cast<Size_t>(NBLA_CUDA_GN_MAX_BLOCKS));
+
+      auto kernel =
+          accum[0]
+              ? group_norm_backward_dx<true, Tc, Size_t, NBLA_CUDA_GN_N_UNROLL>
+              : group_norm_backward_dx<false, Tc, Size_t,
+                                       NBLA_CUDA_GN_N_UNROLL>;
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          size, channel_size_, spatial_size, this->num_groups_, x, dy,
+          gamma_invstd, factor1, factor2, dx);
+    }
     NBLA_CUDA_KERNEL_CHECK();
 
     // Clear internal buffer
@@ -391,8 +467,9 @@ void GroupNormalizationCuda<T>::backward_channel_first(
                    ? group_norm_backward_dbeta_dgamma<false, true, Tc, Size_t>
                    : group_norm_backward_dbeta_dgamma<false, false, Tc, Size_t>;
     }
-    kernel<<<grid, block>>>(batch_size_, channel_size_, this->num_groups_, mean,
-                            var, sum_dy, sum_dyx, dbeta, dgamma, this->eps_);
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        batch_size_, channel_size_, this->num_groups_, mean, var, sum_dy,
+        sum_dyx, dbeta, dgamma, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -40,11 +40,21 @@ void InstanceNormalizationCuda<T>::setup_impl(const Variables &inputs,
     return;
   }
 
-  // Setup input and output adaptor for channel-last memory format
-  need_adaptor_ = ChannelFirstAdaptor::need_adaptor(
-      inputs[0]->shape(), this->batch_axis_, this->channel_axis_);
-
-  if (need_adaptor_) {
+  // [B, S, C] is normalized directly by the channel-last kernels. The other
+  // non channel-first layouts are transposed by an adaptor.
+  channel_last_ = is_channel_last_layout(inputs[0]->shape(), this->batch_axis_,
+                                         this->channel_axis_);
+  need_adaptor_ =
+      !channel_last_ &&
+      ChannelFirstAdaptor::need_adaptor(inputs[0]->shape(), this->batch_axis_,
+                                        this->channel_axis_);
+
+  if (channel_last_) {
+    channel_size_ = inputs[0]->shape()[this->channel_axis_];
+    reduce_size_ = inputs[0]->size(this->batch_axis_.size()) / channel_size_;
+    inv_reduce_size_ = 1.0f / reduce_size_;
+    outer_size_ = inputs[0]->size() / reduce_size_;
+  } else if (need_adaptor_) {
     adaptor_ = std::make_shared<ChannelFirstAdaptor>();
     adaptor_->setup(inputs[0], &pre_adaptor_, &post_adaptor_, outputs[0],
                     inputs[0]->shape(), this->batch_axis_, this->channel_axis_,
@@ -78,10 +88,8 @@ template <typename T>
 void InstanceNormalizationCuda<T>::forward_impl(const Variables &inputs,
                                                 const Variables &outputs) {
   cuda_set_device(this->device_);
-  // Currently, only channel-fist kernels are provided. Channel-last execution
-  // is performed by transforming input and output memory format to
-  // channel-first and using channel-first implementation. The transformation is
-  // performed by ChannelFirstAdaptor.
+  // Channel-first and [B, S, C] inputs are normalized directly. Other layouts
+  // are transformed to channel-first by ChannelFirstAdaptor.
   if (need_adaptor_) {
     // Transpose input to [B, C, H, W] memory format.
     adaptor_->convert_to_channel_first(inputs[0], &pre_adaptor_);
@@ -92,17 +100,17 @@ void InstanceNormalizationCuda<T>::forward_impl(const Variables &inputs,
     channel_first_outputs[0] = &post_adaptor_;
 
     // Instance normalization
-    forward_channel_first(channel_first_inputs, channel_first_outputs);
+    forward_normalization(channel_first_inputs, channel_first_outputs);
 
     // Transpose output to original memory format.
     adaptor_->convert_from_channel_first(&post_adaptor_, outputs[0]);
   } else {
-    forward_channel_first(inputs, outputs);
+    forward_normalization(inputs, outputs);
   }
 }
 
 template <typename T>
-void InstanceNormalizationCuda<T>::forward_channel_first(
+void InstanceNormalizationCuda<T>::forward_normalization(
     const Variables &inputs, const Variables &outputs) {
   cuda_set_device(this->device_);
 
@@ -120,16 +128,27 @@ void InstanceNormalizationCuda<T>::forward_channel_first(
     Tc *mean = v_mean->cast_data_and_get_pointer<Tc>(this->ctx_, true);
     Tc *var = v_var->cast_data_and_get_pointer<Tc>(this->ctx_, true);
 
-    const int num_threads = reduce_size_ < NBLA_CUDA_IN_NUM_THREADS
-                                ? CUDA_WARP_SIZE
-                                : NBLA_CUDA_IN_NUM_THREADS;
+    WelfordOp<Tc, Size_t> op(x, mean, var, reduce_size_);
+    if (channel_last_) {
+      const Size_t batch_size = outer_size_ / channel_size_;
+      const dim3 block(CUDA_WARP_SIZE, NBLA_CUDA_REDUCE_3D_Y_ROWS);
+      const dim3 grid(
+          NBLA_CEIL_SIZE_T_DIV(channel_size_, CUDA_WARP_SIZE),
+          std::min(batch_size, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS)));
+      reduce_3d_y<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, batch_size, reduce_size_, channel_size_);
+    } else {
+      const int num_threads = reduce_size_ < NBLA_CUDA_IN_NUM_THREADS
+                                  ? CUDA_WARP_SIZE
+                                  : NBLA_CUDA_IN_NUM_THREADS;
 
-    const auto grid =
-        std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
-    const auto block = num_threads;
+      const auto grid =
+          std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      const auto block = num_threads;
 
-    WelfordOp<Tc, Size_t> op(x, mean, var, reduce_size_);
-    reduce_2d_x<<<grid, block>>>(op, outer_size_, reduce_size_);
+      reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, outer_size_, reduce_size_);
+    }
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -149,17 +168,38 @@ void InstanceNormalizationCuda<T>::forward_channel_first(
                           : inputs[gamma_idx]->get_data_pointer<Tc>(this->ctx_);
     Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_);
 
-    const size_t elements_per_grid_y = NBLA_CUDA_IN_NUM_THREADS * 4;
-    dim3 grid;
-    grid.x =
-        std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
-    grid.y = std::min(NBLA_CEIL_SIZE_T_DIV(reduce_size_, elements_per_grid_y),
-                      static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
-    grid.z = 1;
-    const auto block = NBLA_CUDA_IN_NUM_THREADS;
-
-    instance_norm_forward_normalization<<<grid, block>>>(
-        outer_size_, reduce_size_, x, mean, var, beta, gamma, y, this->eps_);
+    if (channel_last_) {
+      const Size_t size = inputs[0]->size();
+      constexpr int N = max_pack_size<Tc>();
+      const bool vectorize =
+          channel_size_ % N == 0 && pack_aligned<Tc, N>(x, y);
+      const auto block = NBLA_CUDA_IN_NUM_THREADS;
+      const auto grid = std::min(
+          NBLA_CEIL_SIZE_T_DIV(size / (vectorize ? N : 1), block),
+          static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      auto kernel =
+          vectorize
+              ? instance_norm_forward_normalization_channel_last<Tc, Size_t, N>
+              : instance_norm_forward_normalization_channel_last<Tc, Size_t,
+                                                                 1>;
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          size, reduce_size_, channel_size_, x, mean, var, beta, gamma, y,
+          this->eps_);
+    } else {
+      const size_t elements_per_grid_y = NBLA_CUDA_IN_NUM_THREADS * 4;
+      dim3 grid;
+      grid.x =
+          std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      grid.y =
+          std::min(NBLA_CEIL_SIZE_T_DIV(reduce_size_, elements_per_grid_y),
+                   static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      grid.z = 1;
+      const auto block = NBLA_CUDA_IN_NUM_THREADS;
+
+      instance_norm_forward_normalization<<<grid, block, 0,
+                                            cuda_get_current_stream()>>>(
+          outer_size_, reduce_size_, x, mean, var, beta, gamma, y, this->eps_);
+    }
     NBLA_CUDA_KERNEL_CHECK();
   }
 }
@@ -185,7 +225,7 @@ void InstanceNormalizationCuda<T>::backward_impl(
 
     auto channel_first_accum = accum;
     channel_first_accum[0] = false;
-    backward_channel_first(channel_first_inputs, channel_first_outputs,
+    backward_normalization(channel_first_inputs, channel_first_outputs,
                            propagate_down, channel_first_accum);
 
     post_adaptor_.data()->array()->clear();
@@ -197,12 +237,12 @@ void InstanceNormalizationCuda<T>::backward_impl(
     pre_adaptor_.data()->array()->clear();
     pre_adaptor_.grad()->array()->clear();
   } else {
-    backward_channel_first(inputs, outputs, propagate_down, accum);
+    backward_normalization(inputs, outputs, propagate_down, accum);
   }
 }
 
 template <typename T>
-void InstanceNormalizationCuda<T>::backward_channel_first(
+void InstanceNormalizationCuda<T>::backward_normalization(
     const Variables &inputs, const Variables &outputs,
     const vector<bool> &propagate_down, const vector<bool> &accum) {
   Variable *v_mean = &mean_;
@@ -220,17 +260,28 @@ void InstanceNormalizationCuda<T>::backward_channel_first(
     Tc *sum_dy = sum_dy_.cast_data_and_get_pointer<Tc>(this->ctx_);
     Tc *sum_dyx = sum_dyx_.cast_data_and_get_pointer<Tc>(this->ctx_);
 
-    const int num_threads = reduce_size_ < NBLA_CUDA_IN_NUM_THREADS
-                                ? CUDA_WARP_SIZE
-                                : NBLA_CUDA_IN_NUM_THREADS;
+    INGradOp<Tc, Size_t> op(x, dy, sum_dy, sum_dyx);
+    if (channel_last_) {
+      const Size_t batch_size = outer_size_ / channel_size_;
+      const dim3 block(CUDA_WARP_SIZE, NBLA_CUDA_REDUCE_3D_Y_ROWS);
+      const dim3 grid(
+          NBLA_CEIL_SIZE_T_DIV(channel_size_, CUDA_WARP_SIZE),
+          std::min(batch_size, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS)));
+      reduce_3d_y<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, batch_size, reduce_size_, channel_size_);
+    } else {
+      const int num_threads = reduce_size_ < NBLA_CUDA_IN_NUM_THREADS
+                                  ? CUDA_WARP_SIZE
+                                  : NBLA_CUDA_IN_NUM_THREADS;
 
-    const auto grid =
-        std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      const auto grid =
+          std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
 
-    const auto block = num_threads;
+      const auto block = num_threads;
 
-    INGradOp<Tc, Size_t> op(x, dy, sum_dy, sum_dyx);
-    reduce_2d_x<<<grid, block>>>(op, outer_size_, reduce_size_);
+      reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(
+          op, outer_size_, reduce_size_);
+    }
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -258,7 +309,8 @@ void InstanceNormalizationCuda<T>::backward_channel_first(
                                    outer_size_, NBLA_CUDA_IN_NUM_THREADS)));
     const auto block = NBLA_CUDA_IN_NUM_THREADS;
 
-    instance_norm_backward_dx_factor<<<grid, block>>>(
+    instance_norm_backward_dx_factor<<<grid, block, 0,
+                                       cuda_get_current_stream()>>>(
         outer_size_, inv_reduce_size_, gamma, mean, var, dmean, dvar, sum_dy,
         sum_dyx, factor_a, factor_b, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
@@ -279,19 +331,45 @@ void InstanceNormalizationCuda<T>::backward_channel_first(
 
     Tc *dx = inputs[0]->cast_grad_and_get_pointer<Tc>(this->ctx_, !accum[0]);
 
-    const size_t elements_per_grid_y = NBLA_CUDA_IN_NUM_THREADS * 4;
-    dim3 grid;
-    grid.x =
-        std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
-    grid.y = std::min(NBLA_CEIL_SIZE_T_DIV(reduce_size_, elements_per_grid_y),
-                      static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
-    grid.z = 1;
-    const auto block = NBLA_CUDA_IN_NUM_THREADS;
-
-    auto kernel = accum[0] ? instance_norm_backward_dx<true, Tc, Size_t>
-                           : instance_norm_backward_dx<false, Tc, Size_t>;
-    kernel<<<grid, block>>>(outer_size_, reduce_size_, x, gamma, dy, var,
-                            factor_a, factor_b, dx, this->eps_);
+    if (channel_last_) {
+      const Size_t size = inputs[0]->size();
+      constexpr int N = max_pack_size<Tc>();
+      const bool vectorize =
+          channel_size_ % N == 0 && pack_aligned<Tc, N>(x, dy, dx);
+      const auto block = NBLA_CUDA_IN_NUM_THREADS;
+      const auto grid = std::min(
+          NBLA_CEIL_SIZE_T_DIV(size / (vectorize ? N : 1), block),
+          static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      auto kernel =
+          instance_norm_backward_dx_channel_last<false, Tc, Size_t, 1>;
+      if (vectorize) {
+        kernel =
+            accum[0]
+                ? instance_norm_backward_dx_channel_last<true, Tc, Size_t, N>
+                : instance_norm_backward_dx_channel_last<false, Tc, Size_t, N>;
+      } else if (accum[0]) {
+        kernel = instance_norm_backward_dx_channel_last<true, Tc, Size_t, 1>;
+      }
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          size, reduce_size_, channel_size_, x, gamma, dy, var, factor_a,
+          factor_b, dx, this->eps_);
+    } else {
+      const size_t elements_per_grid_y = NBLA_CUDA_IN_NUM_THREADS * 4;
+      dim3 grid;
+      grid.x =
+          std::min(outer_size_, static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      grid.y =
+          std::min(NBLA_CEIL_SIZE_T_DIV(reduce_size_, elements_per_grid_y),
+                   static_cast<Size_t>(NBLA_CUDA_IN_MAX_BLOCKS));
+      grid.z = 1;
+      const auto block = NBLA_CUDA_IN_NUM_THREADS;
+
+      auto kernel = accum[0] ? instance_norm_backward_dx<true, Tc, Size_t>
+                             : instance_norm_backward_dx<false, Tc, Size_t>;
+      kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+          outer_size_, reduce_size_, x, gamma, dy, var, factor_a, factor_b, dx,
+          this->eps_);
+    }
     NBLA_CUDA_KERNEL_CHECK();
 
     // Clear internal buffer
@@ -341,8 +419,9 @@ void InstanceNormalizationCuda<T>::backward_channel_first(
               ? instance_norm_backward_dbeta_dgamma<false, true, Tc, Size_t>
               : instance_norm_backward_dbeta_dgamma<false, false, Tc, Size_t>;
     }
-    kernel<<<grid, block>>>(outer_size_, reduce_size_, x, gamma, dy, sum_dy,
-                            sum_dyx, mean, var, dbeta, dgamma, this->eps_);
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        outer_size_, reduce_size_, x, gamma, dy, sum_dy, sum_dyx, mean, var,
+        dbeta, dgamma, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
   }
 
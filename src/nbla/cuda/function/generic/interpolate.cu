@@ -15,8 +15,8 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/interpolate.hpp>
-#include <nbla/cuda/utils/atomic_add.cuh>
 #include <nbla/cuda/utils/nd_index.cuh>
+#include <nbla/cuda/utils/scatter_add.cuh>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -197,9 +197,10 @@ __global__ void kernel_linear_interpolate_3d(
 
 template <typename T, bool channel_last = false>
 __global__ void kernel_linear_interpolate_1d_backward(
-    const int g_y_inner_size, const T *g_y, const int g_x_inner_size, T *g_x,
-    int outer_size, const int ishape, const int istride, const int ostride,
-    const float sx, const bool half_pixel) {
+    const int g_y_inner_size, const T *g_y, const int g_x_inner_size,
+    const ScatterAddView<T> g_x, const int outer_size, const int ishape,
+    const int istride, const int ostride, const float sx,
+    const bool half_pixel) {
 
   NBLA_CUDA_KERNEL_LOOP(index, g_y_inner_size) {
     const auto nd_index = device_flat_to_2d(index, ostride);
@@ -220,19 +221,22 @@ __global__ void kernel_linear_interpolate_1d_backward(
     const auto idx_lx1 = device_2d_to_flat(nd_idx_x1, istride);
     const auto idx_lx2 = device_2d_to_flat(nd_idx_x2, istride);
 
-    for (; outer_size--; g_x += g_x_inner_size, g_y += g_y_inner_size) {
-      const T g = g_y[index];
-      atomic_add(g_x + idx_lx1, lx0 * g);
-      atomic_add(g_x + idx_lx2, lx1 * g);
+    for (int o = 0; o < outer_size; o++) {
+      const T g = g_y[o * g_y_inner_size + index];
+      const int offset = o * g_x_inner_size;
+      const Size_t slot = static_cast<Size_t>(o * g_y_inner_size + index) * 2;
+      g_x(slot + 0, offset + idx_lx1, lx0 * g);
+      g_x(slot + 1, offset + idx_lx2, lx1 * g);
     }
   }
 }
 
 template <typename T, bool channel_last = false>
 __global__ void kernel_linear_interpolate_2d_backward(
-    const int g_y_inner_size, const T *g_y, const int g_x_inner_size, T *g_x,
-    int outer_size, const int2 ishape, const int2 istride, const int2 ostride,
-    const float sx, const float sy, const bool half_pixel) {
+    const int g_y_inner_size, const T *g_y, const int g_x_inner_size,
+    const ScatterAddView<T> g_x, const int outer_size, const int2 ishape,
+    const int2 istride, const int2 ostride, const float sx, const float sy,
+    const bool half_pixel) {
 
   NBLA_CUDA_KERNEL_LOOP(index, g_y_inner_size) {
     const auto nd_index = device_flat_to_3d(index, ostride);
@@ -264,21 +268,24 @@ __global__ void kernel_linear_interpolate_2d_backward(
     const auto idx_ly0x1 = device_3d_to_flat(nd_idx_y1x2, istride);
     const auto idx_ly1x0 = device_3d_to_flat(nd_idx_y2x1, istride);
     const auto idx_ly1x1 = device_3d_to_flat(nd_idx_y2x2, istride);
-    for (; outer_size--; g_x += g_x_inner_size, g_y += g_y_inner_size) {
-      const T g = g_y[index];
-      atomic_add(g_x + idx_ly0x0, ly0 * lx0 * g);
-      atomic_add(g_x + idx_ly0x1, ly0 * lx1 * g);
-      atomic_add(g_x + idx_ly1x0, ly1 * lx0 * g);
-      atomic_add(g_x + idx_ly1x1, ly1 * lx1 * g);
+    for (int o = 0; o < outer_size; o++) {
+      const T g = g_y[o * g_y_inner_size + index];
+      const int offset = o * g_x_inner_size;
+      const Size_t slot = static_cast<Size_t>(o * g_y_inner_size + index) * 4;
+      g_x(slot + 0, offset + idx_ly0x0, ly0 * lx0 * g);
+      g_x(slot + 1, offset + idx_ly0x1, ly0 * lx1 * g);
+      g_x(slot + 2, offset + idx_ly1x0, ly1 * lx0 * g);
+      g_x(slot + 3, offset + idx_ly1x1, ly1 * lx1 * g);
     }
   }
 }
 
 template <typename T, bool channel_last = false>
 __global__ void kernel_linear_interpolate_3d_backward(
-    const int g_y_inner_size, const T *g_y, const int g_x_inner_size, T *g_x,
-    int outer_size, const int3 ishape, const int3 istride, const int3 ostride,
-    const float sx, const float sy, const float sz, const bool half_pixel) {
+    const int g_y_inner_size, const T *g_y, const int g_x_inner_size,
+    const ScatterAddView<T> g_x, const int outer_size, const int3 ishape,
+    const int3 istride, const int3 ostride, const float sx, const float sy,
+    const float sz, const bool half_pixel) {
 
   NBLA_CUDA_KERNEL_LOOP(index, g_y_inner_size) {
     const auto nd_index = device_flat_to_4d(index, ostride);
@@ -327,16 +334,18 @@ __global__ void kernel_linear_interpolate_3d_backward(
     const auto idx_lz1y1x0 = device_4d_to_flat(nd_idx_z2y2x1, istride);
     const auto idx_lz1y1x1 = device_4d_to_flat(nd_idx_z2y2x2, istride);
 
-    for (; outer_size--; g_x += g_x_inner_size, g_y += g_y_inner_size) {
-      const T g = g_y[index];
-      atomic_add(g_x + idx_lz0y0x0, lz0 * ly0 * lx0 * g);
-      atomic_add(g_x + idx_lz0y0x1, lz0 * ly0 * lx1 * g);
-      atomic_add(g_x + idx_lz0y1x0, lz0 * ly1 * lx0 * g);
-      atomic_add(g_x + idx_lz0y1x1, lz0 * ly1 * lx1 * g);
-      atomic_add(g_x + idx_lz1y0x0, lz1 * ly0 * lx0 * g);
-      atomic_add(g_x + idx_lz1y0x1, lz1 * ly0 * lx1 * g);
-      atomic_add(g_x + idx_lz1y1x0, lz1 * ly1 * lx0 * g);
-      atomic_add(g_x + idx_lz1y1x1, lz1 * ly1 * lx1 * g);
+    for (int o = 0; o < outer_size; o++) {
+      const T g = g_y[o * g_y_inner_size + index];
+      const int offset = o * g_x_inner_size;
+      const Size_t slot = static_cast<Size_t>(o * g_y_inner_size + index) * 8;
+      g_x(slot + 0, offset + idx_lz0y0x0, lz0 * ly0 * lx0 * g);
+      g_x(slot + 1, offset + idx_lz0y0x1, lz0 * ly0 * lx1 * g);
+      g_x(slot + 2, offset + idx_lz0y1x0, lz0 * ly1 * lx0 * g);
+      g_x(slot + 3, offset + idx_lz0y1x1, lz0 * ly1 * lx1 * g);
+      g_x(slot + 4, offset + idx_lz1y0x0, lz1 * ly0 * lx0 * g);
+      g_x(slot + 5, offset + idx_lz1y0x1, lz1 * ly0 * lx1 * g);
+      g_x(slot + 6, offset + idx_lz1y1x0, lz1 * ly1 * lx0 * g);
+      g_x(slot + 7, offset + idx_lz1y1x1, lz1 * ly1 * lx1 * g);
     }
   }
 }
@@ -426,9 +435,10 @@ __global__ void kernel_nearest_interpolate_3d(
 
 template <typename T, bool channel_last = false>
 __global__ void kernel_nearest_interpolate_1d_backward(
-    const int g_y_inner_size, const T *g_y, const int g_x_inner_size, T *g_x,
-    int outer_size, const int ishape, const int istride, const int ostride,
-    const float sx, const bool half_pixel, const bool half_pixel_for_nn) {
+    const int g_y_inner_size, const T *g_y, const int g_x_inner_size,
+    const ScatterAddView<T> g_x, const int outer_size, const int ishape,
+    const int istride, const int ostride, const float sx,
+    const bool half_pixel, const bool half_pixel_for_nn) {
 
   NBLA_CUDA_KERNEL_LOOP(index, g_y_inner_size) {
     const auto nd_index = device_flat_to_2d(index, ostride);
@@ -441,18 +451,21 @@ __global__ void kernel_nearest_interpolate_1d_backward(
 
     const auto nd_idx_x = make_int2(ix, oc);
     const auto idx_x = device_2d_to_flat(nd_idx_x, istride);
-    for (; outer_size--; g_x += g_x_inner_size, g_y += g_y_inner_size) {
-      atomic_add(g_x + idx_x, g_y[index]);
+    for (int o = 0; o < outer_size; o++) {
+      const T g = g_y[o * g_y_inner_size + index];
+      const int offset = o * g_x_inner_size;
+      const Size_t slot = o * g_y_inner_size + index;
+      g_x(slot, offset + idx_x, g);
     }
   }
 }
 
 template <typename T, bool channel_last = false>
 __global__ void kernel_nearest_interpolate_2d_backward(
-    const int g_y_inner_size, const T *g_y, const int g_x_inner_size, T *g_x,
-    int outer_size, const int2 ishape, const int2 istride, const int2 ostride,
-    const float sx, const float sy, const bool half_pixel,
-    const bool half_pixel_for_nn) {
+    const int g_y_inner_size, const T *g_y, const int g_x_inner_size,
+    const ScatterAddView<T> g_x, const int outer_size, const int2 ishape,
+    const int2 istride, const int2 ostride, const float sx, const float sy,
+    const bool half_pixel, const bool half_pixel_for_nn) {
 
   NBLA_CUDA_KERNEL_LOOP(index, g_y_inner_size) {
     const auto nd_index = device_flat_to_3d(index, ostride);
@@ -471,18 +484,21 @@ __global__ void kernel_nearest_interpolate_2d_backward(
     const auto nd_idx_yx = make_int3(iy, ix, oc);
     const auto idx_yx = device_3d_to_flat(nd_idx_yx, istride);
 
-    for (; outer_size--; g_x += g_x_inner_size, g_y += g_y_inner_size) {
-      atomic_add(g_x + idx_yx, g_y[index]);
+    for (int o = 0; o < outer_size; o++) {
+      const T g = g_y[o * g_y_inner_size + index];
+      const int offset = o * g_x_inner_size;
+      const Size_t slot = o * g_y_inner_size + index;
+      g_x(slot, offset + idx_yx, g);
     }
   }
 }
 
 template <typename T, bool channel_last = false>
 __global__ void kernel_nearest_interpolate_3d_backward(
-    const int g_y_inner_size, const T *g_y, const int g_x_inner_size, T *g_x,
-    int outer_size, const int3 ishape, const int3 istride, const int3 ostride,
-    const float sx, const float sy, const float sz, const bool half_pixel,
-    const bool half_pixel_for_nn) {
+    const int g_y_inner_size, const T *g_y, const int g_x_inner_size,
+    const ScatterAddView<T> g_x, const int outer_size, const int3 ishape,
+    const int3 istride, const int3 ostride, const float sx, const float sy,
+    const float sz, const bool half_pixel, const bool half_pixel_for_nn) {
 
   NBLA_CUDA_KERNEL_LOOP(index, g_y_inner_size) {
     const auto nd_index = device_flat_to_4d(index, ostride);
@@ -504,8 +520,11 @@ __global__ void kernel_nearest_interpolate_3d_backward(
 
     const auto nd_idx_zyx = make_int4(iz, iy, ix, oc);
     const auto idx_zyx = device_4d_to_flat(nd_idx_zyx, istride);
-    for (; outer_size--; g_x += g_x_inner_size, g_y += g_y_inner_size) {
-      atomic_add(g_x + idx_zyx, g_y[index]);
+    for (int o = 0; o < outer_size; o++) {
+      const T g = g_y[o * g_y_inner_size + index];
+      const int offset = o * g_x_inner_size;
+      const Size_t slot = o * g_y_inner_size + index;
+      g_x(slot, offset + idx_zyx, g);
     }
   }
 }
@@ -696,18 +715,24 @@ void InterpolateCuda<T>::backward_impl(const Variables &inputs,
       auto kernel = this->channel_last_
                         ? kernel_linear_interpolate_1d_backward<Tcu, true>
                         : kernel_linear_interpolate_1d_backward<Tcu, false>;
+      ScatterAdder<Tcu> adder(this->ctx_, g_x, outputs[0]->size() * 2);
       NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel, g_y_inner_size, g_y,
-                                     g_x_inner_size, g_x, outer_size, ishape,
-                                     istride, ostride, sx, this->half_pixel_);
+                                     g_x_inner_size, adder.view(), outer_size,
+                                     ishape, istride, ostride, sx,
+                                     this->half_pixel_);
+      adder.finish();
     } else if (this->mode_ == "nearest") {
       const float sx = compute_scale_for_nn(iw, ow, this->align_corners_,
                                             this->half_pixel_for_nn_);
       auto kernel = this->channel_last_
                         ? kernel_nearest_interpolate_1d_backward<Tcu, true>
                         : kernel_nearest_interpolate_1d_backward<Tcu, false>;
+      ScatterAdder<Tcu> adder(this->ctx_, g_x, outputs[0]->size());
       NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          kernel, g_y_inner_size, g_y, g_x_inner_size, g_x, outer_size, ishape,
-          istride, ostride, sx, this->half_pixel_, this->half_pixel_for_nn_);
+          kernel, g_y_inner_size, g_y, g_x_inner_size, adder.view(),
+          outer_size, ishape, istride, ostride, sx, this->half_pixel_,
+          this->half_pixel_for_nn_);
+      adder.finish();
     }
   }
 
@@ -738,9 +763,11 @@ void InterpolateCuda<T>::backward_impl(const Variables &inputs,
       auto kernel = this->channel_last_
                         ? kernel_linear_interpolate_2d_backward<Tcu, true>
                         : kernel_linear_interpolate_2d_backward<Tcu, false>;
+      ScatterAdder<Tcu> adder(this->ctx_, g_x, outputs[0]->size() * 4);
       NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          kernel, g_y_inner_size, g_y, g_x_inner_size, g_x, outer_size, ishape,
-          istride, ostride, sx, sy, this->half_pixel_);
+          kernel, g_y_inner_size, g_y, g_x_inner_size, adder.view(),
+          outer_size, ishape, istride, ostride, sx, sy, this->half_pixel_);
+      adder.finish();
     } else if (this->mode_ == "nearest") {
       const float sx = compute_scale_for_nn(iw, ow, this->align_corners_,
                                             this->half_pixel_for_nn_);
@@ -749,10 +776,12 @@ void InterpolateCuda<T>::backward_impl(const Variables &inputs,
       auto kernel = this->channel_last_
                         ? kernel_nearest_interpolate_2d_backward<Tcu, true>
                         : kernel_nearest_interpolate_2d_backward<Tcu, false>;
+      ScatterAdder<Tcu> adder(this->ctx_, g_x, outputs[0]->size());
       NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          kernel, g_y_inner_size, g_y, g_x_inner_size, g_x, outer_size, ishape,
-          istride, ostride, sx, sy, this->half_pixel_,
+          kernel, g_y_inner_size, g_y, g_x_inner_size, adder.view(),
+          outer_size, ishape, istride, ostride, sx, sy, this->half_pixel_,
           this->half_pixel_for_nn_);
+      adder.finish();
     }
   }
 
@@ -793,9 +822,11 @@ void InterpolateCuda<T>::backward_impl(const Variables &inputs,
       auto kernel = this->channel_last_
                         ? kernel_linear_interpolate_3d_backward<Tcu, true>
                         : kernel_linear_interpolate_3d_backward<Tcu, false>;
+      ScatterAdder<Tcu> adder(this->ctx_, g_x, outputs[0]->size() * 8);
       NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          kernel, g_y_inner_size, g_y, g_x_inner_size, g_x, outer_size, ishape,
-          istride, ostride, sx, sy, sz, this->half_pixel_);
+          kernel, g_y_inner_size, g_y, g_x_inner_size, adder.view(),
+          outer_size, ishape, istride, ostride, sx, sy, sz, this->half_pixel_);
+      adder.finish();
     } else if (this->mode_ == "nearest") {
       const float sx = compute_scale_for_nn(iw, ow, this->align_corners_,
                                             this->half_pixel_for_nn_);
@@ -806,10 +837,12 @@ void InterpolateCuda<T>::backward_impl(const Variables &inputs,
       auto kernel = this->channel_last_
                         ? kernel_nearest_interpolate_3d_backward<Tcu, true>
                         : kernel_nearest_interpolate_3d_backward<Tcu, false>;
+      ScatterAdder<Tcu> adder(this->ctx_, g_x, outputs[0]->size());
       NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-          kernel, g_y_inner_size, g_y, g_x_inner_size, g_x, outer_size, ishape,
-          istride, ostride, sx, sy, sz, this->half_pixel_,
+          kernel, g_y_inner_size, g_y, g_x_inner_size, adder.view(),
+          outer_size, ishape, istride, ostride, sx, sy, sz, this->half_pixel_,
           this->half_pixel_for_nn_);
+      adder.finish();
     }
   }
 }
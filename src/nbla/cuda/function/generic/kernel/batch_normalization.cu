@@ -64,35 +64,36 @@ void forward_batch_parallel_reduction(
     const int size0, const int size1, const int size2, const int ndim,
     const int *axes, const int *x_strides, const int *x_shape,
     const int *y_strides, const int *y_shape, const float decay_rate,
-    const float eps, const T *x, const T *gamma, const T *beta, T *x_trans,
-    T *m, T *v, T *rm, T *rv, T *y, T *tmp_mean_buffer_per_block,
+    const float eps, const T *x_trans, const T *gamma, const T *beta, T *m,
+    T *v, T *rm, T *rv, T *y, T *tmp_mean_buffer_per_block,
     T *tmp_variance_buffer_per_block, T *inv_sqrt_variance) {
   int N = size0 * size2;
   reduction_blocks(blocks, N);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(transpose_kernel, size1 * N, ndim, axes,
-                                 x_strides, y_strides, y_shape, x, x_trans);
 #ifdef TEST_FEATURE_MEAN_VARIANCE_AXIS_REDUCTION_KERNEL
   printf("TEST_FEATURE_MEAN_VARIANCE_AXIS_REDUCTION_KERNEL\n");
-  mean_variance_with_axis_kernel<<<blocks, NBLA_CUDA_NUM_THREADS>>>(
+  mean_variance_with_axis_kernel<<<blocks, NBLA_CUDA_NUM_THREADS, 0,
+                                   cuda_get_current_stream()>>>(
       x_trans, tmp_mean_buffer_per_block, tmp_variance_buffer_per_block, m, v,
       N, blocks, size1);
 #elif defined TEST_FEATURE_MEAN_VARIANCE_KERNEL
   printf("TEST_FEATURE_MEAN_VARIANCE_KERNEL\n");
   for (int i = 0; i < size1; ++i) {
-    mean_variance_kernel<<<blocks, NBLA_CUDA_NUM_THREADS>>>(
+    mean_variance_kernel<<<blocks, NBLA_CUDA_NUM_THREADS, 0,
+                           cuda_get_current_stream()>>>(
         x_trans + i * N, tmp_mean_buffer_per_block,
         tmp_variance_buffer_per_block, m + i, v + i, N, blocks);
   }
 #else
   blocks = min((N + NBLA_CUDA_NUM_THREADS - 1) / NBLA_CUDA_NUM_THREADS, 1024);
   for (int i = 0; i < size1; ++i) {
-    forward_batch_kernel_mean_variance_preprocess<<<blocks,
-                                                    NBLA_CUDA_NUM_THREADS>>>(
+    forward_batch_kernel_mean_variance_preprocess<<<
+        blocks, NBLA_CUDA_NUM_THREADS, 0, cuda_get_current_stream()>>>(
         /* Input */
         x_trans + i * N, N,
         /* Output */
         tmp_mean_buffer_per_block, tmp_variance_buffer_per_block);
-    forward_batch_kernel_mean_variance_postprocess<<<1, 1024>>>(
+    forward_batch_kernel_mean_variance_postprocess<<<
+        1, 1024, 0, cuda_get_current_stream()>>>(
         /* Input */
         tmp_mean_buffer_per_block, tmp_variance_buffer_per_block, blocks,
         decay_rate, 1. / N, (float)N / (N - 1),
@@ -124,13 +125,14 @@ void backward_batch_data_parallel_reduction(
       min((N + NBLA_CUDA_NUM_THREADS - 1) / NBLA_CUDA_NUM_THREADS, 1024);
   for (int i = 0; i < size1; i++) {
     backward_batch_data_kernel_mean_variance_preprocess<<<
-        blocks, NBLA_CUDA_NUM_THREADS>>>(
+        blocks, NBLA_CUDA_NUM_THREADS, 0, cuda_get_current_stream()>>>(
         /* Input */
         N, dy_trans + i * N, x_trans + i * N, g ? g + i : nullptr, m + i,
         /* Output */
         tmp_mean_buffer_per_block, tmp_variance_buffer_per_block,
         tmp_t_buffer_per_block);
-    backward_batch_data_kernel_mean_variance_postprocess<<<1, 1024>>>(
+    backward_batch_data_kernel_mean_variance_postprocess<<<
+        1, 1024, 0, cuda_get_current_stream()>>>(
         /* Input */
         tmp_mean_buffer_per_block, tmp_variance_buffer_per_block,
         tmp_t_buffer_per_block, blocks, 1. / N, v + i, dm, dv, eps, N,
@@ -157,13 +159,14 @@ void backward_batch_gamma_beta_parallel_reduction(
       min((N + NBLA_CUDA_NUM_THREADS - 1) / NBLA_CUDA_NUM_THREADS, 1024);
 
   for (int i = 0; i < size1; i++) {
-    backward_batch_kernel_gamma_beta_preprocess<<<blocks,
-                                                  NBLA_CUDA_NUM_THREADS>>>(
+    backward_batch_kernel_gamma_beta_preprocess<<<
+        blocks, NBLA_CUDA_NUM_THREADS, 0, cuda_get_current_stream()>>>(
         /* Input */
         N, dy_trans + i * N, x_trans + i * N, m + i,
         /* Output */
         gamma_reduction_space, beta_reduction_space, inv_sqrt_variance + i);
-    backward_batch_kernel_gamma_beta_postprocess<<<1, 1024>>>(
+    backward_batch_kernel_gamma_beta_postprocess<<<
+        1, 1024, 0, cuda_get_current_stream()>>>(
         /* Input */
         gamma_reduction_space, beta_reduction_space, blocks,
         /* Output */
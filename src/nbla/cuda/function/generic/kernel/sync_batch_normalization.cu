@@ -21,19 +21,19 @@ static bool can_use_int_as_index_t(const Size_t size0, const Size_t size1,
   return size0 * size1 * size2 < std::numeric_limits<int>::max();
 }
 
+// Local sums and moments laid out as described in store_local_moments.
 template <typename T>
 void forward_collect_statistics(const Size_t size0, const Size_t size1,
                                 const Size_t size2, Variable *x,
-                                Variable *local_mean, Variable *local_invstd,
-                                const float epsilon, Context &ctx) {
+                                Variable *sums, Variable *local_stats,
+                                Context &ctx) {
   using input_scalar_t = T;
   using stat_accscalar_t = typename CudaTypeForceFloat<T>::type;
 
   const auto *x_ptr = x->get_data_pointer<input_scalar_t>(ctx);
-  auto *local_mean_ptr =
-      local_mean->cast_data_and_get_pointer<stat_accscalar_t>(ctx);
-  auto *local_invstd_ptr =
-      local_invstd->cast_data_and_get_pointer<stat_accscalar_t>(ctx);
+  auto *sums_ptr = sums->cast_data_and_get_pointer<stat_accscalar_t>(ctx, true);
+  auto *local_ptr =
+      local_stats->cast_data_and_get_pointer<stat_accscalar_t>(ctx, true);
 
   dim3 blocks(size1);
   int tf = getNumThreads(size2);
@@ -41,14 +41,18 @@ void forward_collect_statistics(const Size_t size0, const Size_t size1,
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_collect_statistics_kernel<
-        InvStd, input_scalar_t, stat_accscalar_t, index_t><<<blocks, threads>>>(
-        x_ptr, epsilon, local_mean_ptr, local_invstd_ptr, size0, size1, size2);
+    auto kernel =
+        batch_norm_collect_statistics_kernel<input_scalar_t, stat_accscalar_t,
+                                             index_t>;
+    kernel<<<blocks, threads, 0, cuda_get_current_stream()>>>(
+        x_ptr, sums_ptr, local_ptr, size0, size1, size2);
   } else {
     using index_t = Size_t;
-    batch_norm_collect_statistics_kernel<
-        InvStd, input_scalar_t, stat_accscalar_t, index_t><<<blocks, threads>>>(
-        x_ptr, epsilon, local_mean_ptr, local_invstd_ptr, size0, size1, size2);
+    auto kernel =
+        batch_norm_collect_statistics_kernel<input_scalar_t, stat_accscalar_t,
+                                             index_t>;
+    kernel<<<blocks, threads, 0, cuda_get_current_stream()>>>(
+        x_ptr, sums_ptr, local_ptr, size0, size1, size2);
   }
   NBLA_CUDA_KERNEL_CHECK();
 }
@@ -56,8 +60,8 @@ void forward_collect_statistics(const Size_t size0, const Size_t size1,
 template <typename T>
 void forward_collect_statistics_channels_last(
     const Size_t size0, const Size_t size1, const Size_t size2, Variable *x,
-    Variable *local_mean, Variable *local_invstd, Variable *staging_data,
-    Variable *semaphores, const float epsilon, Context &ctx) {
+    Variable *sums, Variable *local_stats, Variable *staging_data,
+    Variable *semaphores, Context &ctx) {
   using scalar_t = T;
   using accscalar_t = typename CudaTypeForceFloat<T>::type;
   const Size_t reduction_size = size0;
@@ -73,10 +77,9 @@ void forward_collect_statistics_channels_last(
   }
 
   const auto *x_ptr = x->get_data_pointer<scalar_t>(ctx);
-  auto *local_mean_ptr =
-      local_mean->cast_data_and_get_pointer<accscalar_t>(ctx);
-  auto *local_invstd_ptr =
-      local_invstd->cast_data_and_get_pointer<accscalar_t>(ctx);
+  auto *sums_ptr = sums->cast_data_and_get_pointer<accscalar_t>(ctx, true);
+  auto *local_ptr =
+      local_stats->cast_data_and_get_pointer<accscalar_t>(ctx, true);
 
   auto *staging_data_ptr =
       grid.y > 1 ? staging_data->cast_data_and_get_pointer<accscalar_t>(ctx)
@@ -86,70 +89,63 @@ void forward_collect_statistics_channels_last(
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_collect_statistics_channels_last_kernel<
-        InvStd, scalar_t, accscalar_t, index_t,
-        SYNC_BN_ELEMENTS_PER_ITER><<<grid, block>>>(
-        x_ptr, local_mean_ptr, local_invstd_ptr, staging_data_ptr,
-        semaphores_ptr, reduction_size, stride, epsilon);
+    auto kernel = batch_norm_collect_statistics_channels_last_kernel<
+        scalar_t, accscalar_t, index_t, SYNC_BN_ELEMENTS_PER_ITER>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        x_ptr, sums_ptr, local_ptr, staging_data_ptr, semaphores_ptr,
+        reduction_size, stride);
   } else {
     using index_t = Size_t;
-    batch_norm_collect_statistics_channels_last_kernel<
-        InvStd, scalar_t, accscalar_t, index_t,
-        SYNC_BN_ELEMENTS_PER_ITER><<<grid, block>>>(
-        x_ptr, local_mean_ptr, local_invstd_ptr, staging_data_ptr,
-        semaphores_ptr, reduction_size, stride, epsilon);
+    auto kernel = batch_norm_collect_statistics_channels_last_kernel<
+        scalar_t, accscalar_t, index_t, SYNC_BN_ELEMENTS_PER_ITER>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        x_ptr, sums_ptr, local_ptr, staging_data_ptr, semaphores_ptr,
+        reduction_size, stride);
   }
   NBLA_CUDA_KERNEL_CHECK();
 }
 
+// M2 of the local samples around the global mean given by the all-reduced
+// sums.
 template <typename T>
-void forward_reduce_statistics(const Size_t size0, const Size_t size1,
-                               const Size_t size2, Variable *all_mean,
-                               Variable *all_invstd, Variable *all_count,
-                               Variable *global_mean, Variable *global_var,
-                               Variable *r_mean, Variable *r_var,
-                               const float epsilon, const float decay_rate,
-                               Context &ctx, const int n_workers) {
-  using scalar_t = T;
+void forward_centered_moments(const Size_t size1, Variable *sums,
+                              Variable *local_stats, Variable *m2,
+                              Context &ctx) {
   using accscalar_t = typename CudaTypeForceFloat<T>::type;
 
-  const accscalar_t *all_mean_ptr =
-      all_mean->get_data_pointer<accscalar_t>(ctx);
-  const accscalar_t *all_invstd_ptr =
-      all_invstd->get_data_pointer<accscalar_t>(ctx);
+  const auto *sums_ptr = sums->get_data_pointer<accscalar_t>(ctx);
+  const auto *local_ptr = local_stats->get_data_pointer<accscalar_t>(ctx);
+  auto *m2_ptr = m2->cast_data_and_get_pointer<accscalar_t>(ctx, true);
+
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+      batch_norm_centered_moments_kernel<accscalar_t>, size1, sums_ptr,
+      local_ptr, m2_ptr);
+}
+
+template <typename T>
+void forward_finalize_statistics(const Size_t size1, Variable *sums,
+                                 Variable *m2, Variable *global_mean,
+                                 Variable *global_var, Variable *r_mean,
+                                 Variable *r_var, const float decay_rate,
+                                 Context &ctx) {
+  using scalar_t = T;
+  using accscalar_t = typename CudaTypeForceFloat<T>::type;
 
+  const auto *sums_ptr = sums->get_data_pointer<accscalar_t>(ctx);
+  const auto *m2_ptr = m2->get_data_pointer<accscalar_t>(ctx);
   auto *global_mean_ptr =
-      global_mean->cast_data_and_get_pointer<accscalar_t>(ctx);
+      global_mean->cast_data_and_get_pointer<accscalar_t>(ctx, true);
   auto *global_var_ptr =
-      global_var->cast_data_and_get_pointer<accscalar_t>(ctx);
-
+      global_var->cast_data_and_get_pointer<accscalar_t>(ctx, true);
   auto *r_mean_ptr =
       r_mean ? r_mean->cast_data_and_get_pointer<scalar_t>(ctx) : nullptr;
   auto *r_var_ptr =
       r_var ? r_var->cast_data_and_get_pointer<scalar_t>(ctx) : nullptr;
 
-  const auto *all_count_ptr = all_count->get_data_pointer<scalar_t>(ctx);
-
-  const int feature_size = size1;
-  int block = getNumThreads(feature_size);
-  int grid = std::max<int>(1, feature_size / block);
-
-  if (can_use_int_as_index_t(size0, size1, size2)) {
-    using index_t = int;
-    batch_norm_reduce_statistics_kernel<scalar_t, accscalar_t,
-                                        index_t><<<grid, block>>>(
-        all_mean_ptr, all_invstd_ptr, global_mean_ptr, global_var_ptr,
-        r_mean_ptr, r_var_ptr, epsilon, decay_rate, all_count_ptr, feature_size,
-        n_workers);
-  } else {
-    using index_t = Size_t;
-    batch_norm_reduce_statistics_kernel<scalar_t, accscalar_t,
-                                        index_t><<<grid, block>>>(
-        all_mean_ptr, all_invstd_ptr, global_mean_ptr, global_var_ptr,
-        r_mean_ptr, r_var_ptr, epsilon, decay_rate, all_count_ptr, feature_size,
-        n_workers);
-  }
-  NBLA_CUDA_KERNEL_CHECK();
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+      (batch_norm_finalize_statistics_kernel<scalar_t, accscalar_t>), size1,
+      sums_ptr, m2_ptr, global_mean_ptr, global_var_ptr, r_mean_ptr, r_var_ptr,
+      decay_rate);
 }
 
 template <typename T>
@@ -188,16 +184,18 @@ void forward_normalization(const Size_t size0, const Size_t size1,
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_transform_input_kernel<input_scalar_t, stat_scalar_t,
-                                      stat_accscalar_t,
-                                      index_t><<<blocks_trans, threads_trans>>>(
+    auto kernel =
+        batch_norm_transform_input_kernel<input_scalar_t, stat_scalar_t,
+                                          stat_accscalar_t, index_t>;
+    kernel<<<blocks_trans, threads_trans, 0, cuda_get_current_stream()>>>(
         x_ptr, y_ptr, global_mean_ptr, global_var_ptr, weight_ptr, bias_ptr,
         epsilon, size0, size1, size2);
   } else {
     using index_t = Size_t;
-    batch_norm_transform_input_kernel<input_scalar_t, stat_scalar_t,
-                                      stat_accscalar_t,
-                                      index_t><<<blocks_trans, threads_trans>>>(
+    auto kernel =
+        batch_norm_transform_input_kernel<input_scalar_t, stat_scalar_t,
+                                          stat_accscalar_t, index_t>;
+    kernel<<<blocks_trans, threads_trans, 0, cuda_get_current_stream()>>>(
         x_ptr, y_ptr, global_mean_ptr, global_var_ptr, weight_ptr, bias_ptr,
         epsilon, size0, size1, size2);
   }
@@ -236,27 +234,30 @@ void forward_normalization_channel_last(const Size_t size0, const Size_t size1,
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_transform_input_channels_last_kernel<
+    auto kernel = batch_norm_transform_input_channels_last_kernel<
         scalar_t, accscalar_t, layerscalar_t, index_t,
-        SYNC_BN_ELEMENTS_PER_ITER><<<grid, block>>>(
+        SYNC_BN_ELEMENTS_PER_ITER>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         x_ptr, global_mean_ptr, global_var_ptr, gamma_ptr, beta_ptr, y_ptr,
         epsilon, reduction_size, stride);
   } else {
     using index_t = Size_t;
-    batch_norm_transform_input_channels_last_kernel<
+    auto kernel = batch_norm_transform_input_channels_last_kernel<
         scalar_t, accscalar_t, layerscalar_t, index_t,
-        SYNC_BN_ELEMENTS_PER_ITER><<<grid, block>>>(
+        SYNC_BN_ELEMENTS_PER_ITER>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         x_ptr, global_mean_ptr, global_var_ptr, gamma_ptr, beta_ptr, y_ptr,
         epsilon, reduction_size, stride);
   }
   NBLA_CUDA_KERNEL_CHECK();
 }
 
+// Local sums of dy and dy * (x - mean) laid out as
+// [sum_dy (C), sum_dy_xmu (C)].
 template <typename T>
 void backward_reduce(const Size_t size0, const Size_t size1, const Size_t size2,
                      Variable *x, Variable *y, Variable *global_mean,
-                     Variable *global_var, Variable *sum_dy,
-                     Variable *sum_dy_xmu, Variable *beta, Variable *gamma,
+                     Variable *global_var, Variable *grad_sums,
                      const float epsilon, Context &ctx) {
   using input_scalar_t = T;
   using stat_scalar_t = T;
@@ -269,13 +270,11 @@ void backward_reduce(const Size_t size0, const Size_t size1, const Size_t size2,
   const auto *global_var_ptr =
       global_var->get_data_pointer<stat_accscalar_t>(ctx);
   auto *sum_dy_ptr =
-      sum_dy->cast_data_and_get_pointer<stat_accscalar_t>(ctx, true);
-  auto *sum_dy_xmu_ptr =
-      sum_dy_xmu->cast_data_and_get_pointer<stat_accscalar_t>(ctx, true);
-  auto *grad_weight_ptr =
-      gamma->cast_data_and_get_pointer<stat_scalar_t>(ctx, true);
-  auto *grad_bias_ptr =
-      beta->cast_data_and_get_pointer<stat_scalar_t>(ctx, true);
+      grad_sums->cast_data_and_get_pointer<stat_accscalar_t>(ctx, true);
+  auto *sum_dy_xmu_ptr = sum_dy_ptr + size1;
+  // The gradients of beta and gamma are computed after the all_reduce.
+  stat_scalar_t *grad_weight_ptr = nullptr;
+  stat_scalar_t *grad_bias_ptr = nullptr;
 
   auto batch_size = size0;
   auto n_input = size1;
@@ -292,17 +291,19 @@ void backward_reduce(const Size_t size0, const Size_t size1, const Size_t size2,
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_backward_reduce_kernel<input_scalar_t, stat_scalar_t,
-                                      stat_accscalar_t,
-                                      index_t><<<grid, block>>>(
+    auto kernel =
+        batch_norm_backward_reduce_kernel<input_scalar_t, stat_scalar_t,
+                                          stat_accscalar_t, index_t>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         x_ptr, dy_ptr, global_mean_ptr, global_var_ptr, sum_dy_ptr,
         sum_dy_xmu_ptr, grad_weight_ptr, grad_bias_ptr, epsilon, size0, size1,
         size2);
   } else {
     using index_t = Size_t;
-    batch_norm_backward_reduce_kernel<input_scalar_t, stat_scalar_t,
-                                      stat_accscalar_t,
-                                      index_t><<<grid, block>>>(
+    auto kernel =
+        batch_norm_backward_reduce_kernel<input_scalar_t, stat_scalar_t,
+                                          stat_accscalar_t, index_t>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         x_ptr, dy_ptr, global_mean_ptr, global_var_ptr, sum_dy_ptr,
         sum_dy_xmu_ptr, grad_weight_ptr, grad_bias_ptr, epsilon, size0, size1,
         size2);
@@ -314,10 +315,9 @@ template <typename T>
 void backward_reduce_channels_last(const Size_t size0, const Size_t size1,
                                    const Size_t size2, Variable *x, Variable *y,
                                    Variable *batch_mean, Variable *batch_var,
-                                   Variable *sum_dy_o, Variable *sum_dy_xmu_o,
-                                   Variable *beta, Variable *gamma,
-                                   Variable *staging_data, Variable *semaphores,
-                                   const float epsilon, Context &ctx) {
+                                   Variable *grad_sums, Variable *staging_data,
+                                   Variable *semaphores, const float epsilon,
+                                   Context &ctx) {
   using scalar_t = T;
   using layerscalar_t = T;
   using accscalar_t = typename CudaTypeForceFloat<T>::type;
@@ -339,11 +339,12 @@ void backward_reduce_channels_last(const Size_t size0, const Size_t size1,
   const auto *mean_ptr = batch_mean->get_data_pointer<accscalar_t>(ctx);
   const auto *var_ptr = batch_var->get_data_pointer<accscalar_t>(ctx);
 
-  auto *sum_dy_o_ptr = sum_dy_o->cast_data_and_get_pointer<accscalar_t>(ctx);
-  auto *sum_dy_xmu_o_ptr =
-      sum_dy_xmu_o->cast_data_and_get_pointer<accscalar_t>(ctx);
-  auto *grad_weight_ptr = gamma->cast_data_and_get_pointer<layerscalar_t>(ctx);
-  auto *grad_bias_ptr = beta->cast_data_and_get_pointer<layerscalar_t>(ctx);
+  auto *sum_dy_o_ptr =
+      grad_sums->cast_data_and_get_pointer<accscalar_t>(ctx, true);
+  auto *sum_dy_xmu_o_ptr = sum_dy_o_ptr + size1;
+  // The gradients of beta and gamma are computed after the all_reduce.
+  layerscalar_t *grad_weight_ptr = nullptr;
+  layerscalar_t *grad_bias_ptr = nullptr;
 
   auto *staging_data_ptr =
       staging_data->cast_data_and_get_pointer<accscalar_t>(ctx);
@@ -351,17 +352,19 @@ void backward_reduce_channels_last(const Size_t size0, const Size_t size1,
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_backward_reduce_channels_last_kernel<
+    auto kernel = batch_norm_backward_reduce_channels_last_kernel<
         SYNC_BN_ELEMENTS_PER_ITER, scalar_t, accscalar_t, layerscalar_t,
-        index_t><<<grid, block>>>(
+        index_t>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         x_ptr, dy_ptr, mean_ptr, var_ptr, sum_dy_o_ptr, sum_dy_xmu_o_ptr,
         grad_weight_ptr, grad_bias_ptr, staging_data_ptr, semaphores_ptr,
         reduction_size, stride, epsilon);
   } else {
     using index_t = Size_t;
-    batch_norm_backward_reduce_channels_last_kernel<
+    auto kernel = batch_norm_backward_reduce_channels_last_kernel<
         SYNC_BN_ELEMENTS_PER_ITER, scalar_t, accscalar_t, layerscalar_t,
-        index_t><<<grid, block>>>(
+        index_t>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
         x_ptr, dy_ptr, mean_ptr, var_ptr, sum_dy_o_ptr, sum_dy_xmu_o_ptr,
         grad_weight_ptr, grad_bias_ptr, staging_data_ptr, semaphores_ptr,
         reduction_size, stride, epsilon);
@@ -369,12 +372,39 @@ void backward_reduce_channels_last(const Size_t size0, const Size_t size1,
   NBLA_CUDA_KERNEL_CHECK();
 }
 
+template <typename T>
+void backward_param_grad(const Size_t size1, Variable *grad_sums,
+                         Variable *batch_var, Variable *beta, Variable *gamma,
+                         const bool propagate_beta, const bool propagate_gamma,
+                         const bool accum_beta, const bool accum_gamma,
+                         const float epsilon, Context &ctx) {
+  using scalar_t = T;
+  using accscalar_t = typename CudaTypeForceFloat<T>::type;
+
+  const auto *sum_dy_ptr = grad_sums->get_data_pointer<accscalar_t>(ctx);
+  const auto *sum_dy_xmu_ptr = sum_dy_ptr + size1;
+  const auto *var_ptr = batch_var->get_data_pointer<accscalar_t>(ctx);
+  auto *grad_bias_ptr =
+      propagate_beta
+          ? beta->cast_grad_and_get_pointer<scalar_t>(ctx, !accum_beta)
+          : nullptr;
+  auto *grad_weight_ptr =
+      propagate_gamma
+          ? gamma->cast_grad_and_get_pointer<scalar_t>(ctx, !accum_gamma)
+          : nullptr;
+
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
+      (batch_norm_backward_param_kernel<scalar_t, accscalar_t>), size1,
+      sum_dy_ptr, sum_dy_xmu_ptr, var_ptr, epsilon, grad_bias_ptr,
+      grad_weight_ptr, accum_beta, accum_gamma);
+}
+
 template <typename T, bool accum>
 void backward_dx_post(const Size_t size0, const Size_t size1,
                       const Size_t size2, Variable *x, Variable *y,
                       Variable *global_mean, Variable *global_var,
-                      Variable *sum_dy, Variable *sum_dy_xmu, Variable *gamma,
-                      Variable *all_count, const bool output_stat,
+                      Variable *grad_sums, Variable *gamma,
+                      Variable *all_stats, const bool output_stat,
                       const float epsilon, Context &ctx) {
   using input_scalar_t = T;
   using stat_scalar_t = T;
@@ -393,14 +423,13 @@ void backward_dx_post(const Size_t size0, const Size_t size1,
       output_stat ? global_var->get_grad_pointer<stat_accscalar_t>(ctx)
                   : nullptr;
   const auto *weight_ptr = gamma->get_data_pointer<stat_scalar_t>(ctx);
-  const auto *sum_dy_ptr = sum_dy->get_data_pointer<stat_accscalar_t>(ctx);
-  const auto *sum_dy_xmu_ptr =
-      sum_dy_xmu->get_data_pointer<stat_accscalar_t>(ctx);
+  const auto *sum_dy_ptr = grad_sums->get_data_pointer<stat_accscalar_t>(ctx);
+  const auto *sum_dy_xmu_ptr = sum_dy_ptr + size1;
 
   auto *dx_ptr = x->cast_grad_and_get_pointer<input_scalar_t>(ctx, false);
 
-  const int *all_count_ptr = all_count->get_data_pointer<int>(ctx);
-  const Size_t all_count_numel = all_count->size();
+  const auto *count_ptr =
+      all_stats->get_data_pointer<stat_accscalar_t>(ctx) + size1;
 
   const Size_t tf = std::max<int>(getNumThreads(size2 / 4),
                                   std::min<int>(getNumThreads(size2), 64));
@@ -413,20 +442,22 @@ void backward_dx_post(const Size_t size0, const Size_t size1,
 
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_backward_elemt_kernel<accum, input_scalar_t, stat_scalar_t,
-                                     stat_accscalar_t,
-                                     index_t><<<blocks_trans, threads_trans>>>(
+    auto kernel =
+        batch_norm_backward_elemt_kernel<accum, input_scalar_t, stat_scalar_t,
+                                         stat_accscalar_t, index_t>;
+    kernel<<<blocks_trans, threads_trans, 0, cuda_get_current_stream()>>>(
         x_ptr, dy_ptr, global_mean_ptr, global_var_ptr, dmean_ptr, dvar_ptr,
-        weight_ptr, sum_dy_ptr, sum_dy_xmu_ptr, dx_ptr, epsilon, all_count_ptr,
-        all_count_numel, size0, size1, size2);
+        weight_ptr, sum_dy_ptr, sum_dy_xmu_ptr, dx_ptr, epsilon, count_ptr,
+        size0, size1, size2);
   } else {
     using index_t = Size_t;
-    batch_norm_backward_elemt_kernel<accum, input_scalar_t, stat_scalar_t,
-                                     stat_accscalar_t,
-                                     index_t><<<blocks_trans, threads_trans>>>(
+    auto kernel =
+        batch_norm_backward_elemt_kernel<accum, input_scalar_t, stat_scalar_t,
+                                         stat_accscalar_t, index_t>;
+    kernel<<<blocks_trans, threads_trans, 0, cuda_get_current_stream()>>>(
         x_ptr, dy_ptr, global_mean_ptr, global_var_ptr, dmean_ptr, dvar_ptr,
-        weight_ptr, sum_dy_ptr, sum_dy_xmu_ptr, dx_ptr, epsilon, all_count_ptr,
-        all_count_numel, size0, size1, size2);
+        weight_ptr, sum_dy_ptr, sum_dy_xmu_ptr, dx_ptr, epsilon, count_ptr,
+        size0, size1, size2);
   }
   NBLA_CUDA_KERNEL_CHECK();
 }
@@ -436,8 +467,8 @@ void backward_dx_post_channels_last(const Size_t size0, const Size_t size1,
                                     const Size_t size2, Variable *y,
                                     Variable *x, Variable *batch_mean,
                                     Variable *batch_var, Variable *gamma,
-                                    Variable *sum_dy_o, Variable *sum_dy_xmu_o,
-                                    Variable *count, const bool output_stat,
+                                    Variable *grad_sums, Variable *all_stats,
+                                    const bool output_stat,
                                     const float epsilon, Context &ctx) {
   using scalar_t = T;
   using layerscalar_t = T;
@@ -461,31 +492,32 @@ void backward_dx_post_channels_last(const Size_t size0, const Size_t size1,
 
   const auto *weight_ptr = gamma->get_data_pointer<layerscalar_t>(ctx);
 
-  const auto *sum_dy_ptr = sum_dy_o->get_data_pointer<accscalar_t>(ctx);
-  const auto *sum_dy_xmu_ptr = sum_dy_xmu_o->get_data_pointer<accscalar_t>(ctx);
+  const auto *sum_dy_ptr = grad_sums->get_data_pointer<accscalar_t>(ctx);
+  const auto *sum_dy_xmu_ptr = sum_dy_ptr + size1;
 
-  const auto *numel_ptr = count->get_data_pointer<int>(ctx);
+  const auto *count_ptr =
+      all_stats->get_data_pointer<accscalar_t>(ctx) + size1;
 
   auto *dx_ptr = x->cast_grad_and_get_pointer<scalar_t>(ctx);
 
-  const Size_t world_size = count->size();
-
   if (can_use_int_as_index_t(size0, size1, size2)) {
     using index_t = int;
-    batch_norm_backward_elemt_channels_last_kernel<
+    auto kernel = batch_norm_backward_elemt_channels_last_kernel<
         SYNC_BN_ELEMENTS_PER_ITER, accum, scalar_t, accscalar_t, layerscalar_t,
-        index_t><<<grid, block>>>(dy_ptr, x_ptr, mean_ptr, var_ptr, dmean_ptr,
-                                  dvar_ptr, weight_ptr, sum_dy_ptr,
-                                  sum_dy_xmu_ptr, numel_ptr, dx_ptr, world_size,
-                                  reduction_size, stride, epsilon);
+        index_t>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        dy_ptr, x_ptr, mean_ptr, var_ptr, dmean_ptr, dvar_ptr, weight_ptr,
+        sum_dy_ptr, sum_dy_xmu_ptr, count_ptr, dx_ptr, reduction_size, stride,
+        epsilon);
   } else {
     using index_t = Size_t;
-    batch_norm_backward_elemt_channels_last_kernel<
+    auto kernel = batch_norm_backward_elemt_channels_last_kernel<
         SYNC_BN_ELEMENTS_PER_ITER, accum, scalar_t, accscalar_t, layerscalar_t,
-        index_t><<<grid, block>>>(dy_ptr, x_ptr, mean_ptr, var_ptr, dmean_ptr,
-                                  dvar_ptr, weight_ptr, sum_dy_ptr,
-                                  sum_dy_xmu_ptr, numel_ptr, dx_ptr, world_size,
-                                  reduction_size, stride, epsilon);
+        index_t>;
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        dy_ptr, x_ptr, mean_ptr, var_ptr, dmean_ptr, dvar_ptr, weight_ptr,
+        sum_dy_ptr, sum_dy_xmu_ptr, count_ptr, dx_ptr, reduction_size, stride,
+        epsilon);
   }
   NBLA_CUDA_KERNEL_CHECK();
 }
@@ -83,7 +83,8 @@ void LayerNormalizationCuda<T>::forward_impl(const Variables &inputs,
     const auto block = NBLA_CUDA_LN_NUM_THREADS;
 
     WelfordOp<Tc, Size_t> op(x, mean, var, reduce_size_);
-    reduce_2d_x<<<grid, block>>>(op, batch_size_, reduce_size_);
+    reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(op, batch_size_,
+                                                               reduce_size_);
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -112,7 +113,8 @@ void LayerNormalizationCuda<T>::forward_impl(const Variables &inputs,
     grid.z = 1;
     const auto block = NBLA_CUDA_LN_NUM_THREADS;
 
-    layer_norm_forward_normalization<<<grid, block>>>(
+    layer_norm_forward_normalization<<<grid, block, 0,
+                                       cuda_get_current_stream()>>>(
         batch_size_, reduce_size_, x, mean, var, beta, gamma, y, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
   }
@@ -155,7 +157,8 @@ void LayerNormalizationCuda<T>::backward_impl(
     const auto block = NBLA_CUDA_LN_NUM_THREADS;
 
     LNGradOp<Tc, Size_t> op(x, gamma, dy, sum_dygamma, sum_dyxgamma);
-    reduce_2d_x<<<grid, block>>>(op, batch_size_, reduce_size_);
+    reduce_2d_x<<<grid, block, 0, cuda_get_current_stream()>>>(op, batch_size_,
+                                                               reduce_size_);
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -179,7 +182,8 @@ void LayerNormalizationCuda<T>::backward_impl(
                                    batch_size_, NBLA_CUDA_LN_NUM_THREADS)));
     const auto block = NBLA_CUDA_LN_NUM_THREADS;
 
-    layer_norm_backward_dx_factor<<<grid, block>>>(
+    layer_norm_backward_dx_factor<<<grid, block, 0,
+                                    cuda_get_current_stream()>>>(
         batch_size_, inv_reduce_size_, mean, var, dmean, dvar, sum_dygamma,
         sum_dyxgamma, factor_a, factor_b, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
@@ -214,8 +218,9 @@ void LayerNormalizationCuda<T>::backward_impl(
 
     auto kernel = accum[0] ? layer_norm_backward_dx<true, Tc, Size_t>
                            : layer_norm_backward_dx<false, Tc, Size_t>;
-    kernel<<<grid, block>>>(batch_size_, reduce_size_, x, dy, gamma, var,
-                            factor_a, factor_b, dx, this->eps_);
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        batch_size_, reduce_size_, x, dy, gamma, var, factor_a, factor_b, dx,
+        this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
 
     // Clear internal buffers
@@ -258,8 +263,8 @@ void LayerNormalizationCuda<T>::backward_impl(
                    ? layer_norm_backward_dbeta_dgamma<false, true, Tc, Size_t>
                    : layer_norm_backward_dbeta_dgamma<false, false, Tc, Size_t>;
     }
-    kernel<<<grid, block>>>(batch_size_, reduce_size_, x, dy, mean, var, dbeta,
-                            dgamma, this->eps_);
+    kernel<<<grid, block, 0, cuda_get_current_stream()>>>(
+        batch_size_, reduce_size_, x, dy, mean, var, dbeta, dgamma, this->eps_);
     NBLA_CUDA_KERNEL_CHECK();
   }
 }
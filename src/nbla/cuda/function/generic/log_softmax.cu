@@ -0,0 +1,59 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// log_softmax.cu
+
+#include <nbla/array.hpp>
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/function/kernel/softmax.cuh>
+#include <nbla/cuda/function/log_softmax.hpp>
+#include <nbla/variable.hpp>
+
+namespace nbla {
+
+template <class T>
+void LogSoftmaxCuda<T>::forward_impl(const Variables &inputs,
+                                     const Variables &outputs) {
+  cuda_set_device(std::stoi(this->ctx_.device_id));
+  // Setting up variables
+  const Tc *x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
+  Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
+  softmax_forward<true>(this->ctx_, this->size0_, this->size1_, this->size2_,
+                        SoftmaxLoad<Tc>{x}, SoftmaxStore<Tc>{y});
+}
+
+template <class T>
+void LogSoftmaxCuda<T>::backward_impl(const Variables &inputs,
+                                      const Variables &outputs,
+                                      const vector<bool> &propagate_down,
+                                      const vector<bool> &accum) {
+  if (!propagate_down[0]) {
+    return;
+  }
+  cuda_set_device(std::stoi(this->ctx_.device_id));
+  // Setting up variables
+  const Tc *y = outputs[0]->get_data_pointer<Tc>(this->ctx_);
+  const Tc *dy = outputs[0]->get_grad_pointer<Tc>(this->ctx_);
+  Tc *dx = inputs[0]->cast_grad_and_get_pointer<Tc>(this->ctx_, !accum[0]);
+  const SoftmaxGradLoad<Tc> load{y, dy};
+  if (accum[0]) {
+    softmax_backward<true>(this->ctx_, this->size0_, this->size1_,
+                           this->size2_, load, SoftmaxGradStore<Tc, true>{dx});
+  } else {
+    softmax_backward<true>(this->ctx_, this->size0_, this->size1_,
+                           this->size2_, load,
+                           SoftmaxGradStore<Tc, false>{dx});
+  }
+}
+}
@@ -52,17 +52,20 @@ void MeanCuda<T>::forward_impl_reduce(const T *x_, T *y_, int outer_size,
     NdArray arr_buff({blocks});
     Tc *buff = arr_buff.cast(get_dtype<Tc>(), this->ctx_, true)->pointer<Tc>();
     while (outer_size--) {
-      kernel_reduce_per_block<Tc><<<blocks, threads>>>(reduction_size, x, buff,
-                                                       scale);
+      kernel_reduce_per_block<Tc><<<blocks, threads, 0,
+                                    cuda_get_current_stream()>>>(
+          reduction_size, x, buff, scale);
       NBLA_CUDA_KERNEL_CHECK();
-      kernel_reduce_per_block<Tc><<<1, 1024>>>(blocks, buff, y);
+      kernel_reduce_per_block<Tc><<<1, 1024, 0, cuda_get_current_stream()>>>(
+          blocks, buff, y);
       NBLA_CUDA_KERNEL_CHECK();
       x += reduction_size;
       y += 1;
     }
   } else {
     while (outer_size--) {
-      kernel_reduce_per_block<Tc><<<1, 1024>>>(reduction_size, x, y, scale);
+      kernel_reduce_per_block<Tc><<<1, 1024, 0, cuda_get_current_stream()>>>(
+          reduction_size, x, y, scale);
       NBLA_CUDA_KERNEL_CHECK();
       x += reduction_size;
       y += 1;
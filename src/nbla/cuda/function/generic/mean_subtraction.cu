@@ -89,7 +89,8 @@ void MeanSubtractionCuda<T>::forward_impl_batch(const Variables &inputs,
   NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_mean_subtraction_forward_batch,
                                  this->size1_, this->size0_, x, m, rm, y, t);
 
-  kernel_mean_subtraction_inc_t<<<1, 1>>>(t, std::numeric_limits<int>::max());
+  kernel_mean_subtraction_inc_t<<<1, 1, 0, cuda_get_current_stream()>>>(
+      t, std::numeric_limits<int>::max());
 }
 
 template <typename T>
@@ -16,6 +16,7 @@
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/pad.hpp>
 #include <nbla/cuda/utils/atomic_add.cuh>
+#include <nbla/cuda/utils/pack.cuh>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -34,10 +35,14 @@ struct AxisParam {
 
 namespace pad_constant_impl {
 
-template <typename T, int DIMENSIONS>
+// The constant padding kernels copy N consecutive elements at once. N > 1
+// requires the innermost axis size and its padding to be multiples of N, so
+// that the N elements are either all padded or all copied from x.
+template <typename T, int DIMENSIONS, int N>
 __inline__ __device__ void d_pad_forward(const Index_t y_idx, const T *x, T *y,
                                          const int ndim,
                                          const AxisParam *params, const T val) {
+  using PackT = Pack<T, N>;
   const int NDIM = DIMENSIONS > 0 ? DIMENSIONS : ndim;
   Index_t y_tmp = y_idx;
   Index_t x_idx = 0;
@@ -50,15 +55,21 @@ __inline__ __device__ void d_pad_forward(const Index_t y_idx, const T *x, T *y,
 
     if ((axis_idx < param.pad.first) ||
         (axis_idx >= param.y_shape - param.pad.second)) {
-      y[y_idx] = val;
+      PackT v;
+#pragma unroll
+      for (int j = 0; j < N; j++) {
+        v.v[j] = val;
+      }
+      *reinterpret_cast<PackT *>(y + y_idx) = v;
       return;
     }
     x_idx += (axis_idx - param.pad.first) * param.x_stride;
   }
-  y[y_idx] = x[x_idx];
+  *reinterpret_cast<PackT *>(y + y_idx) =
+      *reinterpret_cast<const PackT *>(x + x_idx);
 }
 
-template <typename T, int DIMENSIONS = 0>
+template <typename T, int DIMENSIONS = 0, int N = 1>
 __global__ void pad_forward(const Index_t size, const T *x, T *y,
                             const int ndim, const AxisParam *params,
                             const T constant_value) {
@@ -69,15 +80,17 @@ __global__ void pad_forward(const Index_t size, const T *x, T *y,
     reinterpret_cast<int *>(shared)[threadIdx.x] = tmp;
   }
   __syncthreads();
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
-    d_pad_forward<T, DIMENSIONS>(i, x, y, ndim, shared, constant_value);
+  NBLA_CUDA_KERNEL_LOOP(i, size / N) {
+    d_pad_forward<T, DIMENSIONS, N>(i * N, x, y, ndim, shared,
+                                    constant_value);
   }
 }
 
-template <typename T, bool ACCUMULATE, int DIMENSIONS>
+template <typename T, bool ACCUMULATE, int DIMENSIONS, int N>
 __inline__ __device__ void d_pad_backward(const Index_t y_idx, const T *dy,
                                           T *dx, const int ndim,
                                           const AxisParam *params) {
+  using PackT = Pack<T, N>;
   const int NDIM = DIMENSIONS > 0 ? DIMENSIONS : ndim;
   Index_t y_tmp = y_idx;
   Index_t x_idx = 0;
@@ -94,10 +107,21 @@ __inline__ __device__ void d_pad_backward(const Index_t y_idx, const T *dy,
     }
     x_idx += (axis_idx - param.pad.first) * param.x_stride;
   }
-  dx[x_idx] = ACCUMULATE ? dx[x_idx] + dy[y_idx] : dy[y_idx];
+  const PackT g = *reinterpret_cast<const PackT *>(dy + y_idx);
+  PackT *dx_pack = reinterpret_cast<PackT *>(dx + x_idx);
+  if (ACCUMULATE) {
+    PackT v = *dx_pack;
+#pragma unroll
+    for (int j = 0; j < N; j++) {
+      v.v[j] = v.v[j] + g.v[j];
+    }
+    *dx_pack = v;
+  } else {
+    *dx_pack = g;
+  }
 }
 
-template <typename T, int DIMENSIONS = 0, bool ACCUMULATE = false>
+template <typename T, int DIMENSIONS = 0, bool ACCUMULATE = false, int N = 1>
 __global__ void pad_backward(const Index_t size, const T *dy, T *dx,
                              const int ndim, const AxisParam *params) {
   extern __shared__ AxisParam shared[];
@@ -107,8 +131,8 @@ __global__ void pad_backward(const Index_t size, const T *dy, T *dx,
     reinterpret_cast<int *>(shared)[threadIdx.x] = tmp;
   }
   __syncthreads();
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
-    d_pad_backward<T, ACCUMULATE, DIMENSIONS>(i, dy, dx, ndim, shared);
+  NBLA_CUDA_KERNEL_LOOP(i, size / N) {
+    d_pad_backward<T, ACCUMULATE, DIMENSIONS, N>(i * N, dy, dx, ndim, shared);
   }
 }
 
@@ -285,17 +309,46 @@ void PadCuda<T>::setup_impl(const Variables &inputs, const Variables &outputs) {
   Variable &x_var = *inputs[0];
   Variable &y_var = *outputs[0];
 
+  // An unpadded axis is merged into the preceding axis, which reduces the
+  // index computation per element. With constant padding, the preceding axis
+  // may be padded as well, e.g. [N, H, W, C] padded on H and W is processed as
+  // [N, H, W * C]. Reflection and repetition only merge unpadded axes.
   std::vector<AxisParam> h_params;
   h_params.reserve(this->padding_.size());
   for (int axis = 0; axis < this->padding_.size(); axis++) {
+    const auto &pad = this->padding_.at(axis);
+    if (!h_params.empty() && pad.first == 0 && pad.second == 0) {
+      auto &prev = h_params.back();
+      if (this->pad_mode_ == this->PAD_CONSTANT ||
+          (prev.pad.first == 0 && prev.pad.second == 0)) {
+        const Index_t n = this->y_shape_.at(axis);
+        prev.x_stride = this->x_stride_.at(axis);
+        prev.y_stride = this->y_stride_.at(axis);
+        prev.y_shape *= n;
+        prev.pad.first *= n;
+        prev.pad.second *= n;
+        continue;
+      }
+    }
     AxisParam axis_param;
     axis_param.x_stride = this->x_stride_.at(axis);
     axis_param.y_stride = this->y_stride_.at(axis);
     axis_param.y_shape = this->y_shape_.at(axis);
-    axis_param.pad.first = this->padding_.at(axis).first;
-    axis_param.pad.second = this->padding_.at(axis).second;
+    axis_param.pad.first = pad.first;
+    axis_param.pad.second = pad.second;
     h_params.push_back(axis_param);
   }
+  ndim_ = h_params.size();
+
+  // The innermost axis is contiguous. Constant padding copies packs of
+  // consecutive elements if the axis and its padding are multiples of the
+  // pack size (e.g. the channels of a channel-last array).
+  constexpr int N = max_pack_size<Tcu>();
+  vectorize_ = this->pad_mode_ == this->PAD_CONSTANT && !h_params.empty() &&
+               h_params.back().y_shape % N == 0 &&
+               h_params.back().pad.first % N == 0 &&
+               h_params.back().pad.second % N == 0;
+
   auto bytes = h_params.size() * sizeof(AxisParam);
   this->parameter_memory_.reshape(Shape_t{static_cast<Size_t>(bytes)}, true);
   auto d_params =
@@ -314,7 +367,7 @@ void PadCuda<T>::forward_impl(const Variables &inputs,
   Variable &y_var = *outputs[0];
 
   const auto y_size = y_var.size();
-  const auto ndim = this->padding_.size();
+  const auto ndim = ndim_;
 
   auto x = x_var.get_data_pointer<Tcu>(this->ctx_);
   auto y = y_var.cast_data_and_get_pointer<Tcu>(this->ctx_, true);
@@ -330,7 +383,11 @@ void PadCuda<T>::forward_impl(const Variables &inputs,
     auto cvalue = this->constant_value_;
     void (*kernel)(const Index_t, const Tcu *, Tcu *, const int,
                    const AxisParam *, const Tcu);
-    if (ndim == 1) {
+    constexpr int N = max_pack_size<Tcu>();
+    if (vectorize_ && pack_aligned<Tcu, N>(x, y)) {
+      kernel = pad_forward<Tcu, 0, N>;
+      blocks = cuda_get_blocks_by_size(y_size / N);
+    } else if (ndim == 1) {
       kernel = pad_forward<Tcu, 1>;
     } else if (ndim == 2) {
       kernel = pad_forward<Tcu, 2>;
@@ -341,7 +398,8 @@ void PadCuda<T>::forward_impl(const Variables &inputs,
     } else {
       kernel = pad_forward<Tcu>;
     }
-    kernel<<<blocks, threads, shared>>>(y_size, x, y, ndim, params, cvalue);
+    kernel<<<blocks, threads, shared, cuda_get_current_stream()>>>(
+        y_size, x, y, ndim, params, cvalue);
     NBLA_CUDA_KERNEL_CHECK();
   }
 
@@ -360,7 +418,8 @@ void PadCuda<T>::forward_impl(const Variables &inputs,
     } else {
       kernel = pad_reflect_forward<Tcu>;
     }
-    kernel<<<blocks, threads, shared>>>(y_size, x, y, ndim, params);
+    kernel<<<blocks, threads, shared, cuda_get_current_stream()>>>(
+        y_size, x, y, ndim, params);
     NBLA_CUDA_KERNEL_CHECK();
   } else if (this->pad_mode_ == this->PAD_REPEAT) {
     using pad_repeat_impl::pad_repeat_forward;
@@ -377,7 +436,8 @@ void PadCuda<T>::forward_impl(const Variables &inputs,
     } else {
       kernel = pad_repeat_forward<Tcu>;
     }
-    kernel<<<blocks, threads, shared>>>(y_size, x, y, ndim, params);
+    kernel<<<blocks, threads, shared, cuda_get_current_stream()>>>(
+        y_size, x, y, ndim, params);
     NBLA_CUDA_KERNEL_CHECK();
   }
 }
@@ -394,7 +454,7 @@ void PadCuda<T>::backward_impl(const Variables &inputs,
     Variable &x_var = *inputs[0];
     Variable &y_var = *outputs[0];
 
-    const auto ndim = this->padding_.size();
+    const auto ndim = ndim_;
     auto dy = y_var.get_grad_pointer<Tcu>(this->ctx_);
 
     if (this->pad_mode_ == this->PAD_CONSTANT) {
@@ -407,7 +467,12 @@ void PadCuda<T>::backward_impl(const Variables &inputs,
                         ->template const_pointer<AxisParam>();
       void (*kernel)(const Index_t, const Tcu *, Tcu *, const int,
                      const AxisParam *);
-      if (ndim == 1) {
+      constexpr int N = max_pack_size<Tcu>();
+      if (vectorize_ && pack_aligned<Tcu, N>(dy, dx)) {
+        kernel = accum ? pad_backward<Tcu, 0, true, N>
+                       : pad_backward<Tcu, 0, false, N>;
+        blocks = cuda_get_blocks_by_size(y_var.size() / N);
+      } else if (ndim == 1) {
         kernel = accum ? pad_backward<Tcu, 1, true> : pad_backward<Tcu, 1>;
       } else if (ndim == 2) {
         kernel = accum ? pad_backward<Tcu, 2, true> : pad_backward<Tcu, 2>;
@@ -418,7 +483,8 @@ void PadCuda<T>::backward_impl(const Variables &inputs,
       } else {
         kernel = accum ? pad_backward<Tcu, 0, true> : pad_backward<Tcu>;
       }
-      kernel<<<blocks, threads, shared>>>(y_var.size(), dy, dx, ndim, params);
+      kernel<<<blocks, threads, shared, cuda_get_current_stream()>>>(
+          y_var.size(), dy, dx, ndim, params);
       NBLA_CUDA_KERNEL_CHECK();
     }
 
@@ -446,7 +512,8 @@ void PadCuda<T>::backward_impl(const Variables &inputs,
       } else {
         kernel = pad_reflect_backward<Tcu>;
       }
-      kernel<<<blocks, threads, shared>>>(y_var.size(), dy, dx, ndim, params);
+      kernel<<<blocks, threads, shared, cuda_get_current_stream()>>>(
+          y_var.size(), dy, dx, ndim, params);
       NBLA_CUDA_KERNEL_CHECK();
     } else if (this->pad_mode_ == this->PAD_REPEAT) {
       using namespace pad_repeat_impl;
@@ -472,7 +539,8 @@ void PadCuda<T>::backward_impl(const Variables &inputs,
       } else {
         kernel = pad_repeat_backward<Tcu>;
       }
-      kernel<<<blocks, threads, shared>>>(y_var.size(), dy, dx, ndim, params);
+      kernel<<<blocks, threads, shared, cuda_get_current_stream()>>>(
+          y_var.size(), dy, dx, ndim, params);
       NBLA_CUDA_KERNEL_CHECK();
     }
   }
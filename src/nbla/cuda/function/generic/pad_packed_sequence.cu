@@ -13,18 +13,11 @@
 // limitations under the License.
 
 #include <nbla/array.hpp>
-#include <nbla/cuda/array/cuda_array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/pad_packed_sequence.hpp>
 #include <nbla/cuda/function/utils/rnn.cuh>
-#include <nbla/function/transpose.hpp>
-#include <nbla/function/utils/rnn.hpp>
-#include <nbla/imperative.hpp>
 #include <nbla/variable.hpp>
 
-#include <algorithm>
-#include <numeric>
-
 namespace nbla {
 
 template <typename U>
@@ -32,57 +25,42 @@ void PadPackedSequenceCuda<U>::setup_impl(const Variables &inputs,
                                           const Variables &outputs) {
   PadPackedSequence<U>::setup_impl(inputs, outputs);
   cuda_set_device(this->device_);
-
-  if (this->batch_first_) {
-    vector<int> axes(3);
-    std::iota(axes.begin(), axes.end(), 0);
-    std::iter_swap(axes.begin(), axes.begin() + 1);
-    f_transpose_ = create_Transpose(this->ctx_, axes);
-  }
 }
 
 template <typename U>
 void PadPackedSequenceCuda<U>::forward_impl(const Variables &inputs,
                                             const Variables &outputs) {
   cuda_set_device(this->device_);
-  nbla::Context cpu_ctx{{"cpu:int"}, "CpuCachedArray", "0"};
   auto packed_sequence = inputs[0];
   auto batch_sizes = inputs[1];
   auto padded_sequence = outputs[0];
   auto lengths = outputs[1];
 
-  auto N = packed_sequence->shape()[0];
   auto T = batch_sizes->shape()[0];
   auto B = lengths->shape()[0];
   auto D = packed_sequence->ndim() == 1 ? 1 : packed_sequence->size(1);
-  auto ishape0 = packed_sequence->shape();
-  auto oshape0 = padded_sequence->shape();
+  auto TP = padded_sequence->shape()[this->batch_first_ ? 1 : 0];
+
+  // Lengths and offsets of the time steps, computed on device.
+  auto data_batch_sizes = batch_sizes->get_data_pointer<int>(this->ctx_);
+  auto data_lengths = lengths->cast_data_and_get_pointer<int>(this->ctx_, true);
+  NdArray offsets(Shape_t{T});
+  auto data_offsets =
+      offsets.cast(get_dtype<int>(), this->ctx_, true)->pointer<int>();
+  using cuda::function::utils::rnn::compute_lengths;
+  using cuda::function::utils::rnn::compute_offsets;
+  compute_lengths(data_batch_sizes, T, B, data_lengths);
+  compute_offsets(this->ctx_, data_batch_sizes, T, data_offsets);
 
   // Unpack
-  auto TL = this->total_length_;
-  Variable padded_sequence_t(Shape_t{(TL > T) ? TL : T, B, D});
-  auto _cast_data = [this](Variable *v) {
-    return v->cast_data_and_get_pointer<Tcu>(this->ctx_);
-  };
   auto data_packed_sequence =
       packed_sequence->get_data_pointer<Tcu>(this->ctx_);
-  auto data_batch_sizes = batch_sizes->get_data_pointer<int>(cpu_ctx);
-  auto data_padded_sequence = this->batch_first_
-                                  ? _cast_data(&padded_sequence_t)
-                                  : _cast_data(padded_sequence);
-  auto data_lengths = lengths->cast_data_and_get_pointer<int>(cpu_ctx);
-
-  using function::utils::rnn::compute_lengths;
+  auto data_padded_sequence =
+      padded_sequence->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
   using cuda::function::utils::rnn::unpack;
-  compute_lengths(data_batch_sizes, batch_sizes->size(), data_lengths);
-  unpack<Tcu, false>(this->ctx_, data_packed_sequence, data_batch_sizes,
-                     data_padded_sequence, T, B, D, N, TL);
-  // Transpose
-  if (this->batch_first_) {
-    auto oshape = padded_sequence->shape();
-    execute(f_transpose_, {&padded_sequence_t}, {padded_sequence});
-    padded_sequence->reshape(oshape, false);
-  }
+  unpack<Tcu, false>(data_packed_sequence, data_batch_sizes, data_offsets,
+                     data_padded_sequence, T, TP, B, D, this->batch_first_,
+                     Tcu(this->padding_value_));
 }
 
 template <typename U>
@@ -95,46 +73,35 @@ void PadPackedSequenceCuda<U>::backward_impl(const Variables &inputs,
   }
 
   cuda_set_device(this->device_);
-  nbla::Context cpu_ctx{{"cpu:int"}, "CpuCachedArray", "0"};
   auto packed_sequence = inputs[0];
   auto batch_sizes = inputs[1];
   auto padded_sequence = outputs[0];
   auto lengths = outputs[1];
 
-  auto N = packed_sequence->shape()[0];
   auto T = batch_sizes->shape()[0];
   auto B = lengths->shape()[0];
   auto D = packed_sequence->ndim() == 1 ? 1 : packed_sequence->size(1);
-  auto ishape0 = packed_sequence->shape();
-  auto oshape0 = padded_sequence->shape();
+  auto TP = padded_sequence->shape()[this->batch_first_ ? 1 : 0];
 
-  // Transpose
-  auto TL = this->total_length_;
-  Variable padded_sequence_t(Shape_t{(TL > T) ? TL : T, B, D});
-  if (this->batch_first_) {
-    auto oshape = padded_sequence->shape();
-    nbla::backward(f_transpose_, {&padded_sequence_t}, {padded_sequence},
-                   {true}, {false}, true);
-    padded_sequence->reshape(oshape, false);
-  }
+  auto data_batch_sizes = batch_sizes->get_data_pointer<int>(this->ctx_);
+  NdArray offsets(Shape_t{T});
+  auto data_offsets =
+      offsets.cast(get_dtype<int>(), this->ctx_, true)->pointer<int>();
+  using cuda::function::utils::rnn::compute_offsets;
+  compute_offsets(this->ctx_, data_batch_sizes, T, data_offsets);
 
   // Pack
-  auto _get_grad = [this](Variable *v) {
-    return v->get_grad_pointer<Tcu>(this->ctx_);
-  };
+  auto grad_padded_sequence =
+      padded_sequence->get_grad_pointer<Tcu>(this->ctx_);
   auto grad_packed_sequence =
-      packed_sequence->cast_grad_and_get_pointer<Tcu>(this->ctx_);
-  auto data_batch_sizes = batch_sizes->get_data_pointer<int>(cpu_ctx);
-  auto grad_padded_sequence = this->batch_first_ ? _get_grad(&padded_sequence_t)
-                                                 : _get_grad(padded_sequence);
-
+      packed_sequence->cast_grad_and_get_pointer<Tcu>(this->ctx_, !accum[0]);
   using cuda::function::utils::rnn::pack;
   if (accum[0]) {
-    pack<Tcu, true>(this->ctx_, grad_padded_sequence, data_batch_sizes,
-                    grad_packed_sequence, T, B, D, N);
+    pack<Tcu, true>(grad_padded_sequence, data_batch_sizes, data_offsets,
+                    grad_packed_sequence, T, TP, B, D, this->batch_first_);
   } else {
-    pack<Tcu, false>(this->ctx_, grad_padded_sequence, data_batch_sizes,
-                     grad_packed_sequence, T, B, D, N);
+    pack<Tcu, false>(grad_padded_sequence, data_batch_sizes, data_offsets,
+                     grad_packed_sequence, T, TP, B, D, this->batch_first_);
   }
 }
 }
@@ -161,13 +161,18 @@ void PReLUCuda<T>::backward_impl(const Variables &inputs,
         arr_buff2.reshape(Shape_t{blocks}, true);
         buff2 =
             arr_buff2.cast(get_dtype<Tc>(), this->ctx_, true)->pointer<Tc>();
-        kernel_reduce_per_block<Tc, false><<<blocks, NBLA_CUDA_NUM_THREADS>>>(
+        kernel_reduce_per_block<Tc, false><<<blocks, NBLA_CUDA_NUM_THREADS, 0,
+                                             cuda_get_current_stream()>>>(
             insize, buff, buff2);
       }
       if (accum[1]) {
-        kernel_reduce_per_block<Tc, true><<<1, 1024>>>(blocks, buff, dw);
+        kernel_reduce_per_block<Tc, true><<<1, 1024, 0,
+                                            cuda_get_current_stream()>>>(
+            blocks, buff, dw);
       } else {
-        kernel_reduce_per_block<Tc, false><<<1, 1024>>>(blocks, buff, dw);
+        kernel_reduce_per_block<Tc, false><<<1, 1024, 0,
+                                             cuda_get_current_stream()>>>(
+            blocks, buff, dw);
       }
     } else {
       const int spatial_size = insize / channels;
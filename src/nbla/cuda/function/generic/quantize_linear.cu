@@ -15,13 +15,15 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/quantize_linear.hpp>
+#include <nbla/cuda/function/utils/quantize.hpp>
 #include <nbla/variable.hpp>
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_saturate(int size, T *x, int min_range, int max_range) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
+template <typename T, typename index_t>
+__global__ void kernel_saturate(const index_t size, T *x, int min_range,
+                                int max_range) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, size, index_t) {
     if (x[i] < min_range) {
       x[i] = min_range;
     } else if (x[i] > max_range) {
@@ -30,13 +32,14 @@ __global__ void kernel_saturate(int size, T *x, int min_range, int max_range) {
   }
 }
 
-template <typename T> __global__ void kernel_std_round(int size, T *x) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) { x[i] = round(x[i]); }
+template <typename T, typename index_t>
+__global__ void kernel_std_round(const index_t size, T *x) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, size, index_t) { x[i] = round(x[i]); }
 }
 
-template <typename T>
-__global__ void kernel_round_half_to_even(int size, T *x) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
+template <typename T, typename index_t>
+__global__ void kernel_round_half_to_even(const index_t size, T *x) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, size, index_t) {
     auto t = round(x[i]);
     if (abs(x[i] - t) == 0.5) {
       x[i] = round(x[i] * 0.5) * 2;
@@ -46,30 +49,95 @@ __global__ void kernel_round_half_to_even(int size, T *x) {
   }
 }
 
+// y = saturate(round(x / scale) + zero_point) in a single pass, with scale and
+// zero_point indexed per channel. The result is an integer in [qmin, qmax] and
+// is stored as such.
+template <typename T, typename Ty, bool half_to_even, typename index_t>
+__global__ void kernel_quantize_linear(const index_t size, const T *x,
+                                       const T *scale, const T *zero_point,
+                                       const index_t channels,
+                                       const index_t inner_size,
+                                       const int qmin, const int qmax, Ty *y) {
+  typedef typename CudaTypeForceFloat<T>::type Tf;
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, size, index_t) {
+    const index_t c = (i / inner_size) % channels;
+    Tf v = Tf(x[i]) / Tf(scale[c]);
+    v = half_to_even ? rint(v) : round(v);
+    v += Tf(zero_point[c]);
+    v = min(max(v, Tf(qmin)), Tf(qmax));
+    y[i] = static_cast<Ty>(v);
+  }
+}
+
 template <typename T>
 void QuantizeLinearCuda<T>::setup_impl(const Variables &inputs,
                                        const Variables &outputs) {
   QuantizeLinear<T>::setup_impl(inputs, outputs);
   cuda_set_device(this->device_);
+
+  // The fused kernel needs per-tensor or per-channel scale and zero_point.
+  // Other broadcasts go through QuantizeLinear::forward_impl.
+  fused_ = get_quantize_channel_layout(inputs[0]->shape(), inputs[1]->shape(),
+                                       inputs[2]->shape(), channels_,
+                                       inner_size_);
+}
+
+template <typename T>
+void QuantizeLinearCuda<T>::forward_impl(const Variables &inputs,
+                                         const Variables &outputs) {
+  if (!fused_) {
+    QuantizeLinear<T>::forward_impl(inputs, outputs);
+    return;
+  }
+  cuda_set_device(this->device_);
+  const Tcu *x = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
+  const Tcu *scale = inputs[1]->get_data_pointer<Tcu>(this->ctx_);
+  const Tcu *zero_point = inputs[2]->get_data_pointer<Tcu>(this->ctx_);
+  const Size_t size = inputs[0]->size();
+
+  // Written as 8-bit integers. The values are exact integers in range, so
+  // reading the output as T later converts it without loss.
+  auto y_arr = outputs[0]->data()->cast(storage_dtype_, this->ctx_, true);
+#define LAUNCH_QUANTIZE_LINEAR(Ty, half_to_even)                               \
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(                                      \
+      (kernel_quantize_linear<Tcu, Ty, half_to_even, index_t>), size, x,       \
+      scale, zero_point, channels_, inner_size_, qmin_, qmax_,                 \
+      y_arr->template pointer<Ty>())
+  if (storage_dtype_ == dtypes::UBYTE) {
+    if (half_to_even_) {
+      LAUNCH_QUANTIZE_LINEAR(unsigned char, true);
+    } else {
+      LAUNCH_QUANTIZE_LINEAR(unsigned char, false);
+    }
+  } else {
+    if (half_to_even_) {
+      LAUNCH_QUANTIZE_LINEAR(char, true);
+    } else {
+      LAUNCH_QUANTIZE_LINEAR(char, false);
+    }
+  }
+#undef LAUNCH_QUANTIZE_LINEAR
 }
 
 template <typename T>
 void QuantizeLinearCuda<T>::saturate(Variable *inp, int min_range,
                                      int max_range) {
-  auto size = inp->size();
+  const Size_t size = inp->size();
   Tcu *x = inp->cast_data_and_get_pointer<Tcu>(this->ctx_, false);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_saturate<Tcu>, size, x, min_range,
-                                 max_range);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_saturate<Tcu, index_t>), size,
+                                         x, min_range, max_range);
 }
 
 template <typename T>
 void QuantizeLinearCuda<T>::round(Variable *inp, std::string round_mode) {
-  auto size = inp->size();
+  const Size_t size = inp->size();
   Tcu *x = inp->cast_data_and_get_pointer<Tcu>(this->ctx_, false);
   if (round_mode == "HALF_AWAY_FROM_ZERO") {
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_std_round<Tcu>, size, x);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_std_round<Tcu, index_t>),
+                                           size, x);
   } else if (round_mode == "HALF_TO_EVEN") {
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_round_half_to_even, size, x);
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (kernel_round_half_to_even<Tcu, index_t>), size, x);
   }
 }
 }
@@ -17,63 +17,82 @@
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/random_choice.hpp>
 #include <nbla/cuda/utils/atomic_add.cuh>
+#include <nbla/cuda/utils/thrust_allocator.cuh>
+#include <nbla/cuda/utils/top_k.cuh>
 #include <nbla/variable.hpp>
 
-#include <thrust/device_vector.h>
+#include <math_constants.h>
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
 #include <thrust/scan.h>
 
 namespace nbla {
 
 namespace random_choice_cuda {
 
-// CUDA kernel to uniformly draw samples from the cumulative summed weights
-// (per population) in w_sums. Each population has w_size elements. The number
-// of samples to draw (per population) is given by u_size, the u_vals pointer
-// is input with uniform random value [0..1). Each thread (subject to grid
-// striding) determines for one input element and all samples if the weight sum
-// is less than the uniform value and, if true, increses the mapping index for
-// that input value. After all threads have run, the index map points to the
-// values drawn from input x.
+// Population index of a flat weight index, used as scan key.
+struct PopulationIndex {
+  int w_size;
+  __host__ __device__ PopulationIndex(const int w_size) : w_size(w_size) {}
+  __host__ __device__ int operator()(const int i) const { return i / w_size; }
+};
+
+// Weights are accumulated in float, also for half precision weights.
+template <typename T> struct ToFloat {
+  __device__ float operator()(const T &v) const { return static_cast<float>(v); }
+};
+
+// Build the cumulative sum of weights for all populations in one scan.
 template <typename T>
-__global__ void draw_samples(const size_t size, const size_t w_size,
-                             const size_t u_size, const T *w_sums,
+void cumulative_weights(const Context &ctx, const int size, const int w_size,
+                        const T *w_data, float *w_sums) {
+  ThrustCachingAllocator alloc(ctx.device_id);
+  auto keys = thrust::make_transform_iterator(
+      thrust::make_counting_iterator<int>(0), PopulationIndex(w_size));
+  auto vals = thrust::make_transform_iterator(
+      thrust::device_pointer_cast(w_data), ToFloat<T>());
+  thrust::inclusive_scan_by_key(
+      NBLA_THRUST_PAR(alloc).on(cuda_get_current_stream()), keys, keys + size,
+      vals, thrust::device_pointer_cast(w_sums));
+}
+
+// CUDA kernel to draw samples from the cumulative summed weights (per
+// population) in w_sums. Each population has w_size elements. The number of
+// samples to draw (per population) is given by u_size, the u_vals pointer is
+// input with uniform random value [0..1). Each thread (subject to grid
+// striding) draws one sample by binary search for the first weight sum that
+// is not less than the scaled uniform value.
+__global__ void draw_samples(const int size, const int w_size,
+                             const int u_size, const float *w_sums,
                              const float *u_vals, int *idxmap) {
   NBLA_CUDA_KERNEL_LOOP(i, size) {
-    const auto b = i / w_size; // population index
-    const auto scale = w_sums[(b + 1) * w_size - 1];
-
-    for (int j = 0; j < u_size; j++) {
-      if (w_sums[i] < u_vals[b * u_size + j] * scale) {
-        atomic_add(idxmap + b * u_size + j, 1);
+    const auto sums = w_sums + (i / u_size) * w_size; // population sums
+    const auto value = u_vals[i] * sums[w_size - 1];
+    int lo = 0, hi = w_size - 1;
+    while (lo < hi) {
+      const int mid = (lo + hi) / 2;
+      if (sums[mid] < value) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
       }
     }
+    idxmap[i] = lo;
   }
 }
 
-// Same kernel as above but draws one sample per round `r`. Needed for sampling
-// without replacement.
+// Compute the sort keys for weighted sampling without replacement. Taking
+// the u_size largest keys log(u) / w (with u uniform in (0, 1]) per population
+// is equivalent to drawing u_size samples one after another and removing each
+// drawn category (Efraimidis-Spirakis, the exponential form of Gumbel-top-k).
+// Categories with zero weight get a key of -inf.
 template <typename T>
-__global__ void draw_sample(const size_t size, const size_t w_size,
-                            const size_t u_size, const T *w_sums,
-                            const float *u_vals, int *idxmap, const int r) {
+__global__ void sample_keys(const int size, const T *w_data,
+                            const float *u_vals, float *keys) {
   NBLA_CUDA_KERNEL_LOOP(i, size) {
-    const auto b = i / w_size; // population index
-    const auto scale = w_sums[(b + 1) * w_size - 1];
-
-    if (w_sums[i] < u_vals[b * u_size + r] * scale) {
-      atomic_add(idxmap + b * u_size + r, 1);
-    }
-  }
-}
-
-// Kernel that sets choosen weigths to zero after each round `r`. Used for
-// sampling without replacement.
-template <typename T>
-__global__ void zero_weight(const size_t size, const size_t w_size,
-                            const size_t u_size, const int *idxmap, const int r,
-                            T *w_data) {
-  NBLA_CUDA_KERNEL_LOOP(b, size) {
-    w_data[b * w_size + idxmap[b * u_size + r]] = 0;
+    const auto w = static_cast<float>(w_data[i]);
+    keys[i] = w > 0 ? logf(u_vals[i]) / w : -CUDART_INF_F;
   }
 }
 
@@ -135,9 +154,8 @@ void RandomChoiceCuda<T>::sample_with_replacement(const Variables &inputs,
                                                   const Variables &outputs) {
   auto x = inputs[0], w = inputs[1], y = outputs[0];
   Variable &idxbuf_ = this->idxbuf_;
-  idxbuf_.data()->zero();
 
-  auto idxbuf = idxbuf_.cast_data_and_get_pointer<int>(this->ctx_, false);
+  auto idxbuf = idxbuf_.cast_data_and_get_pointer<int>(this->ctx_, true);
   auto x_data = x->get_data_pointer<Tcu>(this->ctx_);
   auto w_data = w->get_data_pointer<Tcu>(this->ctx_);
   auto y_data = y->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
@@ -146,7 +164,8 @@ void RandomChoiceCuda<T>::sample_with_replacement(const Variables &inputs,
 
   NdArray tmp0(Shape_t{x->size()});
   NdArray tmp1(Shape_t{y->size()});
-  auto w_sums = tmp0.cast(get_dtype<Tcu>(), this->ctx_, true)->pointer<Tcu>();
+  auto w_sums =
+      tmp0.cast(get_dtype<float>(), this->ctx_, true)->pointer<float>();
   auto u_vals =
       tmp1.cast(get_dtype<float>(), this->ctx_, true)->pointer<float>();
 
@@ -156,15 +175,12 @@ void RandomChoiceCuda<T>::sample_with_replacement(const Variables &inputs,
                         : curand_generator_;
   curand_generate_rand<float>(gen, 0, 1, u_vals, y->size());
 
-  // Build cumulative sum of weights per population.
-  for (int i = 0; i < this->outer_loop_; i++) {
-    auto w_data_ptr = thrust::device_pointer_cast(w_data + i * w_size);
-    auto w_sums_ptr = thrust::device_pointer_cast(w_sums + i * w_size);
-    thrust::inclusive_scan(w_data_ptr, w_data_ptr + w_size, w_sums_ptr);
-  }
+  // Build cumulative sum of weights of all populations.
+  random_choice_cuda::cumulative_weights(this->ctx_, w->size(), w_size,
+                                         w_data, w_sums);
 
-  // Indirectly draw samples by building an index map.
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(random_choice_cuda::draw_samples, x->size(),
+  // Draw samples by binary search on the cumulative weights.
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(random_choice_cuda::draw_samples, y->size(),
                                  w_size, u_size, w_sums, u_vals, idxbuf);
 
   // Copy input data values according to index map.
@@ -177,9 +193,8 @@ void RandomChoiceCuda<T>::sample_without_replace(const Variables &inputs,
                                                  const Variables &outputs) {
   auto x = inputs[0], w = inputs[1], y = outputs[0];
   Variable &idxbuf_ = this->idxbuf_;
-  idxbuf_.data()->zero();
 
-  auto idxbuf = idxbuf_.cast_data_and_get_pointer<int>(this->ctx_, false);
+  auto idxbuf = idxbuf_.cast_data_and_get_pointer<int>(this->ctx_, true);
   auto x_data = x->get_data_pointer<Tcu>(this->ctx_);
   auto y_data = y->cast_data_and_get_pointer<Tcu>(this->ctx_, true);
   auto w_size = w->shape().back(); // size of each weight vector
@@ -188,38 +203,27 @@ void RandomChoiceCuda<T>::sample_without_replace(const Variables &inputs,
 
   NdArray tmp0(Shape_t{x->size()});
   NdArray tmp1(Shape_t{x->size()});
-  NdArray tmp2(Shape_t{y->size()});
-  auto w_data = tmp0.cast(get_dtype<Tcu>(), this->ctx_, true)->pointer<Tcu>();
-  auto w_sums = tmp1.cast(get_dtype<Tcu>(), this->ctx_, true)->pointer<Tcu>();
+  NdArray tmp2(Shape_t{static_cast<Size_t>(
+      top_k_batched_buffer_size(b_size, u_size))});
+  auto keys = tmp0.cast(get_dtype<float>(), this->ctx_, true)->pointer<float>();
   auto u_vals =
-      tmp2.cast(get_dtype<float>(), this->ctx_, true)->pointer<float>();
-
-  // Copy the weight data to writable memory where we can remove a
-  // category (by nulling it's weight) after each round.
-  auto w_data_ptr = w->get_data_pointer<Tcu>(this->ctx_);
-  thrust::copy_n(thrust::device_pointer_cast(w_data_ptr), w->size(),
-                 thrust::device_pointer_cast(w_data));
+      tmp1.cast(get_dtype<float>(), this->ctx_, true)->pointer<float>();
+  auto buffer = tmp2.cast(get_dtype<char>(), this->ctx_, true)->pointer<char>();
+  auto w_data = w->get_data_pointer<Tcu>(this->ctx_);
 
-  // Generate random choices for each output sample point.
+  // Generate one random value for each category of each population.
   curandGenerator_t &gen =
       this->seed_ == -1 ? SingletonManager::get<Cuda>()->curand_generator()
                         : curand_generator_;
-  curand_generate_rand<float>(gen, 0, 1, u_vals, y->size());
-
-  // We draw one sample per round (and population) and set the choosen weight
-  // to zero, so each round decreases the number of non-zero weights.
-  for (int r = 0; r < u_size; r++) {
-    for (int i = 0; i < b_size; i++) {
-      auto w_data_ptr = thrust::device_pointer_cast(w_data + i * w_size);
-      auto w_sums_ptr = thrust::device_pointer_cast(w_sums + i * w_size);
-      thrust::inclusive_scan(w_data_ptr, w_data_ptr + w_size, w_sums_ptr);
-    }
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(random_choice_cuda::draw_sample, x->size(),
-                                   w_size, u_size, w_sums, u_vals, idxbuf, r);
-
-    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(random_choice_cuda::zero_weight, b_size,
-                                   w_size, u_size, idxbuf, r, w_data)
-  }
+  curand_generate_rand<float>(gen, 0, 1, u_vals, x->size());
+
+  // Instead of drawing one sample per round and nulling the weight of the
+  // choosen category, all samples are drawn at once as the u_size categories
+  // with largest random key per population.
+  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(random_choice_cuda::sample_keys<Tcu>,
+                                 x->size(), w_data, u_vals, keys);
+  top_k_batched<float>(keys, b_size, w_size, u_size, buffer,
+                       reinterpret_cast<unsigned int *>(idxbuf));
 
   // Copy input data values according to index map.
   NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(random_choice_cuda::copy_samples, y->size(),
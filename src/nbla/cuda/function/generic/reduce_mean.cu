@@ -18,32 +18,41 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/reduce_mean.hpp>
+#include <nbla/cuda/utils/reduce.cuh>
+#include <nbla/cuda/utils/reduce_ops/mean.cuh>
 #include <nbla/variable.hpp>
 
-#include <thrust/copy.h>
-#include <thrust/device_ptr.h>
-#include <thrust/device_vector.h>
-
 namespace nbla {
 
-template <typename T>
+template <typename T, bool accum>
 __global__ void kernel_reduce_mean_backward(const int num, T *dx, const T *dy) {
-  const T graddiv = *dy / num;
-  NBLA_CUDA_KERNEL_LOOP(idx, num) { dx[idx] += graddiv; }
+  typedef typename CudaTypeForceFloat<T>::type AccumType;
+  const AccumType graddiv = AccumType(*dy) / num;
+  NBLA_CUDA_KERNEL_LOOP(idx, num) {
+    dx[idx] = (accum ? AccumType(dx[idx]) : AccumType(0)) + graddiv;
+  }
+}
+
+template <typename T>
+void ReduceMeanCuda<T>::setup_impl(const Variables &inputs,
+                                   const Variables &outputs) {
+  ReduceMean<T>::setup_impl(inputs, outputs);
+  // Reduce all axes.
+  Shape_t axes(inputs[0]->ndim());
+  for (Size_t i = 0; i < axes.size(); i++)
+    axes[i] = i;
+  reduce_setup_(inputs[0]->shape(), axes);
 }
 
 template <class T>
 void ReduceMeanCuda<T>::forward_impl(const Variables &inputs,
                                      const Variables &outputs) {
-  // Thrust doesn't support half reduction.
-  typedef typename CudaTypeForceFloat<T>::type Tc;
   cuda_set_device(std::stoi(this->ctx_.device_id));
+  // The result is written on the device, deterministically and accumulated
+  // in float for half.
+  const Tc *x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
   Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
-  const Size_t size = inputs[0]->size();
-  thrust::device_ptr<const Tc> x(inputs[0]->get_data_pointer<Tc>(this->ctx_));
-  Tc sum = thrust::reduce(x, x + size, (Tc)0, thrust::plus<Tc>());
-  sum /= size;
-  cudaMemcpy(y, &sum, sizeof(Tc), cudaMemcpyHostToDevice);
+  device_mean(this->ctx_, x, y, reduce_setup_, inputs[0]->size());
 }
 
 template <class T>
@@ -58,6 +67,12 @@ void ReduceMeanCuda<T>::backward_impl(const Variables &inputs,
   const Tc *dy = outputs[0]->get_grad_pointer<Tc>(this->ctx_);
   Tc *dx = inputs[0]->cast_grad_and_get_pointer<Tc>(this->ctx_, !accum[0]);
   const Size_t size = inputs[0]->size();
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_reduce_mean_backward, size, dx, dy);
+  if (accum[0]) {
+    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_reduce_mean_backward<Tc, true>),
+                                   size, dx, dy);
+  } else {
+    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((kernel_reduce_mean_backward<Tc, false>),
+                                   size, dx, dy);
+  }
 }
 }
@@ -15,7 +15,7 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/scatter_add.hpp>
-#include <nbla/cuda/utils/atomic_add.cuh>
+#include <nbla/cuda/utils/scatter_add.cuh>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -30,7 +30,8 @@ template <typename T>
 __global__ void forward_x1(const int indices_size, const int *indices_data,
                            const int *indices_stride, const int *x0_stride,
                            const int ndim, const T *x1_data,
-                           const int *x1_stride, T *y_data, const int axis) {
+                           const int *x1_stride, const ScatterAddView<T> y_data,
+                           const int axis) {
   NBLA_CUDA_KERNEL_LOOP(tid, indices_size) {
     auto dst_axis_index = indices_data[tid];
     int src_flat_index = 0;
@@ -46,7 +47,7 @@ __global__ void forward_x1(const int indices_size, const int *indices_data,
         dst_flat_index += nd_index * x0_stride[d];
       }
     }
-    atomic_add(y_data + dst_flat_index, x1_data[src_flat_index]);
+    y_data(tid, dst_flat_index, x1_data[src_flat_index]);
   }
 }
 
@@ -141,10 +142,12 @@ void ScatterAddCuda<T>::forward_impl(const Variables &inputs,
                                  inputs[0]->size(), x0, y);
 
   auto axis = (this->axis_ < 0) ? inputs[0]->ndim() + this->axis_ : this->axis_;
+  ScatterAdder<Tcu> adder(this->ctx_, y, inputs[1]->size());
   NBLA_CUDA_LAUNCH_KERNEL_SIMPLE((scatter_add_cuda::forward_x1<Tcu>),
                                  inputs[1]->size(), indices, indices_stride_ptr,
                                  x0_stride_ptr, inputs[0]->ndim(), x1,
-                                 x1_stride_ptr, y, axis);
+                                 x1_stride_ptr, adder.view(), axis);
+  adder.finish();
 }
 
 template <typename T>
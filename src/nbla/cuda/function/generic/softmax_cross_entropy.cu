@@ -16,9 +16,8 @@
 
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
-#include <nbla/cuda/function/softmax.hpp>
+#include <nbla/cuda/function/kernel/softmax.cuh>
 #include <nbla/cuda/function/softmax_cross_entropy.hpp>
-#include <nbla/cuda/limits.hpp>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -44,27 +43,22 @@ kernel_softmax_cross_entropy_forward(const int size0x2_, const int size1_,
 
 template <typename T, typename Tl, bool accum>
 __global__ void
-kernel_softmax_cross_entropy_backward(const int size0x2_, const int size1_,
+kernel_softmax_cross_entropy_backward(const int size, const int size1_,
                                       const int size2_, const T *log_p,
                                       const T *dy, const Tl *l, T *dx) {
-  NBLA_CUDA_KERNEL_LOOP(idx, size0x2_) {
-    const int i0 = idx / size2_;
-    const int i2 = idx % size2_;
-    const int j = i0 * size2_ + i2;
-    Tl label = l[j];
-    T grad = dy[j];
-    if (label < 0) {
-      for (int i1 = 0; i1 < size1_; ++i1) {
-        const int k = i0 * size1_ * size2_ + i1 * size2_ + i2;
-        dx[k] = (accum ? dx[k] : (T)0);
-      }
-    } else {
-      for (int i1 = 0; i1 < size1_; ++i1) {
-        const int k = i0 * size1_ * size2_ + i1 * size2_ + i2;
-        dx[k] = (accum ? dx[k] : (T)0) +
-                grad * (std::exp(log_p[k]) - static_cast<int>(label == i1));
-      }
-    }
+  typedef typename CudaTypeForceFloat<T>::type AccumType;
+  NBLA_CUDA_KERNEL_LOOP(k, size) {
+    const int i2 = k % size2_;
+    const int i01 = k / size2_;
+    const int i1 = i01 % size1_;
+    const int j = (i01 / size1_) * size2_ + i2;
+    const Tl label = l[j];
+    const AccumType grad =
+        label < 0 ? AccumType(0)
+                  : AccumType(dy[j]) *
+                        (std::exp(AccumType(log_p[k])) -
+                         static_cast<int>(label == i1));
+    dx[k] = (accum ? AccumType(dx[k]) : AccumType(0)) + grad;
   }
 }
 
@@ -79,8 +73,11 @@ void SoftmaxCrossEntropyCuda<T, Tl>::forward_impl(const Variables &inputs,
                                                   const Variables &outputs) {
   cuda_set_device(std::stoi(this->ctx_.device_id));
   Variable &tso = this->log_softmax_output_;
-  this->log_softmax_->forward(Variables{inputs[0]}, Variables{&tso});
   // Setting up variables
+  const Tc *x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
+  Tc *log_p_out = tso.cast_data_and_get_pointer<Tc>(this->ctx_, true);
+  softmax_forward<true>(this->ctx_, this->size0_, this->size1_, this->size2_,
+                        SoftmaxLoad<Tc>{x}, SoftmaxStore<Tc>{log_p_out});
   const Tc *log_p = tso.get_data_pointer<Tc>(this->ctx_);
   const Tl *l = inputs[1]->get_data_pointer<Tl>(this->ctx_);
   Tc *y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
@@ -104,16 +101,15 @@ void SoftmaxCrossEntropyCuda<T, Tl>::backward_impl(
   const Tc *dy = outputs[0]->get_grad_pointer<Tc>(this->ctx_);
   const Tl *l = inputs[1]->get_data_pointer<Tl>(this->ctx_);
   Tc *dx = inputs[0]->cast_grad_and_get_pointer<Tc>(this->ctx_, !accum[0]);
+  const int size = this->size0_ * this->size1_ * this->size2_;
   if (accum[0]) {
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-        (kernel_softmax_cross_entropy_backward<Tc, Tl, true>),
-        this->size0_ * this->size2_, this->size1_, this->size2_, log_p, dy, l,
-        dx);
+        (kernel_softmax_cross_entropy_backward<Tc, Tl, true>), size,
+        this->size1_, this->size2_, log_p, dy, l, dx);
   } else {
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-        (kernel_softmax_cross_entropy_backward<Tc, Tl, false>),
-        this->size0_ * this->size2_, this->size1_, this->size2_, log_p, dy, l,
-        dx);
+        (kernel_softmax_cross_entropy_backward<Tc, Tl, false>), size,
+        this->size1_, this->size2_, log_p, dy, l, dx);
   }
 }
 }
@@ -15,156 +15,257 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/sort.hpp>
+#include <nbla/cuda/utils/bitonic_sort.cuh>
+#include <nbla/cuda/utils/thrust_allocator.cuh>
+#include <nbla/cuda/utils/warp_shuffle.cuh>
 #include <nbla/variable.hpp>
 
 #include <thrust/device_ptr.h>
-#include <thrust/device_vector.h>
 #include <thrust/execution_policy.h>
-#if THRUST_VERSION < 100904 || !defined(THRUST_CPP11) ||                       \
-    !defined(THRUST_MODERN_GCC)
+#include <thrust/functional.h>
+#include <thrust/iterator/zip_iterator.h>
 #include <thrust/sort.h>
-#else
-#include <thrust/async/sort.h>
-#endif
+
+#include <limits>
 
 namespace nbla {
 
 namespace sort_impl {
 
-template <typename T> struct CompareGreater {
-  const T *data;
-  const size_t stride;
+/*
+  A value-index pair for the bitonic sorter. Padding elements, used to
+  fill a segment up to the power-of-two block size, are marked with an
+  index of 0xffffffff and always compare after real elements so that
+  they cannot displace values outside the representable range of
+  extrema().
+*/
+template <typename T, bool Descending> struct SortKey {
+  T v;
+  unsigned int i;
+
+  static __device__ __forceinline__ SortKey<T, Descending> extrema() {
+    return {T(0), 0xffffffff};
+  }
 
-  __host__ __device__ CompareGreater(const T *data, const size_t stride)
-      : data(data), stride(stride) {}
+  static __device__ __forceinline__ bool
+  compare(const SortKey<T, Descending> &a, const SortKey<T, Descending> &b) {
+    if (a.i == 0xffffffff)
+      return false;
+    if (b.i == 0xffffffff)
+      return true;
+    return Descending ? a.v > b.v : a.v < b.v;
+  }
 
-  __host__ __device__ bool operator()(size_t i1, size_t i2) const {
-    return data[i1 * stride] > data[i2 * stride];
+  static __device__ __forceinline__ SortKey<T, Descending>
+  shuffle(const SortKey<T, Descending> var, int mask) {
+    return {warp::shuffle_xor(var.v, mask), warp::shuffle_xor(var.i, mask)};
   }
 };
 
-template <typename T> struct CompareLess {
-  const T *data;
-  const size_t stride;
-
-  __host__ __device__ CompareLess(const T *data, const size_t stride)
-      : data(data), stride(stride) {}
+// Offset of the j-th element of segment `seg` where a segment is one
+// slice along the sort axis of size `size` and stride `inner`.
+template <typename index_t>
+__device__ __forceinline__ index_t segment_offset(const index_t seg,
+                                                  const index_t j,
+                                                  const index_t size,
+                                                  const index_t inner) {
+  return (seg / inner) * size * inner + j * inner + seg % inner;
+}
 
-  __host__ __device__ bool operator()(size_t i1, size_t i2) const {
-    return data[i1 * stride] < data[i2 * stride];
+/*
+  Sort each segment of at most N elements with one thread block
+  using the shared memory bitonic sorter. The sorted index and, if
+  `y` is not null, the sorted value are written directly to the
+  strided output locations.
+*/
+template <typename T, bool Descending, unsigned N>
+__global__ void bitonic_sort_segments(const Size_t segments, const Size_t size,
+                                      const Size_t inner, const T *x,
+                                      size_t *index, T *y) {
+  __shared__ SortKey<T, Descending> shared[N];
+  const unsigned int tid = threadIdx.x;
+
+  for (Size_t seg = blockIdx.x; seg < segments; seg += gridDim.x) {
+    if (tid < size) {
+      shared[tid] = {x[segment_offset<Size_t>(seg, tid, size, inner)], tid};
+    } else {
+      shared[tid] = SortKey<T, Descending>::extrema();
+    }
+    bitonic_sort_block<SortKey<T, Descending>, N>(shared, tid);
+    if (tid < size) {
+      const auto offset = segment_offset<Size_t>(seg, tid, size, inner);
+      index[offset] = shared[tid].i;
+      if (y)
+        y[offset] = shared[tid].v;
+    }
+    __syncthreads();
   }
-};
+}
 
-__global__ void make_sequence(const size_t size, size_t *dst) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) { dst[i] = static_cast<size_t>(i); }
+// Copy the strided input into a segment-major key array.
+template <typename T, typename index_t>
+__global__ void gather_keys(const index_t total, const index_t size,
+                            const index_t inner, const T *x, T *keys,
+                            unsigned int *perm) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, total, index_t) {
+    keys[i] = x[segment_offset(i / size, i % size, size, inner)];
+    perm[i] = i;
+  }
 }
 
-__global__ void copy_index(const size_t size, const size_t stride,
-                           const size_t *src, size_t *dst) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) { dst[i * stride] = src[i]; }
+template <typename index_t>
+__global__ void segment_of(const index_t total, const index_t size,
+                           const unsigned int *perm, unsigned int *segs) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, total, index_t) { segs[i] = perm[i] / size; }
 }
 
-template <typename T>
-__global__ void copy_value(const size_t size, const size_t stride, const T *src,
-                           const size_t *idx, T *dst) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
-    dst[i * stride] = src[idx[i * stride] * stride];
+// Write the sorted index and, if `y` is not null, the sorted value.
+template <typename T, typename index_t>
+__global__ void scatter_sorted(const index_t total, const index_t size,
+                               const index_t inner, const unsigned int *perm,
+                               const T *keys, size_t *index, T *y) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, total, index_t) {
+    const auto offset = segment_offset(i / size, i % size, size, inner);
+    index[offset] = perm[i] % size;
+    if (y)
+      y[offset] = keys[i];
   }
 }
 
-template <typename T>
-__global__ void add_grad(const size_t size, const size_t stride, const T *src,
-                         const size_t *idx, T *dst) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
-    dst[i * stride] += src[idx[i * stride] * stride];
+template <typename T, bool Descending>
+void bitonic_sort_segments(const Size_t segments, const Size_t size,
+                           const Size_t inner, const T *x, size_t *index,
+                           T *y) {
+  const int blocks = static_cast<int>(
+      std::min<Size_t>(segments, NBLA_CUDA_MAX_BLOCKS));
+  if (size <= 32) {
+    bitonic_sort_segments<T, Descending, 32><<<blocks, 32, 0,
+                                               cuda_get_current_stream()>>>(
+        segments, size, inner, x, index, y);
+  } else if (size <= 64) {
+    bitonic_sort_segments<T, Descending, 64><<<blocks, 64, 0,
+                                               cuda_get_current_stream()>>>(
+        segments, size, inner, x, index, y);
+  } else if (size <= 128) {
+    bitonic_sort_segments<T, Descending, 128><<<blocks, 128, 0,
+                                                cuda_get_current_stream()>>>(
+        segments, size, inner, x, index, y);
+  } else if (size <= 256) {
+    bitonic_sort_segments<T, Descending, 256><<<blocks, 256, 0,
+                                                cuda_get_current_stream()>>>(
+        segments, size, inner, x, index, y);
+  } else if (size <= 512) {
+    bitonic_sort_segments<T, Descending, 512><<<blocks, 512, 0,
+                                                cuda_get_current_stream()>>>(
+        segments, size, inner, x, index, y);
+  } else {
+    bitonic_sort_segments<T, Descending, 1024><<<blocks, 1024, 0,
+                                                 cuda_get_current_stream()>>>(
+        segments, size, inner, x, index, y);
   }
+  NBLA_CUDA_KERNEL_CHECK();
 }
 
-template <typename T>
-__global__ void set_grad(const size_t size, const size_t stride, const T *src,
-                         const size_t *idx, T *dst) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) {
-    dst[i * stride] = src[idx[i * stride] * stride];
+template <typename T, bool Accum, typename index_t>
+__global__ void backward_sorted(const index_t total, const index_t size,
+                                const index_t inner, const T *g_y,
+                                const size_t *index, T *g_x) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, total, index_t) {
+    const index_t seg = (i / (size * inner)) * inner + i % inner;
+    const auto src = segment_offset<index_t>(seg, index[i], size, inner);
+    g_x[i] = Accum ? g_x[i] + g_y[src] : g_y[src];
   }
 }
 
 } // namespace sort_impl
 
+template <typename T>
+void SortCuda<T>::setup_impl(const Variables &inputs,
+                             const Variables &outputs) {
+  Sort<T>::setup_impl(inputs, outputs);
+
+  // The bitonic sorter handles segments of up to 1024 elements in
+  // shared memory. Longer segments are sorted by two device-wide radix
+  // sorts (keys, then segment index) which need segment-major buffers.
+  const auto size = inputs[0]->shape()[this->axis];
+  if (size > 1024) {
+    NBLA_CHECK(this->total_size <= std::numeric_limits<unsigned int>::max(),
+               error_code::value,
+               "Sort of %ld elements along an axis longer than 1024 is not "
+               "supported, the permutation is indexed by 32 bit integers.",
+               (long)this->total_size);
+    this->sort_keys_.reshape(Shape_t{static_cast<Size_t>(this->total_size)},
+                             true);
+    this->sort_perm_.reshape(Shape_t{static_cast<Size_t>(this->total_size)},
+                             true);
+    this->sort_segs_.reshape(Shape_t{static_cast<Size_t>(this->total_size)},
+                             true);
+  }
+}
+
 template <typename T>
 void SortCuda<T>::forward_impl(const Variables &inputs,
                                const Variables &outputs) {
-#if THRUST_VERSION < 100904 || !defined(THRUST_CPP11) ||                       \
-    !defined(THRUST_MODERN_GCC)
-  using thrust::sort;
-#else
-  using thrust::async::sort;
-#endif
-
   using namespace sort_impl;
   cuda_set_device(this->device_);
 
   const auto &ctx = this->ctx_;
   const auto &shape = inputs[0]->shape();
+  const Size_t size = shape[this->axis];
+  const Size_t inner = this->inner_size;
+  const Size_t total = this->total_size;
+  const Size_t segments = size > 0 ? total / size : 0;
 
   Variable &sort_index_var = this->sort_index;
-  Variable &temp_index_var = this->temp_index;
-  auto sort_index_raw = sort_index_var.cast_data_and_get_pointer<size_t>(ctx);
-  auto temp_index_raw = temp_index_var.cast_data_and_get_pointer<size_t>(ctx);
-  auto temp_index_ptr = thrust::device_pointer_cast(temp_index_raw);
+  auto sort_index = sort_index_var.cast_data_and_get_pointer<size_t>(ctx, true);
   auto x_data = inputs[0]->get_data_pointer<Tcu>(ctx);
-
-  auto outer_x_raw = x_data;
-  auto outer_i_raw = sort_index_raw;
-  auto stride = this->inner_size;
-
-  while (outer_x_raw < x_data + this->total_size) {
-    auto inner_x_raw = outer_x_raw;
-    auto inner_i_raw = outer_i_raw;
-
-    while (inner_x_raw < outer_x_raw + this->inner_size) {
-      auto size = temp_index_var.size();
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(make_sequence, size, temp_index_raw);
-      if (this->reverse) {
-        (void)sort(thrust::cuda::par.on(0), temp_index_ptr,
-                   temp_index_ptr + size,
-                   CompareGreater<Tcu>(inner_x_raw, stride));
-      } else {
-        (void)sort(thrust::cuda::par.on(0), temp_index_ptr,
-                   temp_index_ptr + size,
-                   CompareLess<Tcu>(inner_x_raw, stride));
-      }
-      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(copy_index, shape[this->axis], stride,
-                                     temp_index_raw, inner_i_raw);
-      inner_x_raw++;
-      inner_i_raw++;
+  auto y_data = this->only_index
+                    ? nullptr
+                    : outputs[0]->cast_data_and_get_pointer<Tcu>(ctx, true);
+
+  if (segments == 0) {
+    // nothing to sort
+  } else if (size <= 1024) {
+    if (this->reverse) {
+      bitonic_sort_segments<Tcu, true>(segments, size, inner, x_data,
+                                       sort_index, y_data);
+    } else {
+      bitonic_sort_segments<Tcu, false>(segments, size, inner, x_data,
+                                        sort_index, y_data);
     }
-    outer_x_raw += this->outer_size;
-    outer_i_raw += this->outer_size;
-  }
-
-  if (!this->only_index) {
-    auto y_data = outputs[0]->cast_data_and_get_pointer<Tcu>(ctx, true);
-    auto outer_x_raw = x_data;
-    auto outer_y_raw = y_data;
-    auto outer_i_raw = sort_index_raw;
-    auto stride = this->inner_size;
-
-    while (outer_x_raw < x_data + this->total_size) {
-      auto inner_x_raw = outer_x_raw;
-      auto inner_y_raw = outer_y_raw;
-      auto inner_i_raw = outer_i_raw;
-
-      while (inner_x_raw < outer_x_raw + this->inner_size) {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(copy_value, shape[this->axis], stride,
-                                       inner_x_raw, inner_i_raw, inner_y_raw);
-        inner_x_raw++;
-        inner_y_raw++;
-        inner_i_raw++;
-      }
-      outer_x_raw += this->outer_size;
-      outer_y_raw += this->outer_size;
-      outer_i_raw += this->outer_size;
+  } else {
+    auto keys = this->sort_keys_.cast(get_dtype<Tcu>(), ctx, true)
+                    ->template pointer<Tcu>();
+    auto perm = this->sort_perm_.cast(get_dtype<unsigned int>(), ctx, true)
+                    ->template pointer<unsigned int>();
+    auto segs = this->sort_segs_.cast(get_dtype<unsigned int>(), ctx, true)
+                    ->template pointer<unsigned int>();
+    auto keys_ptr = thrust::device_pointer_cast(keys);
+    auto perm_ptr = thrust::device_pointer_cast(perm);
+    auto segs_ptr = thrust::device_pointer_cast(segs);
+    ThrustCachingAllocator alloc(ctx.device_id);
+
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((gather_keys<Tcu, index_t>), total,
+                                           size, inner, x_data, keys, perm);
+    // Sort all keys at once, then restore the segment order with a
+    // stable sort by segment index. Both sorts are radix sorts for
+    // arithmetic key types.
+    auto policy = NBLA_THRUST_PAR(alloc).on(cuda_get_current_stream());
+    if (this->reverse) {
+      thrust::stable_sort_by_key(policy, keys_ptr, keys_ptr + total, perm_ptr,
+                                 thrust::greater<Tcu>());
+    } else {
+      thrust::stable_sort_by_key(policy, keys_ptr, keys_ptr + total, perm_ptr,
+                                 thrust::less<Tcu>());
     }
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((segment_of<index_t>), total, size,
+                                           perm, segs);
+    thrust::stable_sort_by_key(policy, segs_ptr, segs_ptr + total,
+                               thrust::make_zip_iterator(
+                                   thrust::make_tuple(perm_ptr, keys_ptr)));
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((scatter_sorted<Tcu, index_t>),
+                                           total, size, inner, perm, keys,
+                                           sort_index, y_data);
   }
 
   if (this->with_index || this->only_index) {
@@ -189,37 +290,23 @@ void SortCuda<T>::backward_impl(const Variables &inputs,
 
   const auto &ctx = this->ctx_;
   const auto &shape = inputs[0]->shape();
+  const Size_t size = shape[this->axis];
+  const Size_t inner = this->inner_size;
+  const Size_t total = this->total_size;
 
   Variable &sort_index_var = this->sort_index;
-  auto sort_index_raw = sort_index_var.cast_data_and_get_pointer<size_t>(ctx);
+  auto sort_index = sort_index_var.get_data_pointer<size_t>(ctx);
   auto x_grad = inputs[0]->cast_grad_and_get_pointer<Tcu>(ctx, !accum[0]);
   auto y_grad = outputs[0]->get_grad_pointer<Tcu>(ctx);
 
-  auto outer_x_raw = x_grad;
-  auto outer_y_raw = y_grad;
-  auto outer_i_raw = sort_index_raw;
-  auto stride = this->inner_size;
-
-  while (outer_x_raw < x_grad + this->total_size) {
-    auto inner_x_raw = outer_x_raw;
-    auto inner_y_raw = outer_y_raw;
-    auto inner_i_raw = outer_i_raw;
-
-    while (inner_y_raw < outer_y_raw + this->inner_size) {
-      if (accum[0]) {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(add_grad, shape[this->axis], stride,
-                                       inner_y_raw, inner_i_raw, inner_x_raw);
-      } else {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(set_grad, shape[this->axis], stride,
-                                       inner_y_raw, inner_i_raw, inner_x_raw);
-      }
-      inner_x_raw++;
-      inner_y_raw++;
-      inner_i_raw++;
-    }
-    outer_x_raw += this->outer_size;
-    outer_y_raw += this->outer_size;
-    outer_i_raw += this->outer_size;
+  if (accum[0]) {
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (backward_sorted<Tcu, true, index_t>), total, size, inner, y_grad,
+        sort_index, x_grad);
+  } else {
+    NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+        (backward_sorted<Tcu, false, index_t>), total, size, inner, y_grad,
+        sort_index, x_grad);
   }
 }
 
@@ -13,17 +13,12 @@
 // limitations under the License.
 
 #include <nbla/array.hpp>
-#include <nbla/imperative.hpp>
 #include <nbla/variable.hpp>
 
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/sync_batch_normalization.hpp>
 #include <nbla/cuda/limits.hpp>
 
-#include <nbla/function/add2.hpp>
-#include <nbla/function/concatenate.hpp>
-#include <nbla/function/slice.hpp>
-
 #include "kernel/sync_batch_normalization.cu"
 
 namespace nbla {
@@ -37,48 +32,17 @@ void SyncBatchNormalizationCuda<T>::setup_impl(const Variables &inputs,
 
   int c = this->size1_;
 
-  //----------------
-  // Forward setup
-  //----------------
-  v_local_mean_.reshape(Shape_t{c}, true);
-  v_local_invstd_.reshape(Shape_t{c}, true);
-  v_local_count_.reshape(Shape_t{1}, true);
-
-  // Store local reduction size to the buffer in order to synchronize between
-  // other processes and get total reduction size.
-  nbla::Context cpu_ctx{{"cpu:float"}, "CpuCachedArray", "0"};
-  float *local_count = v_local_count_.cast_data_and_get_pointer<float>(cpu_ctx);
-  local_count[0] = this->size02_;
-
-  int n_workers = this->comm_->size();
-  v_all_gather_send_.reshape(Shape_t{2 * c + 1}, true);
-  v_all_gather_recv_.reshape(Shape_t{n_workers, (2 * c + 1)}, true);
-
-  // Concatenate buffers for all_gather.
-  concatenate_ = create_Concatenate(this->ctx_, 0);
-  concatenate_->setup({&v_local_mean_, &v_local_invstd_, &v_local_count_},
-                      {&v_all_gather_send_});
-
-  // Slices for extracting the result of all_gather.
-  slice_mean_ = create_Slice(this->ctx_, {0, 0}, {n_workers, c}, {1, 1});
-  slice_mean_->setup({&v_all_gather_recv_}, {&v_all_mean_});
-
-  slice_invstd_ = create_Slice(this->ctx_, {0, c}, {n_workers, 2 * c}, {1, 1});
-  slice_invstd_->setup({&v_all_gather_recv_}, {&v_all_invstd_});
-
-  slice_count_ =
-      create_Slice(this->ctx_, {0, 2 * c}, {n_workers, 2 * c + 1}, {1, 1});
-  slice_count_->setup({&v_all_gather_recv_}, {&v_all_count_});
-
-  //----------------
-  // Backward setup
-  //----------------
-  v_sum_dy_o_.reshape(Shape_t{c}, true);
-  v_sum_dy_xmu_o_.reshape(Shape_t{c}, true);
-
-  v_beta_grad_.reshape(inputs[1]->shape(), true);
-  v_gamma_grad_.reshape(inputs[2]->shape(), true);
-  add2_ = create_Add2(this->ctx_, true /* inplace */);
+  // Local sums of each channel followed by the local count, all-reduced in
+  // place across workers for the global mean. The M2 of each worker around
+  // that mean is all-reduced next for the global variance. Both collectives
+  // are O(C), and neither cancels like E[x^2] - E[x]^2 would for inputs
+  // with a large mean.
+  v_stats_.reshape(Shape_t{c + 1}, true);
+  v_local_stats_.reshape(Shape_t{2 * c + 1}, true);
+  v_m2_.reshape(Shape_t{c}, true);
+
+  // Local sums of dy and dy * (x - mean), all-reduced in backward.
+  v_grad_sums_.reshape(Shape_t{2 * c}, true);
 }
 
 template <class T>
@@ -105,35 +69,30 @@ void SyncBatchNormalizationCuda<T>::forward_impl_batch(
 
   const bool channel_last = this->axes_[0] == inputs[0]->ndim() - 1;
 
-  // Calculate local mean and variance
+  // Calculate local sums, means, M2 and count
   if (channel_last) {
     forward_collect_statistics_channels_last<Tc>(
-        size0, size1, size2, x, &v_local_mean_, &v_local_invstd_,
-        &v_staging_data_for_forward_, &v_semaphores_for_forward_, this->eps_,
-        this->ctx_);
+        size0, size1, size2, x, &v_stats_, &v_local_stats_,
+        &v_staging_data_for_forward_, &v_semaphores_for_forward_, this->ctx_);
   } else {
-    forward_collect_statistics<Tc>(size0, size1, size2, x, &v_local_mean_,
-                                   &v_local_invstd_, this->eps_, this->ctx_);
+    forward_collect_statistics<Tc>(size0, size1, size2, x, &v_stats_,
+                                   &v_local_stats_, this->ctx_);
   }
 
-  // All gather local mean, variance and count
-  concatenate_->forward({&v_local_mean_, &v_local_invstd_, &v_local_count_},
-                        {&v_all_gather_send_});
-  const auto send_buffer = v_all_gather_send_.data();
-  const auto recv_buffer = v_all_gather_recv_.data();
-  this->comm_->all_gather(send_buffer, {recv_buffer}, this->group_);
+  // All reduce local sums for the global mean
+  this->comm_->all_reduce({v_stats_.data()}, false, true, this->group_);
+
+  // All reduce local M2 around the global mean
+  forward_centered_moments<Tc>(size1, &v_stats_, &v_local_stats_, &v_m2_,
+                               this->ctx_);
+  this->comm_->all_reduce({v_m2_.data()}, false, true, this->group_);
 
   // Calculate global mean, variance
-  slice_mean_->forward({&v_all_gather_recv_}, {&v_all_mean_});
-  slice_invstd_->forward({&v_all_gather_recv_}, {&v_all_invstd_});
-  slice_count_->forward({&v_all_gather_recv_}, {&v_all_count_});
   auto r_mean = !update_inputs ? nullptr : inputs[3];
   auto r_var = !update_inputs ? nullptr : inputs[4];
-  const int n_workers = this->comm_->size();
-  forward_reduce_statistics<Tc>(size0, size1, size2, &v_all_mean_,
-                                &v_all_invstd_, &v_all_count_, batch_mean,
-                                batch_var, r_mean, r_var, this->eps_,
-                                this->decay_rate_, this->ctx_, n_workers);
+  forward_finalize_statistics<Tc>(size1, &v_stats_, &v_m2_, batch_mean,
+                                  batch_var, r_mean, r_var, this->decay_rate_,
+                                  this->ctx_);
 
   // Batch normalization
   if (channel_last) {
@@ -149,17 +108,10 @@ void SyncBatchNormalizationCuda<T>::forward_impl_batch(
   {
     v_staging_data_for_forward_.data()->array()->clear();
     v_semaphores_for_forward_.data()->array()->clear();
-    v_local_mean_.data()->array()->clear();
-    v_local_invstd_.data()->array()->clear();
-    // v_local_count is constant value with size 1. This value is set by CPU
-    // context in setup_impl and cannot be clear during propagation.
-    // v_local_count_.data()->array()->clear();
-    v_all_gather_send_.data()->array()->clear();
-    v_all_gather_recv_.data()->array()->clear();
-    v_all_mean_.data()->array()->clear();
-    v_all_invstd_.data()->array()->clear();
-    // v_all_count_ will be used in backward
-    // v_all_count_.data()->array()->clear();
+    v_local_stats_.data()->array()->clear();
+    v_m2_.data()->array()->clear();
+    // v_stats_ holds the total count used in backward
+    // v_stats_.data()->array()->clear();
   }
 }
 
@@ -196,76 +148,49 @@ void SyncBatchNormalizationCuda<T>::backward_impl_batch(
 
   const bool channel_last = this->axes_[0] == inputs[0]->ndim() - 1;
 
-  // Reduce channels and calculate grad of beta and gamma to temporally buffers
+  // Reduce channels to temporally buffers
   if (channel_last) {
     backward_reduce_channels_last<Tc>(
-        size0, size1, size2, x, y, batch_mean, batch_var, &v_sum_dy_o_,
-        &v_sum_dy_xmu_o_, &v_beta_grad_, &v_gamma_grad_,
+        size0, size1, size2, x, y, batch_mean, batch_var, &v_grad_sums_,
         &v_staging_data_for_backward_, &v_semaphores_for_backward_, this->eps_,
         this->ctx_);
   } else {
     backward_reduce<Tc>(size0, size1, size2, x, y, batch_mean, batch_var,
-                        &v_sum_dy_o_, &v_sum_dy_xmu_o_, &v_beta_grad_,
-                        &v_gamma_grad_, this->eps_, this->ctx_);
+                        &v_grad_sums_, this->eps_, this->ctx_);
   }
 
   // All reduce
-  this->comm_->all_reduce({v_sum_dy_o_.data(), v_sum_dy_xmu_o_.data(),
-                           v_beta_grad_.data(), v_gamma_grad_.data()},
-                          false, false, this->group_);
+  this->comm_->all_reduce({v_grad_sums_.data()}, false, true, this->group_);
 
-  // Store beta grad and gamma grad
-  auto set_param_grad = [&](Variable *param, Variable *param_grad_global,
-                            const bool accum) {
-    if (accum) {
-      // Copy current grad value.
-      Variable tmp_var(param->grad());
-      // Accumulate gradient by add2 operation.
-      nbla::execute(add2_, {&tmp_var, param_grad_global}, {&tmp_var});
-    } else {
-      // Just copy grad.
-      const Array *param_from =
-          param_grad_global->data()->get(get_dtype<T>(), this->ctx_);
-      Array *param_to = param->grad()->cast(get_dtype<T>(), this->ctx_, true);
-      param_to->copy_from(param_from);
-    }
-  };
-  // Beta grad
-  if (propagate_down[1]) {
-    set_param_grad(beta, &v_beta_grad_, accum[1]);
-  }
-  // Gamma grad
-  if (propagate_down[2]) {
-    set_param_grad(gamma, &v_gamma_grad_, accum[2]);
+  // Beta grad and gamma grad
+  if (propagate_down[1] || propagate_down[2]) {
+    backward_param_grad<Tc>(size1, &v_grad_sums_, batch_var, beta, gamma,
+                            propagate_down[1], propagate_down[2], accum[1],
+                            accum[2], this->eps_, this->ctx_);
   }
 
   // Calculate x grad
   if (propagate_down[0]) {
     const bool output_stat = outputs.size() == 3;
-    const int n_workers = this->comm_->size();
     if (channel_last) {
       if (accum[0]) {
         backward_dx_post_channels_last<Tc, true>(
             size0, size1, size2, y, x, batch_mean, batch_var, gamma,
-            &v_sum_dy_o_, &v_sum_dy_xmu_o_, &v_all_count_, output_stat,
-            this->eps_, this->ctx_);
+            &v_grad_sums_, &v_stats_, output_stat, this->eps_, this->ctx_);
       } else {
         backward_dx_post_channels_last<Tc, false>(
             size0, size1, size2, y, x, batch_mean, batch_var, gamma,
-            &v_sum_dy_o_, &v_sum_dy_xmu_o_, &v_all_count_, output_stat,
-            this->eps_, this->ctx_);
+            &v_grad_sums_, &v_stats_, output_stat, this->eps_, this->ctx_);
       }
     } else {
       if (accum[0]) {
         backward_dx_post<Tc, true>(size0, size1, size2, x, y, batch_mean,
-                                   batch_var, &v_sum_dy_o_, &v_sum_dy_xmu_o_,
-                                   gamma, &v_all_count_, output_stat,
-                                   this->eps_, this->ctx_);
+                                   batch_var, &v_grad_sums_, gamma, &v_stats_,
+                                   output_stat, this->eps_, this->ctx_);
       } else {
         backward_dx_post<Tc, false>(size0, size1, size2, x, y, batch_mean,
-                                    batch_var, &v_sum_dy_o_, &v_sum_dy_xmu_o_,
-                                    gamma, &v_all_count_, output_stat,
-                                    this->eps_, this->ctx_);
+                                    batch_var, &v_grad_sums_, gamma, &v_stats_,
+                                    output_stat, this->eps_, this->ctx_);
       }
     }
   }
@@ -274,11 +199,8 @@ void SyncBatchNormalizationCuda<T>::backward_impl_batch(
   {
     v_staging_data_for_backward_.data()->array()->clear();
     v_semaphores_for_backward_.data()->array()->clear();
-    v_sum_dy_o_.data()->array()->clear();
-    v_sum_dy_xmu_o_.data()->array()->clear();
-    v_beta_grad_.data()->array()->clear();
-    v_gamma_grad_.data()->array()->clear();
-    v_all_count_.data()->array()->clear(); // Calculated in forwrad
+    v_grad_sums_.data()->array()->clear();
+    v_stats_.data()->array()->clear(); // Calculated in forward
   }
 }
 }
@@ -17,10 +17,6 @@
 #include <nbla/cuda/function/top_k_data.hpp>
 #include <nbla/cuda/utils/top_k.cuh>
 #include <nbla/variable.hpp>
-#include <thrust/device_ptr.h>
-#include <thrust/device_vector.h>
-#include <thrust/sequence.h>
-#include <thrust/sort.h>
 
 namespace nbla {
 
@@ -48,12 +44,20 @@ __global__ void copy_index_and_value(const int k, const ValIdx<T> *sorted,
   }
 }
 
-template <typename T> __global__ void set_to_zero(const int size, T *data) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) { data[i] = 0; }
+template <bool REDUCE, typename T>
+__global__ void copy_index_and_value(const int size, const int k,
+                                     const int ss, const int fs,
+                                     const unsigned int *sorted_idx,
+                                     const T *x, T *y) {
+  NBLA_CUDA_KERNEL_LOOP(i, size) {
+    const auto s = i / k;
+    const auto idx = sorted_idx[i];
+    y[s * fs + (REDUCE ? i - s * k : idx)] = x[s * ss + idx];
+  }
 }
 
-template <typename T> __global__ void set_to_absolute(const int size, T *data) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) { data[i] = abs(data[i]); }
+template <typename T> __global__ void set_to_zero(const int size, T *data) {
+  NBLA_CUDA_KERNEL_LOOP(i, size) { data[i] = 0; }
 }
 
 template <typename T>
@@ -86,7 +90,8 @@ void TopKDataCuda<T>::setup_impl(const Variables &inputs,
   cuda_set_device(this->device_);
 
   if (this->k_ > 1024) {
-    this->buffer_.reshape(Shape_t{this->ss_}, true);
+    const auto size = top_k_batched_buffer_size(this->ns_, this->k_);
+    this->buffer_.reshape(Shape_t{static_cast<Size_t>(size)}, true);
   } else {
     this->buffer_.reshape(Shape_t{static_cast<Size_t>(sizeof(Buffer<Tcu>))},
                           true);
@@ -112,40 +117,28 @@ void TopKDataCuda<T>::forward_impl(const Variables &inputs,
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(set_to_zero, y->size(), y_data);
 
   if (this->k_ > 1024) {
-    // For large K we use thrust sort_by_key to do a radix sort of
-    // data and index. This is not very efficient but large K is not
-    // he expected use case. The code could be splitting the input
-    // into a smaller partition of the k-th largest values before
-    // sorting.
-    auto buffer_raw =
-        this->buffer_.cast(get_dtype<unsigned int>(), this->ctx_, true)
-            ->template pointer<unsigned int>();
-    auto buffer_ptr = thrust::device_pointer_cast(buffer_raw);
-
-    for (int s = 0; s < this->ns_; s++) {
-      auto x_data_vec = thrust::device_vector<Tcu>(x_data, x_data + this->ss_);
-      auto sorted_val = thrust::raw_pointer_cast(x_data_vec.data());
-      auto sorted_idx = thrust::raw_pointer_cast(buffer_ptr);
-
-      if (this->abs_) {
-        auto raw_ptr = thrust::raw_pointer_cast(x_data_vec.data());
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(set_to_absolute, this->ss_, raw_ptr);
-      }
-
-      thrust::sequence(buffer_ptr, buffer_ptr + this->ss_);
-      thrust::sort_by_key(x_data_vec.begin(), x_data_vec.end(), buffer_ptr,
-                          thrust::greater<Tcu>());
-
-      if (this->reduce_) {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(copy_index_and_value<true>, this->k_,
-                                       sorted_idx, x_data, y_data, tk_idx);
-      } else {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(copy_index_and_value<false>, this->k_,
-                                       sorted_idx, x_data, y_data, tk_idx);
-      }
-      x_data += this->ss_; // increase by input sample size
-      y_data += this->fs_; // increase by output feature size
-      tk_idx += this->k_;
+    // For large K all samples are processed at once by a radix
+    // select of the k-th largest value followed by a sort of only the
+    // k selected values per sample.
+    auto buffer = this->buffer_.cast(get_dtype<char>(), this->ctx_, true)
+                      ->template pointer<char>();
+    if (this->abs_) {
+      top_k_batched<Tcu, true>(x_data, this->ns_, this->ss_, this->k_, buffer,
+                               tk_idx);
+    } else {
+      top_k_batched<Tcu, false>(x_data, this->ns_, this->ss_, this->k_,
+                                buffer, tk_idx);
+    }
+    if (this->reduce_) {
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(copy_index_and_value<true>,
+                                     this->ns_ * this->k_, this->k_,
+                                     this->ss_, this->fs_, tk_idx, x_data,
+                                     y_data);
+    } else {
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(copy_index_and_value<false>,
+                                     this->ns_ * this->k_, this->k_,
+                                     this->ss_, this->fs_, tk_idx, x_data,
+                                     y_data);
     }
   } else {
     auto buffer = this->buffer_.cast(get_dtype<char>(), this->ctx_, true)
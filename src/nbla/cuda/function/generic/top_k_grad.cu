@@ -17,10 +17,6 @@
 #include <nbla/cuda/function/top_k_grad.hpp>
 #include <nbla/cuda/utils/top_k.cuh>
 #include <nbla/variable.hpp>
-#include <thrust/device_ptr.h>
-#include <thrust/device_vector.h>
-#include <thrust/sequence.h>
-#include <thrust/sort.h>
 
 namespace nbla {
 
@@ -30,10 +26,6 @@ template <typename T> __global__ void set_to_zero(const int size, T *data) {
   NBLA_CUDA_KERNEL_LOOP(i, size) { data[i] = 0; }
 }
 
-template <typename T> __global__ void set_to_absolute(const int size, T *data) {
-  NBLA_CUDA_KERNEL_LOOP(i, size) { data[i] = abs(data[i]); }
-}
-
 template <typename T>
 __global__ void add_gradient(const int k, const ValIdx<T> *sorted,
                              const T *y_grad, T *x_grad) {
@@ -70,6 +62,26 @@ __global__ void set_gradient(const int k, const unsigned int *sorted_idx,
   }
 }
 
+template <typename T>
+__global__ void add_gradient(const int size, const int k, const int ss,
+                             const unsigned int *sorted_idx, const T *y_grad,
+                             T *x_grad) {
+  NBLA_CUDA_KERNEL_LOOP(i, size) {
+    const auto idx = (i / k) * ss + sorted_idx[i];
+    x_grad[idx] += y_grad[idx];
+  }
+}
+
+template <typename T>
+__global__ void set_gradient(const int size, const int k, const int ss,
+                             const unsigned int *sorted_idx, const T *y_grad,
+                             T *x_grad) {
+  NBLA_CUDA_KERNEL_LOOP(i, size) {
+    const auto idx = (i / k) * ss + sorted_idx[i];
+    x_grad[idx] = y_grad[idx];
+  }
+}
+
 } // namspace top_k_grad
 
 template <typename T>
@@ -79,7 +91,12 @@ void TopKGradCuda<T>::setup_impl(const Variables &inputs,
   cuda_set_device(this->device_);
 
   if (this->k_ > 1024) {
-    this->buffer_.reshape(Shape_t{outputs[0]->size(this->base_axis_)}, true);
+    // batched top-k buffer followed by the sorted index of all samples
+    const auto inner_size = outputs[0]->size(this->base_axis_);
+    const auto outer_size = outputs[0]->size() / inner_size;
+    const auto size = top_k_batched_buffer_size(outer_size, this->k_) +
+                      outer_size * this->k_ * sizeof(unsigned int);
+    this->buffer_.reshape(Shape_t{static_cast<Size_t>(size)}, true);
   } else {
     this->buffer_.reshape(Shape_t{static_cast<Size_t>(sizeof(Buffer<Tcu>))},
                           true);
@@ -126,39 +143,28 @@ void TopKGradCuda<T>::backward_impl(const Variables &inputs,
   auto outer_size = y->size() / inner_size;
 
   if (this->k_ > 1024) {
-    // For large K we use thrust sort_by_key to do a radix sort of
-    // data and index. This is not very efficient but large K is not
-    // he expected use case. The code could be splitting the input
-    // into a smaller partition of the k-th largest values before
-    // sorting.
-    auto buffer_raw =
-        this->buffer_.cast(get_dtype<unsigned int>(), this->ctx_, true)
-            ->template pointer<unsigned int>();
-    auto buffer_ptr = thrust::device_pointer_cast(buffer_raw);
-
-    for (int s = 0; s < outer_size; s++) {
-      auto y_grad_vec = thrust::device_vector<Tcu>(y_grad, y_grad + inner_size);
-      auto sorted_val = thrust::raw_pointer_cast(y_grad_vec.data());
-      auto sorted_idx = thrust::raw_pointer_cast(buffer_ptr);
-
-      if (this->abs_) {
-        auto raw_ptr = thrust::raw_pointer_cast(y_grad_vec.data());
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(set_to_absolute, inner_size, raw_ptr);
-      }
-
-      thrust::sequence(buffer_ptr, buffer_ptr + inner_size);
-      thrust::sort_by_key(y_grad_vec.begin(), y_grad_vec.end(), buffer_ptr,
-                          thrust::greater<Tcu>());
-
-      if (accum[0]) {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(add_gradient, this->k_, sorted_idx,
-                                       y_grad, x_grad);
-      } else {
-        NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(set_gradient, this->k_, sorted_idx,
-                                       y_grad, x_grad);
-      }
-      y_grad += inner_size;
-      x_grad += inner_size;
+    // For large K all samples are processed at once by a radix
+    // select of the k-th largest value followed by a sort of only the
+    // k selected values per sample.
+    auto buffer = this->buffer_.cast(get_dtype<char>(), this->ctx_, true)
+                      ->template pointer<char>();
+    auto sorted_idx = reinterpret_cast<unsigned int *>(
+        buffer + top_k_batched_buffer_size(outer_size, this->k_));
+    const auto size = outer_size * this->k_;
+
+    if (this->abs_) {
+      top_k_batched<Tcu, true>(y_grad, outer_size, inner_size, this->k_,
+                               buffer, sorted_idx);
+    } else {
+      top_k_batched<Tcu, false>(y_grad, outer_size, inner_size, this->k_,
+                                buffer, sorted_idx);
+    }
+    if (accum[0]) {
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(add_gradient, size, this->k_, inner_size,
+                                     sorted_idx, y_grad, x_grad);
+    } else {
+      NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(set_gradient, size, this->k_, inner_size,
+                                     sorted_idx, y_grad, x_grad);
     }
   } else {
     auto buffer = this->buffer_.cast(get_dtype<char>(), this->ctx_, true)
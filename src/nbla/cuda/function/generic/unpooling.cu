@@ -18,8 +18,12 @@
 #include <nbla/cuda/math.hpp>
 #include <nbla/cuda/utils/atomic_add.cuh>
 #include <nbla/cuda/utils/nd_index.cuh>
+#include <nbla/cuda/utils/pack.cuh>
 #include <nbla/variable.hpp>
 
+#include <functional>
+#include <numeric>
+
 namespace nbla {
 
 template <typename T, bool channel_last = false>
@@ -160,81 +164,73 @@ kernel_unpooling_backward_3d(const int osize, T *dst, const T *src,
   }
 }
 
-template <typename T>
-void UnpoolingCuda<T>::forward_impl(const Variables &inputs,
-                                    const Variables &outputs) {
-  cuda_set_device(this->device_);
+// Launches the forward kernels for an element type U, which is either the
+// array type or a pack of consecutive channels of a channel-last array.
+template <typename U>
+void unpooling_forward(const U *x, U *y, const Shape_t &ishape,
+                       const Shape_t &oshape, const vector<int> &kernel_shape,
+                       const bool channel_last) {
+  auto size = std::accumulate(oshape.begin(), oshape.end(), (Size_t)1,
+                              std::multiplies<Size_t>());
+  auto ndim = ishape.size();
+  auto kdim = kernel_shape.size();
 
-  auto x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
-  auto y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
-  auto size = outputs[0]->size();
-  auto ndim = inputs[0]->ndim();
-  auto kdim = this->kernel_.size();
-
-  auto ishape = inputs[0]->shape();
-  auto oshape = outputs[0]->shape();
   if (kdim == 1) {
-    auto oc = this->channel_last_ ? oshape[ndim - 1] : oshape[ndim - 2];
-    auto ow = this->channel_last_ ? oshape[ndim - 2] : oshape[ndim - 1];
-    auto ic = this->channel_last_ ? ishape[ndim - 1] : ishape[ndim - 2];
-    auto iw = this->channel_last_ ? ishape[ndim - 2] : ishape[ndim - 1];
-    auto osize = this->channel_last_ ? oc * ow : ow;
+    auto oc = channel_last ? oshape[ndim - 1] : oshape[ndim - 2];
+    auto ow = channel_last ? oshape[ndim - 2] : oshape[ndim - 1];
+    auto ic = channel_last ? ishape[ndim - 1] : ishape[ndim - 2];
+    auto iw = channel_last ? ishape[ndim - 2] : ishape[ndim - 1];
+    auto osize = channel_last ? oc * ow : ow;
     auto outer_size = size / osize;
-    auto iinner_size = this->channel_last_ ? ic * iw : iw;
+    auto iinner_size = channel_last ? ic * iw : iw;
     auto oinner_size = osize;
-    auto istride = this->channel_last_ ? (ic) : 1;
-    auto ostride = this->channel_last_ ? (oc) : 1;
-    auto kernel = this->kernel_[0];
-    auto cuda_kernel = this->channel_last_
-                           ? kernel_unpooling_forward_1d<Tc, true>
-                           : kernel_unpooling_forward_1d<Tc, false>;
+    auto istride = channel_last ? (ic) : 1;
+    auto ostride = channel_last ? (oc) : 1;
+    auto kernel = kernel_shape[0];
+    auto cuda_kernel = channel_last ? kernel_unpooling_forward_1d<U, true>
+                                    : kernel_unpooling_forward_1d<U, false>;
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(cuda_kernel, osize, y, x, outer_size,
                                    iinner_size, oinner_size, istride, ostride,
                                    kernel);
   } else if (kdim == 2) {
-    auto oc = this->channel_last_ ? oshape[ndim - 1] : oshape[ndim - 3];
-    auto oh = this->channel_last_ ? oshape[ndim - 3] : oshape[ndim - 2];
-    auto ow = this->channel_last_ ? oshape[ndim - 2] : oshape[ndim - 1];
-    auto ic = this->channel_last_ ? ishape[ndim - 1] : ishape[ndim - 3];
-    auto ih = this->channel_last_ ? ishape[ndim - 3] : ishape[ndim - 2];
-    auto iw = this->channel_last_ ? ishape[ndim - 2] : ishape[ndim - 1];
-    auto osize = this->channel_last_ ? oc * oh * ow : oh * ow;
+    auto oc = channel_last ? oshape[ndim - 1] : oshape[ndim - 3];
+    auto oh = channel_last ? oshape[ndim - 3] : oshape[ndim - 2];
+    auto ow = channel_last ? oshape[ndim - 2] : oshape[ndim - 1];
+    auto ic = channel_last ? ishape[ndim - 1] : ishape[ndim - 3];
+    auto ih = channel_last ? ishape[ndim - 3] : ishape[ndim - 2];
+    auto iw = channel_last ? ishape[ndim - 2] : ishape[ndim - 1];
+    auto osize = channel_last ? oc * oh * ow : oh * ow;
     auto outer_size = size / osize;
-    auto iinner_size = this->channel_last_ ? ic * ih * iw : ih * iw;
+    auto iinner_size = channel_last ? ic * ih * iw : ih * iw;
     auto oinner_size = osize;
-    auto istride =
-        this->channel_last_ ? make_int2(iw * ic, ic) : make_int2(iw, 1);
-    auto ostride =
-        this->channel_last_ ? make_int2(ow * oc, oc) : make_int2(ow, 1);
-    auto kernel = make_int2(this->kernel_[0], this->kernel_[1]);
-    auto cuda_kernel = this->channel_last_
-                           ? kernel_unpooling_forward_2d<Tc, true>
-                           : kernel_unpooling_forward_2d<Tc, false>;
+    auto istride = channel_last ? make_int2(iw * ic, ic) : make_int2(iw, 1);
+    auto ostride = channel_last ? make_int2(ow * oc, oc) : make_int2(ow, 1);
+    auto kernel = make_int2(kernel_shape[0], kernel_shape[1]);
+    auto cuda_kernel = channel_last ? kernel_unpooling_forward_2d<U, true>
+                                    : kernel_unpooling_forward_2d<U, false>;
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(cuda_kernel, osize, y, x, outer_size,
                                    iinner_size, oinner_size, istride, ostride,
                                    kernel);
   } else if (kdim == 3) {
-    auto oc = this->channel_last_ ? oshape[ndim - 1] : oshape[ndim - 4];
-    auto od = this->channel_last_ ? oshape[ndim - 4] : oshape[ndim - 3];
-    auto oh = this->channel_last_ ? oshape[ndim - 3] : oshape[ndim - 2];
-    auto ow = this->channel_last_ ? oshape[ndim - 2] : oshape[ndim - 1];
-    auto ic = this->channel_last_ ? ishape[ndim - 1] : ishape[ndim - 4];
-    auto id = this->channel_last_ ? ishape[ndim - 4] : ishape[ndim - 3];
-    auto ih = this->channel_last_ ? ishape[ndim - 3] : ishape[ndim - 2];
-    auto iw = this->channel_last_ ? ishape[ndim - 2] : ishape[ndim - 1];
-    auto osize = this->channel_last_ ? oc * od * oh * ow : od * oh * ow;
+    auto oc = channel_last ? oshape[ndim - 1] : oshape[ndim - 4];
+    auto od = channel_last ? oshape[ndim - 4] : oshape[ndim - 3];
+    auto oh = channel_last ? oshape[ndim - 3] : oshape[ndim - 2];
+    auto ow = channel_last ? oshape[ndim - 2] : oshape[ndim - 1];
+    auto ic = channel_last ? ishape[ndim - 1] : ishape[ndim - 4];
+    auto id = channel_last ? ishape[ndim - 4] : ishape[ndim - 3];
+    auto ih = channel_last ? ishape[ndim - 3] : ishape[ndim - 2];
+    auto iw = channel_last ? ishape[ndim - 2] : ishape[ndim - 1];
+    auto osize = channel_last ? oc * od * oh * ow : od * oh * ow;
     auto outer_size = size / osize;
-    auto iinner_size = this->channel_last_ ? ic * id * ih * iw : id * ih * iw;
+    auto iinner_size = channel_last ? ic * id * ih * iw : id * ih * iw;
     auto oinner_size = osize;
-    auto istride = this->channel_last_ ? make_int3(ih * iw * ic, iw * ic, ic)
-                                       : make_int3(ih * iw, iw, 1);
-    auto ostride = this->channel_last_ ? make_int3(oh * ow * oc, ow * oc, oc)
-                                       : make_int3(oh * ow, ow, 1);
-    auto kernel =
-        make_int3(this->kernel_[0], this->kernel_[1], this->kernel_[2]);
-    auto cuda_kernel = this->channel_last_
-                           ? kernel_unpooling_forward_3d<Tc, true>
-                           : kernel_unpooling_forward_3d<Tc, false>;
+    auto istride = channel_last ? make_int3(ih * iw * ic, iw * ic, ic)
+                                : make_int3(ih * iw, iw, 1);
+    auto ostride = channel_last ? make_int3(oh * ow * oc, ow * oc, oc)
+                                : make_int3(oh * ow, ow, 1);
+    auto kernel = make_int3(kernel_shape[0], kernel_shape[1], kernel_shape[2]);
+    auto cuda_kernel = channel_last ? kernel_unpooling_forward_3d<U, true>
+                                    : kernel_unpooling_forward_3d<U, false>;
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(cuda_kernel, osize, y, x, outer_size,
                                    iinner_size, oinner_size, istride, ostride,
                                    kernel);
@@ -243,6 +239,32 @@ void UnpoolingCuda<T>::forward_impl(const Variables &inputs,
   }
 }
 
+template <typename T>
+void UnpoolingCuda<T>::forward_impl(const Variables &inputs,
+                                    const Variables &outputs) {
+  cuda_set_device(this->device_);
+
+  auto x = inputs[0]->get_data_pointer<Tc>(this->ctx_);
+  auto y = outputs[0]->cast_data_and_get_pointer<Tc>(this->ctx_, true);
+  auto ishape = inputs[0]->shape();
+  auto oshape = outputs[0]->shape();
+
+  // Channel-last arrays are copied in packs of consecutive channels if the
+  // number of channels allows it.
+  constexpr int N = max_pack_size<Tc>();
+  if (this->channel_last_ && ishape.back() % N == 0 &&
+      pack_aligned<Tc, N>(x, y)) {
+    ishape.back() /= N;
+    oshape.back() /= N;
+    unpooling_forward(reinterpret_cast<const Pack<Tc, N> *>(x),
+                      reinterpret_cast<Pack<Tc, N> *>(y), ishape, oshape,
+                      this->kernel_, true);
+  } else {
+    unpooling_forward(x, y, ishape, oshape, this->kernel_,
+                      this->channel_last_);
+  }
+}
+
 template <typename T>
 void UnpoolingCuda<T>::backward_impl(const Variables &inputs,
                                      const Variables &outputs,
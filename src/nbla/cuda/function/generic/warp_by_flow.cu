@@ -15,7 +15,7 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/warp_by_flow.hpp>
-#include <nbla/cuda/utils/atomic_add.cuh>
+#include <nbla/cuda/utils/scatter_add.cuh>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -58,7 +58,8 @@ __global__ void forward(const int size, const int4 oshape, const int4 strides,
 
 template <typename T>
 __global__ void grad2data(const int size, const int4 oshape, const int4 stride,
-                          const T *data, const T *flow, const T *grad, T *out) {
+                          const T *data, const T *flow, const T *grad,
+                          const ScatterAddView<T> out) {
   // size = NCHW, oshape.(w|z|y|x) = (N|C|H|W), stride.(w|z|y|x) = (CHW|HW|W|1)
   NBLA_CUDA_KERNEL_LOOP(index, size) {
     auto x = index;
@@ -78,10 +79,11 @@ __global__ void grad2data(const int size, const int4 oshape, const int4 stride,
     auto a0 = xf - T(xl), b0 = yf - T(yt);
     auto a1 = T(1) - a0, b1 = T(1) - b0;
     auto nc = n * stride.w + c * stride.z;
-    atomic_add(&out[nc + yt * stride.y + xl], a1 * b1 * grad[index]);
-    atomic_add(&out[nc + yb * stride.y + xl], a1 * b0 * grad[index]);
-    atomic_add(&out[nc + yt * stride.y + xr], a0 * b1 * grad[index]);
-    atomic_add(&out[nc + yb * stride.y + xr], a0 * b0 * grad[index]);
+    auto slot = static_cast<Size_t>(index) * 4;
+    out(slot + 0, nc + yt * stride.y + xl, a1 * b1 * grad[index]);
+    out(slot + 1, nc + yb * stride.y + xl, a1 * b0 * grad[index]);
+    out(slot + 2, nc + yt * stride.y + xr, a0 * b1 * grad[index]);
+    out(slot + 3, nc + yb * stride.y + xr, a0 * b0 * grad[index]);
   }
 }
 
@@ -188,8 +190,10 @@ void WarpByFlowCuda<T>::backward_impl(const Variables &inputs,
       inputs[0]->grad()->zero();
     using warp_by_flow::grad2data;
     auto g_data = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_, false);
+    ScatterAdder<Tcu> adder(this->ctx_, g_data, inputs[0]->size() * 4);
     NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(grad2data, inputs[0]->size(), oshape, stride,
-                                   data, flow, grad, g_data);
+                                   data, flow, grad, adder.view());
+    adder.finish();
   }
 
   if (propagate_down[1]) {
@@ -15,8 +15,8 @@
 #include <nbla/array.hpp>
 #include <nbla/cuda/common.hpp>
 #include <nbla/cuda/function/warp_by_grid.hpp>
-#include <nbla/cuda/utils/atomic_add.cuh>
 #include <nbla/cuda/utils/nd_index.cuh>
+#include <nbla/cuda/utils/scatter_add.cuh>
 #include <nbla/variable.hpp>
 
 namespace nbla {
@@ -183,28 +183,30 @@ __forceinline__ __device__ T get_pixel_value_3d(const T *input, int b, int c,
 
 template <typename T, bool channel_last = false>
 __forceinline__ __device__ void
-backward_data_2d(T *igrad, const T ograd, const T p, const T q, int b, int c,
-                 int h, int w, const int H, const int W, const int2 istride,
+backward_data_2d(const ScatterAddView<T> &igrad, const Size_t slot,
+                 const T ograd, const T p, const T q, int b, int c, int h,
+                 int w, const int H, const int W, const int2 istride,
                  const int iisize) {
   if ((h >= 0 && h < H) && (w >= 0 && w < W)) {
     auto ind_index = channel_last ? make_int3(h, w, c) : make_int3(c, h, w);
     auto iidx = device_3d_to_flat(ind_index, istride);
     auto b_iidx = iidx + b * iisize;
-    atomic_add(igrad + b_iidx, ograd * p * q);
+    igrad(slot, b_iidx, ograd * p * q);
   }
 }
 
 template <typename T, bool channel_last = false>
 __forceinline__ __device__ void
-backward_data_3d(T *igrad, const T ograd, const T p, const T q, const T r,
-                 int b, int c, int d, int h, int w, const int D, const int H,
-                 const int W, const int3 istride, const int iisize) {
+backward_data_3d(const ScatterAddView<T> &igrad, const Size_t slot,
+                 const T ograd, const T p, const T q, const T r, int b, int c,
+                 int d, int h, int w, const int D, const int H, const int W,
+                 const int3 istride, const int iisize) {
   if ((d >= 0 && d < D) && (h >= 0 && h < H) && (w >= 0 && w < W)) {
     auto ind_index =
         channel_last ? make_int4(d, h, w, c) : make_int4(c, d, h, w);
     auto iidx = device_4d_to_flat(ind_index, istride);
     auto b_iidx = iidx + b * iisize;
-    atomic_add(igrad + b_iidx, ograd * p * q * r);
+    igrad(slot, b_iidx, ograd * p * q * r);
   }
 }
 
@@ -483,9 +485,10 @@ template <typename T, warp_by_grid::PADDING_MODE padding_mode =
                           warp_by_grid::PADDING_MODE::zero,
           bool align_corners = false, bool channel_last = false>
 __global__ void kernel_warp_linear_backward_data_2d(
-    const int oisize, const int iisize, const int gisize, T *igrad,
-    const T *ograd, const T *grid, const int3 ishape, const int2 istride,
-    const int2 gstride, const int2 ostride, const int B) {
+    const int oisize, const int iisize, const int gisize,
+    const ScatterAddView<T> igrad, const T *ograd, const T *grid,
+    const int3 ishape, const int2 istride, const int2 gstride,
+    const int2 ostride, const int B) {
   auto Hi = channel_last ? ishape.x : ishape.y;
   auto Wi = channel_last ? ishape.y : ishape.z;
 
@@ -531,14 +534,15 @@ __global__ void kernel_warp_linear_backward_data_2d(
 
       auto b_oidx = oidx + b * oisize;
       auto grad = ograd[b_oidx];
-      backward_data_2d<T, channel_last>(igrad, grad, py1, px1, b, c, yi0, xi0,
-                                        Hi, Wi, istride, iisize);
-      backward_data_2d<T, channel_last>(igrad, grad, py1, px0, b, c, yi0, xi1,
-                                        Hi, Wi, istride, iisize);
-      backward_data_2d<T, channel_last>(igrad, grad, py0, px1, b, c, yi1, xi0,
-                                        Hi, Wi, istride, iisize);
-      backward_data_2d<T, channel_last>(igrad, grad, py0, px0, b, c, yi1, xi1,
-                                        Hi, Wi, istride, iisize);
+      auto slot = static_cast<Size_t>(b_oidx) * 4;
+      backward_data_2d<T, channel_last>(igrad, slot + 0, grad, py1, px1, b, c,
+                                        yi0, xi0, Hi, Wi, istride, iisize);
+      backward_data_2d<T, channel_last>(igrad, slot + 1, grad, py1, px0, b, c,
+                                        yi0, xi1, Hi, Wi, istride, iisize);
+      backward_data_2d<T, channel_last>(igrad, slot + 2, grad, py0, px1, b, c,
+                                        yi1, xi0, Hi, Wi, istride, iisize);
+      backward_data_2d<T, channel_last>(igrad, slot + 3, grad, py0, px0, b, c,
+                                        yi1, xi1, Hi, Wi, istride, iisize);
     }
   }
 }
@@ -547,9 +551,10 @@ template <typename T, warp_by_grid::PADDING_MODE padding_mode =
                           warp_by_grid::PADDING_MODE::zero,
           bool align_corners = false, bool channel_last = false>
 __global__ void kernel_warp_nearest_backward_data_2d(
-    const int oisize, const int iisize, const int gisize, T *igrad,
-    const T *ograd, const T *grid, const int3 ishape, const int2 istride,
-    const int2 gstride, const int2 ostride, const int B) {
+    const int oisize, const int iisize, const int gisize,
+    const ScatterAddView<T> igrad, const T *ograd, const T *grid,
+    const int3 ishape, const int2 istride, const int2 gstride,
+    const int2 ostride, const int B) {
   auto Hi = channel_last ? ishape.x : ishape.y;
   auto Wi = channel_last ? ishape.y : ishape.z;
 
@@ -589,8 +594,9 @@ __global__ void kernel_warp_nearest_backward_data_2d(
 
       auto b_oidx = oidx + b * oisize;
       auto grad = ograd[b_oidx];
-      backward_data_2d<T, channel_last>(igrad, grad, T(1.0), T(1.0), b, c, yi,
-                                        xi, Hi, Wi, istride, iisize);
+      auto slot = static_cast<Size_t>(b_oidx);
+      backward_data_2d<T, channel_last>(igrad, slot, grad, T(1.0), T(1.0), b, c,
+                                        yi, xi, Hi, Wi, istride, iisize);
     }
   }
 }
@@ -599,9 +605,10 @@ template <typename T, warp_by_grid::PADDING_MODE padding_mode =
                           warp_by_grid::PADDING_MODE::zero,
           bool align_corners = false, bool channel_last = false>
 __global__ void kernel_warp_linear_backward_data_3d(
-    const int oisize, const int iisize, const int gisize, T *igrad,
-    const T *ograd, const T *grid, const int4 ishape, const int3 istride,
-    const int3 gstride, const int3 ostride, const int B) {
+    const int oisize, const int iisize, const int gisize,
+    const ScatterAddView<T> igrad, const T *ograd, const T *grid,
+    const int4 ishape, const int3 istride, const int3 gstride,
+    const int3 ostride, const int B) {
   auto Di = channel_last ? ishape.x : ishape.y;
   auto Hi = channel_last ? ishape.y : ishape.z;
   auto Wi = channel_last ? ishape.z : ishape.w;
@@ -656,40 +663,41 @@ __global__ void kernel_warp_linear_backward_data_3d(
 
       auto b_oidx = oidx + b * oisize;
       auto grad = ograd[b_oidx];
+      auto slot = static_cast<Size_t>(b_oidx) * 8;
       if (channel_last) {
-        backward_data_3d<T, true>(igrad, grad, pz1, py1, px1, b, c, zi0, yi0,
-                                  xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz1, py1, px0, b, c, zi0, yi0,
-                                  xi1, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz1, py0, px1, b, c, zi0, yi1,
-                                  xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz1, py0, px0, b, c, zi0, yi1,
-                                  xi1, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz0, py1, px1, b, c, zi1, yi0,
-                                  xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz0, py1, px0, b, c, zi1, yi0,
-                                  xi1, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz0, py0, px1, b, c, zi1, yi1,
-                                  xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, true>(igrad, grad, pz0, py0, px0, b, c, zi1, yi1,
-                                  xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 0, grad, pz1, py1, px1, b, c,
+                                  zi0, yi0, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 1, grad, pz1, py1, px0, b, c,
+                                  zi0, yi0, xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 2, grad, pz1, py0, px1, b, c,
+                                  zi0, yi1, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 3, grad, pz1, py0, px0, b, c,
+                                  zi0, yi1, xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 4, grad, pz0, py1, px1, b, c,
+                                  zi1, yi0, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 5, grad, pz0, py1, px0, b, c,
+                                  zi1, yi0, xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 6, grad, pz0, py0, px1, b, c,
+                                  zi1, yi1, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, true>(igrad, slot + 7, grad, pz0, py0, px0, b, c,
+                                  zi1, yi1, xi1, Di, Hi, Wi, istride, iisize);
       } else {
-        backward_data_3d<T, false>(igrad, grad, pz1, py1, px1, b, c, zi0, yi0,
-                                   xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz1, py1, px0, b, c, zi0, yi0,
-                                   xi1, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz1, py0, px1, b, c, zi0, yi1,
-                                   xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz1, py0, px0, b, c, zi0, yi1,
-                                   xi1, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz0, py1, px1, b, c, zi1, yi0,
-                                   xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz0, py1, px0, b, c, zi1, yi0,
-                                   xi1, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz0, py0, px1, b, c, zi1, yi1,
-                                   xi0, Di, Hi, Wi, istride, iisize);
-        backward_data_3d<T, false>(igrad, grad, pz0, py0, px0, b, c, zi1, yi1,
-                                   xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 0, grad, pz1, py1, px1, b, c,
+                                   zi0, yi0, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 1, grad, pz1, py1, px0, b, c,
+                                   zi0, yi0, xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 2, grad, pz1, py0, px1, b, c,
+                                   zi0, yi1, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 3, grad, pz1, py0, px0, b, c,
+                                   zi0, yi1, xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 4, grad, pz0, py1, px1, b, c,
+                                   zi1, yi0, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 5, grad, pz0, py1, px0, b, c,
+                                   zi1, yi0, xi1, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 6, grad, pz0, py0, px1, b, c,
+                                   zi1, yi1, xi0, Di, Hi, Wi, istride, iisize);
+        backward_data_3d<T, false>(igrad, slot + 7, grad, pz0, py0, px0, b, c,
+                                   zi1, yi1, xi1, Di, Hi, Wi, istride, iisize);
       }
     }
   }
@@ -699,9 +707,10 @@ template <typename T, warp_by_grid::PADDING_MODE padding_mode =
                           warp_by_grid::PADDING_MODE::zero,
           bool align_corners = false, bool channel_last = false>
 __global__ void kernel_warp_nearest_backward_data_3d(
-    const int oisize, const int iisize, const int gisize, T *igrad,
-    const T *ograd, const T *grid, const int4 ishape, const int3 istride,
-    const int3 gstride, const int3 ostride, const int B) {
+    const int oisize, const int iisize, const int gisize,
+    const ScatterAddView<T> igrad, const T *ograd, const T *grid,
+    const int4 ishape, const int3 istride, const int3 gstride,
+    const int3 ostride, const int B) {
   auto Di = channel_last ? ishape.x : ishape.y;
   auto Hi = channel_last ? ishape.y : ishape.z;
   auto Wi = channel_last ? ishape.z : ishape.w;
@@ -747,9 +756,10 @@ __global__ void kernel_warp_nearest_backward_data_3d(
 
       auto b_oidx = oidx + b * oisize;
       auto grad = ograd[b_oidx];
-      backward_data_3d<T, channel_last>(igrad, grad, T(1.0), T(1.0), T(1.0), b,
-                                        c, zi, yi, xi, Di, Hi, Wi, istride,
-                                        iisize);
+      auto slot = static_cast<Size_t>(b_oidx);
+      backward_data_3d<T, channel_last>(igrad, slot, grad, T(1.0), T(1.0),
+                                        T(1.0), b, c, zi, yi, xi, Di, Hi, Wi,
+                                        istride, iisize);
     }
   }
 }
@@ -762,9 +772,10 @@ template <typename T, warp_by_grid::PADDING_MODE padding_mode =
                           warp_by_grid::PADDING_MODE::zero,
           bool align_corners = false, bool channel_last = false>
 __global__ void kernel_warp_linear_backward_grid_2d(
-    const int oisize, const int iisize, const int gisize, T *ggrad,
-    const T *ograd, const T *input, const T *grid, const int3 ishape,
-    const int2 istride, const int2 gstride, const int2 ostride, const int B) {
+    const int oisize, const int iisize, const int gisize,
+    const ScatterAddView<T> ggrad, const T *ograd, const T *input,
+    const T *grid, const int3 ishape, const int2 istride, const int2 gstride,
+    const int2 ostride, const int B) {
   auto Hi = channel_last ? ishape.x : ishape.y;
   auto Wi = channel_last ? ishape.y : ishape.z;
 
@@ -832,6 +843,7 @@ __global__ void kernel_warp_linear_backward_grid_2d(
           input, b, c, yi1, xi1, Hi, Wi, istride, iisize);
       auto b_oidx = oidx + b * oisize;
       auto grad = ograd[b_oidx];
+      auto slot = static_cast<Size_t>(b_oidx) * 2;
 
       // d_grid = d_output * local_grad{output/pad(x)} * local_grad{pad(x)/x} *
       // unnormalized_coef
@@ -839,8 +851,8 @@ __global__ void kernel_warp_linear_backward_grid_2d(
       auto grad_y = grad * ((v_y1x0 - v_y0x0) * px1 + (v_y1x1 - v_y0x1) * px0);
       auto coef_x = get_grad_coef_with_pad(xf0, Wi);
       auto coef_y = get_grad_coef_with_pad(yf0, Hi);
-      atomic_add(ggrad + b_gidx + 0, grad_x * coef_x);
-      atomic_add(ggrad + b_gidx + 1, grad_y * coef_y);
+      ggrad(slot + 0, b_gidx + 0, grad_x * coef_x);
+      ggrad(slot + 1, b_gidx + 1, grad_y * coef_y);
     }
   }
 }
@@ -849,9 +861,10 @@ template <typename T, warp_by_grid::PADDING_MODE padding_mode =
                           warp_by_grid::PADDING_MODE::zero,
           bool align_corners = false, bool channel_last = false>
 __global__ void kernel_warp_linear_backward_grid_3d(
-    const int oisize, const int iisize, const int gisize, T *ggrad,
-    const T *ograd, const T *input, const T *grid, const int4 ishape,
-    const int3 istride, const int3 gstride, const int3 ostride, const int B) {
+    const int oisize, const int iisize, const int gisize,
+    const ScatterAddView<T> ggrad, const T *ograd, const T *input,
+    const T *grid, const int4 ishape, const int3 istride, const int3 gstride,
+    const int3 ostride, const int B) {
   auto Di = channel_last ? ishape.x : ishape.y;
   auto Hi = channel_last ? ishape.y : ishape.z;
   auto Wi = channel_last ? ishape.z : ishape.w;
@@ -936,6 +949,7 @@ __global__ void kernel_warp_linear_backward_grid_3d(
           input, b, c, zi1, yi1, xi1, Di, Hi, Wi, istride, iisize);
       auto b_oidx = oidx + b * oisize;
       auto grad = ograd[b_oidx];
+      auto slot = static_cast<Size_t>(b_oidx) * 3;
 
       // d_grid = d_output * local_grad{output/pad(x)} * local_grad{pad(x)/x} *
       // unnormalized_coef
@@ -954,9 +968,9 @@ __global__ void kernel_warp_linear_backward_grid_3d(
       auto coef_x = get_grad_coef_with_pad(xf0, Wi);
       auto coef_y = get_grad_coef_with_pad(yf0, Hi);
       auto coef_z = get_grad_coef_with_pad(zf0, Di);
-      atomic_add(ggrad + b_gidx + 0, grad_x * coef_x);
-      atomic_add(ggrad + b_gidx + 1, grad_y * coef_y);
-      atomic_add(ggrad + b_gidx + 2, grad_z * coef_z);
+      ggrad(slot + 0, b_gidx + 0, grad_x * coef_x);
+      ggrad(slot + 1, b_gidx + 1, grad_y * coef_y);
+      ggrad(slot + 2, b_gidx + 2, grad_z * coef_z);
     }
   }
 }
@@ -1414,8 +1428,13 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
       auto input = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
       auto grid = inputs[1]->get_data_pointer<Tcu>(this->ctx_);
       auto ograd = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
-      auto igrad = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+      auto igrad_ptr = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
       auto ggrad = inputs[1]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+      // Each output element adds to 4 (linear) or 1 (nearest) input pixels.
+      ScatterAdder<Tcu> igrad_adder(
+          this->ctx_, igrad_ptr,
+          outputs[0]->size() * (this->mode_ == "linear" ? 4 : 1));
+      auto igrad = igrad_adder.view();
 
       auto oisize = Ci * Ho * Wo;
       auto iisize = Ci * Hi * Wi;
@@ -1602,6 +1621,7 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
           }
         }
       }
+      igrad_adder.finish();
     } else if (ndims == 5) {
       auto B = inputs[0]->shape()[0];
       auto Ci = channel_last ? inputs[0]->shape()[4] : inputs[0]->shape()[1];
@@ -1625,8 +1645,13 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
       auto input = inputs[0]->get_data_pointer<Tcu>(this->ctx_);
       auto grid = inputs[1]->get_data_pointer<Tcu>(this->ctx_);
       auto ograd = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
-      auto igrad = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+      auto igrad_ptr = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
       auto ggrad = inputs[1]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+      // Each output element adds to 8 (linear) or 1 (nearest) input pixels.
+      ScatterAdder<Tcu> igrad_adder(
+          this->ctx_, igrad_ptr,
+          outputs[0]->size() * (this->mode_ == "linear" ? 8 : 1));
+      auto igrad = igrad_adder.view();
 
       auto oisize = Ci * Do * Ho * Wo;
       auto iisize = Ci * Di * Hi * Wi;
@@ -1813,6 +1838,7 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
           }
         }
       }
+      igrad_adder.finish();
     }
 
     // w.r.t. grid
@@ -1841,7 +1867,10 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
         auto grid = inputs[1]->get_data_pointer<Tcu>(this->ctx_);
         auto ograd = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
         auto igrad = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
-        auto ggrad = inputs[1]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+        auto ggrad_ptr = inputs[1]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+        ScatterAdder<Tcu> ggrad_adder(this->ctx_, ggrad_ptr,
+                                      outputs[0]->size() * 2);
+        auto ggrad = ggrad_adder.view();
 
         auto oisize = Ci * Ho * Wo;
         auto iisize = Ci * Hi * Wi;
@@ -1939,6 +1968,7 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
               "Backward wrt the grid is not supported in the nearest mode. "
               "Use the `linear` mode.");
         }
+        ggrad_adder.finish();
       } else if (ndims == 5) {
         auto B = inputs[0]->shape()[0];
         auto Ci = channel_last ? inputs[0]->shape()[4] : inputs[0]->shape()[1];
@@ -1966,7 +1996,10 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
         auto grid = inputs[1]->get_data_pointer<Tcu>(this->ctx_);
         auto ograd = outputs[0]->get_grad_pointer<Tcu>(this->ctx_);
         auto igrad = inputs[0]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
-        auto ggrad = inputs[1]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+        auto ggrad_ptr = inputs[1]->cast_grad_and_get_pointer<Tcu>(this->ctx_);
+        ScatterAdder<Tcu> ggrad_adder(this->ctx_, ggrad_ptr,
+                                      outputs[0]->size() * 3);
+        auto ggrad = ggrad_adder.view();
 
         auto oisize = Ci * Do * Ho * Wo;
         auto iisize = Ci * Di * Hi * Wi;
@@ -2064,6 +2097,7 @@ void WarpByGridCuda<T>::backward_impl(const Variables &inputs,
               "Backward wrt the grid is not supported in the nearest mode. "
               "Use the `linear` mode.");
         }
+        ggrad_adder.finish();
       }
     }
   }
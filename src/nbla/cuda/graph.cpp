@@ -0,0 +1,136 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/cuda.hpp>
+#include <nbla/cuda/cudnn/cudnn.hpp>
+#include <nbla/cuda/graph.hpp>
+#include <nbla/cuda/memory/cuda_memory.hpp>
+
+#include <nbla/memory/caching_allocator_with_buckets.hpp>
+
+namespace nbla {
+
+static thread_local CudaGraph *capturing_graph = nullptr;
+
+/** Point the cuBLAS handle and the null-stream cuDNN handle of this thread
+    at the current stream.
+
+    The getters switch the stream of the handles, so also the handles cached
+    by functions at setup follow the capture and go back afterwards instead
+    of keeping the destroyed capture stream.
+ */
+static void update_handle_streams(int device) {
+  SingletonManager::get<Cuda>()->cublas_handle(device);
+  SingletonManager::get<CudnnHandleManager>()->handle(device);
+}
+
+CudaGraph::CudaGraph(int device)
+    : device_(device < 0 ? cuda_get_device() : device), stream_(0),
+      graph_(nullptr), exec_(nullptr),
+      allocator_(std::make_shared<CachingAllocatorWithBuckets<CudaMemory>>()) {
+  cuda_set_device(device_);
+  // A blocking stream, so that work issued to the null stream during the
+  // capture invalidates it instead of silently running outside the graph.
+  NBLA_CUDA_CHECK(cudaStreamCreate(&stream_));
+}
+
+CudaGraph::~CudaGraph() {
+  // Not checked since it may run at exit after the device is released.
+  if (capturing_graph == this) {
+    discard_capture();
+  }
+  if (exec_) {
+    cudaGraphExecDestroy(exec_);
+  }
+  if (graph_) {
+    cudaGraphDestroy(graph_);
+  }
+  cudaStreamDestroy(stream_);
+}
+
+CudaGraph *CudaGraph::capturing() { return capturing_graph; }
+
+void CudaGraph::begin_capture() {
+  NBLA_CHECK(!capturing_graph, error_code::target_specific,
+             "Another CUDA graph is being captured in this thread.");
+  cuda_set_device(device_);
+  if (exec_) {
+    NBLA_CUDA_CHECK(cudaGraphExecDestroy(exec_));
+    exec_ = nullptr;
+  }
+  if (graph_) {
+    NBLA_CUDA_CHECK(cudaGraphDestroy(graph_));
+    graph_ = nullptr;
+  }
+  // Work issued before the capture is not a part of the graph.
+  NBLA_CUDA_CHECK(cudaStreamSynchronize(0));
+  // Relaxed since memory may be allocated while capturing.
+  NBLA_CUDA_CHECK(
+      cudaStreamBeginCapture(stream_, cudaStreamCaptureModeRelaxed));
+  capturing_graph = this;
+  cuda_set_current_stream(stream_);
+  update_handle_streams(device_);
+}
+
+void CudaGraph::end_capture() {
+  NBLA_CHECK(capturing_graph == this, error_code::target_specific,
+             "The CUDA graph is not being captured in this thread.");
+  capturing_graph = nullptr;
+  cuda_set_current_stream(0);
+  update_handle_streams(device_);
+  const cudaError_t status = cudaStreamEndCapture(stream_, &graph_);
+  if (status != cudaSuccess) {
+    cudaGetLastError(); // Clear the error.
+    graph_ = nullptr;
+    NBLA_ERROR(error_code::target_specific,
+               "CUDA graph capture failed: %s. A function issued work to the "
+               "null stream or synchronized with the host during the capture.",
+               cudaGetErrorString(status));
+  }
+#if CUDA_VERSION >= 12000
+  NBLA_CUDA_CHECK(cudaGraphInstantiate(&exec_, graph_, 0));
+#else
+  NBLA_CUDA_CHECK(cudaGraphInstantiate(&exec_, graph_, nullptr, nullptr, 0));
+#endif
+}
+
+void CudaGraph::replay() {
+  NBLA_CHECK(exec_, error_code::target_specific,
+             "The CUDA graph has not been captured.");
+  NBLA_CHECK(capturing_graph != this, error_code::target_specific,
+             "The CUDA graph is being captured.");
+  cuda_set_device(device_);
+  NBLA_CUDA_CHECK(cudaGraphLaunch(exec_, 0));
+}
+
+void CudaGraph::discard_capture() {
+  if (capturing_graph != this) {
+    return;
+  }
+  capturing_graph = nullptr;
+  cuda_set_current_stream(0);
+  cudaGraph_t graph = nullptr;
+  cudaStreamEndCapture(stream_, &graph);
+  if (graph) {
+    cudaGraphDestroy(graph);
+  }
+  cudaGetLastError();
+  try {
+    update_handle_streams(device_);
+  } catch (...) {
+    // Also called from the destructor, which must not throw.
+  }
+}
+}
@@ -0,0 +1,194 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/launch.hpp>
+#include <nbla/singleton_manager-internal.hpp>
+
+#include <cstdlib>
+#include <sstream>
+
+namespace nbla {
+
+/** Kernel expression without the enclosing parentheses and spaces. */
+static string kernel_name(const string &name) {
+  size_t begin = name.find_first_not_of(" \t");
+  size_t end = name.find_last_not_of(" \t");
+  if (begin == string::npos) {
+    return "";
+  }
+  while (begin < end && name[begin] == '(' && name[end] == ')') {
+    begin = name.find_first_not_of(" \t", begin + 1);
+    end = name.find_last_not_of(" \t", end - 1);
+    if (begin == string::npos) {
+      return "";
+    }
+  }
+  return name.substr(begin, end - begin + 1);
+}
+
+/** Entries of an override list split at the commas outside of angle
+    brackets and parentheses.
+ */
+static std::vector<string> split_overrides(const string &overrides) {
+  std::vector<string> entries;
+  string entry;
+  int depth = 0;
+  for (const char c : overrides) {
+    if (c == '<' || c == '(') {
+      depth++;
+    } else if ((c == '>' || c == ')') && depth > 0) {
+      depth--;
+    } else if (c == ',' && depth == 0) {
+      entries.push_back(entry);
+      entry.clear();
+      continue;
+    }
+    entry += c;
+  }
+  entries.push_back(entry);
+  return entries;
+}
+
+std::atomic<uint64_t> CudaLaunchConfigCache::generation_{1};
+
+CudaLaunchConfigCache::CudaLaunchConfigCache() { read_overrides_from_env(); }
+
+CudaLaunchConfigCache::~CudaLaunchConfigCache() {}
+
+void CudaLaunchConfigCache::read_overrides_from_env() {
+  const char *e = std::getenv("NNABLA_CUDA_LAUNCH_OVERRIDES");
+  if (e) {
+    set_overrides(e);
+  }
+}
+
+void CudaLaunchConfigCache::set_overrides(const string &overrides) {
+  for (const auto &entry : split_overrides(overrides)) {
+    if (entry.find_first_not_of(" \t") == string::npos) {
+      continue;
+    }
+    const size_t eq = entry.rfind('=');
+    std::stringstream values(eq == string::npos ? "" : entry.substr(eq + 1));
+    int threads = 0, blocks_per_sm = 0;
+    char colon = ':';
+    NBLA_CHECK(values >> threads &&
+                   (values.eof() || (values >> colon >> blocks_per_sm &&
+                                     colon == ':' && values.eof())),
+               error_code::value,
+               "Invalid entry: %s in NNABLA_CUDA_LAUNCH_OVERRIDES. "
+               "name=threads or name=threads:blocks_per_sm required.",
+               entry.c_str());
+    set_override(entry.substr(0, eq), threads, blocks_per_sm);
+  }
+}
+
+std::pair<int, int> CudaLaunchConfigCache::get_override(const string &name) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = overrides_.find(kernel_name(name));
+  return it != overrides_.end() ? it->second : std::make_pair(0, 0);
+}
+
+CudaLaunchConfig CudaLaunchConfigCache::get(const void *kernel,
+                                            const char *name) {
+  const int device = cuda_get_device();
+  std::lock_guard<std::mutex> lock(mtx_);
+  const auto key = std::make_pair(kernel, device);
+  auto it = configs_.find(key);
+  if (it != configs_.end()) {
+    return it->second;
+  }
+  CudaLaunchConfig config;
+  int min_grid_size;
+  NBLA_CUDA_CHECK(cudaOccupancyMaxPotentialBlockSize(&min_grid_size,
+                                                     &config.threads, kernel));
+  config.blocks_per_sm = 0;
+  auto o = overrides_.find(kernel_name(name));
+  if (o != overrides_.end()) {
+    cudaFuncAttributes attr;
+    NBLA_CUDA_CHECK(cudaFuncGetAttributes(&attr, kernel));
+    NBLA_CHECK(o->second.first <= attr.maxThreadsPerBlock, error_code::value,
+               "Override of %s: %d threads exceeds the limit %d of the "
+               "kernel.",
+               o->first.c_str(), o->second.first, attr.maxThreadsPerBlock);
+    config.threads = o->second.first;
+    config.blocks_per_sm = o->second.second;
+  }
+  if (config.blocks_per_sm <= 0) {
+    NBLA_CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+        &config.blocks_per_sm, kernel, config.threads, 0));
+    config.blocks_per_sm = std::max(config.blocks_per_sm, 1);
+  }
+  NBLA_CUDA_CHECK(cudaDeviceGetAttribute(
+      &config.multiprocessors, cudaDevAttrMultiProcessorCount, device));
+  configs_[key] = config;
+  return config;
+}
+
+void CudaLaunchConfigCache::set_override(const string &name, int threads,
+                                         int blocks_per_sm) {
+  NBLA_CHECK(threads > 0 && threads % CUDA_WARP_SIZE == 0, error_code::value,
+             "Override of %s: threads must be a positive multiple of %d. "
+             "Given %d.",
+             name.c_str(), CUDA_WARP_SIZE, threads);
+  std::lock_guard<std::mutex> lock(mtx_);
+  overrides_[kernel_name(name)] = std::make_pair(threads, blocks_per_sm);
+  // Computed again with the override.
+  configs_.clear();
+  generation_++;
+}
+
+void CudaLaunchConfigCache::clear_overrides() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  overrides_.clear();
+  configs_.clear();
+  generation_++;
+}
+
+void CudaLaunchConfigCache::clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  configs_.clear();
+  generation_++;
+}
+
+NBLA_INSTANTIATE_SINGLETON(NBLA_CUDA_API, CudaLaunchConfigCache);
+
+const CudaLaunchConfig &CudaLaunchSite::get(const void *kernel,
+                                            const char *name) {
+  const int device = cuda_get_device();
+  if (device >= static_cast<int>(entries_.size())) {
+    entries_.resize(device + 1);
+  }
+  Entry &entry = entries_[device];
+  const uint64_t generation = CudaLaunchConfigCache::generation();
+  if (entry.generation != generation) {
+    // The generation is read first, so a change in the meantime only makes
+    // the next launch look up again.
+    entry.config =
+        SingletonManager::get<CudaLaunchConfigCache>()->get(kernel, name);
+    entry.generation = generation;
+  }
+  return entry.config;
+}
+
+void cuda_set_launch_override(const string &name, int threads,
+                              int blocks_per_sm) {
+  SingletonManager::get<CudaLaunchConfigCache>()->set_override(
+      name, threads, blocks_per_sm);
+}
+
+void cuda_clear_launch_overrides() {
+  SingletonManager::get<CudaLaunchConfigCache>()->clear_overrides();
+}
+}
@@ -0,0 +1,292 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/profiler.hpp>
+#include <nbla/singleton_manager-internal.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace nbla {
+
+// Always counted. The profiler takes the difference around a call.
+static thread_local size_t launch_count = 0;
+static thread_local size_t allocated_bytes = 0;
+static thread_local size_t workspace_bytes = 0;
+
+void cuda_profiler_count_launch() { launch_count++; }
+
+void cuda_profiler_count_allocation(size_t bytes, bool workspace) {
+  allocated_bytes += bytes;
+  if (workspace) {
+    workspace_bytes += bytes;
+  }
+}
+
+CudaProfiler::CudaProfiler()
+    : enabled_(false), sampling_interval_(1), capacity_(65536) {}
+
+CudaProfiler::~CudaProfiler() {
+  // Not checked since it may run at exit after the device is released.
+  for (auto &p : pending_) {
+    cudaEventDestroy(p.start);
+    cudaEventDestroy(p.stop);
+  }
+  for (auto &r : running_) {
+    cudaEventDestroy(r.second.start);
+  }
+  for (auto &origin : origins_) {
+    cudaEventDestroy(origin.second);
+  }
+  for (auto &device_events : free_events_) {
+    for (auto event : device_events.second) {
+      cudaEventDestroy(event);
+    }
+  }
+}
+
+void CudaProfiler::enable(bool enabled) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  enabled_ = enabled;
+}
+
+bool CudaProfiler::enabled() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return enabled_;
+}
+
+void CudaProfiler::set_sampling_interval(int interval) {
+  NBLA_CHECK(interval > 0, error_code::value,
+             "Sampling interval must be positive. Given %d.", interval);
+  std::lock_guard<std::mutex> lock(mtx_);
+  sampling_interval_ = interval;
+}
+
+void CudaProfiler::set_capacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  capacity_ = capacity;
+  while (records_.size() > capacity_) {
+    records_.pop_front();
+  }
+}
+
+cudaEvent_t CudaProfiler::get_event(int device) {
+  auto &events = free_events_[device];
+  if (events.empty()) {
+    cudaEvent_t event;
+    NBLA_CUDA_CHECK(cudaEventCreate(&event));
+    return event;
+  }
+  cudaEvent_t event = events.back();
+  events.pop_back();
+  return event;
+}
+
+void CudaProfiler::release_event(int device, cudaEvent_t event) {
+  free_events_[device].push_back(event);
+}
+
+void CudaProfiler::begin(const string &name, uint64_t key) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (!enabled_ || calls_[key]++ % sampling_interval_) {
+    return;
+  }
+  const int device = cuda_get_device();
+  const cudaStream_t stream = cuda_get_current_stream();
+  cudaEvent_t &origin = origins_[device];
+  if (!origin) {
+    origin = get_event(device);
+    NBLA_CUDA_CHECK(cudaEventRecord(origin, stream));
+  }
+  auto it = running_.find(key);
+  if (it != running_.end()) {
+    // end() was not called for the previous call.
+    release_event(it->second.record.device, it->second.start);
+    running_.erase(it);
+  }
+  Pending p;
+  p.record = CudaProfileRecord{name, key, device, 0, 0, 0, 0, 0};
+  p.start = get_event(device);
+  p.stop = nullptr;
+  p.launches = launch_count;
+  p.allocated_bytes = allocated_bytes;
+  p.workspace_bytes = workspace_bytes;
+  NBLA_CUDA_CHECK(cudaEventRecord(p.start, stream));
+  running_[key] = p;
+}
+
+void CudaProfiler::end(uint64_t key) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = running_.find(key);
+  if (it == running_.end()) {
+    // Not sampled.
+    return;
+  }
+  Pending p = it->second;
+  running_.erase(it);
+  p.record.launches = launch_count - p.launches;
+  p.record.allocated_bytes = allocated_bytes - p.allocated_bytes;
+  p.record.workspace_bytes = workspace_bytes - p.workspace_bytes;
+  p.stop = get_event(p.record.device);
+  NBLA_CUDA_CHECK(cudaEventRecord(p.stop, cuda_get_current_stream()));
+  pending_.push_back(p);
+  // Wait only if the GPU is too far behind to keep the events bounded.
+  flush(pending_.size() > std::max<size_t>(capacity_, 1));
+}
+
+void CudaProfiler::flush(bool wait) {
+  while (!pending_.empty()) {
+    Pending &p = pending_.front();
+    if (wait) {
+      NBLA_CUDA_CHECK(cudaEventSynchronize(p.stop));
+    } else {
+      const cudaError_t status = cudaEventQuery(p.stop);
+      if (status == cudaErrorNotReady) {
+        break;
+      }
+      NBLA_CUDA_CHECK(status);
+    }
+    const int device = p.record.device;
+    float start_ms, elapsed_ms;
+    NBLA_CUDA_CHECK(
+        cudaEventElapsedTime(&start_ms, origins_[device], p.start));
+    NBLA_CUDA_CHECK(cudaEventElapsedTime(&elapsed_ms, p.start, p.stop));
+    p.record.start_ms = start_ms;
+    p.record.elapsed_ms = elapsed_ms;
+    release_event(device, p.start);
+    release_event(device, p.stop);
+    if (capacity_ > 0) {
+      if (records_.size() >= capacity_) {
+        records_.pop_front();
+      }
+      records_.push_back(p.record);
+    }
+    pending_.pop_front();
+  }
+}
+
+vector<CudaProfileRecord> CudaProfiler::records() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  flush(true);
+  return vector<CudaProfileRecord>(records_.begin(), records_.end());
+}
+
+void CudaProfiler::clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  flush(true);
+  records_.clear();
+  calls_.clear();
+  for (auto &r : running_) {
+    release_event(r.second.record.device, r.second.start);
+  }
+  running_.clear();
+  // Times of new records start from the next call.
+  for (auto &origin : origins_) {
+    release_event(origin.first, origin.second);
+  }
+  origins_.clear();
+}
+
+static string json_string(const string &s) {
+  std::stringstream ss;
+  ss << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      ss << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+         << static_cast<int>(c) << std::dec;
+    } else {
+      ss << c;
+    }
+  }
+  ss << '"';
+  return ss.str();
+}
+
+static void write_counters(std::stringstream &ss, const CudaProfileRecord &r) {
+  ss << "\"launches\": " << r.launches
+     << ", \"allocated_bytes\": " << r.allocated_bytes
+     << ", \"workspace_bytes\": " << r.workspace_bytes;
+}
+
+string CudaProfiler::to_json() {
+  auto rs = records();
+  std::stringstream ss;
+  ss << std::setprecision(9) << "[";
+  for (size_t i = 0; i < rs.size(); i++) {
+    const auto &r = rs[i];
+    ss << (i ? ",\n " : "") << "{\"name\": " << json_string(r.name)
+       << ", \"key\": " << r.key << ", \"device\": " << r.device
+       << ", \"start_ms\": " << r.start_ms
+       << ", \"elapsed_ms\": " << r.elapsed_ms << ", ";
+    write_counters(ss, r);
+    ss << "}";
+  }
+  ss << "]";
+  return ss.str();
+}
+
+string CudaProfiler::to_chrome_trace() {
+  auto rs = records();
+  std::stringstream ss;
+  ss << std::setprecision(12) << "{\"traceEvents\": [";
+  for (size_t i = 0; i < rs.size(); i++) {
+    const auto &r = rs[i];
+    // Complete events in microseconds, one process per device.
+    ss << (i ? ",\n " : "") << "{\"name\": " << json_string(r.name)
+       << ", \"cat\": \"cuda\", \"ph\": \"X\", \"ts\": " << r.start_ms * 1000
+       << ", \"dur\": " << r.elapsed_ms * 1000 << ", \"pid\": " << r.device
+       << ", \"tid\": 0, \"args\": {\"key\": " << r.key << ", ";
+    write_counters(ss, r);
+    ss << "}}";
+  }
+  ss << "], \"displayTimeUnit\": \"ms\"}";
+  return ss.str();
+}
+
+NBLA_INSTANTIATE_SINGLETON(NBLA_CUDA_API, CudaProfiler);
+
+void cuda_profiler_enable(bool enabled) {
+  SingletonManager::get<CudaProfiler>()->enable(enabled);
+}
+
+void cuda_profiler_set_sampling_interval(int interval) {
+  SingletonManager::get<CudaProfiler>()->set_sampling_interval(interval);
+}
+
+void cuda_profiler_set_capacity(size_t capacity) {
+  SingletonManager::get<CudaProfiler>()->set_capacity(capacity);
+}
+
+void cuda_profiler_begin(const string &name, uint64_t key) {
+  SingletonManager::get<CudaProfiler>()->begin(name, key);
+}
+
+void cuda_profiler_end(uint64_t key) {
+  SingletonManager::get<CudaProfiler>()->end(key);
+}
+
+void cuda_profiler_clear() { SingletonManager::get<CudaProfiler>()->clear(); }
+
+string cuda_profiler_to_json() {
+  return SingletonManager::get<CudaProfiler>()->to_json();
+}
+
+string cuda_profiler_to_chrome_trace() {
+  return SingletonManager::get<CudaProfiler>()->to_chrome_trace();
+}
+}
@@ -21,13 +21,13 @@
 
 namespace nbla {
 
-template <typename T>
+template <typename T, typename index_t>
 __global__ void kernel_adabelief_update(
-    const int num, T *theta, T *m, T *s, T *s_max, const T *g,
+    const index_t num, T *theta, T *m, T *s, T *s_max, const T *g,
     const float alpha_t, const float beta1, const float beta2, const float eps,
     const float decay_ratio, const bool amsgrad, const bool weight_decouple,
     const bool sgd_update, const float bias_correction2) {
-  NBLA_CUDA_KERNEL_LOOP(i, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(i, num, index_t) {
     // Updating running mean and var.
     m[i] = beta1 * m[i] + (1 - beta1) * g[i];
     s[i] = beta2 * s[i] + (1 - beta2) * (g[i] - m[i]) * (g[i] - m[i]);
@@ -89,10 +89,10 @@ void AdaBeliefCuda<T>::update_impl(const string &key, VariablePtr param) {
       sgd_update ? this->alpha_ : this->alpha_ * r_t / bias_correction1;
   const float decay_ratio =
       (this->fixed_decay_) ? this->wd_ : this->wd_ * this->alpha_;
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
-      kernel_adabelief_update, size, theta, m, s, s_max, g, alpha_t,
-      this->beta1_, this->beta2_, this->eps_, decay_ratio, this->amsgrad_,
-      this->weight_decouple_, sgd_update, bias_correction2);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_adabelief_update<T, index_t>), size, theta, m, s, s_max, g,
+      alpha_t, this->beta1_, this->beta2_, this->eps_, decay_ratio,
+      this->amsgrad_, this->weight_decouple_, sgd_update, bias_correction2);
 }
 NBLA_DEF_WEIGHT_DECAY(AdaBeliefCuda, weight_decay_cuda);
 NBLA_DEF_CLIP_GRAD_BY_NORM(AdaBeliefCuda, clip_grad_by_norm_cuda);
@@ -21,13 +21,13 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_adabound_update(const int num, T *theta, T *m, T *v,
+template <typename T, typename index_t>
+__global__ void kernel_adabound_update(const index_t num, T *theta, T *m, T *v,
                                        const T *g, float alpha_t,
                                        const float beta1, const float beta2,
                                        const float eps, const float final_lr,
                                        const float gamma) {
-  NBLA_CUDA_KERNEL_LOOP(s, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(s, num, index_t) {
     // Updating running mean and var.
     m[s] = beta1 * m[s] + (1 - beta1) * g[s];
     v[s] = beta2 * v[s] + (1 - beta2) * g[s] * g[s];
@@ -58,9 +58,9 @@ void AdaBoundCuda<T>::update_impl(const string &key, VariablePtr param) {
                             (1 - std::pow(this->beta1_, t));
   T alpha_t = this->alpha_ * bias_correction;
   T final_lr = this->final_lr_ * (this->alpha_ / this->init_alpha_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_adabound_update, size, theta, m, v, g,
-                                 alpha_t, this->beta1_, this->beta2_,
-                                 this->eps_, final_lr, this->gamma_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_adabound_update<T, index_t>), size, theta, m, v, g, alpha_t,
+      this->beta1_, this->beta2_, this->eps_, final_lr, this->gamma_);
 }
 NBLA_DEF_WEIGHT_DECAY(AdaBoundCuda, weight_decay_cuda);
 NBLA_DEF_CLIP_GRAD_BY_NORM(AdaBoundCuda, clip_grad_by_norm_cuda);
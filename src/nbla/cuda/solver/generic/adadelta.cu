@@ -21,12 +21,12 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_adadelta_update(const int num, T *data, const T *grad,
-                                       T *e_sqr_grad, T *e_sqr_delta,
-                                       const float lr, const float decay,
-                                       const float eps) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
+template <typename T, typename index_t>
+__global__ void kernel_adadelta_update(const index_t num, T *data,
+                                       const T *grad, T *e_sqr_grad,
+                                       T *e_sqr_delta, const float lr,
+                                       const float decay, const float eps) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
     e_sqr_grad[idx] =
         e_sqr_grad[idx] * decay + grad[idx] * grad[idx] * (1 - decay);
     T delta =
@@ -46,9 +46,9 @@ void AdadeltaCuda<T>::update_impl(const string &key, VariablePtr param) {
   T *e_sqr_delta = e2->cast_data_and_get_pointer<T>(this->ctx_);
   const T *grad = param->get_grad_pointer<T>(this->ctx_);
   T *data = param->cast_data_and_get_pointer<T>(this->ctx_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_adadelta_update, size, data, grad,
-                                 e_sqr_grad, e_sqr_delta, this->lr_,
-                                 this->decay_, this->eps_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_adadelta_update<T, index_t>), size, data, grad, e_sqr_grad,
+      e_sqr_delta, this->lr_, this->decay_, this->eps_);
   auto &t = state.t;
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
 }
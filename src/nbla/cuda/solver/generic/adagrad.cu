@@ -21,10 +21,10 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_adagrad_update(const int num, T *data, const T *grad,
+template <typename T, typename index_t>
+__global__ void kernel_adagrad_update(const index_t num, T *data, const T *grad,
                                       T *g, const float lr, const float eps) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
     g[idx] += grad[idx] * grad[idx];
     data[idx] -= lr * grad[idx] / (sqrt(g[idx]) + eps);
   }
@@ -40,8 +40,9 @@ void AdagradCuda<T>::update_impl(const string &key, VariablePtr param) {
   const T *grad = param->get_grad_pointer<T>(this->ctx_);
   T *data = param->cast_data_and_get_pointer<T>(this->ctx_);
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_adagrad_update, size, data, grad, g,
-                                 this->lr_, this->eps_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_adagrad_update<T, index_t>),
+                                         size, data, grad, g, this->lr_,
+                                         this->eps_);
 }
 
 NBLA_DEF_WEIGHT_DECAY(AdagradCuda, weight_decay_cuda);
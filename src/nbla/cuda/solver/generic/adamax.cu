@@ -21,12 +21,12 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_adamax_update(const int num, T *theta, T *m, T *u,
+template <typename T, typename index_t>
+__global__ void kernel_adamax_update(const index_t num, T *theta, T *m, T *u,
                                      const T *g, const float alpha_t,
                                      const float beta1, const float beta2,
                                      const float eps) {
-  NBLA_CUDA_KERNEL_LOOP(s, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(s, num, index_t) {
     // Updating running mean and var.
     m[s] = beta1 * m[s] + (1 - beta1) * g[s];
     u[s] = max(beta2 * u[s], abs(g[s]));
@@ -49,9 +49,9 @@ void AdamaxCuda<T>::update_impl(const string &key, VariablePtr param) {
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
   const T bias_correction = 1 / (1 - std::pow(this->beta1_, t));
   const T alpha_t = this->alpha_ * bias_correction;
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_adamax_update, size, theta, m, u, g,
-                                 alpha_t, this->beta1_, this->beta2_,
-                                 this->eps_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_adamax_update<T, index_t>), size, theta, m, u, g, alpha_t,
+      this->beta1_, this->beta2_, this->eps_);
 }
 NBLA_DEF_WEIGHT_DECAY(AdamaxCuda, weight_decay_cuda);
 NBLA_DEF_CLIP_GRAD_BY_NORM(AdamaxCuda, clip_grad_by_norm_cuda);
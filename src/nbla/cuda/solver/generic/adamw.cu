@@ -21,12 +21,12 @@
 
 namespace nbla {
 
-template <typename T>
+template <typename T, typename index_t>
 __global__ void
-kernel_adamw_update(const int num, T *theta, T *m, T *v, const T *g,
+kernel_adamw_update(const index_t num, T *theta, T *m, T *v, const T *g,
                     const float alpha_t, const float beta1, const float beta2,
                     const float eps, const float wd, const T eta_t) {
-  NBLA_CUDA_KERNEL_LOOP(s, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(s, num, index_t) {
     // Updating running mean and var.
     m[s] = beta1 * m[s] + (1 - beta1) * g[s];
     v[s] = beta2 * v[s] + (1 - beta2) * g[s] * g[s];
@@ -54,9 +54,9 @@ void AdamWCuda<T>::update_impl(const string &key, VariablePtr param) {
   const T bias_correction = std::sqrt(1 - std::pow(this->beta2_, t)) /
                             (1 - std::pow(this->beta1_, t));
   const T alpha_t = this->alpha_ * bias_correction;
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_adamw_update, size, theta, m, v, g,
-                                 alpha_t, this->beta1_, this->beta2_,
-                                 this->eps_, this->wd_, eta_t);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_adamw_update<T, index_t>), size, theta, m, v, g, alpha_t,
+      this->beta1_, this->beta2_, this->eps_, this->wd_, eta_t);
 }
 
 template <typename T>
@@ -21,12 +21,12 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_amsgrad_update(const int num, T *theta, T *m, T *v,
+template <typename T, typename index_t>
+__global__ void kernel_amsgrad_update(const index_t num, T *theta, T *m, T *v,
                                       T *v_hat, const T *g, const float alpha_t,
                                       const float beta1, const float beta2,
                                       const float eps) {
-  NBLA_CUDA_KERNEL_LOOP(s, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(s, num, index_t) {
     // Updating running mean and var.
     m[s] = beta1 * m[s] + (1 - beta1) * g[s];
     v[s] = beta2 * v[s] + (1 - beta2) * g[s] * g[s];
@@ -56,9 +56,9 @@ void AMSGRADCuda<T>::update_impl(const string &key, VariablePtr param) {
                             (1 - std::pow(this->beta1_, t));
   const T alpha_t =
       this->alpha_ * (this->bias_correction_ ? bias_correction : 1);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_amsgrad_update, size, theta, m, v,
-                                 v_hat, g, alpha_t, this->beta1_, this->beta2_,
-                                 this->eps_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_amsgrad_update<T, index_t>), size, theta, m, v, v_hat, g, alpha_t,
+      this->beta1_, this->beta2_, this->eps_);
 }
 NBLA_DEF_WEIGHT_DECAY(AMSGRADCuda, weight_decay_cuda);
 NBLA_DEF_CLIP_GRAD_BY_NORM(AMSGRADCuda, clip_grad_by_norm_cuda);
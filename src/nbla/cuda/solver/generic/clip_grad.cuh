@@ -21,14 +21,17 @@
 #include <nbla/variable.hpp>
 
 namespace nbla {
-template <typename T>
-__global__ void kernel_clip_grad_by_norm(const int num, T *grad, const T *l2sum,
+template <typename T, typename index_t>
+__global__ void kernel_clip_grad_by_norm(const index_t num, T *grad,
+                                         const T *l2sum,
                                          const float clip_norm) {
   // to avoid zero division
   if (*l2sum == 0.0 || *l2sum <= clip_norm * clip_norm)
     return;
   const float norm = sqrtf(*l2sum);
-  NBLA_CUDA_KERNEL_LOOP(idx, num) { grad[idx] = clip_norm * grad[idx] / norm; }
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
+    grad[idx] = clip_norm * grad[idx] / norm;
+  }
 }
 
 template <typename T>
@@ -56,8 +59,8 @@ void clip_grad_by_norm_cuda(const Context &ctx,
   const T *l2sum = sum.get_data_pointer<T>(ctx);
   T *grad = param->cast_grad_and_get_pointer<T>(ctx);
   Size_t size = param->size();
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_clip_grad_by_norm, size, grad, l2sum,
-                                 clip_norm);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_clip_grad_by_norm<T, index_t>), size, grad, l2sum, clip_norm);
 }
 }
 #endif
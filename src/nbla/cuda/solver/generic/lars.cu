@@ -131,7 +131,8 @@ void LarsCuda<T>::update_impl(const string &key, VariablePtr param) {
   const Tc *grad = param->get_grad_pointer<Tc>(this->ctx_);
 
   /* calculate squared sum */
-  sq_sum(nullptr, size, data, d_buff, d_sq, grad, g_buff, g_sq);
+  sq_sum(cuda_get_current_stream(), size, data, d_buff, d_sq, grad, g_buff,
+         g_sq);
 
   NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(
       kernel_lars_update, size, data, grad, v, d_sq, g_sq, this->lr_,
@@ -37,13 +37,15 @@ template <typename T> struct check_inf_or_nan {
   }
 };
 
-template <typename T>
-__global__ void kernel_scale_grad_impl(const int num, float scale, T *grad) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) { grad[idx] *= scale; }
+template <typename T, typename index_t>
+__global__ void kernel_scale_grad_impl(const index_t num, float scale,
+                                       T *grad) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) { grad[idx] *= scale; }
 }
 
 template <typename T>
 bool check_inf_grad_cuda(const Context &ctx, const shared_ptr<Variable> param) {
+  cuda_check_not_capturing("check_inf_grad_cuda");
   cuda_set_device(std::stoi(ctx.device_id));
   Size_t size = param->size();
   T *grad = param->cast_grad_and_get_pointer<T>(ctx);
@@ -56,6 +58,7 @@ bool check_inf_grad_cuda(const Context &ctx, const shared_ptr<Variable> param) {
 
 template <typename T>
 bool check_nan_grad_cuda(const Context &ctx, const shared_ptr<Variable> param) {
+  cuda_check_not_capturing("check_nan_grad_cuda");
   cuda_set_device(std::stoi(ctx.device_id));
   Size_t size = param->size();
   T *grad = param->cast_grad_and_get_pointer<T>(ctx);
@@ -69,6 +72,7 @@ bool check_nan_grad_cuda(const Context &ctx, const shared_ptr<Variable> param) {
 template <typename T>
 bool check_inf_or_nan_grad_cuda(const Context &ctx,
                                 const shared_ptr<Variable> param) {
+  cuda_check_not_capturing("check_inf_or_nan_grad_cuda");
   cuda_set_device(std::stoi(ctx.device_id));
   Size_t size = param->size();
   T *grad = param->cast_grad_and_get_pointer<T>(ctx);
@@ -85,7 +89,8 @@ void scale_grad_impl_cuda(const Context &ctx, const shared_ptr<Variable> param,
   cuda_set_device(std::stoi(ctx.device_id));
   Size_t size = param->size();
   T *grad = param->cast_grad_and_get_pointer<T>(ctx);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_scale_grad_impl, size, scale, grad);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_scale_grad_impl<T, index_t>),
+                                         size, scale, grad);
 }
 }
 #endif
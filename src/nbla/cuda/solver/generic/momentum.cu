@@ -21,11 +21,11 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_momentum_update(const int num, T *data, const T *grad,
-                                       T *v, const float lr,
+template <typename T, typename index_t>
+__global__ void kernel_momentum_update(const index_t num, T *data,
+                                       const T *grad, T *v, const float lr,
                                        const float momentum) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
     v[idx] = momentum * v[idx] + lr * grad[idx];
     data[idx] -= v[idx];
   }
@@ -40,8 +40,9 @@ void MomentumCuda<T>::update_impl(const string &key, VariablePtr param) {
   const T *grad = param->get_grad_pointer<T>(this->ctx_);
   T *v = r_->cast_data_and_get_pointer<T>(this->ctx_);
   T *data = param->cast_data_and_get_pointer<T>(this->ctx_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_momentum_update, size, data, grad, v,
-                                 this->lr_, this->momentum_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_momentum_update<T, index_t>),
+                                         size, data, grad, v, this->lr_,
+                                         this->momentum_);
   auto &t = state.t;
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
 }
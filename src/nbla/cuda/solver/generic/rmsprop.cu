@@ -21,11 +21,11 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_rmsprop_update(const int num, T *data, const T *grad,
+template <typename T, typename index_t>
+__global__ void kernel_rmsprop_update(const index_t num, T *data, const T *grad,
                                       T *e_sqr_grad, const float lr,
                                       const float decay, const float eps) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
     e_sqr_grad[idx] =
         e_sqr_grad[idx] * decay + grad[idx] * grad[idx] * (1 - decay);
     data[idx] -= lr * grad[idx] / (sqrt(e_sqr_grad[idx]) + eps);
@@ -40,9 +40,9 @@ void RMSpropCuda<T>::update_impl(const string &key, VariablePtr param) {
   T *e_sqr_grad = v->cast_data_and_get_pointer<T>(this->ctx_);
   const T *grad = param->get_grad_pointer<T>(this->ctx_);
   T *data = param->cast_data_and_get_pointer<T>(this->ctx_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_rmsprop_update, size, data, grad,
-                                 e_sqr_grad, this->lr_, this->decay_,
-                                 this->eps_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_rmsprop_update<T, index_t>),
+                                         size, data, grad, e_sqr_grad,
+                                         this->lr_, this->decay_, this->eps_);
   auto &t = state.t;
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
 }
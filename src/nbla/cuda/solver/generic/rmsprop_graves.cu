@@ -21,12 +21,12 @@
 
 namespace nbla {
 
-template <typename T>
+template <typename T, typename index_t>
 __global__ void
-kernel_rmsprop_graves_update(const int num, T *data, const T *grad, T *n, T *g,
-                             T *d, const float lr, const float decay,
+kernel_rmsprop_graves_update(const index_t num, T *data, const T *grad, T *n,
+                             T *g, T *d, const float lr, const float decay,
                              const float momentum, const float eps) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) {
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
     n[idx] = decay * n[idx] + (1 - decay) * grad[idx] * grad[idx];
     g[idx] = decay * g[idx] + (1 - decay) * grad[idx];
     d[idx] = (momentum)*d[idx] -
@@ -47,9 +47,9 @@ void RMSpropGravesCuda<T>::update_impl(const string &key, VariablePtr param) {
   T *d = s3->cast_data_and_get_pointer<T>(this->ctx_);
   const T *grad = param->get_grad_pointer<T>(this->ctx_);
   T *data = param->cast_data_and_get_pointer<T>(this->ctx_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_rmsprop_graves_update, size, data, grad,
-                                 n, g, d, this->lr_, this->decay_,
-                                 this->momentum_, this->eps_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX(
+      (kernel_rmsprop_graves_update<T, index_t>), size, data, grad, n, g, d,
+      this->lr_, this->decay_, this->momentum_, this->eps_);
   auto &t = state.t;
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
 }
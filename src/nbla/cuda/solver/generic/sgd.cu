@@ -21,10 +21,12 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_update(const int num, T *data, const T *grad,
+template <typename T, typename index_t>
+__global__ void kernel_update(const index_t num, T *data, const T *grad,
                               const float lr) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) { data[idx] -= lr * grad[idx]; }
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
+    data[idx] -= lr * grad[idx];
+  }
 }
 
 template <typename T>
@@ -33,7 +35,8 @@ void SgdCuda<T>::update_impl(const string &key, VariablePtr param) {
   Size_t size = param->size();
   const T *grad = param->get_grad_pointer<T>(this->ctx_);
   T *data = param->cast_data_and_get_pointer<T>(this->ctx_);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_update, size, data, grad, this->lr_);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_update<T, index_t>), size,
+                                         data, grad, this->lr_);
   auto &state = this->states_.at(key);
   auto &t = state.t;
   t = std::min(t + 1, std::numeric_limits<uint32_t>::max() - 1);
@@ -20,10 +20,12 @@
 
 namespace nbla {
 
-template <typename T>
-__global__ void kernel_weight_decay(const int num, T *grad, const T *data,
+template <typename T, typename index_t>
+__global__ void kernel_weight_decay(const index_t num, T *grad, const T *data,
                                     const float decay_rate) {
-  NBLA_CUDA_KERNEL_LOOP(idx, num) { grad[idx] += decay_rate * data[idx]; }
+  NBLA_CUDA_KERNEL_LOOP_INDEX(idx, num, index_t) {
+    grad[idx] += decay_rate * data[idx];
+  }
 }
 
 template <typename T>
@@ -33,8 +35,8 @@ void weight_decay_cuda(const Context &ctx, const shared_ptr<Variable> param,
   Size_t size = param->size();
   const T *data = param->get_data_pointer<T>(ctx);
   T *grad = param->cast_grad_and_get_pointer<T>(ctx);
-  NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_weight_decay, size, grad, data,
-                                 decay_rate);
+  NBLA_CUDA_LAUNCH_KERNEL_DISPATCH_INDEX((kernel_weight_decay<T, index_t>),
+                                         size, grad, data, decay_rate);
 }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bfloat16_kernel.cuh"
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/math.hpp>
+#include <nbla/cuda/utils/atomic_add.cuh>
+
+#include <vector>
+
+namespace nbla {
+
+#if NBLA_CUDA_BFLOAT16
+namespace {
+
+// Device copy of a host float array in bfloat16.
+BFloat16Cuda *to_device(const float *x, int size) {
+  std::vector<BFloat16Cuda> h(x, x + size);
+  BFloat16Cuda *d;
+  NBLA_CUDA_CHECK(cudaMalloc(&d, sizeof(BFloat16Cuda) * size));
+  NBLA_CUDA_CHECK(cudaMemcpy(d, h.data(), sizeof(BFloat16Cuda) * size,
+                             cudaMemcpyHostToDevice));
+  return d;
+}
+
+// Copy back to the host and free the device array.
+void to_host(BFloat16Cuda *d, int size, float *x) {
+  std::vector<BFloat16Cuda> h(size);
+  NBLA_CUDA_CHECK(cudaMemcpy(h.data(), d, sizeof(BFloat16Cuda) * size,
+                             cudaMemcpyDeviceToHost));
+  NBLA_CUDA_CHECK(cudaFree(d));
+  for (int i = 0; i < size; i++)
+    x[i] = h[i];
+}
+
+template <bool CAS>
+__global__ void kernel_atomic_add(const int n, const BFloat16Cuda *values,
+                                  const int dst_size, BFloat16Cuda *dst) {
+  NBLA_CUDA_KERNEL_LOOP(i, n) {
+    if (CAS)
+      atomic_add_cas(dst + i % dst_size, values[i]);
+    else
+      atomic_add(dst + i % dst_size, values[i]);
+  }
+}
+}
+
+bool bfloat16_available() { return true; }
+
+void bfloat16_gemm(int device, float *z, const float *x, int row_x, int col_x,
+                   bool transpose_x, const float *y, int row_y, int col_y,
+                   bool transpose_y) {
+  const int row_z = transpose_x ? col_x : row_x;
+  const int col_z = transpose_y ? row_y : col_y;
+  auto d_x = to_device(x, row_x * col_x);
+  auto d_y = to_device(y, row_y * col_y);
+  BFloat16Cuda *d_z;
+  NBLA_CUDA_CHECK(cudaMalloc(&d_z, sizeof(BFloat16Cuda) * row_z * col_z));
+  cuda_gemm<BFloat16Cuda>(device, d_z, false, d_x, row_x, col_x, transpose_x,
+                          d_y, row_y, col_y, transpose_y, 1, 0);
+  to_host(d_z, row_z * col_z, z);
+  NBLA_CUDA_CHECK(cudaFree(d_x));
+  NBLA_CUDA_CHECK(cudaFree(d_y));
+}
+
+void bfloat16_atomic_add(bool cas, const float *values, int n, float *dst,
+                         int dst_size) {
+  auto d_values = to_device(values, n);
+  auto d_dst = to_device(dst, dst_size);
+  if (cas) {
+    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_atomic_add<true>, n, d_values,
+                                   dst_size, d_dst);
+  } else {
+    NBLA_CUDA_LAUNCH_KERNEL_SIMPLE(kernel_atomic_add<false>, n, d_values,
+                                   dst_size, d_dst);
+  }
+  to_host(d_dst, dst_size, dst);
+  NBLA_CUDA_CHECK(cudaFree(d_values));
+}
+#else
+bool bfloat16_available() { return false; }
+
+void bfloat16_gemm(int device, float *z, const float *x, int row_x, int col_x,
+                   bool transpose_x, const float *y, int row_y, int col_y,
+                   bool transpose_y) {
+  NBLA_ERROR(error_code::not_implemented, "bfloat16 requires CUDA 11.");
+}
+
+void bfloat16_atomic_add(bool cas, const float *values, int n, float *dst,
+                         int dst_size) {
+  NBLA_ERROR(error_code::not_implemented, "bfloat16 requires CUDA 11.");
+}
+#endif
+}
@@ -0,0 +1,38 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _NBLA_CUDA_BFLOAT16_KERNEL_CUH_
+#define _NBLA_CUDA_BFLOAT16_KERNEL_CUH_
+
+// Host entry points of the bfloat16 tests. All arrays are host float
+// arrays, converted to and from bfloat16 on the device side.
+namespace nbla {
+
+// Whether the extension is built with bfloat16 (CUDA 11 or later).
+bool bfloat16_available();
+
+// z = op(x) * op(y) by cuda_gemm<BFloat16Cuda>, with the column-major
+// layout of cuda_gemm. z has (transpose_x ? col_x : row_x) rows and
+// (transpose_y ? row_y : col_y) columns.
+void bfloat16_gemm(int device, float *z, const float *x, int row_x, int col_x,
+                   bool transpose_x, const float *y, int row_y, int col_y,
+                   bool transpose_y);
+
+// Thread i adds values[i] to dst[i % dst_size] with atomic_add, or with
+// the compare-and-swap fallback of architectures below sm_80 if `cas`.
+void bfloat16_atomic_add(bool cas, const float *values, int n, float *dst,
+                         int dst_size);
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// test_benchmark_utils.cpp
+
+#include "gtest/gtest.h"
+
+#include "../benchmark/benchmark_utils.hpp"
+#include <nbla/exception.hpp>
+
+namespace nbla {
+namespace benchmark {
+
+TEST(BenchmarkUtilsTest, ParseShape) {
+  EXPECT_EQ(parse_shape("8x64x56x56"), (Shape_t{8, 64, 56, 56}));
+  EXPECT_EQ(parse_shape("1024"), (Shape_t{1024}));
+  EXPECT_EQ(shape_to_string(Shape_t{8, 64, 56, 56}), "8x64x56x56");
+  EXPECT_THROW(parse_shape("8x0"), Exception);
+  EXPECT_THROW(parse_shape("8xa"), Exception);
+  EXPECT_THROW(parse_shape(""), Exception);
+}
+
+TEST(BenchmarkUtilsTest, ExpandGrid) {
+  const auto options = parse_options(
+      {"--names", "ReLU,Convolution", "--shapes", "8x64x56x56,2x3x4x5",
+       "--dtypes", "float,half", "--layouts", "nchw,nhwc", "--iterations",
+       "5"});
+  EXPECT_EQ(options.iterations, 5);
+  const auto cases = expand_grid(options);
+  ASSERT_EQ(cases.size(), 16);
+  EXPECT_EQ(case_key(cases.front()), "ReLU,8x64x56x56,float,nchw");
+  EXPECT_EQ(case_key(cases.back()), "Convolution,2x3x4x5,half,nhwc");
+
+  EXPECT_THROW(parse_options({"--shapes", "2x3"}), Exception);
+  EXPECT_THROW(parse_options({"--names", "ReLU", "--shapes"}), Exception);
+  EXPECT_THROW(
+      parse_options({"--names", "ReLU", "--shapes", "2", "--dtypes", "int"}),
+      Exception);
+}
+
+TEST(BenchmarkUtilsTest, Roofline) {
+  // V100: 877 MHz HBM2 on a 4096-bit bus, 80 SMs at 1530 MHz.
+  const auto roofline = compute_roofline(877000, 4096, 80, 1530000, 7, 0);
+  EXPECT_NEAR(roofline.bandwidth_gbps, 898.0, 1.0);
+  EXPECT_NEAR(roofline.tflops, 15.67, 0.01);
+  EXPECT_DOUBLE_EQ(to_gbps(1e9, 1000), 1.0);
+  EXPECT_DOUBLE_EQ(to_tflops(1e12, 1000), 1.0);
+  EXPECT_DOUBLE_EQ(to_gbps(1e9, 0), 0);
+}
+
+TEST(BenchmarkUtilsTest, BaselineRoundTrip) {
+  BenchmarkResult r;
+  r.bench_case = BenchmarkCase{"Affine", Shape_t{32, 1024}, "half", "nchw"};
+  r.implementation = "AffineCuda";
+  r.forward_ms = 0.125;
+  r.backward_ms = 0.25;
+  r.forward_bytes = 4096;
+  r.forward_flops = 1e9;
+  const auto text = to_baseline({r});
+  const auto parsed = parse_baseline(text);
+  ASSERT_EQ(parsed.size(), 1);
+  EXPECT_EQ(case_key(parsed[0].bench_case), case_key(r.bench_case));
+  EXPECT_EQ(parsed[0].implementation, r.implementation);
+  EXPECT_DOUBLE_EQ(parsed[0].forward_ms, r.forward_ms);
+  EXPECT_DOUBLE_EQ(parsed[0].backward_ms, r.backward_ms);
+  EXPECT_DOUBLE_EQ(parsed[0].forward_bytes, r.forward_bytes);
+  EXPECT_DOUBLE_EQ(parsed[0].forward_flops, r.forward_flops);
+  EXPECT_THROW(parse_baseline("unknown\n"), Exception);
+}
+
+TEST(BenchmarkUtilsTest, FindRegressions) {
+  BenchmarkResult base;
+  base.bench_case = BenchmarkCase{"ReLU", Shape_t{1024}, "float", "nchw"};
+  base.forward_ms = 1.0;
+  base.backward_ms = 1.0;
+  BenchmarkResult fast = base, slow = base, other = base;
+  fast.forward_ms = 1.05;
+  slow.backward_ms = 1.5;
+  other.bench_case.dtype = "half";
+  other.forward_ms = 10.0;
+  EXPECT_TRUE(find_regressions({fast}, {base}, 0.1).empty());
+  EXPECT_EQ(find_regressions({slow}, {base}, 0.1).size(), 1);
+  // Cases missing in the baseline are not compared.
+  EXPECT_TRUE(find_regressions({other}, {base}, 0.1).empty());
+}
+}
+}
@@ -0,0 +1,87 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// test_bfloat16.cpp
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "bfloat16_kernel.cuh"
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/init.hpp>
+
+namespace nbla {
+
+// Small integers are exact in bfloat16, and so are the products and sums
+// below, so the results must equal the float references.
+TEST(BFloat16Test, Gemm) {
+  if (!bfloat16_available())
+    return;
+  init_cuda();
+  std::mt19937 rng(313);
+  std::uniform_int_distribution<int> dist(-2, 2);
+  const int m = 5, k = 16, n = 7;
+  for (int tx = 0; tx < 2; tx++) {
+    for (int ty = 0; ty < 2; ty++) {
+      // op(x) is m x k and op(y) is k x n, all column-major.
+      const int row_x = tx ? k : m, col_x = tx ? m : k;
+      const int row_y = ty ? n : k, col_y = ty ? k : n;
+      std::vector<float> x(row_x * col_x), y(row_y * col_y), z(m * n);
+      for (auto &v : x)
+        v = dist(rng);
+      for (auto &v : y)
+        v = dist(rng);
+      bfloat16_gemm(0, z.data(), x.data(), row_x, col_x, tx, y.data(), row_y,
+                    col_y, ty);
+      for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+          float ref = 0;
+          for (int l = 0; l < k; l++) {
+            const float a = tx ? x[l + i * row_x] : x[i + l * row_x];
+            const float b = ty ? y[j + l * row_y] : y[l + j * row_y];
+            ref += a * b;
+          }
+          ASSERT_EQ(z[i + j * m], ref) << "tx=" << tx << " ty=" << ty
+                                       << " i=" << i << " j=" << j;
+        }
+      }
+    }
+  }
+}
+
+// Four adjacent values cover both halves of two 32-bit words, so an
+// update of one half must keep the other. The partial sums are exact in
+// bfloat16, so the result does not depend on the order of the updates.
+TEST(BFloat16Test, AtomicAdd) {
+  if (!bfloat16_available())
+    return;
+  init_cuda();
+  const int dst_size = 4, n = 256 * dst_size;
+  const float steps[dst_size] = {1.0f, 0.5f, 0.25f, 0.125f};
+  std::vector<float> values(n), ref(dst_size, 0.0f);
+  for (int i = 0; i < n; i++) {
+    values[i] = steps[i % dst_size];
+    ref[i % dst_size] += values[i];
+  }
+  for (int cas = 0; cas < 2; cas++) {
+    std::vector<float> dst(dst_size, 0.0f);
+    bfloat16_atomic_add(cas, values.data(), n, dst.data(), dst_size);
+    for (int i = 0; i < dst_size; i++) {
+      EXPECT_EQ(dst[i], ref[i]) << "cas=" << cas << " i=" << i;
+    }
+  }
+}
+}
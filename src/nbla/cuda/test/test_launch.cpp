@@ -0,0 +1,86 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// test_launch.cpp
+
+#include "gtest/gtest.h"
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/launch.hpp>
+
+namespace nbla {
+
+TEST(LaunchTest, LaunchDims) {
+  // 80 multiprocessors with 4 resident blocks of 512 threads.
+  const CudaLaunchConfig config{512, 4, 80};
+
+  auto dims = cuda_get_launch_dims(config, 0);
+  EXPECT_EQ(dims.blocks, 0);
+
+  // Capped at a full wave of 320 blocks.
+  dims = cuda_get_launch_dims(config, Size_t(1) << 32);
+  EXPECT_EQ(dims.threads, 512);
+  EXPECT_EQ(dims.blocks, 320);
+
+  // Exactly a full wave.
+  dims = cuda_get_launch_dims(config, 320 * 512);
+  EXPECT_EQ(dims.threads, 512);
+  EXPECT_EQ(dims.blocks, 320);
+
+  // Smaller blocks spread over the multiprocessors.
+  dims = cuda_get_launch_dims(config, 320 * 128);
+  EXPECT_EQ(dims.threads, 128);
+  EXPECT_EQ(dims.blocks, 320);
+
+  // Down to a warp for tiny sizes.
+  dims = cuda_get_launch_dims(config, 7);
+  EXPECT_EQ(dims.threads, 32);
+  EXPECT_EQ(dims.blocks, 1);
+}
+
+TEST(LaunchTest, InvalidOverride) {
+  EXPECT_THROW(cuda_set_launch_override("kernel_copy", 100), Exception);
+  EXPECT_THROW(cuda_set_launch_override("kernel_copy", 0), Exception);
+  cuda_set_launch_override("(kernel_copy)", 256, 2);
+  cuda_clear_launch_overrides();
+}
+
+TEST(LaunchTest, OverrideList) {
+  auto cache = SingletonManager::get<CudaLaunchConfigCache>();
+  // Commas of template arguments belong to the name.
+  cache->set_overrides("kernel_transform_unary<T, UnaryOp>=256:4, "
+                       "(kernel_copy)=128,kernel_fill<f(a, b)>=64");
+  EXPECT_EQ(cache->get_override("kernel_transform_unary<T, UnaryOp>"),
+            std::make_pair(256, 4));
+  EXPECT_EQ(cache->get_override("kernel_copy"), std::make_pair(128, 0));
+  EXPECT_EQ(cache->get_override("kernel_fill<f(a, b)>"),
+            std::make_pair(64, 0));
+  EXPECT_EQ(cache->get_override("kernel_transform_unary<T"),
+            std::make_pair(0, 0));
+  EXPECT_THROW(cache->set_overrides("kernel_copy=128:4:2"), Exception);
+  cache->clear_overrides();
+  EXPECT_EQ(cache->get_override("kernel_copy"), std::make_pair(0, 0));
+}
+
+TEST(LaunchTest, Generation) {
+  // Launch sites look up again after every change of the overrides.
+  auto generation = CudaLaunchConfigCache::generation();
+  EXPECT_GT(generation, 0);
+  cuda_set_launch_override("kernel_copy", 256);
+  EXPECT_GT(CudaLaunchConfigCache::generation(), generation);
+  generation = CudaLaunchConfigCache::generation();
+  cuda_clear_launch_overrides();
+  EXPECT_GT(CudaLaunchConfigCache::generation(), generation);
+}
+}
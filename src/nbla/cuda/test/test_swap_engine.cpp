@@ -0,0 +1,112 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// test_swap_engine.cpp
+
+#include "gtest/gtest.h"
+#include <cuda_runtime.h>
+
+#include <memory>
+#include <vector>
+
+#include "non_stop_kernel.cuh"
+#include <nbla/cuda/array/swap_engine.hpp>
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/cuda.hpp>
+#include <nbla/singleton_manager.hpp>
+#include <nbla/synced_array.hpp>
+
+namespace nbla {
+
+namespace {
+const Context host_ctx{{"cpu:float"}, "CudaCachedHostArray", "0"};
+const Context device_ctx{{"cuda:float"}, "CudaCachedArray", "0"};
+
+// An array with the values 0, 1, ... in pinned host memory.
+SyncedArrayPtr make_host_array(Size_t size) {
+  auto array = std::make_shared<SyncedArray>(size);
+  auto data = array->cast(dtypes::FLOAT, host_ctx)->pointer<float>();
+  for (Size_t i = 0; i < size; i++) {
+    data[i] = static_cast<float>(i);
+  }
+  return array;
+}
+}
+
+TEST(SwapEngineTest, Prefetch) {
+  init_cpu();
+  init_cuda();
+  cuda_swap_reset_statistics();
+
+  const Size_t size = 1024;
+  auto array = make_host_array(size);
+  cuda_swap_prefetch(array, dtypes::FLOAT, device_ctx);
+  auto stats = cuda_swap_get_statistics();
+  EXPECT_EQ(stats.prefetches, 1u);
+  EXPECT_EQ(stats.copies_htod, 1u);
+  EXPECT_EQ(stats.pageable_copies, 0u);
+
+  // Already on the device, so nothing is copied again.
+  cuda_swap_prefetch(array, dtypes::FLOAT, device_ctx);
+  stats = cuda_swap_get_statistics();
+  EXPECT_EQ(stats.prefetches, 2u);
+  EXPECT_EQ(stats.copies_htod, 1u);
+
+  std::vector<float> result(size);
+  NBLA_CUDA_CHECK(cudaMemcpy(
+      result.data(),
+      array->get(dtypes::FLOAT, device_ctx)->const_pointer<float>(),
+      sizeof(float) * size, cudaMemcpyDeviceToHost));
+  for (Size_t i = 0; i < size; i++) {
+    ASSERT_EQ(result[i], static_cast<float>(i));
+  }
+}
+
+TEST(SwapEngineTest, StallTime) {
+  init_cpu();
+  init_cuda();
+  cuda_swap_reset_statistics();
+
+  const Size_t size = Size_t(1) << 24;
+  auto array = make_host_array(size);
+  {
+    // Cache the device memory, since cudaMalloc would wait for the kernel.
+    SyncedArray warmup(size);
+    warmup.cast(dtypes::FLOAT, device_ctx);
+  }
+
+  // Keep the null stream busy, so that the copy ordered after it has not
+  // finished when the array is used.
+  bool h_flag = true;
+  bool *d_flag;
+  NBLA_CUDA_CHECK(cudaMalloc(&d_flag, sizeof(bool)));
+  NBLA_CUDA_CHECK(cudaMemcpy(d_flag, &h_flag, 1, cudaMemcpyHostToDevice));
+  stop_null_stream_until_flag_set(d_flag);
+
+  cuda_swap_prefetch(array, dtypes::FLOAT, device_ctx);
+  array->get(dtypes::FLOAT, device_ctx);
+  EXPECT_EQ(cuda_swap_get_statistics().late_waits, 1u);
+
+  cudaStream_t stream;
+  NBLA_CUDA_CHECK(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  NBLA_CUDA_CHECK(cudaMemsetAsync(d_flag, false, sizeof(bool), stream));
+  NBLA_CUDA_CHECK(cudaDeviceSynchronize());
+
+  // The null stream waited for the whole copy of 64 MiB.
+  EXPECT_GT(cuda_swap_get_statistics().stall_ms, 0);
+
+  NBLA_CUDA_CHECK(cudaStreamDestroy(stream));
+  NBLA_CUDA_CHECK(cudaFree(d_flag));
+}
+}
@@ -0,0 +1,133 @@
+// Copyright 2021 Sony Group Corporation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <nbla/cuda/common.hpp>
+#include <nbla/cuda/function/utils/fft.hpp>
+#include <nbla/cuda/graph.hpp>
+
+#include <cufftXt.h>
+
+#include <cstdlib>
+#include <sstream>
+
+namespace nbla {
+
+CufftPlan::CufftPlan(const CufftPlanKey &key) : work_size(0) {
+  cuda_set_device(key.device);
+  NBLA_CUFFT_CHECK(cufftCreate(&handle));
+  // Work areas are provided by CufftPlanCache.
+  NBLA_CUFFT_CHECK(cufftSetAutoAllocation(handle, false));
+  auto n = key.n;
+  auto inembed = key.inembed;
+  auto onembed = key.onembed;
+  NBLA_CUFFT_CHECK(cufftXtMakePlanMany(
+      handle, n.size(), n.data(), inembed.data(), key.istride, key.idist,
+      key.input_type, onembed.data(), key.ostride, key.odist, key.output_type,
+      key.batch, &work_size, key.execution_type));
+}
+
+CufftPlan::~CufftPlan() {
+  // Not checked since it may run at exit after the device is released.
+  cufftDestroy(handle);
+}
+
+CufftPlanCache::CufftPlanCache() : capacity_(128) {
+  const char *e = std::getenv("NNABLA_CUFFT_PLAN_CACHE_SIZE");
+  if (e) {
+    std::stringstream sstream(e);
+    long long int capacity;
+    NBLA_CHECK(sstream >> capacity && capacity >= 0, error_code::value,
+               "Invalid value: NNABLA_CUFFT_PLAN_CACHE_SIZE=%s. Non-negative "
+               "integer required.",
+               e);
+    capacity_ = capacity;
+  }
+}
+
+CufftPlanCache::~CufftPlanCache() {}
+
+shared_ptr<CufftPlan> CufftPlanCache::get_plan(const CufftPlanKey &key) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = plans_.find(key);
+  if (it != plans_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+  }
+  auto plan = std::make_shared<CufftPlan>(key);
+  if (capacity_ > 0) {
+    evict(capacity_ - 1);
+    lru_.emplace_front(key, plan);
+    plans_[key] = lru_.begin();
+  }
+  return plan;
+}
+
+void *CufftPlanCache::get_work_area(const Context &ctx, size_t bytes) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (CudaGraph::capturing()) {
+    capture_work_area_ = std::make_shared<NdArray>(
+        Shape_t{static_cast<Size_t>(std::max<size_t>(bytes, 1))});
+    return capture_work_area_->cast(get_dtype<unsigned char>(), ctx, true)
+        ->pointer<void>();
+  }
+  capture_work_area_ = nullptr;
+  auto &work_area = work_areas_[std::stoi(ctx.device_id)];
+  if (!work_area || static_cast<size_t>(work_area->size()) < bytes) {
+    // Grow to the largest size requested so far.
+    work_area = std::make_shared<NdArray>(
+        Shape_t{static_cast<Size_t>(std::max<size_t>(bytes, 1))});
+  }
+  return work_area->cast(get_dtype<unsigned char>(), ctx, true)
+      ->pointer<void>();
+}
+
+size_t CufftPlanCache::get_capacity() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return capacity_;
+}
+
+void CufftPlanCache::set_capacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  capacity_ = capacity;
+  evict(capacity_);
+}
+
+void CufftPlanCache::clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  evict(0);
+  work_areas_.clear();
+  capture_work_area_ = nullptr;
+}
+
+void CufftPlanCache::evict(size_t capacity) {
+  while (lru_.size() > capacity) {
+    plans_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+NBLA_INSTANTIATE_SINGLETON(NBLA_CUDA_API, CufftPlanCache);
+
+size_t cufft_get_plan_cache_capacity() {
+  return SingletonManager::get<CufftPlanCache>()->get_capacity();
+}
+
+void cufft_set_plan_cache_capacity(size_t capacity) {
+  SingletonManager::get<CufftPlanCache>()->set_capacity(capacity);
+}
+
+void cufft_clear_plan_cache() {
+  SingletonManager::get<CufftPlanCache>()->clear();
+}
+}